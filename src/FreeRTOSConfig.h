@@ -63,24 +63,31 @@
 #define configUSE_NEWLIB_REENTRANT              0
 #define configENABLE_BACKWARD_COMPATIBILITY     0
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5
+/* 0: drivers, 1: spsc.c blocking wrappers, 2: timekeeper events and render
+sources (timekeeper.h, render.h), 3: HD44780 bus DMA (hd44780_bus.h),
+4: console input (console.h) */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   5
 
 /* System */
 #define configSTACK_DEPTH_TYPE                  uint32_t
 #define configMESSAGE_BUFFER_LENGTH_TYPE        size_t
 
 /* Memory allocation related definitions. */
-#define configSUPPORT_STATIC_ALLOCATION         0
+#define configSUPPORT_STATIC_ALLOCATION         1
 #define configSUPPORT_DYNAMIC_ALLOCATION        1
-#define configTOTAL_HEAP_SIZE                   (128*1024)
+#define configTOTAL_HEAP_SIZE                   (16*1024)
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
 /* Hook function related definitions. */
+/* Method 2 also with stacks sized from a profile (-DSTACK_SIZES=<header>,
+tools/stack_report.py): the margin only covers the paths the profile ran,
+the pattern check catches an overflow the stack pointer check misses. */
 #define configCHECK_FOR_STACK_OVERFLOW          2
 #define configUSE_MALLOC_FAILED_HOOK            1
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS           0
+#define configGENERATE_RUN_TIME_STATS           1
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
@@ -104,7 +111,21 @@
 /* SMP port only */
 #define configNUM_CORES                         2
 #define configTICK_CORE                         0
-#define configRUN_MULTIPLE_PRIORITIES           0
+/* Tasks of different priorities run side by side, the placement table in
+main.c keeps the LCD and I/O tasks off the core of the control tasks. */
+#define configRUN_MULTIPLE_PRIORITIES           1
+#define configUSE_CORE_AFFINITY                 1
+
+/* Tickless idle (tickless.c), build with -DTICKLESS_IDLE=ON. The SMP kernel
+does not support it, so the scheduler then runs on core 0 only. */
+#ifdef TICKLESS_IDLE
+#if ( TICKLESS_IDLE == 1 )
+#undef configUSE_TICKLESS_IDLE
+#define configUSE_TICKLESS_IDLE                 2
+#undef configNUM_CORES
+#define configNUM_CORES                         1
+#endif
+#endif
 
 /* RP2040 specific */
 #define configSUPPORT_PICO_SYNC_INTEROP         1
@@ -133,6 +154,22 @@ to exclude the API function. */
 #define INCLUDE_xTaskResumeFromISR              1
 #define INCLUDE_xQueueGetMutexHolder            1
 
+/* Host build (FreeRTOS POSIX port): single core, tasks run as pthreads whose
+stacks come from the FreeRTOS heap, so they need far more room than on the
+RP2040. Stack overflow checking does not apply to the POSIX port. */
+#ifdef HOST_BUILD
+#undef configNUM_CORES
+#define configNUM_CORES                         1
+#undef configMINIMAL_STACK_SIZE
+#define configMINIMAL_STACK_SIZE                ( configSTACK_DEPTH_TYPE ) 4096
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE                   ( 1024 * 1024 )
+#undef configCHECK_FOR_STACK_OVERFLOW
+#define configCHECK_FOR_STACK_OVERFLOW          0
+#endif
+
 /* A header file that defines trace macro can be included here. */
+#include "trace.h"
+#include "tickless.h"
 
 #endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,78 @@
+#include "bench.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+#include <stdlib.h>
+
+void bench_reset(bench_samples *s) {
+    s->n = 0;
+}
+
+void bench_add(bench_samples *s, const uint32_t v) {
+    if(s->n < BENCH_MAX_SAMPLES) {
+        s->v[s->n++] = v;
+    }
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+uint32_t bench_percentile(bench_samples *s, const uint32_t pct) {
+    if(s->n == 0) { return 0; }
+    qsort(s->v, s->n, sizeof(s->v[0]), cmp_u32);
+    uint32_t i = (s->n * pct) / 100;
+    if(i >= s->n) { i = s->n - 1; }
+    return s->v[i];
+}
+
+void bench_report(const char *bench, const char *metric, const char *unit, bench_samples *s) {
+    uint64_t sum = 0;
+    for(uint32_t i=0; i<s->n; i++) { sum += s->v[i]; }
+    const uint32_t p50 = bench_percentile(s, 50);
+    const uint32_t p99 = bench_percentile(s, 99);
+    printf("{\"bench\":\"%s\",\"metric\":\"%s\",\"unit\":\"%s\",\"n\":%lu,"
+           "\"min\":%lu,\"p50\":%lu,\"p99\":%lu,\"max\":%lu,\"avg\":%lu}\n",
+        bench, metric, unit, (unsigned long)s->n,
+        (unsigned long)(s->n ? s->v[0] : 0), (unsigned long)p50, (unsigned long)p99,
+        (unsigned long)(s->n ? s->v[s->n - 1] : 0),
+        (unsigned long)(s->n ? sum / s->n : 0));
+}
+
+void bench_report_value(const char *bench, const char *metric, const char *unit, const uint64_t value) {
+    printf("{\"bench\":\"%s\",\"metric\":\"%s\",\"unit\":\"%s\",\"value\":%llu}\n",
+        bench, metric, unit, (unsigned long long)value);
+}
+
+void bench_report_histogram(const char *bench, const char *metric, const char *unit,
+        const bench_samples *s, const uint32_t bucket_width, uint32_t buckets) {
+    uint32_t count[BENCH_MAX_BUCKETS] = { 0 };
+    if(buckets > BENCH_MAX_BUCKETS) { buckets = BENCH_MAX_BUCKETS; }
+    if(buckets == 0 || bucket_width == 0) { return; }
+    for(uint32_t i=0; i<s->n; i++) {
+        uint32_t b = s->v[i] / bucket_width;
+        count[b < buckets ? b : buckets - 1]++;
+    }
+    printf("{\"bench\":\"%s\",\"metric\":\"%s\",\"unit\":\"%s\",\"bucket\":%lu,\"histogram\":[",
+        bench, metric, unit, (unsigned long)bucket_width);
+    for(uint32_t b=0; b<buckets; b++) {
+        printf(b ? ",%lu" : "%lu", (unsigned long)count[b]);
+    }
+    printf("]}\n");
+}
+
+void bench_done(void) {
+    printf("{\"bench\":\"done\"}\n");
+    fflush(stdout);
+#ifdef HOST_BUILD
+    exit(EXIT_SUCCESS);
+#else
+    vTaskDelete(NULL);
+#endif
+}
@@ -0,0 +1,44 @@
+#ifndef BENCH_H
+#define BENCH_H
+/*
+ * Helpers shared by the benchmark executables.
+ *
+ * Results are printed one JSON object per line so runs can be collected from
+ * USB stdio or the host build and compared with a script:
+ *   {"bench":"lcd","metric":"full_frame","unit":"us","n":50,"min":..,"p50":..,"p99":..,"max":..,"avg":..}
+ *   {"bench":"lcd","metric":"chars_per_s","value":..}
+ *   {"bench":"rx","metric":"wake_latency","unit":"us","bucket":..,"histogram":[..]}
+ */
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENCH_MAX_SAMPLES             ( 512 )
+#define BENCH_MAX_BUCKETS             ( 32 )
+
+typedef struct {
+    uint32_t n;
+    uint32_t v[BENCH_MAX_SAMPLES];
+} bench_samples;
+
+void bench_reset(bench_samples *s);
+// Samples past BENCH_MAX_SAMPLES are dropped
+void bench_add(bench_samples *s, const uint32_t v);
+// Sorts the samples in place
+uint32_t bench_percentile(bench_samples *s, const uint32_t pct);
+
+void bench_report(const char *bench, const char *metric, const char *unit, bench_samples *s);
+void bench_report_value(const char *bench, const char *metric, const char *unit, const uint64_t value);
+// Counts per bucket of bucket_width, the last bucket also holds everything above
+void bench_report_histogram(const char *bench, const char *metric, const char *unit,
+        const bench_samples *s, const uint32_t bucket_width, uint32_t buckets);
+
+// Leave the benchmark: exit on the host, park the task on target
+void bench_done(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
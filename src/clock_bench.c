@@ -0,0 +1,156 @@
+/*
+ * Timekeeper and clock widget benchmark.
+ *
+ * Built as clock_bench (RP2040, results over USB stdio) and clock_bench_host.
+ * common.c calls main_clock_bench() instead of main_blinky().
+ *
+ * The timekeeper runs on a fake counter clockbenchFAST_PPM fast against the
+ * real one, which plays the reference (an NTP server, a GPS):
+ * - second_bus_bytes   : data bytes plus instructions sent per second by the
+ *                        clock widget, through a 23:59:59 roll over
+ * - second_cpu         : time from the second event to the frame being
+ *                        handed to the bus
+ * - error_uncorrected  : wall clock error clockbenchSECONDS after the first
+ *                        set, when the time is set again from the reference
+ * - drift_ppb          : drift measured by that second set
+ * - error_corrected    : error another clockbenchSECONDS later
+ */
+
+#include "timekeeper.h"
+#include "clock_widget.h"
+#include "hd44780.h"
+#include "bench.h"
+#include "hal.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+
+#define clockbenchTASK_PRIORITY                ( tskIDLE_PRIORITY + 1 )
+#define clockbenchTIME_TASK_PRIORITY           ( tskIDLE_PRIORITY + 2 )
+
+#define clockbenchSECONDS                      ( 15 )
+#define clockbenchFAST_PPM                     ( 100 )
+// 2024-12-31 23:59:50 UTC, every digit rolls over 10 seconds in
+#define clockbenchSTART_S                      ( 1735689590ull )
+// Give the host time to open the USB serial port
+#define clockbenchUSB_SETTLE_MS                ( 2000 / portTICK_PERIOD_MS )
+
+int main_clock_bench( void );
+
+static void prvClockBenchTask( void *pvParameters );
+
+static bench_samples xBytes;
+static bench_samples xCpu;
+static uint64_t ullReferenceBase;
+
+/*-----------------------------------------------------------*/
+
+int main_clock_bench( void )
+{
+    printf(" Starting main_clock_bench.\n");
+
+    xTaskCreate( prvClockBenchTask, "BENCH", configMINIMAL_STACK_SIZE * 2, NULL, clockbenchTASK_PRIORITY, NULL );
+    vTaskStartScheduler();
+
+    for( ;; );
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+/* Counter running clockbenchFAST_PPM fast. */
+static uint64_t prvFastCounter( void )
+{
+    const uint64_t ullNow = hal_time_us();
+    return ullNow + ullNow * clockbenchFAST_PPM / 1000000;
+}
+/*-----------------------------------------------------------*/
+
+/* Reference wall time, the undisturbed counter. */
+static uint64_t prvReferenceUs( void )
+{
+    return ullReferenceBase + hal_time_us();
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitSeconds( const uint32_t ulSeconds )
+{
+    for( uint32_t i = 0; i < ulSeconds; )
+    {
+        if( timekeeper_wait( portMAX_DELAY ) & TIMEKEEPER_EVENT_SECOND )
+        {
+            i++;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvClockBenchTask( void *pvParameters )
+{
+TickType_t xNextWakeTime;
+clock_widget xClock;
+timekeeper_time xNow;
+timekeeper_stats xStats;
+
+    ( void ) pvParameters;
+
+#ifndef HOST_BUILD
+    vTaskDelay( clockbenchUSB_SETTLE_MS );
+#endif
+
+    xNextWakeTime = xTaskGetTickCount();
+    hd44780_init( &xNextWakeTime );
+    set_line( 0, "Hora" );
+    hd44780_frame_lock();
+    clock_widget_init( &xClock, hd44780_display_data[ 0 ], 5 );
+    hd44780_frame_unlock();
+
+    timekeeper_init( prvFastCounter );
+    xTaskCreate( timekeeperTask, "TIME", configMINIMAL_STACK_SIZE, NULL, clockbenchTIME_TASK_PRIORITY, NULL );
+    timekeeper_subscribe( NULL );
+
+    ullReferenceBase = clockbenchSTART_S * 1000000 - hal_time_us();
+    timekeeper_set_us( prvReferenceUs() );
+
+    /* One redraw per second event, the first one draws every digit. */
+    bench_reset( &xBytes );
+    bench_reset( &xCpu );
+    for( uint32_t i = 0; i <= clockbenchSECONDS; )
+    {
+        if( ( timekeeper_wait( portMAX_DELAY ) & TIMEKEEPER_EVENT_SECOND ) == 0 )
+        {
+            continue;
+        }
+        const uint64_t ullStart = hal_time_us();
+        timekeeper_split( timekeeper_now_s(), &xNow );
+        hd44780_frame_lock();
+        clock_widget_draw( &xClock, &xNow );
+        hd44780_frame_unlock();
+        display_frame();
+        const uint64_t ullTime = hal_time_us() - ullStart;
+        if( i > 0 )
+        {
+            bench_add( &xBytes, hd44780_shadow.stats.data_bytes + hd44780_shadow.stats.instructions );
+            bench_add( &xCpu, ( uint32_t ) ullTime );
+        }
+        i++;
+    }
+    bench_report( "clock", "second_bus_bytes", "bytes", &xBytes );
+    bench_report( "clock", "second_cpu", "us", &xCpu );
+    bench_report_value( "clock", "digits_written", "digits", xClock.digits_written );
+
+    /* Set from the reference again: measures the drift. */
+    timekeeper_set_us( prvReferenceUs() );
+    timekeeper_get_stats( &xStats );
+    bench_report_value( "clock", "error_uncorrected", "us", ( uint64_t ) ( xStats.last_error_us < 0 ? -xStats.last_error_us : xStats.last_error_us ) );
+    bench_report_value( "clock", "drift_ppb", "ppb", ( uint64_t ) ( xStats.drift_ppb < 0 ? -xStats.drift_ppb : xStats.drift_ppb ) );
+
+    prvWaitSeconds( clockbenchSECONDS );
+    const int64_t llError = ( int64_t ) ( timekeeper_now_us() - prvReferenceUs() );
+    bench_report_value( "clock", "error_corrected", "us", ( uint64_t ) ( llError < 0 ? -llError : llError ) );
+    bench_done();
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,35 @@
+#include "clock_widget.h"
+
+// Cell of every digit, the separators sit at 2 and 5
+static const uint8_t clock_widget_cell[6] = { 0, 1, 3, 4, 6, 7 };
+
+void clock_widget_init(clock_widget *w, char *row, const int col) {
+    int end = 0;
+    while(row[end] != '\0') { end++; }
+    for(int i=end; i<col + CLOCK_WIDGET_WIDTH; i++) {
+        row[i] = ' ';
+    }
+    if(end <= col + CLOCK_WIDGET_WIDTH) {
+        row[col + CLOCK_WIDGET_WIDTH] = '\0';
+    }
+    w->cells = row + col;
+    w->cells[2] = ':';
+    w->cells[5] = ':';
+    w->valid = false;
+    w->draws = 0;
+    w->digits_written = 0;
+}
+
+void clock_widget_draw(clock_widget *w, const timekeeper_time *t) {
+    const uint8_t fields[3] = { t->hour, t->minute, t->second };
+    for(int i=0; i<6; i++) {
+        const uint8_t v = fields[i / 2];
+        const uint8_t digit = (i & 0x01) ? v % 10 : v / 10;
+        if(w->valid && w->digits[i] == digit) { continue; }
+        w->digits[i] = digit;
+        w->cells[clock_widget_cell[i]] = (char)('0' + digit);
+        w->digits_written++;
+    }
+    w->valid = true;
+    w->draws++;
+}
@@ -0,0 +1,34 @@
+#ifndef CLOCK_WIDGET_H
+#define CLOCK_WIDGET_H
+/*
+ * HH:MM:SS clock drawn into a frame row.
+ *
+ * Only the digits that changed since the last draw are stored into the
+ * frame, and hd44780_fb only sends cells that changed: a normal second costs
+ * one data byte (and the set DDRAM address in front of it) on the bus, a
+ * new minute a few more. No printf.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "timekeeper.h"
+
+#define CLOCK_WIDGET_WIDTH            ( 8 )
+
+typedef struct {
+    char *cells;                  // First cell of the widget in the frame
+    uint8_t digits[6];            // Shown hh mm ss digits
+    bool valid;
+    uint32_t draws;
+    uint32_t digits_written;
+} clock_widget;
+
+/*
+ * Place the widget at column `col` of the NUL terminated `row`, which holds
+ * at least `col` + CLOCK_WIDGET_WIDTH + 1 bytes. The row is padded with
+ * spaces up to the widget and the separators are drawn.
+ */
+void clock_widget_init(clock_widget *w, char *row, const int col);
+// Store the digits of `t` that differ from what is shown
+void clock_widget_draw(clock_widget *w, const timekeeper_time *t);
+#endif
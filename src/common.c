@@ -49,16 +49,28 @@
 
 /* Library includes. */
 #include <stdio.h>
-#include "pico/stdlib.h"
+#include "hal.h"
+#ifdef HOST_BUILD
+#include "hal_host.h"
+#endif
 #if ( mainRUN_ON_CORE == 1 )
 #include "pico/multicore.h"
 #endif
 
 #include "common.h"
+#include "periodic.h"
+#include "tickless.h"
 
 /* Set mainCREATE_SIMPLE_BLINKY_DEMO_ONLY to one to run the simple blinky demo,
 or 0 to run the more comprehensive test and demo application. */
 
+/* mainAPP_ENTRY is the function started by vLaunch(), the benchmark
+executables define it to their own entry point. */
+#ifndef mainAPP_ENTRY
+#define mainAPP_ENTRY                       main_blinky
+#endif
+extern int mainAPP_ENTRY( void );
+
 /*-----------------------------------------------------------*/
 
 /*-----------------------------------------------------------*/
@@ -68,7 +80,7 @@ void vLaunch( void)
     /* The mainCREATE_SIMPLE_BLINKY_DEMO_ONLY setting is described at the top
 of this file. */
     {
-        main_blinky();
+        mainAPP_ENTRY();
     }
 }
 
@@ -103,10 +115,11 @@ int main( void )
 
 static void prvSetupHardware( void )
 {
-    stdio_init_all();
-    gpio_init(PICO_DEFAULT_LED_PIN);
-    gpio_set_dir(PICO_DEFAULT_LED_PIN, 1);
-    gpio_put(PICO_DEFAULT_LED_PIN, !PICO_DEFAULT_LED_PIN_INVERTED);
+    hal_init();
+    hal_gpio_init(HAL_LED_PIN);
+    hal_gpio_set_dir(HAL_LED_PIN, HAL_GPIO_OUT);
+    hal_gpio_put(HAL_LED_PIN, !HAL_LED_PIN_INVERTED);
+    tickless_init();
 }
 /*-----------------------------------------------------------*/
 
@@ -155,4 +168,57 @@ void vApplicationIdleHook( void )
 }
 /*-----------------------------------------------------------*/
 
-void vApplicationTickHook( void ) { }
+void vApplicationTickHook( void )
+{
+    tickless_tick();
+    periodic_tick();
+#ifdef HOST_BUILD
+    hal_host_tick();
+#endif
+}
+/*-----------------------------------------------------------*/
+
+/* configSUPPORT_STATIC_ALLOCATION is set, so the kernel asks the application
+for the memory of the tasks it creates itself. */
+void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer,
+                                    StackType_t **ppxIdleTaskStackBuffer,
+                                    uint32_t *pulIdleTaskStackSize )
+{
+static StaticTask_t xIdleTaskTCB;
+static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+#if defined( configNUMBER_OF_CORES ) && ( configNUMBER_OF_CORES > 1 )
+/* Kernels with configNUMBER_OF_CORES (V11+) create one passive idle task per
+extra core and ask for its memory too. */
+void vApplicationGetPassiveIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer,
+                                           StackType_t **ppxIdleTaskStackBuffer,
+                                           uint32_t *pulIdleTaskStackSize,
+                                           BaseType_t xPassiveIdleTaskIndex )
+{
+static StaticTask_t xIdleTaskTCBs[ configNUMBER_OF_CORES - 1 ];
+static StackType_t uxIdleTaskStacks[ configNUMBER_OF_CORES - 1 ][ configMINIMAL_STACK_SIZE ];
+
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCBs[ xPassiveIdleTaskIndex ];
+    *ppxIdleTaskStackBuffer = uxIdleTaskStacks[ xPassiveIdleTaskIndex ];
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+#endif
+/*-----------------------------------------------------------*/
+
+void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer,
+                                     StackType_t **ppxTimerTaskStackBuffer,
+                                     uint32_t *pulTimerTaskStackSize )
+{
+static StaticTask_t xTimerTaskTCB;
+static StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+
+    *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
@@ -0,0 +1,301 @@
+#include "console.h"
+#include "hd44780.h"
+#include "render.h"
+#include "pool.h"
+#include "periodic.h"
+#include "input.h"
+#include "dlog.h"
+
+/* Library includes. */
+#include <stdio.h>
+#include <string.h>
+#ifdef HOST_BUILD
+#include <stdlib.h>
+#endif
+
+#define CONSOLE_RX_MASK               ( CONSOLE_RX_SIZE - 1 )
+#define CONSOLE_FRAME_BYTES           ( NROW * ROWLENCP )
+
+static uint8_t console_rx[CONSOLE_RX_SIZE];
+// Free running, head written by the producer only, tail by the task
+static uint32_t console_rx_head = 0;
+static uint32_t console_rx_tail = 0;
+
+// Whole frames for frame and show, taken from a pool rather than the
+// task's stack, which would have to be sized for the deepest command
+typedef struct {
+    char rows[NROW][ROWLEN];
+} console_frame;
+POOL_DEFINE(console_frame_pool, sizeof(console_frame), CONSOLE_FRAME_BUFFERS);
+
+// Task side
+static char console_line[CONSOLE_LINE_MAX + 1];
+static size_t console_line_len = 0;
+static int console_line_overlong = 0;
+static console_stats console_totals;
+
+size_t console_rx_free(void) {
+    const uint32_t tail = __atomic_load_n(&console_rx_tail, __ATOMIC_ACQUIRE);
+    return CONSOLE_RX_SIZE - (console_rx_head - tail);
+}
+
+size_t console_receive(const uint8_t *data, const size_t len) {
+    const uint32_t head = console_rx_head;
+    size_t n = console_rx_free();
+    if(n < len) {
+        __atomic_store_n(&console_totals.rx_full, console_totals.rx_full + 1, __ATOMIC_RELAXED);
+    } else {
+        n = len;
+    }
+    for(size_t i=0; i<n; i++) {
+        console_rx[(head + i) & CONSOLE_RX_MASK] = data[i];
+    }
+    // Publish the bytes after their contents
+    __atomic_store_n(&console_rx_head, head + (uint32_t)n, __ATOMIC_RELEASE);
+    return n;
+}
+
+void console_get_stats(console_stats *stats) {
+    *stats = console_totals;
+}
+
+// Next space separated word of `*s`, NULL at the end of the line
+static char *next_word(char **s) {
+    char *p = *s;
+    while(*p == ' ') { p++; }
+    if(*p == '\0') { *s = p; return NULL; }
+    char *word = p;
+    while(*p != ' ' && *p != '\0') { p++; }
+    if(*p == ' ') { *p++ = '\0'; }
+    *s = p;
+    return word;
+}
+
+// Decimal below `limit`, -1 if it is not one
+static int parse_index(const char *word, const int limit) {
+    if(word == NULL || *word == '\0') { return -1; }
+    int v = 0;
+    for(const char *p = word; *p; p++) {
+        if(*p < '0' || *p > '9') { return -1; }
+        v = v * 10 + (*p - '0');
+        if(v >= limit) { return -1; }
+    }
+    return v;
+}
+
+static int hex_digit(const char c) {
+    if(c >= '0' && c <= '9') { return c - '0'; }
+    if(c >= 'a' && c <= 'f') { return c - 'a' + 10; }
+    if(c >= 'A' && c <= 'F') { return c - 'A' + 10; }
+    return -1;
+}
+
+// The text argument: one separating space dropped, the rest as typed
+static const char *rest_text(char *s) {
+    return *s == ' ' ? s + 1 : s;
+}
+
+static const char *cmd_line(char *args) {
+    const int row = parse_index(next_word(&args), NROW);
+    if(row < 0) { return "row"; }
+    set_line_utf8(row, rest_text(args));
+    return NULL;
+}
+
+static const char *cmd_cell(char *args) {
+    const int row = parse_index(next_word(&args), NROW);
+    if(row < 0) { return "row"; }
+    const int col = parse_index(next_word(&args), ROWLENCP);
+    if(col < 0) { return "col"; }
+    const char *text = rest_text(args);
+
+    char cells[ROWLEN];
+    hd44780_frame_lock();
+    memcpy(cells, hd44780_display_data[row], ROWLEN);
+    hd44780_frame_unlock();
+    size_t len = strlen(cells);
+    // Cells past the end of the row string are blanks
+    while(len < (size_t)col) { cells[len++] = ' '; }
+    size_t c = (size_t)col;
+    for(; c < ROWLENCP && *text; c++, text++) {
+        cells[c] = *text;
+    }
+    if(c > len) { cells[c] = '\0'; }
+    else { cells[len] = '\0'; }
+    set_line(row, cells);
+    return NULL;
+}
+
+static const char *cmd_frame(char *args) {
+    const char *hex = rest_text(args);
+    if(strlen(hex) != 2 * CONSOLE_FRAME_BYTES) { return "frame size"; }
+    // Checked whole before the frame changes
+    for(size_t i=0; i<2 * CONSOLE_FRAME_BYTES; i++) {
+        if(hex_digit(hex[i]) < 0) { return "hex"; }
+    }
+    // 00 to 0F are the CGRAM slots, which the glyph cache hands out and
+    // rewrites: what they show is not the sender's to pick
+    for(size_t i=0; i<2 * CONSOLE_FRAME_BYTES; i+=2) {
+        if(hex_digit(hex[i]) == 0) { return "cgram"; }
+    }
+    console_frame *frame = pool_alloc(&console_frame_pool);
+    if(frame == NULL) { return "no buffer"; }
+    for(int r=0; r<NROW; r++) {
+        for(int c=0; c<ROWLENCP; c++) {
+            const char *cell = hex + 2 * (r * ROWLENCP + c);
+            frame->rows[r][c] = (char)(hex_digit(cell[0]) << 4 | hex_digit(cell[1]));
+        }
+        frame->rows[r][ROWLENCP] = '\0';
+    }
+    for(int r=0; r<NROW; r++) {
+        set_line(r, frame->rows[r]);
+    }
+    pool_free(&console_frame_pool, frame);
+    console_totals.frames++;
+    return NULL;
+}
+
+static const char *cmd_clear(char *args) {
+    ( void ) args;
+    for(int r=0; r<NROW; r++) {
+        set_line(r, "");
+    }
+    return NULL;
+}
+
+static const char *cmd_show(char *args) {
+    ( void ) args;
+    console_frame *frame = pool_alloc(&console_frame_pool);
+    if(frame == NULL) { return "no buffer"; }
+    hd44780_frame_lock();
+    memcpy(frame->rows, hd44780_display_data, sizeof(frame->rows));
+    hd44780_frame_unlock();
+    for(int r=0; r<NROW; r++) {
+        printf("ROW %d |%-*.*s|\n", r, ROWLENCP, ROWLENCP, frame->rows[r]);
+    }
+    pool_free(&console_frame_pool, frame);
+    return NULL;
+}
+
+static const char *cmd_stats(char *args) {
+    ( void ) args;
+    console_stats c;
+    dlog_stats d;
+    console_get_stats(&c);
+    dlog_get_stats(&d);
+    printf("CONSOLE rx_bytes=%lu lines=%lu errors=%lu overlong=%lu frames=%lu rx_full=%lu\n",
+        (unsigned long)c.rx_bytes, (unsigned long)c.lines, (unsigned long)c.errors,
+        (unsigned long)c.overlong, (unsigned long)c.frames, (unsigned long)c.rx_full);
+    render_report();
+    pool_report();
+    periodic_report();
+    input_report();
+    printf("DLOG records=%lu dropped=%lu bytes=%lu\n",
+        (unsigned long)d.records, (unsigned long)d.dropped, (unsigned long)d.bytes);
+    return NULL;
+}
+
+#ifdef HOST_BUILD
+// Ends a scripted run
+static const char *cmd_quit(char *args) {
+    ( void ) args;
+    printf("OK\n");
+    fflush(stdout);
+    exit(0);
+}
+#endif
+
+static const char *cmd_help(char *args);
+
+typedef struct {
+    const char *name;
+    const char *(*run)(char *args);   // NULL or the reason of the ERR
+    const char *usage;
+} console_command;
+
+static const console_command console_commands[] = {
+    { "line",  cmd_line,  "line <row> <text>" },
+    { "cell",  cmd_cell,  "cell <row> <col> <text>" },
+    { "frame", cmd_frame, "frame <hex of every cell>" },
+    { "clear", cmd_clear, "clear" },
+    { "show",  cmd_show,  "show" },
+    { "stats", cmd_stats, "stats" },
+#ifdef HOST_BUILD
+    { "quit",  cmd_quit,  "quit" },
+#endif
+    { "help",  cmd_help,  "help" },
+};
+#define CONSOLE_COMMANDS              ( sizeof(console_commands) / sizeof(console_commands[0]) )
+
+static const char *cmd_help(char *args) {
+    ( void ) args;
+    for(size_t i=0; i<CONSOLE_COMMANDS; i++) {
+        printf("%s\n", console_commands[i].usage);
+    }
+    return NULL;
+}
+
+void console_execute(char *line) {
+    char *args = line;
+    const char *name = next_word(&args);
+    const char *error = "unknown command";
+
+    console_totals.lines++;
+    if(name == NULL) { return; }
+    for(size_t i=0; i<CONSOLE_COMMANDS; i++) {
+        if(strcmp(name, console_commands[i].name) == 0) {
+            error = console_commands[i].run(args);
+            break;
+        }
+    }
+    if(error) {
+        console_totals.errors++;
+        printf("ERR %s\n", error);
+    } else {
+        printf("OK\n");
+    }
+}
+
+// Lines end at \n, a \r before it is dropped
+static void console_input(const char c) {
+    if(c == '\n') {
+        if(console_line_overlong) {
+            console_totals.overlong++;
+            console_totals.errors++;
+            printf("ERR line too long\n");
+        } else {
+            if(console_line_len > 0 && console_line[console_line_len - 1] == '\r') { console_line_len--; }
+            console_line[console_line_len] = '\0';
+            console_execute(console_line);
+        }
+        console_line_len = 0;
+        console_line_overlong = 0;
+    } else if(console_line_len < CONSOLE_LINE_MAX) {
+        console_line[console_line_len++] = c;
+    } else {
+        console_line_overlong = 1;
+    }
+}
+
+void consoleTask( void *pvParameters ) {
+    ( void ) pvParameters;
+
+    pool_init(&console_frame_pool);
+    console_port_init(xTaskGetCurrentTaskHandle());
+    for( ;; ) {
+        ( void ) ulTaskNotifyTakeIndexed(CONSOLE_NOTIFY_INDEX, pdTRUE, pdMS_TO_TICKS(CONSOLE_POLL_MS));
+        console_port_poll();
+
+        const uint32_t head = __atomic_load_n(&console_rx_head, __ATOMIC_ACQUIRE);
+        uint32_t tail = console_rx_tail;
+        if(head == tail) { continue; }
+        console_totals.rx_bytes += head - tail;
+        while(tail != head) {
+            const char c = (char)console_rx[tail++ & CONSOLE_RX_MASK];
+            // The slot is free for the producer again
+            __atomic_store_n(&console_rx_tail, tail, __ATOMIC_RELEASE);
+            console_input(c);
+        }
+        fflush(stdout);
+    }
+}
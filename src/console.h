@@ -0,0 +1,79 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+/*
+ * Line command console over stdio (USB CDC on target, stdin/stdout on the
+ * host).
+ *
+ * Bytes come in through a lock-free ring: the backend pushes whatever the
+ * port has with console_receive(), never waiting for a character, and
+ * consoleTask() takes them out, assembles lines in a fixed buffer and runs
+ * them. No heap, nothing blocks but the task's own wait for input. A full
+ * ring is backpressure, not loss: the backend leaves the rest in the port.
+ * Commands only hand text to the LCD (set_line(), set_line_utf8()), which
+ * asks the renderer for a frame. The whole frame buffers of frame and show
+ * come from console_frame_pool (pool.h), a POOL line in stats.
+ *
+ *   line <row> <text>        row from column 0, UTF-8
+ *   cell <row> <col> <text>  cells from col, the rest of the row kept
+ *   frame <hex>              every cell, NROW * ROWLENCP bytes as hex, 00 to
+ *                            0F (CGRAM, owned by the glyph cache) are refused
+ *   clear                    blank frame
+ *   show                     the frame as rows of ROW <n> |text|
+ *   stats                    CONSOLE, RENDER, POOL, PERIODIC, INPUT and DLOG counter lines
+ *   help
+ *
+ * Every command answers one OK or ERR <reason> line after its output.
+ * tools/lcd_console.py sends lines and streams frames at a given rate.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONSOLE_RX_SIZE               ( 1024 ) // Bytes, power of 2
+// The longest line, "frame" and its hex fit
+#define CONSOLE_LINE_MAX              ( 160 )
+// The backend wakes the task on input, the period is the fallback
+#define CONSOLE_POLL_MS               ( 10 )
+// Its own index, the commands end up in code that waits on the others
+#define CONSOLE_NOTIFY_INDEX          ( 4 )
+// Frame buffers of the console_frame_pool, one command runs at a time
+#define CONSOLE_FRAME_BUFFERS         ( 1 )
+
+typedef struct {
+    uint32_t rx_bytes;
+    uint32_t lines;
+    uint32_t errors;              // ERR answers
+    uint32_t overlong;            // Lines longer than CONSOLE_LINE_MAX, dropped
+    uint32_t frames;              // frame uploads
+    uint32_t rx_full;             // console_receive() calls that found the ring full
+} console_stats;
+
+void consoleTask( void *pvParameters );
+
+// Producer side of the ring, one caller at a time. Returns the bytes taken
+size_t console_receive(const uint8_t *data, const size_t len);
+size_t console_rx_free(void);
+// Runs one line (no terminator) as if it came in, for tests and benches.
+// frame and show need the pool consoleTask() sets up.
+void console_execute(char *line);
+void console_get_stats(console_stats *stats);
+
+/*
+ * Backend, console_port.c or host/console_port_host.c. init() arranges for
+ * input to reach the ring and may notify `task` on CONSOLE_NOTIFY_INDEX
+ * when it arrives. poll() is called by the task before it parses, it moves
+ * whatever is pending into the ring without waiting.
+ */
+void console_port_init(TaskHandle_t task);
+void console_port_poll(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,41 @@
+/*
+ * Input backend of console.h on the pico SDK stdio, USB CDC or UART.
+ *
+ * The SDK calls back from its interrupt when characters arrive, which only
+ * wakes the console task. The task then takes what stdio holds with zero
+ * timeout reads, as much as the ring has room for: the rest stays in the
+ * CDC buffer and USB holds the host back until the next poll.
+ */
+#include "console.h"
+
+/* Library includes. */
+#include "pico/stdlib.h"
+
+static TaskHandle_t console_port_task = NULL;
+
+static void chars_available(void *param) {
+    BaseType_t woken = pdFALSE;
+    ( void ) param;
+    vTaskNotifyGiveIndexedFromISR(console_port_task, CONSOLE_NOTIFY_INDEX, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void console_port_init(TaskHandle_t task) {
+    console_port_task = task;
+    stdio_set_chars_available_callback(chars_available, NULL);
+}
+
+void console_port_poll(void) {
+    uint8_t chunk[32];
+    size_t room = console_rx_free();
+    while(room > 0) {
+        size_t n = 0;
+        while(n < sizeof(chunk) && n < room) {
+            const int c = getchar_timeout_us(0);
+            if(c < 0) { break; }
+            chunk[n++] = (uint8_t)c;
+        }
+        if(n == 0) { break; }
+        room -= console_receive(chunk, n);
+    }
+}
@@ -0,0 +1,237 @@
+/*
+ * Credential lookups in the flash tables of cred_index.h.
+ *
+ * Built as cred_bench (RP2040, results over USB stdio) and cred_bench_host.
+ * common.c calls main_cred_bench() instead of main_blinky(). The build
+ * generates six tables with tools/cred_index_gen.py: 1k, 10k and 50k random
+ * 4 and 7 byte UIDs, each as a minimal perfect hash and in Eytzinger order.
+ *
+ * Per table, <layout>_<count>_hit and _miss are the cost of one lookup,
+ * averaged over credbenchPROBES lookups and reported over credbenchROUNDS
+ * rounds with the scheduler suspended, in core clock cycles on target and
+ * nanoseconds on the host. Hits are entries spread over the whole table,
+ * misses random UIDs. On target _hit_cold flushes the XIP cache before
+ * every lookup (the flush alone subtracted), the cost of a tap after the
+ * cache was taken over by other code. _flash is the size of keys and pilots
+ * and _errors counts hits not found and misses found, it must be 0.
+ */
+
+#include "cred_index.h"
+#include "bench.h"
+#include "hal.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+#include <string.h>
+#ifdef HOST_BUILD
+#include <time.h>
+#else
+#include "hardware/clocks.h"
+#include "hardware/structs/xip_ctrl.h"
+#endif
+
+#define credbenchTASK_PRIORITY                 ( tskIDLE_PRIORITY + 1 )
+
+#define credbenchPROBES                        ( 256 )
+#define credbenchROUNDS                        ( 20 )
+#define credbenchUID_MAX                       ( 10 )
+// Give the host time to open the USB serial port
+#define credbenchUSB_SETTLE_MS                 ( 2000 / portTICK_PERIOD_MS )
+
+int main_cred_bench( void );
+
+static void prvCredBenchTask( void *pvParameters );
+
+/* Generated by the build, see src/CMakeLists.txt. */
+extern const cred_index cred_1000_mph;
+extern const cred_index cred_1000_eytzinger;
+extern const cred_index cred_10000_mph;
+extern const cred_index cred_10000_eytzinger;
+extern const cred_index cred_50000_mph;
+extern const cred_index cred_50000_eytzinger;
+
+typedef struct
+{
+    const char *pcName;
+    const cred_index *pxIndex;
+} CredTable_t;
+
+static const CredTable_t xTables[] =
+{
+    { "mph_1k", &cred_1000_mph },
+    { "eytzinger_1k", &cred_1000_eytzinger },
+    { "mph_10k", &cred_10000_mph },
+    { "eytzinger_10k", &cred_10000_eytzinger },
+    { "mph_50k", &cred_50000_mph },
+    { "eytzinger_50k", &cred_50000_eytzinger },
+};
+
+typedef struct
+{
+    uint8_t ucUid[ credbenchUID_MAX ];
+    uint8_t ucLen;
+} Probe_t;
+
+static Probe_t xHits[ credbenchPROBES ];
+static Probe_t xMisses[ credbenchPROBES ];
+static bench_samples xCost;
+
+/*-----------------------------------------------------------*/
+
+int main_cred_bench( void )
+{
+    printf(" Starting main_cred_bench.\n");
+
+    xTaskCreate( prvCredBenchTask, "BENCH", configMINIMAL_STACK_SIZE * 2, NULL, credbenchTASK_PRIORITY, NULL );
+    vTaskStartScheduler();
+
+    for( ;; );
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+/* Wall clock, the host virtual clock only advances with the busy waits. */
+static uint64_t prvNowNs( void )
+{
+#ifdef HOST_BUILD
+    struct timespec xNow;
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+    return ( uint64_t ) xNow.tv_sec * 1000000000u + ( uint64_t ) xNow.tv_nsec;
+#else
+    return hal_time_us() * 1000u;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+/* Nanoseconds to the unit of the reports. */
+static uint32_t prvCost( const uint64_t ullNs, const uint32_t ulLookups )
+{
+#ifdef HOST_BUILD
+    return ( uint32_t ) ( ullNs / ulLookups );
+#else
+    const uint64_t ullMhz = clock_get_hz( clk_sys ) / 1000000u;
+    return ( uint32_t ) ( ( ullNs * ullMhz ) / ( 1000u * ulLookups ) );
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvFlushXip( void )
+{
+#ifndef HOST_BUILD
+    /* Reading back waits for the flush to finish. */
+    xip_ctrl_hw->flush = 1;
+    ( void ) xip_ctrl_hw->flush;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+/* Entries spread over the table, and random UIDs of the same sizes. */
+static void prvProbes( const cred_index *pxIndex )
+{
+uint32_t ulSeed = 0xC0FFEE;
+
+    for( uint32_t i = 0; i < credbenchPROBES; i++ )
+    {
+        const uint32_t ulEntry = ( uint32_t ) ( ( ( uint64_t ) i * pxIndex->count ) / credbenchPROBES );
+        xHits[ i ].ucLen = ( uint8_t ) cred_index_uid( pxIndex, ulEntry, xHits[ i ].ucUid );
+
+        xMisses[ i ].ucLen = ( i & 1 ) ? 7 : 4;
+        for( uint8_t j = 0; j < xMisses[ i ].ucLen; j++ )
+        {
+            ulSeed = ulSeed * 1103515245u + 12345u;
+            xMisses[ i ].ucUid[ j ] = ( uint8_t ) ( ulSeed >> 16 );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* One round over the probes, returns the lookups that did not give
+xExpected. */
+static uint32_t prvRound( const cred_index *pxIndex, const Probe_t *pxProbes, const bool xExpected, const BaseType_t xCold )
+{
+uint32_t ulWrong = 0;
+
+    for( uint32_t i = 0; i < credbenchPROBES; i++ )
+    {
+        if( xCold )
+        {
+            prvFlushXip();
+        }
+        ulWrong += cred_index_contains( pxIndex, pxProbes[ i ].ucUid, pxProbes[ i ].ucLen ) != xExpected;
+    }
+    return ulWrong;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvMeasure( const CredTable_t *pxTable, const Probe_t *pxProbes, const bool xExpected,
+                            const BaseType_t xCold, const char *pcVariant )
+{
+char cMetric[ 32 ];
+uint32_t ulWrong = 0;
+
+    bench_reset( &xCost );
+    for( uint32_t r = 0; r < credbenchROUNDS; r++ )
+    {
+        vTaskSuspendAll();
+        const uint64_t ullStart = prvNowNs();
+        ulWrong += prvRound( pxTable->pxIndex, pxProbes, xExpected, xCold );
+        uint64_t ullNs = prvNowNs() - ullStart;
+
+        if( xCold )
+        {
+            const uint64_t ullFlushStart = prvNowNs();
+            for( uint32_t i = 0; i < credbenchPROBES; i++ )
+            {
+                prvFlushXip();
+            }
+            const uint64_t ullFlushNs = prvNowNs() - ullFlushStart;
+            ullNs = ullNs > ullFlushNs ? ullNs - ullFlushNs : 0;
+        }
+        ( void ) xTaskResumeAll();
+        bench_add( &xCost, prvCost( ullNs, credbenchPROBES ) );
+    }
+
+    snprintf( cMetric, sizeof( cMetric ), "%s_%s", pxTable->pcName, pcVariant );
+#ifdef HOST_BUILD
+    bench_report( "cred", cMetric, "ns", &xCost );
+#else
+    bench_report( "cred", cMetric, "cycles", &xCost );
+#endif
+    return ulWrong;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCredBenchTask( void *pvParameters )
+{
+char cMetric[ 32 ];
+
+    ( void ) pvParameters;
+
+#ifndef HOST_BUILD
+    vTaskDelay( credbenchUSB_SETTLE_MS );
+#endif
+
+    for( size_t t = 0; t < sizeof( xTables ) / sizeof( xTables[ 0 ] ); t++ )
+    {
+        const CredTable_t *pxTable = &xTables[ t ];
+        uint32_t ulErrors = 0;
+
+        prvProbes( pxTable->pxIndex );
+        ulErrors += prvMeasure( pxTable, xHits, true, pdFALSE, "hit" );
+        ulErrors += prvMeasure( pxTable, xMisses, false, pdFALSE, "miss" );
+#ifndef HOST_BUILD
+        ulErrors += prvMeasure( pxTable, xHits, true, pdTRUE, "hit_cold" );
+#endif
+
+        snprintf( cMetric, sizeof( cMetric ), "%s_flash", pxTable->pcName );
+        bench_report_value( "cred", cMetric, "bytes", cred_index_flash_bytes( pxTable->pxIndex ) );
+        snprintf( cMetric, sizeof( cMetric ), "%s_errors", pxTable->pcName );
+        bench_report_value( "cred", cMetric, "lookups", ulErrors );
+    }
+    bench_done();
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,104 @@
+#include "cred_index.h"
+
+#include <string.h>
+
+// Finalizer of MurmurHash3, every input bit reaches every output bit
+static inline uint32_t fmix32(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// x * n / 2^32: [0, n) without a division
+static inline uint32_t fastrange(const uint32_t x, const uint32_t n) {
+    return (uint32_t)(((uint64_t)x * n) >> 32);
+}
+
+uint32_t cred_index_hash(const uint32_t *key, const int words, const uint32_t seed) {
+    uint32_t h = seed;
+    for(int i=0; i<words; i++) {
+        h = fmix32(h ^ key[i]);
+    }
+    return h;
+}
+
+uint32_t cred_index_pilot_mix(const uint16_t pilot, const uint32_t seed) {
+    return fmix32(pilot * 0x9E3779B9u + seed);
+}
+
+bool cred_index_pack(const cred_index *idx, const uint8_t *uid, const size_t len, uint32_t key[CRED_INDEX_MAX_WORDS]) {
+    uint8_t bytes[CRED_INDEX_MAX_WORDS * 4] = { 0 };
+    size_t n = 0;
+    if(idx->uid_size) {
+        if(len != idx->uid_size) { return false; }
+    } else {
+        bytes[n++] = (uint8_t)len;
+    }
+    if(n + len > (size_t)idx->key_words * 4) { return false; }
+    memcpy(&bytes[n], uid, len);
+
+    for(int i=0; i<idx->key_words; i++) {
+        const uint8_t *b = &bytes[4 * i];
+        key[i] = (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | b[3];
+    }
+    return true;
+}
+
+size_t cred_index_uid(const cred_index *idx, const uint32_t i, uint8_t *uid) {
+    uint8_t bytes[CRED_INDEX_MAX_WORDS * 4];
+    const uint32_t *key = &idx->keys[(size_t)i * idx->key_words];
+    for(int w=0; w<idx->key_words; w++) {
+        bytes[4 * w] = (uint8_t)(key[w] >> 24);
+        bytes[4 * w + 1] = (uint8_t)(key[w] >> 16);
+        bytes[4 * w + 2] = (uint8_t)(key[w] >> 8);
+        bytes[4 * w + 3] = (uint8_t)key[w];
+    }
+    const size_t len = idx->uid_size ? idx->uid_size : bytes[0];
+    memcpy(uid, idx->uid_size ? bytes : &bytes[1], len);
+    return len;
+}
+
+size_t cred_index_flash_bytes(const cred_index *idx) {
+    size_t bytes = (size_t)idx->count * idx->key_words * sizeof(uint32_t);
+    if(idx->layout == CRED_INDEX_MPH) {
+        bytes += idx->buckets * sizeof(uint16_t);
+    }
+    return bytes;
+}
+
+// -1, 0, 1 as `a` sorts before, with or after `b`
+static inline int compare(const uint32_t *a, const uint32_t *b, const int words) {
+    for(int i=0; i<words; i++) {
+        if(a[i] != b[i]) { return a[i] < b[i] ? -1 : 1; }
+    }
+    return 0;
+}
+
+static bool contains_mph(const cred_index *idx, const uint32_t *key) {
+    const int words = idx->key_words;
+    const uint32_t bucket = fastrange(cred_index_hash(key, words, idx->seed), idx->buckets);
+    const uint32_t g = cred_index_hash(key, words, idx->seed ^ CRED_INDEX_SEED2);
+    const uint32_t slot = fastrange(fmix32(g ^ cred_index_pilot_mix(idx->pilots[bucket], idx->seed)), idx->count);
+    return compare(key, &idx->keys[(size_t)slot * words], words) == 0;
+}
+
+static bool contains_eytzinger(const cred_index *idx, const uint32_t *key) {
+    const int words = idx->key_words;
+    // Children of i at 2i+1 and 2i+2
+    uint32_t i = 0;
+    while(i < idx->count) {
+        const int c = compare(key, &idx->keys[(size_t)i * words], words);
+        if(c == 0) { return true; }
+        i = 2 * i + 1 + (c > 0);
+    }
+    return false;
+}
+
+bool cred_index_contains(const cred_index *idx, const uint8_t *uid, const size_t len) {
+    uint32_t key[CRED_INDEX_MAX_WORDS];
+    if(idx->count == 0 || !cred_index_pack(idx, uid, len, key)) { return false; }
+    return idx->layout == CRED_INDEX_MPH ? contains_mph(idx, key) : contains_eytzinger(idx, key);
+}
@@ -0,0 +1,75 @@
+#ifndef CRED_INDEX_H
+#define CRED_INDEX_H
+/*
+ * Card UIDs allowed in, as a table in flash.
+ *
+ * tools/cred_index_gen.py compiles a list of UIDs into a C file with a
+ * const cred_index, which the linker leaves in XIP flash: no SRAM, no copy
+ * at boot. Each UID is packed into key_words big endian 32 bit words,
+ * prefixed with its length when the list mixes 4, 7 and 10 byte UIDs, and
+ * padded with zeros. Two layouts:
+ *
+ * - CRED_INDEX_MPH       : minimal perfect hash (hash and displace). Keys
+ *                          go into buckets of about CRED_INDEX_MPH_LAMBDA by
+ *                          a first hash, each bucket has a 16 bit pilot
+ *                          that sends its keys to free slots by a second.
+ *                          A lookup reads one pilot and one key, 2 bytes per
+ *                          CRED_INDEX_MPH_LAMBDA keys on top of the keys.
+ * - CRED_INDEX_EYTZINGER : the sorted keys in breadth first order of the
+ *                          implicit search tree, the first levels share
+ *                          XIP cache lines. log2(count) key reads, no
+ *                          extra flash.
+ *
+ * The hashes only multiply, shift and xor: the Cortex-M0+ has a single
+ * cycle multiplier but no divide, the slot comes from the high word of a
+ * 32x32 bit product instead of a modulo.
+ *
+ *   extern const cred_index credentials;       // build/src/credentials.c
+ *   if(cred_index_contains(&credentials, uid.bytes, uid.size)) { ... }
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Length byte and the longest UID
+#define CRED_INDEX_MAX_WORDS          ( 3 )
+#define CRED_INDEX_MPH_LAMBDA         ( 4 )
+// Second hash of the MPH, the first one uses the seed as is
+#define CRED_INDEX_SEED2              ( 0x5BD1E995u )
+
+typedef enum {
+    CRED_INDEX_MPH,
+    CRED_INDEX_EYTZINGER,
+} cred_index_layout;
+
+typedef struct {
+    cred_index_layout layout;
+    uint32_t count;
+    uint8_t key_words;            // Words per key
+    uint8_t uid_size;             // Of every UID, 0: mixed, length prefixed
+    uint32_t seed;                // MPH only
+    uint32_t buckets;             // MPH only
+    const uint32_t *keys;         // count * key_words
+    const uint16_t *pilots;       // MPH only, one per bucket
+} cred_index;
+
+bool cred_index_contains(const cred_index *idx, const uint8_t *uid, const size_t len);
+// Key of `uid` as stored in `idx`, false if no such UID can be in it
+bool cred_index_pack(const cred_index *idx, const uint8_t *uid, const size_t len, uint32_t key[CRED_INDEX_MAX_WORDS]);
+// UID of entry `i` in table order, returns its length
+size_t cred_index_uid(const cred_index *idx, const uint32_t i, uint8_t *uid);
+// Flash taken by keys and pilots
+size_t cred_index_flash_bytes(const cred_index *idx);
+
+// Hash of a packed key, shared with the generator
+uint32_t cred_index_hash(const uint32_t *key, const int words, const uint32_t seed);
+uint32_t cred_index_pilot_mix(const uint16_t pilot, const uint32_t seed);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
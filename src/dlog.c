@@ -0,0 +1,230 @@
+#include "dlog.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+#include <string.h>
+#include "hal.h"
+#ifndef HOST_BUILD
+#include "pico/stdlib.h"
+#include "hardware/structs/timer.h"
+#endif
+
+#define DLOG_RING_MASK                ( DLOG_RING_WORDS - 1 )
+
+/*
+ * In the ring a record is 2 + n words: id | core << 16 | n << 24, the
+ * timestamp and the arguments. Records never wrap around a full ring: the
+ * writer drops them instead, the reader never has to check it was lapped.
+ */
+typedef struct {
+    uint32_t words[DLOG_RING_WORDS];
+    // Written by the owning core with its interrupts masked
+    uint32_t head;
+    uint32_t dropped;
+    // Written by the reader
+    uint32_t tail;
+} dlog_ring;
+
+static dlog_ring dlog_rings[DLOG_RING_CORES];
+// Reader side
+static uint32_t dlog_reported[DLOG_RING_CORES];
+static dlog_stats dlog_totals;
+
+// Sent by the drain with the count of records a full ring cost
+static const char dlog_dropped[] __attribute__((section("dlog_fmt"), used)) = "<%u records dropped>";
+
+static void dlog_stdio(const uint8_t *frame, size_t len);
+static dlog_output dlog_out = dlog_stdio;
+
+static inline void dlog_put(const char *fmt, const uint32_t n, const uint32_t a, const uint32_t b,
+                            const uint32_t c, const uint32_t d) {
+    const uint32_t id = (uint32_t)(fmt - __start_dlog_fmt);
+    // Nests: a task masks, an ISR of the same core cannot get in
+    const UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+#ifdef portGET_CORE_ID
+    const uint32_t core = portGET_CORE_ID();
+#else
+    const uint32_t core = 0;
+#endif
+    dlog_ring *r = &dlog_rings[core];
+    const uint32_t head = r->head;
+    const uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+
+    if(DLOG_RING_WORDS - (head - tail) < 2 + n) {
+        __atomic_store_n(&r->dropped, r->dropped + 1, __ATOMIC_RELAXED);
+    } else {
+        uint32_t *w = r->words;
+        w[head & DLOG_RING_MASK] = id | core << 16 | n << 24;
+#ifndef HOST_BUILD
+        // The raw low word does not latch the high one, safe from both cores
+        w[(head + 1) & DLOG_RING_MASK] = timer_hw->timerawl;
+#else
+        w[(head + 1) & DLOG_RING_MASK] = (uint32_t)hal_time_us();
+#endif
+        // n is a constant in every caller, the unused stores go away
+        if(n > 0) { w[(head + 2) & DLOG_RING_MASK] = a; }
+        if(n > 1) { w[(head + 3) & DLOG_RING_MASK] = b; }
+        if(n > 2) { w[(head + 4) & DLOG_RING_MASK] = c; }
+        if(n > 3) { w[(head + 5) & DLOG_RING_MASK] = d; }
+        // Publish the record after its contents
+        __atomic_store_n(&r->head, head + 2 + n, __ATOMIC_RELEASE);
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+void dlog_write0(const char *fmt) {
+    dlog_put(fmt, 0, 0, 0, 0, 0);
+}
+
+void dlog_write1(const char *fmt, uint32_t a) {
+    dlog_put(fmt, 1, a, 0, 0, 0);
+}
+
+void dlog_write2(const char *fmt, uint32_t a, uint32_t b) {
+    dlog_put(fmt, 2, a, b, 0, 0);
+}
+
+void dlog_write3(const char *fmt, uint32_t a, uint32_t b, uint32_t c) {
+    dlog_put(fmt, 3, a, b, c, 0);
+}
+
+void dlog_write4(const char *fmt, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    dlog_put(fmt, 4, a, b, c, d);
+}
+
+void dlog_set_output(dlog_output output) {
+    dlog_out = output ? output : dlog_stdio;
+}
+
+// Bypasses the CRLF translation, a 0x0A in a frame must stay one byte
+static void dlog_stdio(const uint8_t *frame, size_t len) {
+#ifndef HOST_BUILD
+    for(size_t i=0; i<len; i++) {
+        putchar_raw(frame[i]);
+    }
+#else
+    fwrite(frame, 1, len, stdout);
+    fflush(stdout);
+#endif
+}
+
+uint16_t dlog_crc16(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for(size_t i=0; i<len; i++) {
+        crc ^= (uint16_t)(data[i] << 8);
+        for(int bit=0; bit<8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)(crc << 1 ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t dlog_frame(const uint8_t *record, size_t len, uint8_t frame[DLOG_FRAME_MAX]) {
+    uint8_t raw[DLOG_RECORD_MAX + 2];
+    memcpy(raw, record, len);
+    const uint16_t crc = dlog_crc16(record, len);
+    raw[len++] = (uint8_t)crc;
+    raw[len++] = (uint8_t)(crc >> 8);
+
+    // COBS: every zero becomes the distance to the next one. A record is far
+    // below the 254 bytes where a block has to be split
+    size_t o = 0;
+    frame[o++] = 0;
+    size_t code = o++;
+    for(size_t i=0; i<len; i++) {
+        if(raw[i] == 0) {
+            frame[code] = (uint8_t)(o - code);
+            code = o++;
+        } else {
+            frame[o++] = raw[i];
+        }
+    }
+    frame[code] = (uint8_t)(o - code);
+    frame[o++] = 0;
+    return o;
+}
+
+static void put_u32(uint8_t *p, const uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void send(const uint32_t id, const uint32_t core, const uint32_t timestamp,
+                 const uint32_t *args, const uint32_t n) {
+    uint8_t record[DLOG_RECORD_MAX];
+    uint8_t frame[DLOG_FRAME_MAX];
+
+    record[0] = (uint8_t)id;
+    record[1] = (uint8_t)(id >> 8);
+    record[2] = (uint8_t)core;
+    record[3] = (uint8_t)n;
+    put_u32(&record[4], timestamp);
+    for(uint32_t i=0; i<n; i++) {
+        put_u32(&record[DLOG_RECORD_HEADER + 4 * i], args[i]);
+    }
+    const size_t len = dlog_frame(record, DLOG_RECORD_HEADER + 4 * n, frame);
+    dlog_out(frame, len);
+    dlog_totals.records++;
+    dlog_totals.bytes += len;
+}
+
+static uint32_t drain_core(const uint32_t core) {
+    dlog_ring *r = &dlog_rings[core];
+    const uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = r->tail;
+    uint32_t records = 0;
+    uint32_t args[DLOG_MAX_ARGS];
+
+    while(tail != head) {
+        const uint32_t w0 = r->words[tail & DLOG_RING_MASK];
+        const uint32_t timestamp = r->words[(tail + 1) & DLOG_RING_MASK];
+        uint32_t n = w0 >> 24;
+        if(n > DLOG_MAX_ARGS) { n = DLOG_MAX_ARGS; }
+        for(uint32_t i=0; i<n; i++) {
+            args[i] = r->words[(tail + 2 + i) & DLOG_RING_MASK];
+        }
+        // The slots are free for the writer again
+        tail += 2 + n;
+        __atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+        send(w0 & 0xFFFF, core, timestamp, args, n);
+        records++;
+    }
+
+    const uint32_t dropped = __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+    if(dropped != dlog_reported[core]) {
+        const uint32_t lost = dropped - dlog_reported[core];
+        dlog_reported[core] = dropped;
+        dlog_totals.dropped += lost;
+        send((uint32_t)(dlog_dropped - __start_dlog_fmt), core, (uint32_t)hal_time_us(), &lost, 1);
+    }
+    return records;
+}
+
+uint32_t dlog_flush(void) {
+    uint32_t records = 0;
+    for(uint32_t core=0; core<DLOG_RING_CORES; core++) {
+        records += drain_core(core);
+    }
+    return records;
+}
+
+void dlog_get_stats(dlog_stats *stats) {
+    *stats = dlog_totals;
+}
+
+void dlog_task(void *pvParameters) {
+    TickType_t xNextWakeTime = xTaskGetTickCount();
+
+    ( void ) pvParameters;
+
+    for( ;; ) {
+        vTaskDelayUntil(&xNextWakeTime, pdMS_TO_TICKS(DLOG_DRAIN_PERIOD_MS));
+        ( void ) dlog_flush();
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef DLOG_H
+#define DLOG_H
+/*
+ * Deferred binary log.
+ *
+ * DLOG("fmt", args...) formats nothing on the device: the format string is
+ * placed in its own section, dlog_fmt, and the record only carries the
+ * offset of the string in that section, the raw 32 bit arguments, the
+ * microsecond timestamp and the core. tools/dlog_decode.py reads the strings
+ * back from the ELF and does the formatting on the host.
+ *
+ * Records go into a ring per core. A call masks the interrupts of its own
+ * core for the few stores of the record, so tasks and ISRs of one core never
+ * interleave and the cores never contend: no lock, no wait. When a ring is
+ * full the record is dropped and counted, the drain reports the count. A
+ * call costs a few dozen cycles, see log_bench.
+ *
+ * dlog_task() drains the rings every DLOG_DRAIN_PERIOD_MS and sends each
+ * record as a frame: COBS of the record and its CRC-16, between two 0x00
+ * bytes, raw (no CRLF translation) through stdio, USB CDC on the benches.
+ * The text of printf() can share the stream, the decoder tells it apart.
+ *
+ *   DLOG("card %u bytes, sak %02x", uid.size, uid.sak);
+ *
+ * Arguments are integers of up to 32 bits: %d %i %u %x %X %o %c, with
+ * flags, width and precision. No %s or floats, nothing points into RAM.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Set to 0 to compile every DLOG() out */
+#ifndef DLOG_ENABLE
+#define DLOG_ENABLE                   1
+#endif
+
+#define DLOG_RING_WORDS               ( 512 ) // Per core, power of 2
+#define DLOG_RING_CORES               ( 2 )
+#define DLOG_MAX_ARGS                 ( 4 )
+#define DLOG_DRAIN_PERIOD_MS          ( 20 )
+
+/*
+ * On the wire, little endian, then CRC-16/CCITT-FALSE of all of it and COBS:
+ *   u16 format id, u8 core, u8 argument count, u32 timestamp, u32 args[]
+ */
+#define DLOG_RECORD_HEADER            ( 8 )
+#define DLOG_RECORD_MAX               ( DLOG_RECORD_HEADER + 4 * DLOG_MAX_ARGS )
+// The CRC, the COBS overhead byte and two delimiters
+#define DLOG_FRAME_MAX                ( DLOG_RECORD_MAX + 2 + 1 + 2 )
+
+typedef struct {
+    uint32_t records;             // Framed and sent
+    uint32_t dropped;             // Rings full, both cores
+    uint32_t bytes;               // Sent, delimiters included
+} dlog_stats;
+
+// Start of the format strings, defined by the linker. dlog.c puts one in,
+// the section exists even in an image without DLOG()
+extern const char __start_dlog_fmt[];
+
+void dlog_write0(const char *fmt);
+void dlog_write1(const char *fmt, uint32_t a);
+void dlog_write2(const char *fmt, uint32_t a, uint32_t b);
+void dlog_write3(const char *fmt, uint32_t a, uint32_t b, uint32_t c);
+void dlog_write4(const char *fmt, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+
+// Where frames go, raw stdio by default
+typedef void (*dlog_output)(const uint8_t *frame, size_t len);
+void dlog_set_output(dlog_output output);
+
+// Frames every record in the rings now, returns how many
+uint32_t dlog_flush(void);
+void dlog_get_stats(dlog_stats *stats);
+// Encoding of one frame, shared with the decoder. Returns the frame length
+size_t dlog_frame(const uint8_t *record, size_t len, uint8_t frame[DLOG_FRAME_MAX]);
+uint16_t dlog_crc16(const uint8_t *data, size_t len);
+
+// Low priority task sending the rings every DLOG_DRAIN_PERIOD_MS
+void dlog_task(void *pvParameters);
+
+#if ( DLOG_ENABLE == 1 )
+// Argument count of DLOG(), the format counts too
+#define DLOG_COUNT_(fmt, _1, _2, _3, _4, n, ...) n
+#define DLOG_COUNT(...) DLOG_COUNT_(__VA_ARGS__, 4, 3, 2, 1, 0, 0)
+#define DLOG_CAT_(a, b) a##b
+#define DLOG_CAT(a, b) DLOG_CAT_(a, b)
+
+#define DLOG_ARGS0(fmt)
+#define DLOG_ARGS1(fmt, a) , (uint32_t)(a)
+#define DLOG_ARGS2(fmt, a, b) , (uint32_t)(a), (uint32_t)(b)
+#define DLOG_ARGS3(fmt, a, b, c) , (uint32_t)(a), (uint32_t)(b), (uint32_t)(c)
+#define DLOG_ARGS4(fmt, a, b, c, d) , (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d)
+
+#define DLOG_FMT_(fmt, ...) fmt
+
+// The string stays in flash and in the ELF, the call only passes its address
+#define DLOG(...) do { \
+        static const char dlog_fmt_[] __attribute__((section("dlog_fmt"), used)) = DLOG_FMT_(__VA_ARGS__, 0); \
+        DLOG_CAT(dlog_write, DLOG_COUNT(__VA_ARGS__))(dlog_fmt_ DLOG_CAT(DLOG_ARGS, DLOG_COUNT(__VA_ARGS__))(__VA_ARGS__)); \
+    } while(0)
+#else
+#define DLOG(...) do { } while(0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,204 @@
+/*
+ * C driver pin path against the templated C++ driver (hd44780.hpp).
+ *
+ * Built as driver_bench (RP2040, results over USB stdio) and
+ * driver_bench_host. common.c calls main_driver_bench() instead of
+ * main_blinky().
+ *
+ * The cost of driving the pins is measured with every delay removed, over
+ * driverbenchCHARS data writes on a 4 bit bus with the scheduler suspended:
+ * - c_gpio       : hd44780_send_data_payload() of hd44780.c, built for the
+ *                  GPIO bus with HD44780_CONFIG_BUS_DELAYS 0: one
+ *                  hal_gpio_put() per pin and a loop over the pin table
+ * - cpp_shift    : the board wiring, consecutive data pins, one shift
+ * - cpp_table    : the same pins in scattered order, one table lookup
+ * Target results are in core clock cycles per character, host results in
+ * nanoseconds (mostly the simulated controller).
+ *
+ * Then a full 16x4 frame goes through the C++ driver with the real timing:
+ * latency, characters per second and, on the host, whether the simulated
+ * controller shows the frame without a single busy violation.
+ *
+ * Flash per object is printed by tools/ram_report.py --flash after the link.
+ */
+
+#include "hd44780.h"
+#include "hd44780.hpp"
+#include "hd44780_cpp.h"
+#include "bench.h"
+#include "hal.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+#include <string.h>
+#ifdef HOST_BUILD
+#include <time.h>
+extern "C" {
+#include "board_host.h"
+}
+#else
+#include "hardware/clocks.h"
+#endif
+
+#define driverbenchTASK_PRIORITY               ( tskIDLE_PRIORITY + 1 )
+
+#define driverbenchCHARS                       ( 10000 )
+#define driverbenchFRAMES                      ( 20 )
+#define driverbenchROWS                        ( 4 )
+#define driverbenchCOLS                        ( 16 )
+// Give the host time to open the USB serial port
+#define driverbenchUSB_SETTLE_MS               ( 2000 / portTICK_PERIOD_MS )
+
+extern "C" int main_driver_bench( void );
+// Driver internals, not part of hd44780.h
+extern "C" void hd44780_send_data_payload( const int v );
+
+namespace {
+// Same display and pins as hd44780_cpp.cpp, no delays at all
+using lcd_shift = hd44780::driver<hd44780::pins<10, 9, 11, 5, 6, 7, 8>,
+                                  hd44780::geometry<driverbenchCOLS, driverbenchROWS>,
+                                  hd44780::timing_none>;
+// D4..D7 crossed over, D4 on 6, D5 on 5, D6 on 8, D7 on 7
+using lcd_table = hd44780::driver<hd44780::pins<10, 9, 11, 6, 5, 8, 7>,
+                                  hd44780::geometry<driverbenchCOLS, driverbenchROWS>,
+                                  hd44780::timing_none>;
+static_assert(lcd_shift::pins_type::contiguous, "expected the shift path");
+static_assert(!lcd_table::pins_type::contiguous, "expected the table path");
+}
+
+static void prvDriverBenchTask( void *pvParameters );
+
+static char cFrame[ driverbenchROWS ][ driverbenchCOLS + 1 ];
+static bench_samples xSamples;
+
+/*-----------------------------------------------------------*/
+
+int main_driver_bench( void )
+{
+    printf(" Starting main_driver_bench.\n");
+
+    xTaskCreate( prvDriverBenchTask, "BENCH", configMINIMAL_STACK_SIZE * 2, NULL, driverbenchTASK_PRIORITY, NULL );
+    vTaskStartScheduler();
+
+    for( ;; );
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+/* Wall clock, the host virtual clock only advances with the busy waits. */
+static uint64_t prvNowNs( void )
+{
+#ifdef HOST_BUILD
+    struct timespec xNow;
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+    return ( uint64_t ) xNow.tv_sec * 1000000000u + ( uint64_t ) xNow.tv_nsec;
+#else
+    return hal_time_us() * 1000u;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvPinCost( void ( *pvWrite )( uint8_t ), const char *pcMetric )
+{
+    vTaskSuspendAll();
+    const uint64_t ullStart = prvNowNs();
+    for( uint32_t i = 0; i < driverbenchCHARS; i++ )
+    {
+        pvWrite( ( uint8_t ) ( 'A' + ( i & 0x0F ) ) );
+    }
+    const uint64_t ullNs = prvNowNs() - ullStart;
+    ( void ) xTaskResumeAll();
+
+#ifdef HOST_BUILD
+    bench_report_value( "driver", pcMetric, "ns_per_char", ullNs / driverbenchCHARS );
+#else
+    const uint64_t ullMhz = clock_get_hz( clk_sys ) / 1000000u;
+    bench_report_value( "driver", pcMetric, "cycles_per_char", ( ullNs * ullMhz ) / ( 1000u * driverbenchCHARS ) );
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvFillFrame( const char c )
+{
+    for( int r = 0; r < driverbenchROWS; r++ )
+    {
+        memset( cFrame[ r ], c + r, driverbenchCOLS );
+        cFrame[ r ][ driverbenchCOLS ] = '\0';
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvFullFrame( void )
+{
+uint64_t ullTotalUs = 0;
+
+    bench_reset( &xSamples );
+    for( int i = 0; i < driverbenchFRAMES; i++ )
+    {
+        prvFillFrame( ( char ) ( 'A' + ( i % 23 ) ) );
+        const uint64_t ullStart = hal_time_us();
+        hd44780_cpp_flush( &cFrame[ 0 ][ 0 ], sizeof( cFrame[ 0 ] ) );
+        const uint64_t ullTime = hal_time_us() - ullStart;
+        bench_add( &xSamples, ( uint32_t ) ullTime );
+        ullTotalUs += ullTime;
+    }
+    bench_report( "driver", "cpp_full_frame", "us", &xSamples );
+    bench_report_value( "driver", "cpp_chars_per_s", "chars/s",
+        ullTotalUs ? ( ( uint64_t ) driverbenchFRAMES * driverbenchROWS * driverbenchCOLS * 1000000 ) / ullTotalUs : 0 );
+}
+/*-----------------------------------------------------------*/
+
+#ifdef HOST_BUILD
+/* Rows the simulated controller shows against the last frame. */
+static uint32_t prvFrameMismatches( void )
+{
+char cRow[ 41 ];
+uint32_t ulBad = 0;
+
+    for( int r = 0; r < driverbenchROWS; r++ )
+    {
+        hd44780_sim_row( board_host_lcd(), r, driverbenchCOLS, cRow );
+        ulBad += strcmp( cRow, cFrame[ r ] ) != 0;
+    }
+    return ulBad;
+}
+#endif
+/*-----------------------------------------------------------*/
+
+static void prvDriverBenchTask( void *pvParameters )
+{
+TickType_t xNextWakeTime;
+
+    ( void ) pvParameters;
+
+#ifndef HOST_BUILD
+    vTaskDelay( driverbenchUSB_SETTLE_MS );
+#endif
+
+    xNextWakeTime = xTaskGetTickCount();
+    hd44780_cpp_init( &xNextWakeTime );
+
+    /* Garbage characters only, the controller drops most of them as busy
+    and the frame below rewrites every cell. */
+    prvPinCost( []( uint8_t v ) { hd44780_send_data_payload( v ); }, "c_gpio" );
+    prvPinCost( lcd_shift::data, "cpp_shift" );
+    prvPinCost( lcd_table::data, "cpp_table" );
+
+    /* Let the controller finish, then start from an unknown DDRAM. */
+    vTaskDelay( pdMS_TO_TICKS( 10 ) );
+    hd44780_fb_invalidate( &hd44780_cpp_shadow );
+#ifdef HOST_BUILD
+    const uint32_t ulViolations = board_host_lcd()->stats.busy_violations;
+#endif
+    prvFullFrame();
+#ifdef HOST_BUILD
+    bench_report_value( "driver", "cpp_busy_violations", "writes", board_host_lcd()->stats.busy_violations - ulViolations );
+    bench_report_value( "driver", "cpp_rows_wrong", "rows", prvFrameMismatches() );
+#endif
+    bench_done();
+}
+/*-----------------------------------------------------------*/
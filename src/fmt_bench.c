@@ -0,0 +1,310 @@
+/*
+ * lcd_fmt against snprintf() on the display path.
+ *
+ * Built as fmt_bench (RP2040, results over USB stdio) and fmt_bench_host.
+ * common.c calls main_fmt_bench() instead of main_blinky().
+ *
+ * Every case formats into a frame row, snprintf() straight into the row as
+ * well (its best case, the render loop used to go through a buffer):
+ * - int          : a counter, "%ld"
+ * - padded       : a signed value right aligned, "%6ld"
+ * - fixed        : hundredths shown as "%ld.%02ld", value and remainder
+ * - hex          : a register, "%08lX"
+ * - time         : "%02u:%02u:%02u"
+ * Per case, <case>_fmt and <case>_snprintf are the cost per call over
+ * fmtbenchCALLS calls with the scheduler suspended, in core clock cycles on
+ * target and nanoseconds on the host. mismatches counts rows where both
+ * disagree, it must be 0.
+ *
+ * stack_fmt and stack_snprintf are the deepest stack a call of each took,
+ * found by painting an area below the caller and looking for the lowest
+ * byte overwritten. Code size is printed by tools/ram_report.py --members
+ * after the link: lcd_fmt.o against the printf members of libc.
+ */
+
+#include "lcd_fmt.h"
+#include "bench.h"
+#include "hal.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+#include <string.h>
+#ifdef HOST_BUILD
+#include <time.h>
+#else
+#include "hardware/clocks.h"
+#endif
+
+#define fmtbenchTASK_PRIORITY                  ( tskIDLE_PRIORITY + 1 )
+
+#define fmtbenchCALLS                          ( 2000 )
+#define fmtbenchROW                            ( 17 )
+// Bytes painted below the caller, deeper than any snprintf() call
+#define fmtbenchSTACK_PROBE                    ( 1536 )
+#define fmtbenchSTACK_PAINT                    ( 0xA5 )
+// Give the host time to open the USB serial port
+#define fmtbenchUSB_SETTLE_MS                  ( 2000 / portTICK_PERIOD_MS )
+
+int main_fmt_bench( void );
+
+static void prvFmtBenchTask( void *pvParameters );
+
+typedef void ( *FormatFunction_t )( char *pcRow, uint32_t ulValue );
+
+typedef struct
+{
+    const char *pcName;
+    FormatFunction_t pxFmt;
+    FormatFunction_t pxSnprintf;
+} FormatCase_t;
+
+static char cRow[ fmtbenchROW ];
+static char cCheck[ fmtbenchROW ];
+
+/*-----------------------------------------------------------*/
+
+int main_fmt_bench( void )
+{
+    printf(" Starting main_fmt_bench.\n");
+
+    /* Room for the stack probe on top of snprintf() itself. */
+    xTaskCreate( prvFmtBenchTask, "BENCH", configMINIMAL_STACK_SIZE * 4, NULL, fmtbenchTASK_PRIORITY, NULL );
+    vTaskStartScheduler();
+
+    for( ;; );
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+/* Values shaped like what a display shows. */
+static int32_t prvSigned( const uint32_t ulValue )
+{
+    return ( int32_t ) ( ulValue % 20001 ) - 10000;
+}
+/*-----------------------------------------------------------*/
+
+static void prvIntFmt( char *pcRow, uint32_t ulValue )
+{
+lcd_fmt xFmt;
+
+    lcd_fmt_begin( &xFmt, pcRow, fmtbenchROW, 0 );
+    lcd_fmt_int( &xFmt, ( int32_t ) ulValue, 0, ' ' );
+    lcd_fmt_end( &xFmt );
+}
+
+static void prvIntSnprintf( char *pcRow, uint32_t ulValue )
+{
+    snprintf( pcRow, fmtbenchROW, "%ld", ( long ) ( int32_t ) ulValue );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPaddedFmt( char *pcRow, uint32_t ulValue )
+{
+lcd_fmt xFmt;
+
+    lcd_fmt_begin( &xFmt, pcRow, fmtbenchROW, 0 );
+    lcd_fmt_int( &xFmt, prvSigned( ulValue ), 6, ' ' );
+    lcd_fmt_end( &xFmt );
+}
+
+static void prvPaddedSnprintf( char *pcRow, uint32_t ulValue )
+{
+    snprintf( pcRow, fmtbenchROW, "%6ld", ( long ) prvSigned( ulValue ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvFixedFmt( char *pcRow, uint32_t ulValue )
+{
+lcd_fmt xFmt;
+
+    lcd_fmt_begin( &xFmt, pcRow, fmtbenchROW, 0 );
+    lcd_fmt_fixed( &xFmt, ( int32_t ) ulValue, 2, 0, ' ' );
+    lcd_fmt_end( &xFmt );
+}
+
+static void prvFixedSnprintf( char *pcRow, uint32_t ulValue )
+{
+    /* No float printf in newlib nano, the usual integer split. */
+    snprintf( pcRow, fmtbenchROW, "%ld.%02ld", ( long ) ( ulValue / 100 ), ( long ) ( ulValue % 100 ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvHexFmt( char *pcRow, uint32_t ulValue )
+{
+lcd_fmt xFmt;
+
+    lcd_fmt_begin( &xFmt, pcRow, fmtbenchROW, 0 );
+    lcd_fmt_hex( &xFmt, ulValue * 2654435761u, 8 );
+    lcd_fmt_end( &xFmt );
+}
+
+static void prvHexSnprintf( char *pcRow, uint32_t ulValue )
+{
+    snprintf( pcRow, fmtbenchROW, "%08lX", ( unsigned long ) ( ulValue * 2654435761u ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSplitTime( const uint32_t ulValue, timekeeper_time *pxTime )
+{
+    pxTime->hour = ( uint8_t ) ( ulValue / 3600 % 24 );
+    pxTime->minute = ( uint8_t ) ( ulValue / 60 % 60 );
+    pxTime->second = ( uint8_t ) ( ulValue % 60 );
+}
+
+static void prvTimeFmt( char *pcRow, uint32_t ulValue )
+{
+lcd_fmt xFmt;
+timekeeper_time xTime;
+
+    prvSplitTime( ulValue, &xTime );
+    lcd_fmt_begin( &xFmt, pcRow, fmtbenchROW, 0 );
+    lcd_fmt_time( &xFmt, &xTime );
+    lcd_fmt_end( &xFmt );
+}
+
+static void prvTimeSnprintf( char *pcRow, uint32_t ulValue )
+{
+timekeeper_time xTime;
+
+    prvSplitTime( ulValue, &xTime );
+    snprintf( pcRow, fmtbenchROW, "%02u:%02u:%02u", xTime.hour, xTime.minute, xTime.second );
+}
+/*-----------------------------------------------------------*/
+
+static const FormatCase_t xCases[] =
+{
+    { "int", prvIntFmt, prvIntSnprintf },
+    { "padded", prvPaddedFmt, prvPaddedSnprintf },
+    { "fixed", prvFixedFmt, prvFixedSnprintf },
+    { "hex", prvHexFmt, prvHexSnprintf },
+    { "time", prvTimeFmt, prvTimeSnprintf },
+};
+/*-----------------------------------------------------------*/
+
+/* Wall clock, the host virtual clock only advances with the busy waits. */
+static uint64_t prvNowNs( void )
+{
+#ifdef HOST_BUILD
+    struct timespec xNow;
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+    return ( uint64_t ) xNow.tv_sec * 1000000000u + ( uint64_t ) xNow.tv_nsec;
+#else
+    return hal_time_us() * 1000u;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvCost( FormatFunction_t pxFormat, const char *pcCase, const char *pcVariant )
+{
+char cMetric[ 32 ];
+
+    vTaskSuspendAll();
+    const uint64_t ullStart = prvNowNs();
+    for( uint32_t i = 0; i < fmtbenchCALLS; i++ )
+    {
+        pxFormat( cRow, i * 7919u );
+    }
+    const uint64_t ullNs = prvNowNs() - ullStart;
+    ( void ) xTaskResumeAll();
+
+    snprintf( cMetric, sizeof( cMetric ), "%s_%s", pcCase, pcVariant );
+#ifdef HOST_BUILD
+    bench_report_value( "fmt", cMetric, "ns_per_call", ullNs / fmtbenchCALLS );
+#else
+    const uint64_t ullMhz = clock_get_hz( clk_sys ) / 1000000u;
+    bench_report_value( "fmt", cMetric, "cycles_per_call", ( ullNs * ullMhz ) / ( 1000u * fmtbenchCALLS ) );
+#endif
+}
+/*-----------------------------------------------------------*/
+
+/* Paints (xPaint) or scans the fmtbenchSTACK_PROBE bytes below its own
+frame, which is where the frames of a function called next from the same
+caller go. Returns how deep the last call went. */
+static __attribute__( ( noinline ) ) uint32_t prvStackProbe( const BaseType_t xPaint )
+{
+volatile uint8_t ucMark = 0;
+volatile uint8_t *pucLow = ( volatile uint8_t * ) ( ( uintptr_t ) &ucMark - fmtbenchSTACK_PROBE );
+
+    for( uint32_t i = 0; i < fmtbenchSTACK_PROBE; i++ )
+    {
+        if( xPaint )
+        {
+            pucLow[ i ] = fmtbenchSTACK_PAINT;
+        }
+        else if( pucLow[ i ] != fmtbenchSTACK_PAINT )
+        {
+            /* The stack grows down, the lowest byte written is the deepest. */
+            return fmtbenchSTACK_PROBE - i;
+        }
+    }
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvStack( FormatFunction_t pxFormat )
+{
+uint32_t ulDeepest = 0;
+
+    for( uint32_t i = 0; i < 64; i++ )
+    {
+        /* An interrupt would push its frame into the painted area. */
+        taskENTER_CRITICAL();
+        ( void ) prvStackProbe( pdTRUE );
+        pxFormat( cRow, i * 7919u );
+        const uint32_t ulUsed = prvStackProbe( pdFALSE );
+        taskEXIT_CRITICAL();
+        if( ulUsed > ulDeepest )
+        {
+            ulDeepest = ulUsed;
+        }
+    }
+    return ulDeepest;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFmtBenchTask( void *pvParameters )
+{
+uint32_t ulMismatches = 0;
+uint32_t ulStackFmt = 0;
+uint32_t ulStackSnprintf = 0;
+
+    ( void ) pvParameters;
+
+#ifndef HOST_BUILD
+    vTaskDelay( fmtbenchUSB_SETTLE_MS );
+#endif
+
+    for( size_t c = 0; c < sizeof( xCases ) / sizeof( xCases[ 0 ] ); c++ )
+    {
+        const FormatCase_t *pxCase = &xCases[ c ];
+
+        for( uint32_t i = 0; i < fmtbenchCALLS; i++ )
+        {
+            cRow[ 0 ] = '\0';
+            pxCase->pxFmt( cRow, i * 7919u );
+            pxCase->pxSnprintf( cCheck, i * 7919u );
+            if( strcmp( cRow, cCheck ) != 0 )
+            {
+                ulMismatches++;
+            }
+        }
+
+        prvCost( pxCase->pxFmt, pxCase->pcName, "fmt" );
+        prvCost( pxCase->pxSnprintf, pxCase->pcName, "snprintf" );
+
+        const uint32_t ulFmt = prvStack( pxCase->pxFmt );
+        const uint32_t ulSnprintf = prvStack( pxCase->pxSnprintf );
+        ulStackFmt = ulFmt > ulStackFmt ? ulFmt : ulStackFmt;
+        ulStackSnprintf = ulSnprintf > ulStackSnprintf ? ulSnprintf : ulStackSnprintf;
+    }
+
+    bench_report_value( "fmt", "stack_fmt", "bytes", ulStackFmt );
+    bench_report_value( "fmt", "stack_snprintf", "bytes", ulStackSnprintf );
+    bench_report_value( "fmt", "mismatches", "rows", ulMismatches );
+    bench_done();
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,5 @@
+#include "hal.h"
+
+#ifndef HOST_BUILD
+volatile uint64_t hal_busy_us_total = 0;
+#endif
@@ -0,0 +1,81 @@
+#ifndef HAL_H
+#define HAL_H
+/*
+ * Hardware abstraction used by the application code.
+ *
+ * On the RP2040 every call maps straight onto the pico SDK (static inline,
+ * no cost). With HOST_BUILD the same calls are implemented by host/hal_host.c,
+ * which keeps a virtual microsecond clock and forwards pin activity to the
+ * simulated devices (host/hd44780_sim.c).
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef HOST_BUILD
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/timer.h"
+#include "hardware/clocks.h"
+
+#define HAL_GPIO_OUT                  GPIO_OUT
+#define HAL_GPIO_IN                   GPIO_IN
+#define HAL_LED_PIN                   PICO_DEFAULT_LED_PIN
+#define HAL_LED_PIN_INVERTED          PICO_DEFAULT_LED_PIN_INVERTED
+
+static inline void hal_init(void) { stdio_init_all(); }
+static inline void hal_gpio_init(const int pin) { gpio_init((uint)pin); }
+static inline void hal_gpio_set_dir(const int pin, const int out) { gpio_set_dir((uint)pin, out); }
+static inline void hal_gpio_put(const int pin, const int v) { gpio_put((uint)pin, v); }
+static inline int hal_gpio_get(const int pin) { return gpio_get((uint)pin); }
+static inline void hal_gpio_xor_mask(const uint32_t mask) { gpio_xor_mask(mask); }
+// Whole bank in one SIO write
+static inline void hal_gpio_init_mask(const uint32_t mask) { gpio_init_mask(mask); }
+static inline void hal_gpio_set_dir_out_masked(const uint32_t mask) { gpio_set_dir_out_masked(mask); }
+static inline void hal_gpio_put_masked(const uint32_t mask, const uint32_t value) { gpio_put_masked(mask, value); }
+static inline void hal_gpio_clr_mask(const uint32_t mask) { gpio_clr_mask(mask); }
+static inline void hal_gpio_set_mask(const uint32_t mask) { gpio_set_mask(mask); }
+
+// Total time spent in hal_busy_wait_us(), defined in hal.c
+extern volatile uint64_t hal_busy_us_total;
+
+static inline void hal_busy_wait_us(const uint32_t us) { busy_wait_us_32(us); hal_busy_us_total += us; }
+// At least `ns` at the compiled clock, for bus setup times under a microsecond
+static inline void hal_busy_wait_ns(const uint32_t ns) {
+    busy_wait_at_least_cycles((ns * (SYS_CLK_KHZ / 1000u) + 999u) / 1000u);
+}
+static inline uint64_t hal_time_us(void) { return time_us_64(); }
+static inline uint64_t hal_busy_us(void) { return hal_busy_us_total; }
+#else
+#define HAL_GPIO_OUT                  1
+#define HAL_GPIO_IN                   0
+#define HAL_LED_PIN                   25
+#define HAL_LED_PIN_INVERTED          0
+
+void hal_init(void);
+void hal_gpio_init(const int pin);
+void hal_gpio_set_dir(const int pin, const int out);
+void hal_gpio_put(const int pin, const int v);
+int hal_gpio_get(const int pin);
+void hal_gpio_xor_mask(const uint32_t mask);
+// Pins change in ascending order, devices see one write per pin
+void hal_gpio_init_mask(const uint32_t mask);
+void hal_gpio_set_dir_out_masked(const uint32_t mask);
+void hal_gpio_put_masked(const uint32_t mask, const uint32_t value);
+void hal_gpio_clr_mask(const uint32_t mask);
+void hal_gpio_set_mask(const uint32_t mask);
+// Advances the virtual clock, nothing actually spins
+void hal_busy_wait_us(const uint32_t us);
+// Below the resolution of the virtual clock, returns at once
+void hal_busy_wait_ns(const uint32_t ns);
+uint64_t hal_time_us(void);
+uint64_t hal_busy_us(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -4,13 +4,20 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
+#include "timers.h"
 
 /* Library includes. */
-#include <stdio.h>
-#include "hardware/gpio.h"
-
-/* RP2040 Specifics */
-#include "hardware/timer.h"
+#include "hal.h"
+#include <string.h>
+
+#include "hd44780_bus.h"
+#include "hd44780_fb.h"
+#include "hd44780_glyph.h"
+#include "hd44780_scroll.h"
+#include "timekeeper.h"
+#include "clock_widget.h"
+#include "lcd_fmt.h"
+#include "render.h"
 
 #define ARRAY_SIZE(a) (sizeof(a)/sizeof(a[0]))
 
@@ -20,6 +27,27 @@
 #define HD44780_CONFIG_F_CHARACTER_FONT 0 
 #define HD44780_CONFIG_C_CURSOR         0 // Cursor visible
 #define HD44780_CONFIG_B_CURSOR_BLINK   0 // Cursor blinking
+#ifndef HD44780_CONFIG_BUS_PIO
+#define HD44780_CONFIG_BUS_PIO          1 // 0 - GPIO bit-bang | 1 - PIO + DMA
+#endif
+#ifndef HD44780_CONFIG_BUSY_FLAG
+#define HD44780_CONFIG_BUSY_FLAG        0 // 0 - fixed delays | 1 - poll BF over RW
+#endif
+#ifndef HD44780_CONFIG_MAX_FPS
+#define HD44780_CONFIG_MAX_FPS          30 // Frames per second at most
+#endif
+#ifndef HD44780_CONFIG_LATENCY_MS
+#define HD44780_CONFIG_LATENCY_MS       50 // Update to frame on the display
+#endif
+#ifndef HD44780_CONFIG_COUNTER
+#define HD44780_CONFIG_COUNTER          0 // 1 - frame counter on line 3, as load
+#endif
+#ifndef HD44780_CONFIG_BUS_DELAYS
+#define HD44780_CONFIG_BUS_DELAYS       1 // 0 - GPIO bus without waits, driver_bench only
+#endif
+#ifndef HD44780_CONFIG_SCROLL_MS
+#define HD44780_CONFIG_SCROLL_MS        300 // Between two steps of a scroll_line() marquee
+#endif
 
 // Macro definition checks
 // HD44780_CONFIG_N_DISPLAY_LINES
@@ -46,12 +74,66 @@
 #error INVALID HD44780_CONFIG_B_CURSOR_BLINK MUST BE EITHER 0 or 1
 #endif
 
+// HD44780_CONFIG_BUS_PIO
+#if HD44780_CONFIG_BUS_PIO != 0 && HD44780_CONFIG_BUS_PIO != 1
+#error
+#error INVALID HD44780_CONFIG_BUS_PIO MUST BE EITHER 0 or 1
+#endif
+
+// HD44780_CONFIG_BUSY_FLAG
+#if HD44780_CONFIG_BUSY_FLAG != 0 && HD44780_CONFIG_BUSY_FLAG != 1
+#error
+#error INVALID HD44780_CONFIG_BUSY_FLAG MUST BE EITHER 0 or 1
+#endif
+#if HD44780_CONFIG_BUSY_FLAG == 1 && HD44780_CONFIG_BUS_PIO == 1
+#error
+#error HD44780_CONFIG_BUSY_FLAG IS ONLY SUPPORTED ON THE GPIO BUS (HD44780_CONFIG_BUS_PIO 0)
+#endif
+
+// HD44780_CONFIG_MAX_FPS
+#if HD44780_CONFIG_MAX_FPS < 1 || HD44780_CONFIG_MAX_FPS > 1000
+#error
+#error INVALID HD44780_CONFIG_MAX_FPS MUST BE BETWEEN 1 AND 1000
+#endif
+
+// HD44780_CONFIG_LATENCY_MS
+// An update may wait a whole frame interval for the cap
+#if HD44780_CONFIG_LATENCY_MS * HD44780_CONFIG_MAX_FPS < 1000
+#error
+#error INVALID HD44780_CONFIG_LATENCY_MS MUST BE AT LEAST ONE FRAME INTERVAL (1000 / HD44780_CONFIG_MAX_FPS)
+#endif
+
+// HD44780_CONFIG_COUNTER
+#if HD44780_CONFIG_COUNTER != 0 && HD44780_CONFIG_COUNTER != 1
+#error
+#error INVALID HD44780_CONFIG_COUNTER MUST BE EITHER 0 or 1
+#endif
+
+// HD44780_CONFIG_BUS_DELAYS
+#if HD44780_CONFIG_BUS_DELAYS != 0 && HD44780_CONFIG_BUS_DELAYS != 1
+#error
+#error INVALID HD44780_CONFIG_BUS_DELAYS MUST BE EITHER 0 or 1
+#endif
+#if HD44780_CONFIG_BUS_DELAYS == 0 && (HD44780_CONFIG_BUS_PIO == 1 || HD44780_CONFIG_BUSY_FLAG == 1)
+#error
+#error HD44780_CONFIG_BUS_DELAYS 0 IS ONLY SUPPORTED ON THE GPIO BUS WITH FIXED DELAYS
+#endif
+
+// HD44780_CONFIG_SCROLL_MS
+#if HD44780_CONFIG_SCROLL_MS < 1
+#error
+#error INVALID HD44780_CONFIG_SCROLL_MS MUST BE AT LEAST 1
+#endif
+
 // Hardware restrictions of official spec
 #define MAX_HD44780_FREQ              ( 250000 ) //Herth
 #define MIN_HD44780_PERIOD_US         ( 1000000/MAX_HD44780_FREQ )
 #define hd44780_POWERON_DELAY_MS      ( 100 / portTICK_PERIOD_MS )
 #define hd44780_INST_CLEAR_DISPLAY_MS ( 10 / portTICK_PERIOD_MS )
 #define hd44780_INST_DELAY_US         80
+#define hd44780_E_PULSE_US            1 // PWEH >= 450ns, tcycE >= 1000ns
+// Longest instruction (clear/home) is 1.52ms, past this the flag is not trusted
+#define hd44780_BUSY_TIMEOUT_US       2000
 
 #define HD44780_START_ADD_L1          (0x00) 
 #define HD44780_START_ADD_L2          (0x40)
@@ -68,28 +150,63 @@ const int HD44780_LINE_START_LOC[] = {
 // Only 4 high used if set to 4 bit mode at HD44780_MODE
 #if HD44780_CONFIG_DL_DATA_LENGTH == 1
 #define HD44780_MODE 8
+#define HD44780_GPIO_DATA 1
 const int HD44780_PINS_DATA[HD44780_MODE] = {1,2,3,4,5,6,7,8};
 #elif HD44780_CONFIG_DL_DATA_LENGTH == 0
 #define HD44780_MODE 4
+#define HD44780_GPIO_DATA 5
 const int HD44780_PINS_DATA[HD44780_MODE] = {5,6,7,8};
 #else
 #error INVALID HD44780_CONFIG_DL_DATA_LENGTH MUST BE EITHER 0 or 1
 #endif
-const int HD44780_PINS_RW   = 9;
-const int HD44780_PINS_RS   = 10;
-const int HD44780_PINS_E    = 11;
-const int HD44780_PINS_DBG  = 12;
+#define HD44780_GPIO_RW  9
+#define HD44780_GPIO_RS  10
+#define HD44780_GPIO_E   11
+#define HD44780_GPIO_DBG 12
+const int HD44780_PINS_RW   = HD44780_GPIO_RW;
+const int HD44780_PINS_RS   = HD44780_GPIO_RS;
+const int HD44780_PINS_E    = HD44780_GPIO_E;
+const int HD44780_PINS_DBG  = HD44780_GPIO_DBG;
+
+// HD44780_GPIO_MASK
+#if HD44780_GPIO_MASK != ((((1u << HD44780_MODE) - 1) << HD44780_GPIO_DATA) | (1u << HD44780_GPIO_RW) | \
+    (1u << HD44780_GPIO_RS) | (1u << HD44780_GPIO_E) | (1u << HD44780_GPIO_DBG))
+#error
+#error HD44780_GPIO_MASK DOES NOT MATCH THE PINS ASSIGNED ABOVE
+#endif
 const int HD44780_PIN_COUNT = HD44780_MODE;
 
-#define NROW 4
-#define ROWLEN 17
-#define ROWLENCP (ROWLEN-1)
 char hd44780_display_data[NROW][ROWLEN] = {
     "",
     "",
     "",
     "",
 };
+// What the controller holds, only the differences get sent
+hd44780_fb hd44780_shadow;
+// Custom characters resident in CGRAM
+hd44780_glyph_cache hd44780_glyphs;
+// Rows longer than the display
+hd44780_scroll hd44780_scroller;
+
+// Text of set_line_utf8(), up to 4 bytes per character, translated and its
+// glyphs uploaded by the renderer in display_frame()
+#define HD44780_UTF8_LEN              ( ROWLENCP * 4 + 1 )
+static char hd44780_utf8_text[NROW][HD44780_UTF8_LEN];
+// Rows whose text has not been translated yet
+static uint8_t hd44780_utf8_pending = 0;
+
+// Texts of scroll_line(), handed to the scroller by the renderer
+static const char* hd44780_scroll_text[NROW];
+// Rows whose text the scroller has not taken yet
+static uint8_t hd44780_scroll_pending = 0;
+// Asks the renderer for a step every HD44780_CONFIG_SCROLL_MS while a row
+// scrolls, NULL without a renderer
+static TimerHandle_t hd44780_scroll_timer = NULL;
+static StaticTimer_t hd44780_scroll_timer_buffer;
+// Renderer, the scroller draws here and the rows that scroll go into the
+// frame with the frame locked
+static char hd44780_scroll_rows[NROW][ROWLEN];
 
 int get_high_4bits(const int v) {
     return (v & 0xF0) >> 4;
@@ -105,18 +222,18 @@ int valPos(int pos, int vals) {
 }
 
 void initialize_pins() {
-    gpio_init( HD44780_PINS_RW );
-    gpio_init( HD44780_PINS_RS );
-    gpio_init( HD44780_PINS_E );
-    gpio_init( HD44780_PINS_DBG );
+    hal_gpio_init( HD44780_PINS_RW );
+    hal_gpio_init( HD44780_PINS_RS );
+    hal_gpio_init( HD44780_PINS_E );
+    hal_gpio_init( HD44780_PINS_DBG );
     for(int i=0; i<HD44780_PIN_COUNT; i++) {
-        gpio_init( HD44780_PINS_DATA[i] );
+        hal_gpio_init( HD44780_PINS_DATA[i] );
     }
 }
 
 void set_datapins_output() {
     for(int i=0; i<HD44780_PIN_COUNT; i++) {
-        gpio_set_dir( HD44780_PINS_DATA[i], GPIO_OUT );
+        hal_gpio_set_dir( HD44780_PINS_DATA[i], HAL_GPIO_OUT );
     }
 }
 /* 
@@ -130,16 +247,155 @@ void set_datapins_output() {
 // bit 0 -> D0 ; bit 7 -> D7
 void hd44780_inst_set_data_pins(const int v) {
     for(int i=0; i<HD44780_PIN_COUNT; i++){
-        gpio_put(HD44780_PINS_DATA[i], v&(1<<i));
+        hal_gpio_put(HD44780_PINS_DATA[i], v&(1<<i));
+    }
+}
+
+#if HD44780_CONFIG_BUS_PIO == 1
+/*
+ * With the PIO engine the RS level travels inside every frame, so only
+ * remember what the last hd44780_send_instruction/data_payload selected.
+ * Frames are only queued here, hd44780_flush() hands them to DMA.
+ */
+static int hd44780_rs = 0;
+
+void hd44780_send_data(const int v) {
+    hd44780_bus_pio_push(
+        hd44780_bus_frame(HD44780_MODE, hd44780_rs, v, hd44780_INST_DELAY_US));
+}
+
+void hd44780_send_payload(const int v) {
+    uint32_t frames[2];
+    const size_t n = hd44780_bus_encode(frames, HD44780_MODE, hd44780_rs, v, hd44780_INST_DELAY_US);
+    for(size_t i=0; i<n; i++) {
+        hd44780_bus_pio_push(frames[i]);
+    }
+}
+
+void hd44780_send_instruction(const int v) {
+    hd44780_rs = 0;
+    hd44780_send_payload(v);
+}
+
+void hd44780_send_data_payload(const int v) {
+    hd44780_rs = 1;
+    hd44780_send_payload(v);
+}
+
+void hd44780_flush() {
+    hd44780_bus_pio_flush();
+}
+
+// Timing is encoded in every frame
+void hd44780_busy_flag_enable() { }
+
+uint32_t hd44780_get_busy_timeouts() {
+    return 0;
+}
+
+void hd44780_wait_long(TickType_t *xNextWakeTime) {
+    vTaskDelayUntil( xNextWakeTime, hd44780_INST_CLEAR_DISPLAY_MS );
+}
+#elif HD44780_CONFIG_BUSY_FLAG == 1
+/*
+ * Busy flag polling
+ *
+ * Before every transfer RW is raised, the data pins become inputs and the
+ * status register (BF in D7, address counter below) is read until BF clears.
+ * Clear and home poll it the same way instead of sleeping their 10ms. If BF
+ * never clears within hd44780_BUSY_TIMEOUT_US (a glitch, RW not wired) the
+ * timeout is counted and that one transfer goes out with the fixed worst
+ * case delay after it, the next one polls again.
+ *
+ * NOTE: the RP2040 pins are not 5V tolerant, reading needs a 3.3V module or
+ * level shifting on the data lines.
+ */
+// Only valid once the function set has been executed
+static int hd44780_busy_flag_enabled = 0;
+// The transfer being sent polled in vain
+static int hd44780_busy_flag_fallback = 0;
+static uint32_t hd44780_busy_timeouts = 0;
+
+void set_datapins_input() {
+    for(int i=0; i<HD44780_PIN_COUNT; i++) {
+        hal_gpio_set_dir( HD44780_PINS_DATA[i], HAL_GPIO_IN );
+    }
+}
+
+int hd44780_inst_get_data_pins() {
+    int v = 0;
+    for(int i=0; i<HD44780_PIN_COUNT; i++){
+        v |= hal_gpio_get(HD44780_PINS_DATA[i]) << i;
+    }
+    return v;
+}
+
+int hd44780_read_data() {
+    hal_gpio_put( HD44780_PINS_E, 1 );
+    hal_busy_wait_us(hd44780_E_PULSE_US);
+    const int v = hd44780_inst_get_data_pins();
+    hal_gpio_put( HD44780_PINS_E, 0 );
+    hal_busy_wait_us(hd44780_E_PULSE_US);
+    return v;
+}
+
+// Busy flag in bit 7, address counter in bits 0..6
+int hd44780_read_status() {
+#if HD44780_CONFIG_DL_DATA_LENGTH == 1
+    return hd44780_read_data();
+#elif HD44780_CONFIG_DL_DATA_LENGTH == 0
+    const int high = hd44780_read_data();
+    return high << 4 | hd44780_read_data();
+#endif
+}
+
+void hd44780_wait_ready() {
+    hd44780_busy_flag_fallback = 0;
+    if(!hd44780_busy_flag_enabled) { return; }
+    set_datapins_input();
+    hal_gpio_put( HD44780_PINS_RS, 0 );
+    hal_gpio_put( HD44780_PINS_RW, 1 );
+    const uint64_t start = hal_time_us();
+    while(hd44780_read_status() & 0x80) {
+        if(hal_time_us() - start > hd44780_BUSY_TIMEOUT_US) {
+            hd44780_busy_timeouts++;
+            hd44780_busy_flag_fallback = 1;
+            break;
+        }
+    }
+    hal_gpio_put( HD44780_PINS_RW, 0 );
+    set_datapins_output();
+}
+
+void hd44780_busy_flag_enable() {
+    hd44780_busy_flag_enabled = 1;
+}
+
+uint32_t hd44780_get_busy_timeouts() {
+    return hd44780_busy_timeouts;
+}
+
+// Clear and home, BF tells when they are done
+void hd44780_wait_long(TickType_t *xNextWakeTime) {
+    if(!hd44780_busy_flag_enabled) {
+        vTaskDelayUntil( xNextWakeTime, hd44780_INST_CLEAR_DISPLAY_MS );
+        return;
     }
+    hd44780_wait_ready();
+    // Later delays count from here
+    *xNextWakeTime = xTaskGetTickCount();
 }
 
 void hd44780_send_data(const int v) {
-    gpio_put( HD44780_PINS_E, 1 );
+    hal_gpio_put( HD44780_PINS_E, 1 );
     hd44780_inst_set_data_pins(v);
-    busy_wait_us(hd44780_INST_DELAY_US);
-    gpio_put( HD44780_PINS_E, 0 );
-    busy_wait_us(hd44780_INST_DELAY_US);
+    hal_busy_wait_us(hd44780_E_PULSE_US);
+    hal_gpio_put( HD44780_PINS_E, 0 );
+    if(hd44780_busy_flag_enabled && !hd44780_busy_flag_fallback) {
+        hal_busy_wait_us(hd44780_E_PULSE_US);
+    } else {
+        hal_busy_wait_us(hd44780_INST_DELAY_US);
+    }
 }
 
 void hd44780_send_payload(const int v) {
@@ -152,15 +408,65 @@ void hd44780_send_payload(const int v) {
 }
 
 void hd44780_send_instruction(const int v) {
-    gpio_put( HD44780_PINS_RS, 0 );
+    hd44780_wait_ready();
+    hal_gpio_put( HD44780_PINS_RS, 0 );
     hd44780_send_payload(v);
 }
 
 void hd44780_send_data_payload(const int v) {
-    gpio_put( HD44780_PINS_RS, 1 );
+    hd44780_wait_ready();
+    hal_gpio_put( HD44780_PINS_RS, 1 );
     hd44780_send_payload(v);
 }
 
+// Every transfer already completed synchronously
+void hd44780_flush() { }
+#else
+void hd44780_send_data(const int v) {
+    hal_gpio_put( HD44780_PINS_E, 1 );
+    hd44780_inst_set_data_pins(v);
+#if HD44780_CONFIG_BUS_DELAYS == 1
+    hal_busy_wait_us(hd44780_INST_DELAY_US);
+#endif
+    hal_gpio_put( HD44780_PINS_E, 0 );
+#if HD44780_CONFIG_BUS_DELAYS == 1
+    hal_busy_wait_us(hd44780_INST_DELAY_US);
+#endif
+}
+
+void hd44780_send_payload(const int v) {
+#if HD44780_CONFIG_DL_DATA_LENGTH == 1
+    hd44780_send_data(v);
+#elif HD44780_CONFIG_DL_DATA_LENGTH == 0
+    hd44780_send_data(get_high_4bits(v));
+    hd44780_send_data(get_low_4bits(v));
+#endif
+}
+
+void hd44780_send_instruction(const int v) {
+    hal_gpio_put( HD44780_PINS_RS, 0 );
+    hd44780_send_payload(v);
+}
+
+void hd44780_send_data_payload(const int v) {
+    hal_gpio_put( HD44780_PINS_RS, 1 );
+    hd44780_send_payload(v);
+}
+
+void hd44780_busy_flag_enable() { }
+
+uint32_t hd44780_get_busy_timeouts() {
+    return 0;
+}
+
+void hd44780_wait_long(TickType_t *xNextWakeTime) {
+    vTaskDelayUntil( xNextWakeTime, hd44780_INST_CLEAR_DISPLAY_MS );
+}
+
+// Every transfer already completed synchronously
+void hd44780_flush() { }
+#endif
+
 void hd44780_inst_display_clear(TickType_t *xNextWakeTime) {
     // Per instructions:
     // - DB7: 0
@@ -173,7 +479,8 @@ void hd44780_inst_display_clear(TickType_t *xNextWakeTime) {
     // - DB0: 1
     const int val = 0x01;
     hd44780_send_instruction(val);
-    vTaskDelayUntil( xNextWakeTime, hd44780_INST_CLEAR_DISPLAY_MS );
+    hd44780_flush();
+    hd44780_wait_long(xNextWakeTime);
 }
 
 void hd44780_inst_return_home(TickType_t *xNextWakeTime) {
@@ -188,7 +495,8 @@ void hd44780_inst_return_home(TickType_t *xNextWakeTime) {
     // - DB0: Ignored
     const int val = 0x02;
     hd44780_send_instruction(val);
-    vTaskDelayUntil( xNextWakeTime, hd44780_INST_CLEAR_DISPLAY_MS );
+    hd44780_flush();
+    hd44780_wait_long(xNextWakeTime);
 }
 
 #define HD44780_CONFIG_ID_INCREMENT_DIRECTION 1 // 1 - Right | 0 - Left
@@ -330,22 +638,32 @@ void hd44780_inst_set_ddram_address(const int address) {
 }
 
 void initialize() {
+#if HD44780_CONFIG_BUS_PIO == 1
+    // The PIO engine owns data, RW, RS (consecutive, data first) and E
+    configASSERT( HD44780_PINS_RW == HD44780_PINS_DATA[0] + HD44780_MODE );
+    configASSERT( HD44780_PINS_RS == HD44780_PINS_RW + 1 );
+    hd44780_bus_pio_init( HD44780_PINS_DATA[0], HD44780_MODE, HD44780_PINS_E );
+    hal_gpio_init( HD44780_PINS_DBG );
+    hal_gpio_set_dir( HD44780_PINS_DBG , HAL_GPIO_OUT );
+    hal_gpio_put( HD44780_PINS_DBG, 1 );
+#else
     // Initialize pins
     initialize_pins();
     // Set direction of control pins
-    gpio_set_dir( HD44780_PINS_RW, GPIO_OUT );
-    gpio_set_dir( HD44780_PINS_RS, GPIO_OUT );
-    gpio_set_dir( HD44780_PINS_E , GPIO_OUT );
-    gpio_set_dir( HD44780_PINS_DBG , GPIO_OUT );
+    hal_gpio_set_dir( HD44780_PINS_RW, HAL_GPIO_OUT );
+    hal_gpio_set_dir( HD44780_PINS_RS, HAL_GPIO_OUT );
+    hal_gpio_set_dir( HD44780_PINS_E , HAL_GPIO_OUT );
+    hal_gpio_set_dir( HD44780_PINS_DBG , HAL_GPIO_OUT );
     // Set direction of pins for default
     set_datapins_output();
 
     // Set initial values
     hd44780_inst_set_data_pins(0);
-    gpio_put( HD44780_PINS_RW, 0 );
-    gpio_put( HD44780_PINS_RS, 0 );
-    gpio_put( HD44780_PINS_E, 0 );
-    gpio_put( HD44780_PINS_DBG, 1 );
+    hal_gpio_put( HD44780_PINS_RW, 0 );
+    hal_gpio_put( HD44780_PINS_RS, 0 );
+    hal_gpio_put( HD44780_PINS_E, 0 );
+    hal_gpio_put( HD44780_PINS_DBG, 1 );
+#endif
 }
 
 void reset_sequence(TickType_t *xNextWakeTime) {
@@ -354,11 +672,16 @@ void reset_sequence(TickType_t *xNextWakeTime) {
     // Instruction to archieve the correct initialization
 #if HD44780_CONFIG_DL_DATA_LENGTH == 0
     hd44780_inst_function_set_half();
+    hd44780_flush();
     vTaskDelayUntil( xNextWakeTime, hd44780_INST_CLEAR_DISPLAY_MS );
 #endif
     hd44780_inst_function_set();
+    hd44780_flush();
     vTaskDelayUntil( xNextWakeTime, hd44780_INST_CLEAR_DISPLAY_MS );
+    // From here on the busy flag can be checked
+    hd44780_busy_flag_enable();
     hd44780_inst_display_clear(xNextWakeTime);
+    hd44780_fb_cleared(&hd44780_shadow);
     hd44780_inst_display_control(1, 1, 0);
     hd44780_inst_entry_mode_set(1,0);
 
@@ -369,25 +692,25 @@ void reset_sequence(TickType_t *xNextWakeTime) {
 // This only exists to confirm that the loop is never stuck
 static int blk = 0;
 void blink_dbg() {
-    gpio_put(HD44780_PINS_DBG, blk);
+    hal_gpio_put(HD44780_PINS_DBG, blk);
     blk = !blk;
 }
 
 int check_line_not_reachable(int const l) {
-    if(l < 0 || l > NROW) { return 1; }
+    if(l < 0 || l >= NROW) { return 1; }
     return 0;
 }
 
-void write_string(char const * const rstr) {
-    char const * str = rstr;
-    for(int i=0 ; i<ROWLENCP && str[i] != '\0' ; i++) {
-        hd44780_send_data_payload(str[i]);
-    }
+void hd44780_frame_lock() {
+    taskENTER_CRITICAL();
 }
 
-void set_line(int line, char* str) {
-    // Verify reachable line
-    if(check_line_not_reachable(line)) { return; }
+void hd44780_frame_unlock() {
+    taskEXIT_CRITICAL();
+}
+
+// With the frame locked
+static void copy_line(int line, const char* str) {
     char* ddl = hd44780_display_data[line];
     // Only copy allowed range of data
     int i;
@@ -399,17 +722,204 @@ void set_line(int line, char* str) {
     ddl[i] = '\0';
 }
 
-void display_line(int line) {
+void set_line(int line, char* str) {
+    // Verify reachable line
     if(check_line_not_reachable(line)) { return; }
-    hd44780_inst_set_ddram_address(HD44780_LINE_START_LOC[line]);
-    write_string(hd44780_display_data[line]);
+    hd44780_frame_lock();
+    // Newer than UTF-8 text still waiting for the renderer
+    hd44780_utf8_pending &= (uint8_t)~(1u << line);
+    copy_line(line, str);
+    hd44780_frame_unlock();
+    render_mark_dirty(RENDER_SOURCE_TEXT);
+}
+
+static void fb_set_address(void *ctx, const int address) {
+    ( void ) ctx;
+    hd44780_inst_set_ddram_address(address);
+}
+
+static void fb_write(void *ctx, const int c) {
+    ( void ) ctx;
+    hd44780_send_data_payload(c);
+}
+
+static const hd44780_fb_sink hd44780_shadow_sink = {
+    .set_address = fb_set_address,
+    .write = fb_write,
+    .ctx = NULL,
+};
+
+static void glyph_set_address(void *ctx, const int address) {
+    ( void ) ctx;
+    hd44780_inst_set_cgram_address(address);
+}
+
+static const hd44780_glyph_sink hd44780_glyph_upload_sink = {
+    .set_cgram_address = glyph_set_address,
+    .write = fb_write,
+    .ctx = NULL,
+};
+
+static void scroll_shift(void *ctx, const int left) {
+    ( void ) ctx;
+    hd44780_inst_cursor_display_shift(1, left ? 0 : 1);
+}
+
+static const hd44780_scroll_sink hd44780_scroll_shift_sink = {
+    .fb = &hd44780_shadow_sink,
+    .shift_display = scroll_shift,
+    .ctx = NULL,
+};
+
+void set_line_utf8(int line, const char* str) {
+    if(check_line_not_reachable(line)) { return; }
+    // Only the text, the glyph cache and the bus belong to the renderer
+    taskENTER_CRITICAL();
+    char* text = hd44780_utf8_text[line];
+    int i;
+    for(i=0; i<HD44780_UTF8_LEN - 1 && str[i] != '\0'; i++) {
+        text[i] = str[i];
+    }
+    text[i] = '\0';
+    hd44780_utf8_pending |= (uint8_t)(1u << line);
+    taskEXIT_CRITICAL();
+    render_mark_dirty(RENDER_SOURCE_TEXT);
+}
+
+// Renderer, glyph uploads are queued ahead of the frame that uses them
+static void translate_utf8_lines(void) {
+    for(int line=0; line<NROW; line++) {
+        char text[HD44780_UTF8_LEN];
+        taskENTER_CRITICAL();
+        const bool pending = hd44780_utf8_pending & (1u << line);
+        if(pending) {
+            memcpy(text, hd44780_utf8_text[line], sizeof(text));
+            hd44780_utf8_pending &= (uint8_t)~(1u << line);
+        }
+        taskEXIT_CRITICAL();
+        if(!pending) { continue; }
+
+        char buf[ROWLEN];
+        hd44780_glyph_utf8(&hd44780_glyphs, text, buf, sizeof(buf));
+        hd44780_frame_lock();
+        copy_line(line, buf);
+        hd44780_frame_unlock();
+    }
+}
+
+// Send every cell of hd44780_display_data that differs from the controller
+void display_frame() {
+    char frame[NROW][ROWLEN];
+
+    translate_utf8_lines();
+    // The flush waits on the bus, so it works on a copy taken in one go
+    hd44780_frame_lock();
+    memcpy(frame, hd44780_display_data, sizeof(frame));
+    hd44780_frame_unlock();
+    hd44780_fb_flush(&hd44780_shadow, &frame[0][0], ROWLEN, &hd44780_shadow_sink);
+    hd44780_flush();
+    hd44780_glyph_sync(&hd44780_glyphs);
+}
+
+void scroll_line(int line, const char* str) {
+    if(check_line_not_reachable(line)) { return; }
+    // The scroller belongs to the renderer, it takes the text on its next frame
+    taskENTER_CRITICAL();
+    hd44780_scroll_text[line] = str;
+    hd44780_scroll_pending |= (uint8_t)(1u << line);
+    taskEXIT_CRITICAL();
+    render_mark_dirty(RENDER_SOURCE_TEXT);
+}
+
+// Renderer, true when a text changed: the next step draws it
+static bool take_scroll_texts(void) {
+    const char* text[NROW];
+    taskENTER_CRITICAL();
+    const uint8_t pending = hd44780_scroll_pending;
+    memcpy(text, hd44780_scroll_text, sizeof(text));
+    hd44780_scroll_pending = 0;
+    taskEXIT_CRITICAL();
+    if(pending == 0) { return false; }
+
+    bool scrolling = false;
+    for(int line=0; line<NROW; line++) {
+        if(pending & (1u << line)) {
+            hd44780_scroll_set(&hd44780_scroller, line, text[line]);
+        }
+        scrolling = scrolling || hd44780_scroller.lines[line].text != NULL;
+    }
+    // No steps while every row stands still
+    if(hd44780_scroll_timer != NULL) {
+        if(scrolling) {
+            xTimerStart(hd44780_scroll_timer, 0);
+        } else {
+            xTimerStop(hd44780_scroll_timer, 0);
+        }
+    }
+    return true;
+}
+
+// Renderer, the sink may wait on the bus so the step draws outside the frame
+static void step_scroll(void) {
+    hd44780_scroll_step(&hd44780_scroller, &hd44780_scroll_rows[0][0], ROWLEN);
+    hd44780_frame_lock();
+    for(int line=0; line<hd44780_shadow.rows; line++) {
+        if(hd44780_scroller.lines[line].text != NULL) {
+            memcpy(hd44780_display_data[line], hd44780_scroll_rows[line], ROWLEN);
+        }
+    }
+    hd44780_frame_unlock();
+}
+
+void scroll_step() {
+    ( void ) take_scroll_texts();
+    step_scroll();
+    display_frame();
+}
+
+// Timer task
+static void scroll_tick(TimerHandle_t timer) {
+    ( void ) timer;
+    render_mark_dirty(RENDER_SOURCE_SCROLL);
+}
+
+void hd44780_render_init() {
+    render_init(NULL, 1000000 / HD44780_CONFIG_MAX_FPS, HD44780_CONFIG_LATENCY_MS * 1000);
+    if(hd44780_scroll_timer == NULL) {
+        hd44780_scroll_timer = xTimerCreateStatic("SCROLL", HD44780_CONFIG_SCROLL_MS / portTICK_PERIOD_MS,
+            pdTRUE, NULL, scroll_tick, &hd44780_scroll_timer_buffer);
+    }
+}
+
+void hd44780_set_rows(const int rows, TickType_t *xNextWakeTime) {
+    if(rows < 1 || rows > NROW) { return; }
+    // The clear also takes back the display shift of a hardware marquee
+    hd44780_inst_display_clear(xNextWakeTime);
+    hd44780_fb_init(&hd44780_shadow, rows, ROWLENCP, HD44780_LINE_START_LOC);
+    hd44780_fb_cleared(&hd44780_shadow);
+    hd44780_scroll_init(&hd44780_scroller, &hd44780_shadow, &hd44780_scroll_shift_sink);
+    taskENTER_CRITICAL();
+    hd44780_scroll_pending = 0;
+    taskEXIT_CRITICAL();
+}
+
+void hd44780_init(TickType_t *xNextWakeTime) {
+    // Initialize internal configurations related to HD44780 specifics
+    initialize();
+    hd44780_fb_init(&hd44780_shadow, NROW, ROWLENCP, HD44780_LINE_START_LOC);
+    hd44780_glyph_init(&hd44780_glyphs, &hd44780_shadow, &hd44780_glyph_upload_sink);
+    hd44780_scroll_init(&hd44780_scroller, &hd44780_shadow, &hd44780_scroll_shift_sink);
+
+    // Realize the reset sequence to initialize the HD44780
+    reset_sequence(xNextWakeTime);
 }
 
 /*-----------------------------------------------------------*/
-/* Logic of operation is to check every 100ms or wait until change event
- * and then run the full logic to realize the task
+/* Logic of operation is to sleep until something changed (a second of the
+ * timekeeper, a line set by another task, a step of a marquee) and then send
+ * one frame with every change made since the last one, at most
+ * HD44780_CONFIG_MAX_FPS per second
  */
-#define hd44780_CHECK_FREQUENCY_MS            ( 1000 / portTICK_PERIOD_MS )
 void hd44780Task( void *pvParameters )
 {
     // Vars
@@ -419,31 +929,48 @@ void hd44780Task( void *pvParameters )
     ( void ) pvParameters;
     xNextWakeTime = xTaskGetTickCount();
 
-    // Initialize internal configurations related to HD44780 specifics
-    initialize();
-
-    // Realize the reset sequence to initialize the HD44780
-    reset_sequence(&xNextWakeTime);
+    hd44780_init(&xNextWakeTime);
+    // Frames on render_mark_dirty() and on every second of the timekeeper
+    hd44780_render_init();
+    timekeeper_subscribe(NULL);
 
     set_line(0, "L1 Me gusta");
-    display_line(0);
-    set_line(1, "L2 Funciona?");
-    display_line(1);
+    set_line_utf8(1, "L2 ¿Funcionará?");
     set_line(2, "L3 No me lo creo");
-    display_line(2);
-    set_line(3, "L4 A la primera?");
-    display_line(3);
-
-    // Test display
-    int cnt = 0;
-    char buf[ROWLEN] = "";
+    set_line(3, "L4");
+    clock_widget time_view;
+    hd44780_frame_lock();
+    clock_widget_init(&time_view, hd44780_display_data[3], 3);
+    hd44780_frame_unlock();
+
+#if HD44780_CONFIG_COUNTER == 1
+    uint32_t cnt = 0;
+#endif
     for( ;; )
     {
+        const uint32_t sources = render_wait();
         blink_dbg();
-        snprintf(buf, sizeof(buf), "%d", cnt++);
-        set_line(3, buf);
-        display_line(3);
-        //vTaskDelayUntil( &xNextWakeTime, hd44780_CHECK_FREQUENCY_MS );
+        timekeeper_time now;
+        timekeeper_split(timekeeper_now_s(), &now);
+        hd44780_frame_lock();
+        clock_widget_draw(&time_view, &now);
+        hd44780_frame_unlock();
+#if HD44780_CONFIG_COUNTER == 1
+        // Every frame asks for the next one, the cap paces the bus
+        lcd_fmt counter;
+        hd44780_frame_lock();
+        lcd_fmt_begin(&counter, hd44780_display_data[2], ROWLEN, 0);
+        lcd_fmt_uint(&counter, cnt++, 0, ' ');
+        lcd_fmt_end(&counter);
+        hd44780_frame_unlock();
+        render_mark_dirty(RENDER_SOURCE_FIELD);
+#endif
+        // A new marquee is drawn at once, then moves one cell per period
+        if(take_scroll_texts() || (sources & RENDER_SOURCE_SCROLL)) {
+            step_scroll();
+        }
+        display_frame();
+        render_done();
     }
 }
 /*-----------------------------------------------------------*/
@@ -1,4 +1,73 @@
 #ifndef HD44780_H
 #define HD44780_H
+#include "FreeRTOS.h"
+#include "hd44780_fb.h"
+#include "hd44780_glyph.h"
+#include "hd44780_scroll.h"
+
+#define NROW 4
+#define ROWLEN 17
+#define ROWLENCP (ROWLEN-1)
+// GPIOs the driver takes: data 5..8, RW 9, RS 10, E 11 and the debug pin 12.
+// Other pin maps check against it, hd44780.c against its wiring.
+#define HD44780_GPIO_MASK (0xFFu << 5)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 void hd44780Task( void *pvParameters );
+
+// Pins, shadow and reset sequence, blocks for the power on delays
+void hd44780_init(TickType_t *xNextWakeTime);
+// The calling task renders the frame on render_mark_dirty() (render.h),
+// at most HD44780_CONFIG_MAX_FPS frames per second
+void hd44780_render_init(void);
+// Copy `str` into the frame (truncated to the row length) and ask for a frame
+void set_line(int line, char* str);
+// Same from UTF-8: only the text is kept here, the renderer translates it
+// in display_frame() and uploads the characters missing from ROM through
+// hd44780_glyphs. A later set_line() on the row replaces it.
+void set_line_utf8(int line, const char* str);
+// Renderer only: translate the UTF-8 rows, then send the cells of the frame
+// that differ from the controller
+void display_frame(void);
+// Scroll `str` (kept, not copied) on `line` as a marquee, NULL stops it.
+// The renderer moves it one cell every HD44780_CONFIG_SCROLL_MS.
+void scroll_line(int line, const char* str);
+// For a task that flushes the frame itself instead of hd44780Task (the
+// benches): move the scrolling lines one cell and send the frame
+void scroll_step(void);
+// Renderer only: show the first `rows` rows, a 16x2 part on the same wiring.
+// Clears the display, stops every marquee and forgets their texts.
+void hd44780_set_rows(const int rows, TickType_t *xNextWakeTime);
+// Put `v` on the data pins one GPIO at a time (bit 0 -> first data pin)
+void hd44780_inst_set_data_pins(const int v);
+// Transfers sent on the fixed delay because BF did not clear in time,
+// always 0 without HD44780_CONFIG_BUSY_FLAG
+uint32_t hd44780_get_busy_timeouts(void);
+
+// Every task writing hd44780_display_data holds the frame lock while it
+// writes, a critical section: nothing that blocks or takes long in between.
+// display_frame() copies the frame under it and flushes the copy.
+void hd44780_frame_lock(void);
+void hd44780_frame_unlock(void);
+
+// Frame being shown and what the controller holds
+extern char hd44780_display_data[NROW][ROWLEN];
+extern hd44780_fb hd44780_shadow;
+extern hd44780_glyph_cache hd44780_glyphs;
+extern hd44780_scroll hd44780_scroller;
+
+// Wiring, defined in hd44780.c
+extern const int HD44780_PINS_DATA[];
+extern const int HD44780_PINS_RW;
+extern const int HD44780_PINS_RS;
+extern const int HD44780_PINS_E;
+extern const int HD44780_PIN_COUNT;
+extern const int HD44780_LINE_START_LOC[];
+
+#ifdef __cplusplus
+}
+#endif
 #endif
@@ -0,0 +1,220 @@
+#ifndef HD44780_HPP
+#define HD44780_HPP
+/*
+ * Compile time specialised HD44780 driver (C++17).
+ *
+ * Wiring, geometry and timing are template parameters, so everything the C
+ * driver looks up at run time is folded by the compiler:
+ * - the data pins become a mask and a nibble/byte to GPIO levels table, or a
+ *   single shift when they are consecutive in ascending order,
+ * - each bus cycle is one masked SIO write raising E with data and RS, and
+ *   one clearing E,
+ * - line start addresses and the function set follow from the geometry.
+ *
+ *   using lcd = hd44780::driver<hd44780::pins<10, 9, 11, 5, 6, 7, 8>,
+ *                               hd44780::geometry<16, 4>>;
+ *   lcd::init_pins();
+ *   lcd::reset(&xNextWakeTime);
+ *   lcd::flush(&shadow, &frame[0][0], sizeof(frame[0]));
+ *
+ * The driver writes only (RW is held low), the frame diffing is hd44780_fb.
+ */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "hal.h"
+#include "hd44780_fb.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+namespace hd44780 {
+
+enum : uint8_t {
+    INST_CLEAR_DISPLAY    = 0x01,
+    INST_RETURN_HOME      = 0x02,
+    INST_ENTRY_MODE_SET   = 0x04,
+    INST_DISPLAY_CONTROL  = 0x08,
+    INST_SHIFT            = 0x10,
+    INST_FUNCTION_SET     = 0x20,
+    INST_SET_CGRAM        = 0x40,
+    INST_SET_DDRAM        = 0x80,
+};
+
+// RS, RW and E pins followed by the data pins, D0..D7 or D4..D7
+template <unsigned Rs, unsigned Rw, unsigned E, unsigned... Data>
+struct pins {
+    static constexpr unsigned width = sizeof...(Data);
+    static_assert(width == 4 || width == 8, "the bus is 4 or 8 data pins wide");
+    static_assert(((Data < 30) && ...) && Rs < 30 && Rw < 30 && E < 30, "not a GPIO");
+
+    static constexpr std::array<unsigned, width> data = { Data... };
+    static constexpr uint32_t data_mask = ((1u << Data) | ...);
+    static constexpr uint32_t rs_mask = 1u << Rs;
+    static constexpr uint32_t rw_mask = 1u << Rw;
+    static constexpr uint32_t e_mask = 1u << E;
+    static constexpr uint32_t all_mask = data_mask | rs_mask | rw_mask | e_mask;
+    static_assert(__builtin_popcount(all_mask) == width + 3, "pins used twice");
+
+    static constexpr bool contiguous = [] {
+        for(unsigned i=1; i<width; i++) {
+            if(data[i] != data[0] + i) { return false; }
+        }
+        return true;
+    }();
+
+    // GPIO levels of every bus value, only instantiated for scattered pins
+    static constexpr std::array<uint32_t, 1u << width> levels = [] {
+        std::array<uint32_t, 1u << width> t{};
+        for(unsigned v=0; v<t.size(); v++) {
+            for(unsigned i=0; i<width; i++) {
+                if(v & (1u << i)) { t[v] |= 1u << data[i]; }
+            }
+        }
+        return t;
+    }();
+
+    static constexpr uint32_t to_gpio(const unsigned v) {
+        if constexpr (contiguous) {
+            return static_cast<uint32_t>(v) << data[0];
+        } else {
+            return levels[v];
+        }
+    }
+};
+
+// Visible size, the DDRAM layout follows from it
+template <unsigned Cols, unsigned Rows>
+struct geometry {
+    static_assert(Rows == 1 || Rows == 2 || Rows == 4, "1, 2 or 4 lines");
+    static_assert(Cols > 0 && Cols * (Rows == 4 ? 2 : 1) <= 40, "a DDRAM line holds 40 characters");
+
+    static constexpr unsigned cols = Cols;
+    static constexpr unsigned rows = Rows;
+    // Lines 3 and 4 continue lines 1 and 2 in DDRAM
+    static constexpr std::array<int, Rows> line_start = [] {
+        std::array<int, Rows> s{};
+        for(unsigned r=0; r<Rows; r++) {
+            s[r] = static_cast<int>((r & 1) * 0x40 + (r >> 1) * Cols);
+        }
+        return s;
+    }();
+};
+
+// Same margins as the fixed delays of hd44780.c
+struct timing_default {
+    static constexpr uint32_t setup_ns = 40;      // tAS, RS to E high
+    static constexpr uint32_t e_pulse_us = 1;     // PWEH >= 450ns, tcycE >= 1000ns
+    static constexpr uint32_t exec_us = 80;       // 37us per instruction, with margin
+    static constexpr uint32_t clear_ms = 10;      // Clear and home, 1.52ms
+    static constexpr uint32_t power_on_ms = 100;
+};
+
+// No waiting at all, only to measure the cost of driving the pins
+struct timing_none {
+    static constexpr uint32_t setup_ns = 0;
+    static constexpr uint32_t e_pulse_us = 0;
+    static constexpr uint32_t exec_us = 0;
+    static constexpr uint32_t clear_ms = 0;
+    static constexpr uint32_t power_on_ms = 0;
+};
+
+template <typename Pins, typename Geometry, typename Timing = timing_default>
+class driver {
+public:
+    using pins_type = Pins;
+    using geometry_type = Geometry;
+
+    static void init_pins() {
+        hal_gpio_init_mask(Pins::all_mask);
+        hal_gpio_set_dir_out_masked(Pins::all_mask);
+        hal_gpio_clr_mask(Pins::all_mask);
+    }
+
+    // Power on initialisation by instruction, blocks for the delays
+    static void reset(TickType_t *xNextWakeTime) {
+        delay_until(xNextWakeTime, Timing::power_on_ms);
+        if constexpr (Pins::width == 4) {
+            // Still in 8 bit mode: only the high nibble of function set
+            cycle(false, function_set >> 4, Timing::exec_us);
+            delay_until(xNextWakeTime, Timing::clear_ms);
+        }
+        instruction(function_set);
+        delay_until(xNextWakeTime, Timing::clear_ms);
+        instruction(INST_CLEAR_DISPLAY);
+        delay_until(xNextWakeTime, Timing::clear_ms);
+        instruction(INST_DISPLAY_CONTROL | 0x04);
+        instruction(INST_ENTRY_MODE_SET | 0x02);
+    }
+
+    static void instruction(const uint8_t v) { write(false, v); }
+    static void data(const uint8_t v) { write(true, v); }
+    static void set_ddram_address(const int address) { instruction(INST_SET_DDRAM | (address & 0x7F)); }
+    static void set_cgram_address(const int address) { instruction(INST_SET_CGRAM | (address & 0x3F)); }
+
+    // hd44780_fb for this geometry, after a reset the DDRAM is known blank
+    static void init_shadow(hd44780_fb *fb) {
+        hd44780_fb_init(fb, Geometry::rows, Geometry::cols, Geometry::line_start.data());
+        hd44780_fb_cleared(fb);
+    }
+
+    // Send the cells of `frame` that differ from `fb`
+    static void flush(hd44780_fb *fb, const char *frame, const size_t stride) {
+        static const hd44780_fb_sink sink = { sink_set_address, sink_write, nullptr };
+        hd44780_fb_flush(fb, frame, stride, &sink);
+    }
+
+private:
+    static constexpr uint8_t function_set = INST_FUNCTION_SET
+        | (Pins::width == 8 ? 0x10 : 0)
+        | (Geometry::rows > 1 ? 0x08 : 0);
+
+    static void wait_us(const uint32_t us) {
+        if(us) { hal_busy_wait_us(us); }
+    }
+
+    static void wait_ns(const uint32_t ns) {
+        if(ns) { hal_busy_wait_ns(ns); }
+    }
+
+    static void delay_until(TickType_t *xNextWakeTime, const uint32_t ms) {
+        if(ms) { vTaskDelayUntil(xNextWakeTime, pdMS_TO_TICKS(ms)); }
+    }
+
+    // One E cycle: data and RS in one write with E low, E high tAS later
+    // in another, then E low after the pulse
+    static void cycle(const bool rs, const unsigned v, const uint32_t hold_us) {
+        hal_gpio_put_masked(Pins::data_mask | Pins::rs_mask | Pins::e_mask,
+                            Pins::to_gpio(v) | (rs ? Pins::rs_mask : 0));
+        wait_ns(Timing::setup_ns);
+        hal_gpio_set_mask(Pins::e_mask);
+        wait_us(Timing::e_pulse_us);
+        hal_gpio_clr_mask(Pins::e_mask);
+        wait_us(hold_us);
+    }
+
+    static void write(const bool rs, const uint8_t v) {
+        if constexpr (Pins::width == 8) {
+            cycle(rs, v, Timing::exec_us);
+        } else {
+            // The instruction only executes after the low nibble
+            cycle(rs, v >> 4, Timing::e_pulse_us);
+            cycle(rs, v & 0x0F, Timing::exec_us);
+        }
+    }
+
+    static void sink_set_address(void *ctx, const int address) {
+        ( void ) ctx;
+        set_ddram_address(address);
+    }
+
+    static void sink_write(void *ctx, const int c) {
+        ( void ) ctx;
+        data(static_cast<uint8_t>(c));
+    }
+};
+
+} // namespace hd44780
+#endif
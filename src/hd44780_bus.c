@@ -0,0 +1,37 @@
+#include "hd44780_bus.h"
+
+static uint32_t group(const int width, const int rs, const int v) {
+    // RW is always 0 (write) on frames, it sits right after the data bits
+    const uint32_t data = (uint32_t)v & ((1u << width) - 1);
+    return data | ((uint32_t)(rs & 0x01) << (width + 1));
+}
+
+uint32_t hd44780_bus_frame(const int width, const int rs, const int v, const uint32_t delay_us) {
+    // The state machine loops y + 1 times, so store delay - 1
+    uint32_t d = delay_us ? delay_us - 1 : 0;
+    if(d >= HD44780_BUS_DELAY_MAX_US) { d = HD44780_BUS_DELAY_MAX_US - 1; }
+    return group(width, rs, v) | (d << HD44780_BUS_GROUP_BITS);
+}
+
+size_t hd44780_bus_encode(uint32_t *frames, const int width, const int rs, const int v, const uint32_t exec_us) {
+    if(width == 8) {
+        frames[0] = hd44780_bus_frame(width, rs, v, exec_us);
+        return 1;
+    }
+    // High nibble first
+    frames[0] = hd44780_bus_frame(width, rs, (v & 0xF0) >> 4, HD44780_BUS_NIBBLE_DELAY_US);
+    frames[1] = hd44780_bus_frame(width, rs, v & 0x0F, exec_us);
+    return 2;
+}
+
+int hd44780_bus_frame_rs(const int width, const uint32_t frame) {
+    return (frame >> (width + 1)) & 0x01;
+}
+
+int hd44780_bus_frame_data(const int width, const uint32_t frame) {
+    return (int)(frame & ((1u << width) - 1));
+}
+
+uint32_t hd44780_bus_frame_delay_us(const uint32_t frame) {
+    return (frame >> HD44780_BUS_GROUP_BITS) + 1;
+}
@@ -0,0 +1,58 @@
+#ifndef HD44780_BUS_H
+#define HD44780_BUS_H
+/*
+ * Frame encoding for the PIO driven HD44780 bus engine (hd44780.pio).
+ *
+ * Every 32 bit word pushed into the state machine TX FIFO is one E cycle:
+ * - bits 0..9   : pin group written with "out pins" (data, RW, RS)
+ * - bits 10..31 : execution delay after E falls, in microseconds - 1
+ *
+ * The pin group is laid out as the pins are wired, data first:
+ * - 4 bit bus: D4..D7 -> bits 0..3, RW -> bit 4, RS -> bit 5
+ * - 8 bit bus: D0..D7 -> bits 0..7, RW -> bit 8, RS -> bit 9
+ *
+ * Nothing in here touches hardware so the generated frames can be checked
+ * on any host against a model of the bus.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#define HD44780_BUS_GROUP_BITS        10
+#define HD44780_BUS_GROUP_MASK        ( ( 1u << HD44780_BUS_GROUP_BITS ) - 1 )
+#define HD44780_BUS_DELAY_BITS        ( 32 - HD44780_BUS_GROUP_BITS )
+#define HD44780_BUS_DELAY_MAX_US      ( 1u << HD44780_BUS_DELAY_BITS )
+
+// State machine clock, one delay loop iteration takes 4 cycles -> 1us
+#define HD44780_BUS_SM_FREQ           ( 4000000 ) //Herth
+
+// Delay between the two nibbles of a 4 bit transfer, the controller only
+// executes the instruction after the second one
+#define HD44780_BUS_NIBBLE_DELAY_US   1
+
+// Encode a single E cycle carrying `v` on a `width` (4 or 8) bit bus
+uint32_t hd44780_bus_frame(const int width, const int rs, const int v, const uint32_t delay_us);
+
+// Encode a full byte, 2 frames on a 4 bit bus and 1 on an 8 bit bus.
+// Returns the number of frames written to `frames`.
+size_t hd44780_bus_encode(uint32_t *frames, const int width, const int rs, const int v, const uint32_t exec_us);
+
+// Inverse helpers, used by the software models of the bus
+int hd44780_bus_frame_rs(const int width, const uint32_t frame);
+int hd44780_bus_frame_data(const int width, const uint32_t frame);
+uint32_t hd44780_bus_frame_delay_us(const uint32_t frame);
+
+/*
+ * PIO + DMA backend (hd44780_bus_pio.c), RP2040 only.
+ * The data pins, RW and RS must be consecutive GPIOs starting at data_base.
+ * The flushing task waits for the DMA on HD44780_BUS_NOTIFY_INDEX, which
+ * nothing else uses, so other wake ups of the task cannot cut it short.
+ */
+#define HD44780_BUS_NOTIFY_INDEX      ( 3 )
+void hd44780_bus_pio_init(const int data_base, const int width, const int pin_e);
+// Append a frame to the pending transfer, flushing if the buffer is full
+void hd44780_bus_pio_push(const uint32_t frame);
+// Hand the pending frames to DMA and block until it has moved them all into
+// the FIFO. Up to 8 frames may still be on their way to the controller, so
+// waits timed from here (hd44780_wait_long()) must cover them as well.
+void hd44780_bus_pio_flush(void);
+#endif
@@ -0,0 +1,90 @@
+#include "hd44780_bus.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+
+/* Generated from hd44780.pio */
+#include "hd44780.pio.h"
+
+// A full 16 character line on a 4 bit bus is (1 + 16) * 2 frames
+#define HD44780_BUS_PIO_QUEUE_LEN     ( 64 )
+#define HD44780_BUS_PIO               ( pio0 )
+#define HD44780_BUS_PIO_DMA_IRQ       ( DMA_IRQ_0 )
+
+static uint32_t hd44780_bus_pio_frames[HD44780_BUS_PIO_QUEUE_LEN];
+static size_t hd44780_bus_pio_pending = 0;
+static uint hd44780_bus_pio_sm;
+static int hd44780_bus_pio_dma;
+static TaskHandle_t volatile hd44780_bus_pio_waiter = NULL;
+
+static void hd44780_bus_pio_dma_handler(void) {
+    if(!dma_channel_get_irq0_status((uint)hd44780_bus_pio_dma)) { return; }
+    traceIRQ_ENTER(HD44780_BUS_PIO_DMA_IRQ);
+    dma_channel_acknowledge_irq0((uint)hd44780_bus_pio_dma);
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    if(hd44780_bus_pio_waiter != NULL) {
+        vTaskNotifyGiveIndexedFromISR(hd44780_bus_pio_waiter, HD44780_BUS_NOTIFY_INDEX, &xHigherPriorityTaskWoken);
+        hd44780_bus_pio_waiter = NULL;
+    }
+    traceIRQ_EXIT(HD44780_BUS_PIO_DMA_IRQ);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void hd44780_bus_pio_init(const int data_base, const int width, const int pin_e) {
+    PIO pio = HD44780_BUS_PIO;
+    // Data bits + RW + RS
+    const uint group_count = (uint)width + 2;
+
+    uint offset = pio_add_program(pio, &hd44780_bus_program);
+    hd44780_bus_pio_sm = (uint)pio_claim_unused_sm(pio, true);
+    hd44780_bus_program_init(pio, hd44780_bus_pio_sm, offset,
+            (uint)data_base, group_count, (uint)pin_e, HD44780_BUS_SM_FREQ);
+
+    // DMA paced by the TX FIFO, the buffer is reused for every flush
+    hd44780_bus_pio_dma = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config((uint)hd44780_bus_pio_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, hd44780_bus_pio_sm, true));
+    dma_channel_configure((uint)hd44780_bus_pio_dma, &c,
+            &pio->txf[hd44780_bus_pio_sm], hd44780_bus_pio_frames, 0, false);
+
+    dma_channel_set_irq0_enabled((uint)hd44780_bus_pio_dma, true);
+    irq_add_shared_handler(HD44780_BUS_PIO_DMA_IRQ, hd44780_bus_pio_dma_handler,
+            PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(HD44780_BUS_PIO_DMA_IRQ, true);
+}
+
+void hd44780_bus_pio_push(const uint32_t frame) {
+    if(hd44780_bus_pio_pending == HD44780_BUS_PIO_QUEUE_LEN) {
+        hd44780_bus_pio_flush();
+    }
+    hd44780_bus_pio_frames[hd44780_bus_pio_pending++] = frame;
+}
+
+void hd44780_bus_pio_flush(void) {
+    if(hd44780_bus_pio_pending == 0) { return; }
+
+    // Clear any stale notification before arming the wait
+    ulTaskNotifyTakeIndexed(HD44780_BUS_NOTIFY_INDEX, pdTRUE, 0);
+    hd44780_bus_pio_waiter = xTaskGetCurrentTaskHandle();
+    dma_channel_transfer_from_buffer_now((uint)hd44780_bus_pio_dma,
+            hd44780_bus_pio_frames, (uint32_t)hd44780_bus_pio_pending);
+    // A give that lands between the check and the take is kept, the take
+    // then returns at once
+    while(dma_channel_is_busy((uint)hd44780_bus_pio_dma)) {
+        ulTaskNotifyTakeIndexed(HD44780_BUS_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+    }
+    // Every frame is in the FIFO and the buffer is free again. The state
+    // machine drains the last ones (8 at most) on its own, the next flush
+    // queues behind them through the DREQ
+    hd44780_bus_pio_pending = 0;
+}
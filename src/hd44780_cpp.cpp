@@ -0,0 +1,21 @@
+#include "hd44780_cpp.h"
+#include "hd44780.hpp"
+
+namespace {
+// RS 10, RW 9, E 11, D4..D7 on 5..8: the wiring of hd44780.c
+using board_lcd = hd44780::driver<hd44780::pins<10, 9, 11, 5, 6, 7, 8>,
+                                  hd44780::geometry<16, 4>>;
+static_assert(board_lcd::pins_type::contiguous, "board data pins are consecutive");
+}
+
+hd44780_fb hd44780_cpp_shadow;
+
+void hd44780_cpp_init(TickType_t *xNextWakeTime) {
+    board_lcd::init_pins();
+    board_lcd::reset(xNextWakeTime);
+    board_lcd::init_shadow(&hd44780_cpp_shadow);
+}
+
+void hd44780_cpp_flush(const char *frame, const size_t stride) {
+    board_lcd::flush(&hd44780_cpp_shadow, frame, stride);
+}
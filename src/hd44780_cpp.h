@@ -0,0 +1,27 @@
+#ifndef HD44780_CPP_H
+#define HD44780_CPP_H
+/*
+ * C entry points of the board instance of the C++ driver (hd44780.hpp),
+ * same wiring and geometry as hd44780.c driven over GPIO.
+ */
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "hd44780_fb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Pins, shadow and reset sequence, blocks for the power on delays
+void hd44780_cpp_init(TickType_t *xNextWakeTime);
+// Send the cells of `frame` (hd44780_fb_flush layout) that differ
+void hd44780_cpp_flush(const char *frame, const size_t stride);
+
+// What the controller holds
+extern hd44780_fb hd44780_cpp_shadow;
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,115 @@
+#include "hd44780_fb.h"
+
+void hd44780_fb_init(hd44780_fb *fb, const int rows, const int cols, const int *line_start) {
+    fb->rows = rows;
+    fb->cols = cols;
+    fb->line_start = line_start;
+    fb->shift = 0;
+    fb->stats = (hd44780_fb_stats){ 0 };
+    hd44780_fb_invalidate(fb);
+}
+
+void hd44780_fb_invalidate(hd44780_fb *fb) {
+    for(int i=0; i<HD44780_FB_DDRAM_SIZE; i++) {
+        fb->shadow[i] = HD44780_FB_UNKNOWN;
+    }
+    fb->cursor = -1;
+}
+
+void hd44780_fb_cleared(hd44780_fb *fb) {
+    for(int i=0; i<HD44780_FB_DDRAM_SIZE; i++) {
+        fb->shadow[i] = ' ';
+    }
+    // Clear leaves the address counter at 0, but callers usually move it
+    fb->cursor = -1;
+    fb->shift = 0;
+}
+
+int hd44780_fb_next_address(const int address) {
+    if(address == 0x27) { return 0x40; }
+    if(address == 0x67) { return 0x00; }
+    return address + 1;
+}
+
+int hd44780_fb_cell_address(const hd44780_fb *fb, const int row, const int col) {
+    const int start = fb->line_start[row];
+    const int base = start & 0x40;
+    return base + (start - base + col + fb->shift) % HD44780_FB_LINE_CELLS;
+}
+
+void hd44780_fb_shifted(hd44780_fb *fb, const int cells) {
+    fb->shift = ((fb->shift + cells) % HD44780_FB_LINE_CELLS + HD44780_FB_LINE_CELLS) % HD44780_FB_LINE_CELLS;
+}
+
+static int valid_address(const int address) {
+    return (address >= 0x00 && address <= 0x27) || (address >= 0x40 && address <= 0x67);
+}
+
+// Can the cells between the cursor and `address` be rewritten with what
+// they already hold instead of moving the address counter
+static int can_bridge(const hd44780_fb *fb, const int address) {
+    const int gap = address - fb->cursor;
+    if(fb->cursor < 0 || gap <= 0 || gap > HD44780_FB_MAX_BRIDGE) { return 0; }
+    for(int a=fb->cursor; a<address; a++) {
+        if(!valid_address(a) || fb->shadow[a] == HD44780_FB_UNKNOWN) { return 0; }
+    }
+    return 1;
+}
+
+static void put(hd44780_fb *fb, const hd44780_fb_sink *sink, const int address, const int c) {
+    sink->write(sink->ctx, c);
+    fb->stats.data_bytes++;
+    fb->shadow[address] = (uint16_t)c;
+    fb->cursor = hd44780_fb_next_address(address);
+}
+
+void hd44780_fb_flush(hd44780_fb *fb, const char *frame, const size_t stride, const hd44780_fb_sink *sink) {
+    int16_t want[HD44780_FB_DDRAM_SIZE];
+    for(int i=0; i<HD44780_FB_DDRAM_SIZE; i++) { want[i] = -1; }
+
+    // Lay the frame out in DDRAM address space
+    for(int r=0; r<fb->rows; r++) {
+        const char *row = frame + (size_t)r * stride;
+        int end = 0;
+        for(int c=0; c<fb->cols && c<HD44780_FB_LINE_CELLS; c++) {
+            const int address = hd44780_fb_cell_address(fb, r, c);
+            if(!valid_address(address)) { break; }
+            if(!end && row[c] == '\0') { end = 1; }
+            want[address] = end ? ' ' : (int16_t)(uint8_t)row[c];
+        }
+    }
+
+    fb->stats.instructions = 0;
+    fb->stats.data_bytes = 0;
+    for(int a=0; a<HD44780_FB_DDRAM_SIZE; a++) {
+        if(want[a] < 0 || fb->shadow[a] == (uint16_t)want[a]) { continue; }
+        if(fb->cursor != a) {
+            if(can_bridge(fb, a)) {
+                while(fb->cursor != a) {
+                    put(fb, sink, fb->cursor, fb->shadow[fb->cursor]);
+                }
+            } else {
+                sink->set_address(sink->ctx, a);
+                fb->stats.instructions++;
+                fb->cursor = a;
+            }
+        }
+        put(fb, sink, a, want[a]);
+    }
+
+    fb->stats.flushes++;
+    fb->stats.total_instructions += fb->stats.instructions;
+    fb->stats.total_data_bytes += fb->stats.data_bytes;
+}
+
+void hd44780_fb_put(hd44780_fb *fb, const hd44780_fb_sink *sink, const int address, const int c) {
+    if(!valid_address(address) || fb->shadow[address] == (uint16_t)c) { return; }
+    if(fb->cursor != address) {
+        sink->set_address(sink->ctx, address);
+        fb->stats.total_instructions++;
+    }
+    sink->write(sink->ctx, c);
+    fb->stats.total_data_bytes++;
+    fb->shadow[address] = (uint16_t)c;
+    fb->cursor = hd44780_fb_next_address(address);
+}
@@ -0,0 +1,84 @@
+#ifndef HD44780_FB_H
+#define HD44780_FB_H
+/*
+ * Shadow of the HD44780 DDRAM and frame diffing.
+ *
+ * The shadow holds what the controller is known to contain, a flush compares
+ * it against the wanted frame and only emits the cells that changed. Changed
+ * cells are visited in DDRAM address order, so lines that are contiguous in
+ * DDRAM (L1 0x00-0x0F and L3 0x10-0x1F on 16x4 parts) are written in one
+ * burst with a single set DDRAM address instruction.
+ *
+ * Only the 2 line DDRAM layout is modeled (0x00-0x27 and 0x40-0x67). A
+ * display shift moves the window of every row along its 40 cell DDRAM line,
+ * `shift` keeps track of it so frames still land in the cells shown.
+ * Nothing in here touches hardware, output goes through hd44780_fb_sink.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HD44780_FB_DDRAM_SIZE         ( 0x68 )
+#define HD44780_FB_UNKNOWN            ( 0x100 )
+// Cells of one DDRAM line, the display shift wraps around at this
+#define HD44780_FB_LINE_CELLS         ( 40 )
+
+// Maximum number of unchanged cells rewritten to avoid a set DDRAM address.
+// A cell costs the same on the bus as the instruction, so 1 is a tie that
+// still saves an instruction.
+#define HD44780_FB_MAX_BRIDGE         1
+
+typedef struct {
+    void (*set_address)(void *ctx, const int address);
+    void (*write)(void *ctx, const int c);
+    void *ctx;
+} hd44780_fb_sink;
+
+typedef struct {
+    uint32_t flushes;
+    // Last flush
+    uint32_t instructions;
+    uint32_t data_bytes;
+    // Since init
+    uint32_t total_instructions;
+    uint32_t total_data_bytes;
+} hd44780_fb_stats;
+
+typedef struct {
+    int rows;
+    int cols;
+    const int *line_start;
+    // Address counter of the controller, -1 when unknown
+    int cursor;
+    // Cells the display is shifted left (0..HD44780_FB_LINE_CELLS-1)
+    int shift;
+    uint16_t shadow[HD44780_FB_DDRAM_SIZE];
+    hd44780_fb_stats stats;
+} hd44780_fb;
+
+void hd44780_fb_init(hd44780_fb *fb, const int rows, const int cols, const int *line_start);
+// Forget everything known about the controller, next flush rewrites it all
+void hd44780_fb_invalidate(hd44780_fb *fb);
+// The controller executed a clear display, DDRAM is filled with spaces
+void hd44780_fb_cleared(hd44780_fb *fb);
+// Next address the controller moves to after a write (increment mode)
+int hd44780_fb_next_address(const int address);
+// DDRAM address shown by cell `col` of row `row`, with the display shift
+int hd44780_fb_cell_address(const hd44780_fb *fb, const int row, const int col);
+// The controller shifted the display `cells` left (negative for right)
+void hd44780_fb_shifted(hd44780_fb *fb, const int cells);
+// Write one DDRAM cell outside of a flush, nothing is sent if it holds `c`
+void hd44780_fb_put(hd44780_fb *fb, const hd44780_fb_sink *sink, const int address, const int c);
+/*
+ * Bring the controller in line with `frame`, `rows` NUL terminated strings
+ * `stride` bytes apart. Cells past the end of a string are blank.
+ */
+void hd44780_fb_flush(hd44780_fb *fb, const char *frame, const size_t stride, const hd44780_fb_sink *sink);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
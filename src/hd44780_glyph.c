@@ -0,0 +1,180 @@
+#include "hd44780_glyph.h"
+
+#define ARRAY_SIZE(a) (sizeof(a)/sizeof(a[0]))
+
+#define HD44780_GLYPH_CGRAM_BYTES     ( HD44780_GLYPH_ROWS )
+
+// Code points with a character in the A00 (Japanese) ROM
+typedef struct {
+    uint32_t code;
+    uint8_t rom;
+} rom_char;
+
+static const rom_char rom_chars[] = {
+    { 0x00A5, 0x5C }, // yen sign, where ASCII has the backslash
+    { 0x00B0, 0xDF }, // degree sign
+    { 0x00B5, 0xE4 }, // micro sign
+    { 0x00DF, 0xE2 }, // sharp s
+    { 0x00E4, 0xE1 }, // a with diaeresis
+    { 0x00F1, 0xEE }, // n with tilde
+    { 0x00F6, 0xEF }, // o with diaeresis
+    { 0x00FC, 0xF5 }, // u with diaeresis
+    { 0x2190, 0x7F }, // leftwards arrow
+    { 0x2192, 0x7E }, // rightwards arrow, where ASCII has the tilde
+};
+
+// ASCII the ROM replaced and Spanish letters missing from it
+static const hd44780_glyph glyphs[] = {
+    { 0x005C, { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00 }, '?' }, // backslash
+    { 0x007E, { 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00 }, '-' }, // tilde
+    { 0x00A1, { 0x04, 0x00, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00 }, '!' }, // inverted exclamation
+    { 0x00BF, { 0x04, 0x00, 0x04, 0x08, 0x10, 0x11, 0x0E, 0x00 }, '?' }, // inverted question
+    { 0x00C1, { 0x02, 0x04, 0x0E, 0x11, 0x1F, 0x11, 0x11, 0x00 }, 'A' },
+    { 0x00C9, { 0x02, 0x04, 0x1F, 0x10, 0x1E, 0x10, 0x1F, 0x00 }, 'E' },
+    { 0x00CD, { 0x02, 0x04, 0x0E, 0x04, 0x04, 0x04, 0x0E, 0x00 }, 'I' },
+    { 0x00D1, { 0x0D, 0x12, 0x00, 0x11, 0x19, 0x15, 0x13, 0x00 }, 'N' },
+    { 0x00D3, { 0x02, 0x04, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00 }, 'O' },
+    { 0x00DA, { 0x02, 0x04, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00 }, 'U' },
+    { 0x00DC, { 0x0A, 0x00, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00 }, 'U' },
+    { 0x00E1, { 0x02, 0x04, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00 }, 'a' },
+    { 0x00E9, { 0x02, 0x04, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00 }, 'e' },
+    { 0x00ED, { 0x02, 0x04, 0x0C, 0x04, 0x04, 0x04, 0x0E, 0x00 }, 'i' },
+    { 0x00F3, { 0x02, 0x04, 0x00, 0x0E, 0x11, 0x11, 0x0E, 0x00 }, 'o' },
+    { 0x00FA, { 0x02, 0x04, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x00 }, 'u' },
+};
+
+void hd44780_glyph_init(hd44780_glyph_cache *cache, hd44780_fb *fb, const hd44780_glyph_sink *sink) {
+    cache->fb = fb;
+    cache->sink = sink;
+    cache->stats = (hd44780_glyph_stats){ 0 };
+    hd44780_glyph_invalidate(cache);
+}
+
+void hd44780_glyph_invalidate(hd44780_glyph_cache *cache) {
+    for(int i=0; i<HD44780_GLYPH_SLOTS; i++) {
+        cache->code[i] = 0;
+        cache->last_use[i] = 0;
+    }
+    cache->clock = 0;
+    cache->pinned = 0;
+}
+
+// Slot shown by a character code, -1 for ROM characters
+static int slot_of(const int c) {
+    // 0..7 and 8..15 both show CGRAM
+    return (c >= 0 && c < 2 * HD44780_GLYPH_SLOTS) ? (c & (HD44780_GLYPH_SLOTS - 1)) : -1;
+}
+
+void hd44780_glyph_sync(hd44780_glyph_cache *cache) {
+    cache->pinned = 0;
+    for(int a=0; a<HD44780_FB_DDRAM_SIZE; a++) {
+        const uint16_t c = cache->fb->shadow[a];
+        // Unknown cells could show anything, keep them from pinning all
+        if(c == HD44780_FB_UNKNOWN) { continue; }
+        const int slot = slot_of(c);
+        if(slot >= 0) { cache->pinned |= (uint8_t)(1u << slot); }
+    }
+}
+
+static void upload(hd44780_glyph_cache *cache, const int slot, const hd44780_glyph *glyph) {
+    const hd44780_glyph_sink *sink = cache->sink;
+    sink->set_cgram_address(sink->ctx, slot * HD44780_GLYPH_CGRAM_BYTES);
+    for(int r=0; r<HD44780_GLYPH_ROWS; r++) {
+        sink->write(sink->ctx, glyph->rows[r] & 0x1F);
+    }
+    // The address counter now points into CGRAM
+    cache->fb->cursor = -1;
+    cache->stats.uploads++;
+}
+
+// Free slot, else the least recently used one that is not pinned
+static int victim(const hd44780_glyph_cache *cache) {
+    int best = -1;
+    for(int i=0; i<HD44780_GLYPH_SLOTS; i++) {
+        if(cache->code[i] == 0) { return i; }
+        if(cache->pinned & (1u << i)) { continue; }
+        if(best < 0 || cache->last_use[i] < cache->last_use[best]) { best = i; }
+    }
+    return best;
+}
+
+char hd44780_glyph_get(hd44780_glyph_cache *cache, const hd44780_glyph *glyph) {
+    cache->stats.lookups++;
+    cache->clock++;
+
+    int slot = -1;
+    for(int i=0; i<HD44780_GLYPH_SLOTS; i++) {
+        if(cache->code[i] == glyph->code) { slot = i; break; }
+    }
+    if(slot >= 0) {
+        cache->stats.hits++;
+    } else {
+        slot = victim(cache);
+        if(slot < 0) {
+            cache->stats.fallbacks++;
+            return glyph->fallback;
+        }
+        if(cache->code[slot] != 0) { cache->stats.evictions++; }
+        cache->code[slot] = glyph->code;
+        upload(cache, slot, glyph);
+    }
+    cache->last_use[slot] = cache->clock;
+    cache->pinned |= (uint8_t)(1u << slot);
+    return (char)(HD44780_GLYPH_CHAR_BASE + slot);
+}
+
+const hd44780_glyph *hd44780_glyph_find(const uint32_t code) {
+    for(size_t i=0; i<ARRAY_SIZE(glyphs); i++) {
+        if(glyphs[i].code == code) { return &glyphs[i]; }
+    }
+    return NULL;
+}
+
+static int rom_find(const uint32_t code) {
+    for(size_t i=0; i<ARRAY_SIZE(rom_chars); i++) {
+        if(rom_chars[i].code == code) { return rom_chars[i].rom; }
+    }
+    return -1;
+}
+
+// Next code point of `*s`, advancing it. Malformed sequences give U+FFFD
+// and skip one byte.
+static uint32_t utf8_next(const char **s) {
+    const uint8_t *p = (const uint8_t *)*s;
+    uint32_t code;
+    int extra;
+    if(p[0] < 0x80) { code = p[0]; extra = 0; }
+    else if((p[0] & 0xE0) == 0xC0) { code = p[0] & 0x1F; extra = 1; }
+    else if((p[0] & 0xF0) == 0xE0) { code = p[0] & 0x0F; extra = 2; }
+    else if((p[0] & 0xF8) == 0xF0) { code = p[0] & 0x07; extra = 3; }
+    else { *s += 1; return 0xFFFD; }
+    for(int i=1; i<=extra; i++) {
+        if((p[i] & 0xC0) != 0x80) { *s += 1; return 0xFFFD; }
+        code = code << 6 | (p[i] & 0x3F);
+    }
+    *s += 1 + extra;
+    return code;
+}
+
+size_t hd44780_glyph_utf8(hd44780_glyph_cache *cache, const char *utf8, char *out, const size_t size) {
+    size_t n = 0;
+    if(size == 0) { return 0; }
+    while(*utf8 != '\0' && n + 1 < size) {
+        const uint32_t code = utf8_next(&utf8);
+        // Printable ASCII is in ROM but for \ and ~, control characters
+        // would hit CGRAM
+        if(code >= 0x20 && code < 0x7F && code != 0x5C && code != 0x7E) {
+            out[n++] = (char)code;
+            continue;
+        }
+        const int rom = rom_find(code);
+        if(rom >= 0) {
+            out[n++] = (char)rom;
+            continue;
+        }
+        const hd44780_glyph *glyph = hd44780_glyph_find(code);
+        out[n++] = glyph ? hd44780_glyph_get(cache, glyph) : '?';
+    }
+    out[n] = '\0';
+    return n;
+}
@@ -0,0 +1,104 @@
+#ifndef HD44780_GLYPH_H
+#define HD44780_GLYPH_H
+/*
+ * Custom glyphs in the 8 CGRAM slots of the HD44780.
+ *
+ * Glyphs are requested by code: a Unicode code point for text, or
+ * HD44780_GLYPH_USER(n) for application glyphs (bar graphs, big digits). A
+ * glyph is only uploaded when it is not resident already, a new one takes a
+ * free slot or the least recently used one. Slots the controller is showing
+ * are never evicted: overwriting CGRAM changes every cell that shows it at
+ * once. When all 8 are pinned the request falls back to a ROM character.
+ *
+ * Slot n is written into frames as character code 8 + n (the controller
+ * mirrors CGRAM 0..7 at 8..15), so frames stay NUL terminated strings.
+ *
+ * Text goes through hd44780_glyph_utf8(): ASCII is unchanged, code points
+ * the A00 ROM has (n with tilde, umlauts, degree sign) map onto it, the
+ * Spanish accented letters and inverted marks come from the built in glyph
+ * table, anything else becomes '?'. The A00 ROM shows a yen sign at 0x5C and
+ * an arrow at 0x7E, so '\' and '~' are glyphs too, and U+00A5 and U+2192
+ * map onto those codes.
+ *
+ *   hd44780_glyph_init(&glyphs, &shadow, &sink);
+ *   hd44780_glyph_utf8(&glyphs, "¿Qué tal?", line, sizeof(line));
+ *   ...flush the frame...
+ *   hd44780_glyph_sync(&glyphs);
+ *
+ * Like hd44780_fb nothing in here touches hardware, uploads go through
+ * hd44780_glyph_sink.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hd44780_fb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HD44780_GLYPH_SLOTS           ( 8 )
+#define HD44780_GLYPH_ROWS            ( 8 )
+// Character code of CGRAM slot 0 in a frame
+#define HD44780_GLYPH_CHAR_BASE       ( 0x08 )
+// Application glyphs live past the last Unicode code point
+#define HD44780_GLYPH_USER( n )       ( 0x110000u + ( uint32_t ) ( n ) )
+
+typedef struct {
+    uint32_t code;
+    // 5x8, row 0 on top, bit 4 is the leftmost dot
+    uint8_t rows[HD44780_GLYPH_ROWS];
+    // ROM character used when no slot can be freed
+    char fallback;
+} hd44780_glyph;
+
+typedef struct {
+    void (*set_cgram_address)(void *ctx, const int address);
+    void (*write)(void *ctx, const int c);
+    void *ctx;
+} hd44780_glyph_sink;
+
+typedef struct {
+    uint32_t lookups;
+    uint32_t hits;
+    uint32_t uploads;
+    uint32_t evictions;
+    // Every slot pinned, the fallback was used
+    uint32_t fallbacks;
+} hd44780_glyph_stats;
+
+typedef struct {
+    hd44780_fb *fb;
+    const hd44780_glyph_sink *sink;
+    // Resident glyph of every slot, 0 when free
+    uint32_t code[HD44780_GLYPH_SLOTS];
+    uint32_t last_use[HD44780_GLYPH_SLOTS];
+    uint32_t clock;
+    // Slots shown by the controller or used by the frame being built
+    uint8_t pinned;
+    hd44780_glyph_stats stats;
+} hd44780_glyph_cache;
+
+// `fb` is the shadow of the controller the glyphs are uploaded to
+void hd44780_glyph_init(hd44780_glyph_cache *cache, hd44780_fb *fb, const hd44780_glyph_sink *sink);
+// The controller lost its CGRAM (reset), every slot is free
+void hd44780_glyph_invalidate(hd44780_glyph_cache *cache);
+// A frame was flushed: from now on only what the controller shows is pinned
+void hd44780_glyph_sync(hd44780_glyph_cache *cache);
+
+// Character code showing `glyph`, uploading it if needed
+char hd44780_glyph_get(hd44780_glyph_cache *cache, const hd44780_glyph *glyph);
+/*
+ * Translate the UTF-8 string `utf8` into controller characters in `out`
+ * (at most `size` - 1 characters, always NUL terminated). Returns the number
+ * of characters written.
+ */
+size_t hd44780_glyph_utf8(hd44780_glyph_cache *cache, const char *utf8, char *out, const size_t size);
+
+// Built in glyph of a code point, NULL if there is none
+const hd44780_glyph *hd44780_glyph_find(const uint32_t code);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
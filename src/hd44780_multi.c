@@ -0,0 +1,187 @@
+#include "hd44780_multi.h"
+#include "hal.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define HD44780_MULTI_SETUP_NS        40 // tAS, RS to E high
+#define HD44780_MULTI_E_PULSE_US      1 // PWEH >= 450ns, tcycE >= 1000ns
+#define HD44780_MULTI_EXEC_US         80 // 37us per instruction, with margin
+#define HD44780_MULTI_POWERON_MS      ( 100 / portTICK_PERIOD_MS )
+#define HD44780_MULTI_CLEAR_MS        ( 10 / portTICK_PERIOD_MS )
+// Transfer carries data, RS high
+#define HD44780_MULTI_DATA            0x100
+
+#define HD44780_INST_CLEAR_DISPLAY    0x01
+#define HD44780_INST_ENTRY_MODE_SET   0x04
+#define HD44780_INST_DISPLAY_CONTROL  0x08
+#define HD44780_INST_FUNCTION_SET     0x20
+#define HD44780_INST_SET_DDRAM        0x80
+
+void hd44780_multi_init(hd44780_multi *m, const int data[4], const int rw, const int rs) {
+    m->pin_rw = rw;
+    m->pin_rs = rs;
+    m->data_mask = 0;
+    for(int i=0; i<4; i++) {
+        m->data_mask |= 1u << data[i];
+    }
+    // The pins may be wired in any order, resolve them once
+    for(int v=0; v<16; v++) {
+        m->nibble[v] = 0;
+        for(int i=0; i<4; i++) {
+            if(v & (1 << i)) { m->nibble[v] |= 1u << data[i]; }
+        }
+    }
+    m->rs_mask = 1u << rs;
+    m->e_mask = 0;
+    m->exec_us = HD44780_MULTI_EXEC_US;
+    m->interleave = true;
+    m->count = 0;
+    m->stats = (hd44780_multi_stats){ 0 };
+}
+
+bool hd44780_multi_add(hd44780_multi *m, hd44780_display *d, const int pin_e, const int rows, const int cols) {
+    if(m->count >= HD44780_MULTI_MAX_DISPLAYS) { return false; }
+    if(rows != 1 && rows != 2 && rows != 4) { return false; }
+    // Lines 3 and 4 continue lines 1 and 2 in the same 40 cell DDRAM line
+    if(cols <= 0 || cols * (rows == 4 ? 2 : 1) > HD44780_MULTI_MAX_COLS) { return false; }
+
+    d->pin_e = pin_e;
+    d->rows = rows;
+    d->cols = cols;
+    for(int r=0; r<rows; r++) {
+        d->line_start[r] = (r & 0x01) * 0x40 + (r >> 1) * cols;
+        d->frame[r][0] = '\0';
+    }
+    hd44780_fb_init(&d->fb, rows, cols, d->line_start);
+    d->transfer_count = 0;
+    d->transfer_next = 0;
+    d->ready_at = 0;
+
+    m->displays[m->count++] = d;
+    m->e_mask |= 1u << pin_e;
+    return true;
+}
+
+// One E cycle on every display of `e`: RS and data with E low, E high
+// tAS later
+static void strobe(const hd44780_multi *m, const uint32_t e, const int rs, const int nibble) {
+    hal_gpio_put_masked(m->data_mask | m->rs_mask | e,
+                        m->nibble[nibble] | (rs ? m->rs_mask : 0));
+    hal_busy_wait_ns(HD44780_MULTI_SETUP_NS);
+    hal_gpio_set_mask(e);
+    hal_busy_wait_us(HD44780_MULTI_E_PULSE_US);
+    hal_gpio_clr_mask(e);
+}
+
+// High then low nibble, the controller executes after the low one
+static void send(const hd44780_multi *m, const uint32_t e, const int transfer) {
+    const int rs = transfer & HD44780_MULTI_DATA;
+    strobe(m, e, rs, (transfer >> 4) & 0x0F);
+    hal_busy_wait_us(HD44780_MULTI_E_PULSE_US);
+    strobe(m, e, rs, transfer & 0x0F);
+}
+
+void hd44780_multi_reset(hd44780_multi *m, TickType_t *xNextWakeTime) {
+    const uint32_t pins = m->data_mask | m->rs_mask | (1u << m->pin_rw) | m->e_mask;
+    hal_gpio_init_mask(pins);
+    hal_gpio_set_dir_out_masked(pins);
+    hal_gpio_clr_mask(pins);
+
+    vTaskDelayUntil( xNextWakeTime, HD44780_MULTI_POWERON_MS );
+    // Still in 8 bit mode: one E cycle switches every display to 4 bit
+    strobe(m, m->e_mask, 0, (HD44780_INST_FUNCTION_SET >> 4) & 0x0F);
+    vTaskDelayUntil( xNextWakeTime, HD44780_MULTI_CLEAR_MS );
+    // The line count differs per display
+    for(int i=0; i<m->count; i++) {
+        const hd44780_display *d = m->displays[i];
+        send(m, 1u << d->pin_e, HD44780_INST_FUNCTION_SET | (d->rows > 1 ? 0x08 : 0x00));
+    }
+    vTaskDelayUntil( xNextWakeTime, HD44780_MULTI_CLEAR_MS );
+    send(m, m->e_mask, HD44780_INST_CLEAR_DISPLAY);
+    vTaskDelayUntil( xNextWakeTime, HD44780_MULTI_CLEAR_MS );
+    // Display on, cursor off, increment
+    send(m, m->e_mask, HD44780_INST_DISPLAY_CONTROL | 0x04);
+    hal_busy_wait_us(m->exec_us);
+    send(m, m->e_mask, HD44780_INST_ENTRY_MODE_SET | 0x02);
+
+    const uint64_t ready = hal_time_us() + m->exec_us;
+    for(int i=0; i<m->count; i++) {
+        m->displays[i]->ready_at = ready;
+        hd44780_fb_cleared(&m->displays[i]->fb);
+    }
+}
+
+void hd44780_display_set_line(hd44780_display *d, const int line, const char *str) {
+    if(line < 0 || line >= d->rows) { return; }
+    char *ddl = d->frame[line];
+    int i;
+    for(i=0; i<d->cols && str[i] != '\0'; i++) {
+        ddl[i] = str[i];
+    }
+    ddl[i] = '\0';
+}
+
+static void queue_address(void *ctx, const int address) {
+    hd44780_display *d = ctx;
+    d->transfers[d->transfer_count++] = (uint16_t)(HD44780_INST_SET_DDRAM | (address & 0x7F));
+}
+
+static void queue_write(void *ctx, const int c) {
+    hd44780_display *d = ctx;
+    d->transfers[d->transfer_count++] = (uint16_t)(HD44780_MULTI_DATA | (c & 0xFF));
+}
+
+// Display with work left whose controller is idle, starting the search at
+// `*next` so every display gets its turn. Without interleaving only the
+// first display with work left is considered.
+static hd44780_display *pick(hd44780_multi *m, int *next, const uint64_t now, uint64_t *earliest) {
+    const int start = m->interleave ? *next : 0;
+    *earliest = UINT64_MAX;
+    for(int i=0; i<m->count; i++) {
+        const int k = (start + i) % m->count;
+        hd44780_display *d = m->displays[k];
+        if(d->transfer_next == d->transfer_count) { continue; }
+        if(d->ready_at <= now) {
+            *next = k + 1;
+            return d;
+        }
+        if(d->ready_at < *earliest) { *earliest = d->ready_at; }
+        if(!m->interleave) { break; }
+    }
+    return NULL;
+}
+
+void hd44780_multi_render(hd44780_multi *m) {
+    for(int i=0; i<m->count; i++) {
+        hd44780_display *d = m->displays[i];
+        const hd44780_fb_sink sink = {
+            .set_address = queue_address,
+            .write = queue_write,
+            .ctx = d,
+        };
+        d->transfer_count = 0;
+        d->transfer_next = 0;
+        hd44780_fb_flush(&d->fb, &d->frame[0][0], sizeof(d->frame[0]), &sink);
+    }
+
+    int next = 0;
+    for( ;; ) {
+        uint64_t earliest;
+        const uint64_t now = hal_time_us();
+        hd44780_display *d = pick(m, &next, now, &earliest);
+        if(d == NULL) {
+            // Nothing left at all, or every display with work is busy
+            if(earliest == UINT64_MAX) { break; }
+            m->stats.waits++;
+            m->stats.wait_us += earliest - now;
+            hal_busy_wait_us((uint32_t)(earliest - now));
+            continue;
+        }
+        send(m, 1u << d->pin_e, d->transfers[d->transfer_next++]);
+        d->ready_at = hal_time_us() + m->exec_us;
+        m->stats.transfers++;
+    }
+    m->stats.renders++;
+}
@@ -0,0 +1,89 @@
+#ifndef HD44780_MULTI_H
+#define HD44780_MULTI_H
+/*
+ * Several HD44780 displays on one GPIO bus.
+ *
+ * Every display shares D4..D7, RS and RW and has an E pin of its own, so a
+ * transfer only reaches the controller whose E is strobed. Each display has
+ * its own geometry (16x2, 20x4, 40x2, ...), frame and DDRAM shadow.
+ *
+ * A render diffs every frame into a list of transfers per display and then
+ * sends them interleaved: while one controller executes (37us, 80us with
+ * margin) the bus carries the next transfer of another one, so the bus only
+ * waits when every display with work left is busy. With interleave off the
+ * displays are written one after the other with the fixed delay, like the
+ * single display driver of hd44780.c.
+ *
+ *   hd44780_multi_init(&bus, data, 9, 10);
+ *   hd44780_multi_add(&bus, &status, 11, 2, 16);
+ *   hd44780_multi_add(&bus, &menu, 13, 4, 20);
+ *   hd44780_multi_reset(&bus, &xNextWakeTime);
+ *   hd44780_display_set_line(&menu, 0, "Ready");
+ *   hd44780_multi_render(&bus);
+ *
+ * All displays of a bus are rendered from one task.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "hd44780_fb.h"
+
+#define HD44780_MULTI_MAX_DISPLAYS    ( 4 )
+#define HD44780_MULTI_MAX_ROWS        ( 4 )
+#define HD44780_MULTI_MAX_COLS        ( 40 )
+// Worst case of a flush: every cell behind its own set DDRAM address
+#define HD44780_MULTI_MAX_TRANSFERS   ( 2 * HD44780_FB_DDRAM_SIZE )
+
+typedef struct {
+    int pin_e;
+    int rows;
+    int cols;
+    int line_start[HD44780_MULTI_MAX_ROWS];
+    char frame[HD44780_MULTI_MAX_ROWS][HD44780_MULTI_MAX_COLS + 1];
+    hd44780_fb fb;
+
+    // Transfers of the running render, bit 8 set for data (RS high)
+    uint16_t transfers[HD44780_MULTI_MAX_TRANSFERS];
+    int transfer_count;
+    int transfer_next;
+    // Controller done with the last transfer, hal_time_us()
+    uint64_t ready_at;
+} hd44780_display;
+
+typedef struct {
+    uint32_t renders;
+    uint32_t transfers;
+    // Bus idle because every display with work left was busy
+    uint32_t waits;
+    uint64_t wait_us;
+} hd44780_multi_stats;
+
+typedef struct {
+    int pin_rw;
+    int pin_rs;
+    uint32_t data_mask;
+    uint32_t rs_mask;
+    uint32_t e_mask;              // Every E pin
+    uint32_t nibble[16];          // GPIO levels of every nibble
+    uint32_t exec_us;
+    bool interleave;
+    hd44780_display *displays[HD44780_MULTI_MAX_DISPLAYS];
+    int count;
+    hd44780_multi_stats stats;
+} hd44780_multi;
+
+// `data` holds the GPIOs of D4..D7, interleaving is on
+void hd44780_multi_init(hd44780_multi *m, const int data[4], const int rw, const int rs);
+// Add a display strobed by `pin_e`, false if the geometry is not supported
+// or the bus is full
+bool hd44780_multi_add(hd44780_multi *m, hd44780_display *d, const int pin_e, const int rows, const int cols);
+// Reset sequence of every display at once (all E pins strobed together),
+// blocks for the power on delays
+void hd44780_multi_reset(hd44780_multi *m, TickType_t *xNextWakeTime);
+
+// Copy `str` into the frame of `d` (truncated to the row length)
+void hd44780_display_set_line(hd44780_display *d, const int line, const char *str);
+// Send the cells of every frame that differ from its controller
+void hd44780_multi_render(hd44780_multi *m);
+#endif
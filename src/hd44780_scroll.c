@@ -0,0 +1,130 @@
+#include "hd44780_scroll.h"
+
+#include <string.h>
+
+void hd44780_scroll_init(hd44780_scroll *s, hd44780_fb *fb, const hd44780_scroll_sink *sink) {
+    s->fb = fb;
+    s->sink = sink;
+    for(int r=0; r<HD44780_SCROLL_MAX_ROWS; r++) {
+        s->lines[r] = (hd44780_scroll_line){ NULL, 0, 0 };
+    }
+    s->mode = HD44780_SCROLL_OFF;
+    s->dirty = false;
+    s->offset = 0;
+    s->stats = (hd44780_scroll_stats){ 0 };
+}
+
+void hd44780_scroll_set(hd44780_scroll *s, const int row, const char *text) {
+    if(row < 0 || row >= HD44780_SCROLL_MAX_ROWS) { return; }
+    s->lines[row].text = text;
+    s->lines[row].length = text ? (int)strlen(text) : 0;
+    s->lines[row].pos = 0;
+    s->dirty = true;
+}
+
+static int rows_of(const hd44780_scroll *s) {
+    return s->fb->rows < HD44780_SCROLL_MAX_ROWS ? s->fb->rows : HD44780_SCROLL_MAX_ROWS;
+}
+
+// Every row scrolls, owns its DDRAM line and fits in it
+static bool hardware_usable(const hd44780_scroll *s) {
+    int used = 0;
+    for(int r=0; r<rows_of(s); r++) {
+        const hd44780_scroll_line *line = &s->lines[r];
+        if(line->text == NULL || line->length > HD44780_FB_LINE_CELLS) { return false; }
+        const int ddram_line = (s->fb->line_start[r] & 0x40) ? 0x02 : 0x01;
+        if(used & ddram_line) { return false; }
+        used |= ddram_line;
+    }
+    return s->fb->rows > 0;
+}
+
+// Cell `i` of the 40 cell hardware ring of a row
+static char ring_at(const hd44780_scroll_line *line, const int i) {
+    return i < line->length ? line->text[i] : ' ';
+}
+
+// Cell `i` of the software loop, the text and HD44780_SCROLL_GAP blanks
+static char loop_at(const hd44780_scroll_line *line, const int i) {
+    const int j = i % (line->length + HD44780_SCROLL_GAP);
+    return j < line->length ? line->text[j] : ' ';
+}
+
+static void load(hd44780_scroll *s) {
+    // Ring cell i goes where column i is shown now, the shift moves it left
+    for(int r=0; r<rows_of(s); r++) {
+        for(int i=0; i<HD44780_FB_LINE_CELLS; i++) {
+            hd44780_fb_put(s->fb, s->sink->fb, hd44780_fb_cell_address(s->fb, r, i), ring_at(&s->lines[r], i));
+        }
+    }
+    s->offset = 0;
+    s->stats.loads++;
+}
+
+static void plan(hd44780_scroll *s) {
+    s->dirty = false;
+    int scrolling = 0;
+    for(int r=0; r<rows_of(s); r++) {
+        if(s->lines[r].text != NULL) { scrolling++; }
+    }
+    if(scrolling == 0) {
+        s->mode = HD44780_SCROLL_OFF;
+    } else if(hardware_usable(s)) {
+        s->mode = HD44780_SCROLL_HARDWARE;
+        load(s);
+    } else {
+        s->mode = HD44780_SCROLL_SOFTWARE;
+    }
+}
+
+hd44780_scroll_mode hd44780_scroll_mode_of(hd44780_scroll *s) {
+    if(s->dirty) { plan(s); }
+    return s->mode;
+}
+
+static void draw(const hd44780_scroll *s, char *frame, const size_t stride) {
+    const int cols = s->fb->cols < HD44780_FB_LINE_CELLS ? s->fb->cols : HD44780_FB_LINE_CELLS;
+    for(int r=0; r<rows_of(s); r++) {
+        const hd44780_scroll_line *line = &s->lines[r];
+        if(line->text == NULL) { continue; }
+        char *row = frame + (size_t)r * stride;
+        for(int c=0; c<cols; c++) {
+            if(s->mode == HD44780_SCROLL_HARDWARE) {
+                row[c] = ring_at(line, (c + s->offset) % HD44780_FB_LINE_CELLS);
+            } else if(line->length <= cols) {
+                row[c] = c < line->length ? line->text[c] : ' ';
+            } else {
+                row[c] = loop_at(line, line->pos + c);
+            }
+        }
+        row[cols] = '\0';
+    }
+}
+
+void hd44780_scroll_step(hd44780_scroll *s, char *frame, const size_t stride) {
+    if(s->dirty) {
+        plan(s);
+        draw(s, frame, stride);
+        return;
+    }
+
+    if(s->mode == HD44780_SCROLL_HARDWARE) {
+        s->sink->shift_display(s->sink->ctx, 1);
+        hd44780_fb_shifted(s->fb, 1);
+        s->offset = (s->offset + 1) % HD44780_FB_LINE_CELLS;
+        s->stats.shift_instructions++;
+        s->stats.hardware_steps++;
+    } else if(s->mode == HD44780_SCROLL_SOFTWARE) {
+        for(int r=0; r<rows_of(s); r++) {
+            hd44780_scroll_line *line = &s->lines[r];
+            // Text that fits the row stays where it is
+            if(line->text == NULL || line->length <= s->fb->cols) { continue; }
+            line->pos = (line->pos + 1) % (line->length + HD44780_SCROLL_GAP);
+        }
+        s->stats.software_steps++;
+    } else {
+        return;
+    }
+    s->stats.steps++;
+    draw(s, frame, stride);
+}
@@ -0,0 +1,102 @@
+#ifndef HD44780_SCROLL_H
+#define HD44780_SCROLL_H
+/*
+ * Marquee text longer than a row.
+ *
+ * Every DDRAM line holds 40 cells, a row only shows a window of them. When
+ * every row of the display scrolls, each has a DDRAM line of its own (16x2,
+ * 20x2, 40x2 parts) and each text fits in 40 cells, the texts are loaded
+ * into DDRAM once and every step is a single display shift instruction: the
+ * controller moves all windows and wraps them around the 40 cells.
+ *
+ * Otherwise the shift would drag along rows that must stay put (on 16x4
+ * parts rows 1 and 3 are two windows of the same DDRAM line), so the rows
+ * that do not fit scroll in software: every step stores the new window into
+ * the frame and the hd44780_fb flush rewrites the cells that changed.
+ *
+ *   hd44780_scroll_init(&scroll, &shadow, &sink);
+ *   hd44780_scroll_set(&scroll, 0, "Temperatura exterior 21.5 C, humedad 40%");
+ *   for( ;; ) {
+ *       hd44780_scroll_step(&scroll, &frame[0][0], ROWLEN);
+ *       ...flush the frame...
+ *   }
+ *
+ * Either way the frame always holds what the rows show, so flushing it after
+ * a hardware step sends nothing. Like hd44780_fb nothing in here touches
+ * hardware, output goes through hd44780_scroll_sink.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hd44780_fb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HD44780_SCROLL_MAX_ROWS       ( 4 )
+// Blank cells between the end of a software marquee and its start
+#define HD44780_SCROLL_GAP            ( 4 )
+
+typedef enum {
+    HD44780_SCROLL_OFF,
+    HD44780_SCROLL_HARDWARE,
+    HD44780_SCROLL_SOFTWARE,
+} hd44780_scroll_mode;
+
+typedef struct {
+    // DDRAM writes of the hardware load
+    const hd44780_fb_sink *fb;
+    // Shift every row one cell, to the left when `left`
+    void (*shift_display)(void *ctx, const int left);
+    void *ctx;
+} hd44780_scroll_sink;
+
+typedef struct {
+    uint32_t steps;
+    uint32_t hardware_steps;
+    uint32_t software_steps;
+    // Texts written into DDRAM for the hardware shift
+    uint32_t loads;
+    uint32_t shift_instructions;
+} hd44780_scroll_stats;
+
+typedef struct {
+    const char *text;             // NULL when the row does not scroll
+    int length;
+    int pos;                      // Software, first cell of the loop shown
+} hd44780_scroll_line;
+
+typedef struct {
+    hd44780_fb *fb;
+    const hd44780_scroll_sink *sink;
+    hd44780_scroll_line lines[HD44780_SCROLL_MAX_ROWS];
+    hd44780_scroll_mode mode;
+    // Texts changed, the next step picks the mode again
+    bool dirty;
+    // Hardware, steps since the texts were loaded
+    int offset;
+    hd44780_scroll_stats stats;
+} hd44780_scroll;
+
+// `fb` is the shadow of the controller, its geometry is used
+void hd44780_scroll_init(hd44780_scroll *s, hd44780_fb *fb, const hd44780_scroll_sink *sink);
+/*
+ * Scroll `text` on row `row`, NULL stops it (the row keeps what it shows).
+ * The text is not copied, it has to outlive the scrolling.
+ */
+void hd44780_scroll_set(hd44780_scroll *s, const int row, const char *text);
+/*
+ * Move every scrolling row one cell and store what the rows show into
+ * `frame` (rows `stride` bytes apart). The first step after a change only
+ * draws the texts, loading them into DDRAM for the hardware shift.
+ */
+void hd44780_scroll_step(hd44780_scroll *s, char *frame, const size_t stride);
+// Mode the current texts scroll in
+hd44780_scroll_mode hd44780_scroll_mode_of(hd44780_scroll *s);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,72 @@
+#include "board_host.h"
+#include "hal_host.h"
+#include "hd44780.h"
+#include "input.h"
+#include "tickless.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define boardHOST_RUN_TASK_PRIORITY   ( configMAX_PRIORITIES - 1 )
+#define boardLCD_ROWS                 4
+#define boardLCD_COLS                 16
+
+static hd44780_sim board_lcd;
+static mfrc522_sim board_rfid;
+
+hd44780_sim *board_host_lcd(void) {
+    return &board_lcd;
+}
+
+mfrc522_sim *board_host_rfid(void) {
+    return &board_rfid;
+}
+
+static uint32_t env_u32(const char *name, const uint32_t def) {
+    const char *v = getenv(name);
+    return v ? (uint32_t)strtoul(v, NULL, 0) : def;
+}
+
+static void prvHostRunTask( void *pvParameters )
+{
+    const TickType_t xRunTime = pdMS_TO_TICKS( ( uint32_t ) ( uintptr_t ) pvParameters );
+    tickless_stats xSleep;
+
+    vTaskDelay( xRunTime );
+    tickless_get_stats( &xSleep );
+    printf("host run finished: time_us=%llu busy_us=%llu led_toggles=%u\n",
+        (unsigned long long)hal_time_us(), (unsigned long long)hal_busy_us(),
+        hal_host_toggles(HAL_LED_PIN));
+    printf("tickless: sleeps=%lu asleep_us=%llu pended_ticks=%llu ticks=%llu\n",
+        (unsigned long)xSleep.sleeps, (unsigned long long)xSleep.asleep_us,
+        (unsigned long long)xSleep.pended_ticks, (unsigned long long)xSleep.ticks);
+    input_report();
+    hd44780_sim_dump(&board_lcd, boardLCD_ROWS, boardLCD_COLS);
+    fflush(stdout);
+    exit(board_lcd.stats.busy_violations ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+void hal_host_board_init(void) {
+    // The driver uses the top data lines on a 4 bit bus
+    int data[8] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+    for(int i=0; i<HD44780_PIN_COUNT; i++) {
+        data[8 - HD44780_PIN_COUNT + i] = HD44780_PINS_DATA[i];
+    }
+    hd44780_sim_timing timing = hd44780_sim_default_timing;
+    timing.exec_us = env_u32("HD44780_SIM_EXEC_US", timing.exec_us);
+    timing.clear_us = env_u32("HD44780_SIM_CLEAR_US", timing.clear_us);
+    timing.home_us = timing.clear_us;
+    hd44780_sim_init(&board_lcd, data, HD44780_PINS_RW, HD44780_PINS_RS, HD44780_PINS_E, &timing);
+    hd44780_sim_attach(&board_lcd);
+    mfrc522_sim_init(&board_rfid);
+
+    const uint32_t run_ms = env_u32("HOST_RUN_MS", 0);
+    if(run_ms) {
+        xTaskCreate( prvHostRunTask, "HOST", configMINIMAL_STACK_SIZE,
+                ( void * ) ( uintptr_t ) run_ms, boardHOST_RUN_TASK_PRIORITY, NULL );
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef BOARD_HOST_H
+#define BOARD_HOST_H
+/*
+ * Simulated board for the host build: the HD44780 wired as in hd44780.c and
+ * the MFRC522 behind the SPI backend of host/mfrc522_spi_host.c, with no
+ * card in the field until a test script adds some.
+ *
+ * Environment:
+ * - HOST_RUN_MS          : stop after that many ms and dump the display
+ * - HD44780_SIM_EXEC_US  : execution time of most instructions (37)
+ * - HD44780_SIM_CLEAR_US : execution time of clear/home (1520)
+ * - INPUT_SCRIPT         : edges for the input pins (host/input_host.c)
+ */
+#include "hd44780_sim.h"
+#include "mfrc522_sim.h"
+
+hd44780_sim *board_host_lcd(void);
+mfrc522_sim *board_host_rfid(void);
+#endif
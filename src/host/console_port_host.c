@@ -0,0 +1,51 @@
+/*
+ * Input backend of console.h for the host build: a plain thread, outside
+ * the kernel, blocks in read() on stdin and pushes what it gets into the
+ * ring. It cannot notify a FreeRTOS task, the console task finds the bytes
+ * on its CONSOLE_POLL_MS poll. When the ring is full the thread waits, the
+ * pipe holds the writer back like USB does on target.
+ *
+ *   printf 'line 0 Hola\nshow\nquit\n' | ./main_blinky_host
+ */
+#include "console.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+#define CONSOLE_PORT_HOST_RETRY_US    ( 1000 )
+
+static void *reader(void *arg) {
+    uint8_t chunk[256];
+
+    ( void ) arg;
+    for( ;; ) {
+        const ssize_t n = read(STDIN_FILENO, chunk, sizeof(chunk));
+        if(n <= 0) { break; }
+        size_t done = 0;
+        while(done < (size_t)n) {
+            done += console_receive(&chunk[done], (size_t)n - done);
+            if(done < (size_t)n) { usleep(CONSOLE_PORT_HOST_RETRY_US); }
+        }
+    }
+    return NULL;
+}
+
+void console_port_init(TaskHandle_t task) {
+    pthread_t thread;
+    sigset_t all;
+    sigset_t old;
+
+    ( void ) task;
+    // The thread starts with every signal blocked, the kernel's tick and
+    // yield signals are for the task threads
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    if(pthread_create(&thread, NULL, reader, NULL) == 0) {
+        pthread_detach(thread);
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
+
+void console_port_poll(void) {
+}
@@ -0,0 +1,185 @@
+#include "hal_host.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <sched.h>
+#include <time.h>
+
+#define HAL_HOST_US_PER_TICK          ( 1000000u / configTICK_RATE_HZ )
+// Real time a busy wait spins for a tick that is held off (interrupts
+// masked by a critical section) before it gives up on it
+#define HAL_HOST_TICK_WAIT_MAX_US     ( 20000 )
+
+static hal_host_device hal_host_devices[HAL_HOST_MAX_DEVICES];
+static int hal_host_device_count = 0;
+
+static int hal_host_level[HAL_HOST_NUM_PINS];
+static int hal_host_dir[HAL_HOST_NUM_PINS];
+static uint32_t hal_host_toggle_count[HAL_HOST_NUM_PINS];
+static uint64_t hal_host_busy = 0;
+// Reached by the waits within the current tick
+static uint64_t hal_host_clock = 0;
+static void (*volatile hal_host_tick_isr)(void) = NULL;
+
+static int valid_pin(const int pin) {
+    return pin >= 0 && pin < HAL_HOST_NUM_PINS;
+}
+
+void hal_host_attach(const hal_host_device *dev) {
+    configASSERT( hal_host_device_count < HAL_HOST_MAX_DEVICES );
+    hal_host_devices[hal_host_device_count++] = *dev;
+}
+
+void hal_init(void) {
+    hal_host_board_init();
+}
+
+void hal_gpio_init(const int pin) {
+    if(!valid_pin(pin)) { return; }
+    hal_host_dir[pin] = HAL_GPIO_IN;
+    hal_host_level[pin] = 0;
+}
+
+void hal_gpio_set_dir(const int pin, const int out) {
+    if(!valid_pin(pin)) { return; }
+    hal_host_dir[pin] = out;
+}
+
+void hal_gpio_put(const int pin, const int v) {
+    if(!valid_pin(pin)) { return; }
+    const int l = v ? 1 : 0;
+    if(hal_host_level[pin] != l) { hal_host_toggle_count[pin]++; }
+    hal_host_level[pin] = l;
+    // Only outputs reach the devices
+    if(hal_host_dir[pin] != HAL_GPIO_OUT) { return; }
+    const uint64_t now = hal_time_us();
+    for(int i=0; i<hal_host_device_count; i++) {
+        if(hal_host_devices[i].on_write) {
+            hal_host_devices[i].on_write(hal_host_devices[i].ctx, pin, l, now);
+        }
+    }
+}
+
+int hal_gpio_get(const int pin) {
+    if(!valid_pin(pin)) { return 0; }
+    if(hal_host_dir[pin] == HAL_GPIO_IN) {
+        const uint64_t now = hal_time_us();
+        for(int i=0; i<hal_host_device_count; i++) {
+            if(!hal_host_devices[i].on_read) { continue; }
+            const int l = hal_host_devices[i].on_read(hal_host_devices[i].ctx, pin, now);
+            if(l >= 0) { return l; }
+        }
+    }
+    return hal_host_level[pin];
+}
+
+void hal_gpio_xor_mask(const uint32_t mask) {
+    for(int pin=0; pin<HAL_HOST_NUM_PINS; pin++) {
+        if(mask & (1u << pin)) {
+            hal_gpio_put(pin, !hal_host_level[pin]);
+        }
+    }
+}
+
+void hal_gpio_init_mask(const uint32_t mask) {
+    for(int pin=0; pin<HAL_HOST_NUM_PINS; pin++) {
+        if(mask & (1u << pin)) { hal_gpio_init(pin); }
+    }
+}
+
+void hal_gpio_set_dir_out_masked(const uint32_t mask) {
+    for(int pin=0; pin<HAL_HOST_NUM_PINS; pin++) {
+        if(mask & (1u << pin)) { hal_gpio_set_dir(pin, HAL_GPIO_OUT); }
+    }
+}
+
+void hal_gpio_put_masked(const uint32_t mask, const uint32_t value) {
+    for(int pin=0; pin<HAL_HOST_NUM_PINS; pin++) {
+        if(mask & (1u << pin)) { hal_gpio_put(pin, (value >> pin) & 1u); }
+    }
+}
+
+void hal_gpio_clr_mask(const uint32_t mask) {
+    hal_gpio_put_masked(mask, 0);
+}
+
+void hal_gpio_set_mask(const uint32_t mask) {
+    hal_gpio_put_masked(mask, mask);
+}
+
+void hal_host_set_input(const int pin, const int level) {
+    if(!valid_pin(pin)) { return; }
+    if(hal_host_level[pin] != (level ? 1 : 0)) { hal_host_toggle_count[pin]++; }
+    hal_host_level[pin] = level ? 1 : 0;
+}
+
+static uint64_t tick_us(void) {
+    return (uint64_t)xTaskGetTickCount() * HAL_HOST_US_PER_TICK;
+}
+
+static uint64_t real_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/*
+ * The clock never gets ahead of the tick: a wait that ends past the next
+ * tick lasts until the kernel got there, spinning when the CPU is busy and
+ * blocked when a peripheral does the work.
+ */
+static void spend(const uint32_t us, const int cpu_free) {
+    const uint64_t until = hal_time_us() + us;
+    if(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        const uint64_t start = real_us();
+        while(until > tick_us() + HAL_HOST_US_PER_TICK) {
+            if(cpu_free) {
+                vTaskDelay(1);
+            } else if(real_us() - start < HAL_HOST_TICK_WAIT_MAX_US) {
+                sched_yield();
+            } else {
+                break;
+            }
+        }
+    }
+    if(until > hal_host_clock) { hal_host_clock = until; }
+}
+
+void hal_busy_wait_us(const uint32_t us) {
+    hal_host_busy += us;
+    spend(us, 0);
+}
+
+void hal_busy_wait_ns(const uint32_t ns) {
+    ( void ) ns;
+}
+
+void hal_host_advance_us(const uint32_t us) {
+    spend(us, 1);
+}
+
+uint64_t hal_time_us(void) {
+    // The tick moves the clock, the waits only within the tick
+    const uint64_t ticks = tick_us();
+    return hal_host_clock > ticks ? hal_host_clock : ticks;
+}
+
+uint64_t hal_busy_us(void) {
+    return hal_host_busy;
+}
+
+uint32_t hal_host_toggles(const int pin) {
+    if(!valid_pin(pin)) { return 0; }
+    return hal_host_toggle_count[pin];
+}
+
+void hal_host_set_tick_isr(void (*isr)(void)) {
+    hal_host_tick_isr = isr;
+}
+
+void hal_host_tick(void) {
+    void (*isr)(void) = hal_host_tick_isr;
+    if(isr) { isr(); }
+}
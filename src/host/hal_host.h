@@ -0,0 +1,45 @@
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+/*
+ * Host side of hal.h: simulated devices hook into the GPIO calls here.
+ *
+ * Time is virtual and driven by the kernel tick: every tick moves it to
+ * the start of that tick period, hal_busy_wait_us() and
+ * hal_host_advance_us() advance it by exactly the requested amount within
+ * the period. A wait that ends past the next tick lasts until the tick has
+ * come, so time spent busy costs ticks as it does on target, and bus
+ * timings within a tick do not depend on the load of the machine.
+ */
+#include "hal.h"
+
+#define HAL_HOST_MAX_DEVICES          4
+#define HAL_HOST_NUM_PINS             30
+
+typedef struct {
+    void (*on_write)(void *ctx, const int pin, const int level, const uint64_t now);
+    // Level driven on `pin`, -1 if the device is not driving it
+    int (*on_read)(void *ctx, const int pin, const uint64_t now);
+    void *ctx;
+} hal_host_device;
+
+void hal_host_attach(const hal_host_device *dev);
+
+// Drive an input pin from the outside (buttons, test scripts)
+void hal_host_set_input(const int pin, const int level);
+
+// Advance the clock for work done by peripherals (PIO/DMA), the CPU is
+// free: the caller blocks for the ticks the work runs past
+void hal_host_advance_us(const uint32_t us);
+
+// Number of level changes on `pin` since start
+uint32_t hal_host_toggles(const int pin);
+
+// Interrupt context of the host: the tick of the POSIX port calls
+// hal_host_tick() through the tick hook, which runs the routine set here
+// (NULL for none)
+void hal_host_set_tick_isr(void (*isr)(void));
+void hal_host_tick(void);
+
+// Board specific setup (host/board_host.c), called by hal_init()
+void hal_host_board_init(void);
+#endif
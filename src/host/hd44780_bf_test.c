@@ -0,0 +1,97 @@
+/*
+ * Busy flag polling of hd44780.c against the simulated controller, built
+ * with the GPIO bus and HD44780_CONFIG_BUSY_FLAG 1:
+ * - the reset sequence and frames poll BF and never write while busy
+ * - clear display polls until done instead of sleeping 10ms
+ * - BF stuck past the timeout costs that one transfer the fixed delay, the
+ *   next one polls again
+ *
+ *   ./hd44780_bf_test_host
+ */
+#include "hd44780.h"
+#include "hal_host.h"
+#include "board_host.h"
+#include "host_test.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <string.h>
+
+#define TEST_COLS                     ( 16 )
+// Fixed wait of clear and home without the flag
+#define TEST_CLEAR_FIXED_US           ( 10000 )
+// Longer than the polling timeout of hd44780.c, shorter than two of them
+#define TEST_STUCK_US                 ( 3000 )
+
+// Driver internals, not part of hd44780.h
+void hd44780_inst_display_clear(TickType_t *xNextWakeTime);
+void hd44780_send_instruction(const int v);
+
+int main_hd44780_bf_test(void);
+
+static int row_is(const int row, const char *want) {
+    char got[TEST_COLS + 1];
+    char padded[TEST_COLS + 1];
+    hd44780_sim_row(board_host_lcd(), row, TEST_COLS, got);
+    snprintf(padded, sizeof(padded), "%-*s", TEST_COLS, want);
+    if(strcmp(got, padded) == 0) { return 1; }
+    printf("row %d is |%s|, expected |%s|\n", row, got, padded);
+    return 0;
+}
+
+static void test_task(void *pvParameters) {
+    hd44780_sim *sim = board_host_lcd();
+    TickType_t wake = xTaskGetTickCount();
+
+    ( void ) pvParameters;
+    hd44780_init(&wake);
+    TEST_EQUAL(sim->stats.busy_violations, 0);
+    TEST_CHECK(sim->stats.status_reads > 0);
+
+    set_line(0, "BF polling");
+    set_line(1, "L2");
+    display_frame();
+    TEST_EQUAL(sim->stats.busy_violations, 0);
+    TEST_CHECK(row_is(0, "BF polling"));
+    TEST_CHECK(row_is(1, "L2"));
+
+    // Done as soon as the controller is, not after the fixed wait
+    const uint64_t start = hal_time_us();
+    hd44780_inst_display_clear(&wake);
+    const uint64_t took = hal_time_us() - start;
+    hd44780_fb_cleared(&hd44780_shadow);
+    TEST_CHECK(took >= sim->timing.clear_us);
+    TEST_CHECK(took < TEST_CLEAR_FIXED_US);
+    display_frame();
+    TEST_EQUAL(sim->stats.busy_violations, 0);
+    TEST_CHECK(row_is(0, "BF polling"));
+
+    // BF stuck for one transfer: it times out and is dropped by the busy
+    // controller, the one after it polls and lands
+    sim->busy_until = hal_time_us() + TEST_STUCK_US;
+    const uint32_t violations = sim->stats.busy_violations;
+    hd44780_send_instruction(0x80);
+    TEST_EQUAL(hd44780_get_busy_timeouts(), 1);
+    TEST_EQUAL(sim->stats.busy_violations, violations + 1);
+
+    const uint32_t reads = sim->stats.status_reads;
+    set_line(2, "Polling again");
+    display_frame();
+    TEST_EQUAL(hd44780_get_busy_timeouts(), 1);
+    TEST_EQUAL(sim->stats.busy_violations, violations + 1);
+    TEST_CHECK(sim->stats.status_reads > reads);
+    TEST_CHECK(row_is(2, "Polling again"));
+
+    hd44780_sim_dump(sim, 4, TEST_COLS);
+    fflush(stdout);
+    exit(test_done("hd44780_bf"));
+}
+
+int main_hd44780_bf_test(void) {
+    xTaskCreate(test_task, "TEST", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+    vTaskStartScheduler();
+    for( ;; );
+    return -1;
+}
@@ -0,0 +1,56 @@
+/*
+ * Software model of the hd44780.pio state machine for the host build.
+ *
+ * Frames are queued exactly like the DMA buffer on target and replayed on
+ * flush with the same pin sequence and timing as the PIO program:
+ * pin group -> E high 1us -> E low 1us -> execution delay.
+ */
+#include "hd44780_bus.h"
+#include "hal_host.h"
+
+#define HD44780_BUS_HOST_QUEUE_LEN    ( 64 )
+
+static uint32_t hd44780_bus_host_frames[HD44780_BUS_HOST_QUEUE_LEN];
+static size_t hd44780_bus_host_pending = 0;
+static int hd44780_bus_host_base;
+static int hd44780_bus_host_count;
+static int hd44780_bus_host_e;
+
+void hd44780_bus_pio_init(const int data_base, const int width, const int pin_e) {
+    hd44780_bus_host_base = data_base;
+    hd44780_bus_host_count = width + 2;
+    hd44780_bus_host_e = pin_e;
+    for(int i=0; i<hd44780_bus_host_count; i++) {
+        hal_gpio_init(data_base + i);
+        hal_gpio_set_dir(data_base + i, HAL_GPIO_OUT);
+        hal_gpio_put(data_base + i, 0);
+    }
+    hal_gpio_init(pin_e);
+    hal_gpio_set_dir(pin_e, HAL_GPIO_OUT);
+    hal_gpio_put(pin_e, 0);
+}
+
+static void replay(const uint32_t frame) {
+    for(int i=0; i<hd44780_bus_host_count; i++) {
+        hal_gpio_put(hd44780_bus_host_base + i, (frame >> i) & 0x01);
+    }
+    // The state machine does the waiting, not the CPU
+    hal_gpio_put(hd44780_bus_host_e, 1);
+    hal_host_advance_us(1);
+    hal_gpio_put(hd44780_bus_host_e, 0);
+    hal_host_advance_us(1 + hd44780_bus_frame_delay_us(frame));
+}
+
+void hd44780_bus_pio_push(const uint32_t frame) {
+    if(hd44780_bus_host_pending == HD44780_BUS_HOST_QUEUE_LEN) {
+        hd44780_bus_pio_flush();
+    }
+    hd44780_bus_host_frames[hd44780_bus_host_pending++] = frame;
+}
+
+void hd44780_bus_pio_flush(void) {
+    for(size_t i=0; i<hd44780_bus_host_pending; i++) {
+        replay(hd44780_bus_host_frames[i]);
+    }
+    hd44780_bus_host_pending = 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Frame encoding of the PIO bus engine (hd44780_bus.h): the pin group of
+ * both bus widths, the nibble order, the delay field and its limits.
+ *
+ *   ./hd44780_bus_test_host
+ */
+#include "hd44780_bus.h"
+#include "host_test.h"
+
+#define RW_BIT( width )               ( 1u << ( width ) )
+#define RS_BIT( width )               ( 1u << ( ( width ) + 1 ) )
+
+static void test_layout(void) {
+    // 4 bit: D4..D7 in 0..3, RW 4, RS 5, delay - 1 from bit 10
+    TEST_EQUAL(hd44780_bus_frame(4, 1, 0xF, 80), 0x2Fu | 79u << HD44780_BUS_GROUP_BITS);
+    TEST_EQUAL(hd44780_bus_frame(4, 0, 0x3, 1), 0x03u);
+    // 8 bit: D0..D7 in 0..7, RW 8, RS 9
+    TEST_EQUAL(hd44780_bus_frame(8, 1, 0xA5, 37), 0x2A5u | 36u << HD44780_BUS_GROUP_BITS);
+    // Data wider than the bus does not spill into RW or RS
+    TEST_EQUAL(hd44780_bus_frame(4, 0, 0xFF, 1) & (RW_BIT(4) | RS_BIT(4)), 0);
+    TEST_EQUAL(hd44780_bus_frame(8, 0, 0x1FF, 1) & (RW_BIT(8) | RS_BIT(8)), 0);
+}
+
+static void test_encode(void) {
+    uint32_t frames[2];
+
+    // High nibble first, the controller executes after the low one
+    TEST_EQUAL(hd44780_bus_encode(frames, 4, 1, 0xA5, 80), 2);
+    TEST_EQUAL(hd44780_bus_frame_data(4, frames[0]), 0xA);
+    TEST_EQUAL(hd44780_bus_frame_data(4, frames[1]), 0x5);
+    TEST_EQUAL(hd44780_bus_frame_delay_us(frames[0]), HD44780_BUS_NIBBLE_DELAY_US);
+    TEST_EQUAL(hd44780_bus_frame_delay_us(frames[1]), 80);
+    TEST_EQUAL(hd44780_bus_frame_rs(4, frames[0]), 1);
+    TEST_EQUAL(hd44780_bus_frame_rs(4, frames[1]), 1);
+
+    TEST_EQUAL(hd44780_bus_encode(frames, 8, 0, 0x01, 1520), 1);
+    TEST_EQUAL(hd44780_bus_frame_data(8, frames[0]), 0x01);
+    TEST_EQUAL(hd44780_bus_frame_rs(8, frames[0]), 0);
+    TEST_EQUAL(hd44780_bus_frame_delay_us(frames[0]), 1520);
+}
+
+// Every byte on both widths and both registers decodes back unchanged
+static void test_round_trip(void) {
+    static const int widths[] = { 4, 8 };
+    unsigned bad = 0;
+    for(size_t w=0; w<sizeof(widths)/sizeof(widths[0]); w++) {
+        const int width = widths[w];
+        for(int rs=0; rs<2; rs++) {
+            for(int v=0; v<256; v++) {
+                uint32_t frames[2];
+                const size_t n = hd44780_bus_encode(frames, width, rs, v, 40);
+                int got = 0;
+                for(size_t i=0; i<n; i++) {
+                    got = got << width | hd44780_bus_frame_data(width, frames[i]);
+                    bad += hd44780_bus_frame_rs(width, frames[i]) != rs;
+                    bad += (frames[i] & RW_BIT(width)) != 0;
+                }
+                bad += got != v;
+                bad += hd44780_bus_frame_delay_us(frames[n - 1]) != 40;
+            }
+        }
+    }
+    TEST_EQUAL(bad, 0);
+}
+
+static void test_delay_limits(void) {
+    // No delay still takes one loop of the state machine
+    TEST_EQUAL(hd44780_bus_frame_delay_us(hd44780_bus_frame(4, 0, 0, 0)), 1);
+    TEST_EQUAL(hd44780_bus_frame_delay_us(hd44780_bus_frame(4, 0, 0, 1)), 1);
+    TEST_EQUAL(hd44780_bus_frame_delay_us(hd44780_bus_frame(8, 0, 0, HD44780_BUS_DELAY_MAX_US)),
+        HD44780_BUS_DELAY_MAX_US);
+    // Longer delays saturate instead of wrapping into a short one
+    TEST_EQUAL(hd44780_bus_frame_delay_us(hd44780_bus_frame(8, 0, 0, HD44780_BUS_DELAY_MAX_US + 5)),
+        HD44780_BUS_DELAY_MAX_US);
+    TEST_EQUAL(hd44780_bus_frame_delay_us(hd44780_bus_frame(8, 0, 0, UINT32_MAX)),
+        HD44780_BUS_DELAY_MAX_US);
+}
+
+int main(void) {
+    test_layout();
+    test_encode();
+    test_round_trip();
+    test_delay_limits();
+    return test_done("hd44780_bus");
+}
@@ -0,0 +1,148 @@
+/*
+ * Frame diffing of hd44780_fb.h against a model of the DDRAM: what reaches
+ * the controller matches the frame, and only the changed cells cost bus
+ * bytes.
+ *
+ *   ./hd44780_fb_test_host
+ */
+#include "hd44780_fb.h"
+#include "host_test.h"
+
+#include <string.h>
+
+#define TEST_ROWS                     ( 4 )
+#define TEST_COLS                     ( 16 )
+#define TEST_STRIDE                   ( TEST_COLS + 1 )
+// A whole frame rewritten row by row: one address and 16 cells per row
+#define TEST_FULL_BYTES               ( TEST_ROWS * ( 1 + TEST_COLS ) )
+
+static const int line_start[TEST_ROWS] = { 0x00, 0x40, 0x10, 0x50 };
+
+// The controller side: DDRAM and its address counter, increment mode
+typedef struct {
+    int ddram[HD44780_FB_DDRAM_SIZE];
+    int ac;
+    uint32_t instructions;
+    uint32_t data_bytes;
+} ddram_model;
+
+static void model_set_address(void *ctx, const int address) {
+    ddram_model *m = ctx;
+    m->ac = address;
+    m->instructions++;
+}
+
+static void model_write(void *ctx, const int c) {
+    ddram_model *m = ctx;
+    m->ddram[m->ac] = c;
+    m->ac = hd44780_fb_next_address(m->ac);
+    m->data_bytes++;
+}
+
+static ddram_model model;
+static const hd44780_fb_sink sink = {
+    .set_address = model_set_address,
+    .write = model_write,
+    .ctx = &model,
+};
+static hd44780_fb fb;
+static char frame[TEST_ROWS][TEST_STRIDE];
+
+static void set_row(const int r, const char *text) {
+    strncpy(frame[r], text, TEST_COLS);
+    frame[r][TEST_COLS] = '\0';
+}
+
+// Bus bytes of one flush, an instruction costs the same as a data byte
+static uint32_t flush(void) {
+    const uint32_t before = model.instructions + model.data_bytes;
+    hd44780_fb_flush(&fb, &frame[0][0], TEST_STRIDE, &sink);
+    return model.instructions + model.data_bytes - before;
+}
+
+// Every cell of the frame, blanks past the end of a row, is in DDRAM
+static int shown(void) {
+    for(int r=0; r<TEST_ROWS; r++) {
+        const size_t len = strlen(frame[r]);
+        for(int c=0; c<TEST_COLS; c++) {
+            const int want = (size_t)c < len ? (uint8_t)frame[r][c] : ' ';
+            if(model.ddram[hd44780_fb_cell_address(&fb, r, c)] != want) { return 0; }
+        }
+    }
+    return 1;
+}
+
+static void test_first_frame(void) {
+    set_row(0, "L1 Me gusta");
+    set_row(1, "L2 Funciona");
+    set_row(2, "L3 No me lo creo");
+    set_row(3, "L4 12:00:00");
+    // Unknown shadow: every cell is sent, L1+L3 and L2+L4 are one burst each
+    TEST_EQUAL(flush(), 2 + TEST_ROWS * TEST_COLS);
+    TEST_EQUAL(fb.stats.instructions, 2);
+    TEST_CHECK(shown());
+    // Nothing changed, nothing sent
+    TEST_EQUAL(flush(), 0);
+}
+
+static void test_single_cell(void) {
+    // A clock tick: one cell, one address and one byte against a full rewrite
+    set_row(3, "L4 12:00:01");
+    const uint32_t bytes = flush();
+    TEST_EQUAL(bytes, 2);
+    TEST_CHECK(bytes * 10 < TEST_FULL_BYTES);
+    TEST_CHECK(shown());
+}
+
+static void test_bridge(void) {
+    // Two cells one apart: the unchanged one between is rewritten instead
+    // of a second address
+    frame[0][3] = 'X';
+    frame[0][5] = 'Y';
+    TEST_EQUAL(flush(), 1 + 3);
+    TEST_CHECK(shown());
+}
+
+static void test_shorter_row(void) {
+    // Cells past the end of the string go blank, and stay without traffic.
+    // Cell 2 was a blank already.
+    set_row(2, "L3");
+    TEST_EQUAL(flush(), 1 + TEST_COLS - 3);
+    TEST_CHECK(shown());
+    TEST_EQUAL(flush(), 0);
+}
+
+static void test_cleared(void) {
+    // After a clear display only the non blank cells are written
+    for(int a=0; a<HD44780_FB_DDRAM_SIZE; a++) { model.ddram[a] = ' '; }
+    hd44780_fb_cleared(&fb);
+    for(int r=0; r<TEST_ROWS; r++) { set_row(r, ""); }
+    set_row(1, "Hi");
+    TEST_EQUAL(flush(), 1 + 2);
+    TEST_CHECK(shown());
+}
+
+static void test_shift(void) {
+    // Frames follow the display shift into the cells that are shown
+    hd44780_fb_shifted(&fb, 3);
+    set_row(1, "Hi");
+    TEST_EQUAL(hd44780_fb_cell_address(&fb, 1, 0), 0x43);
+    TEST_CHECK(flush() > 0);
+    TEST_CHECK(shown());
+    TEST_EQUAL(flush(), 0);
+}
+
+int main(void) {
+    for(int a=0; a<HD44780_FB_DDRAM_SIZE; a++) { model.ddram[a] = -1; }
+    hd44780_fb_init(&fb, TEST_ROWS, TEST_COLS, line_start);
+
+    test_first_frame();
+    test_single_cell();
+    test_bridge();
+    test_shorter_row();
+    test_cleared();
+    test_shift();
+    printf("hd44780_fb: total_instructions=%lu total_data_bytes=%lu\n",
+        (unsigned long)fb.stats.total_instructions, (unsigned long)fb.stats.total_data_bytes);
+    return test_done("hd44780_fb");
+}
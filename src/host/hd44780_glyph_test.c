@@ -0,0 +1,180 @@
+/*
+ * CGRAM glyph cache of hd44780_glyph.h against a model of the CGRAM: least
+ * recently used eviction, slots pinned by what the controller shows, the
+ * fallback when every slot is taken, and the characters the A00 ROM moved.
+ *
+ *   ./hd44780_glyph_test_host
+ */
+#include "hd44780_glyph.h"
+#include "host_test.h"
+
+#include <string.h>
+
+static const int line_start[2] = { 0x00, 0x40 };
+
+// The controller side: CGRAM and the slot written last
+typedef struct {
+    uint8_t cgram[HD44780_GLYPH_SLOTS * HD44780_GLYPH_ROWS];
+    int ac;
+    int last_slot;
+    uint32_t uploads;
+} cgram_model;
+
+static void model_set_cgram_address(void *ctx, const int address) {
+    cgram_model *m = ctx;
+    m->ac = address;
+    m->last_slot = address / HD44780_GLYPH_ROWS;
+    m->uploads++;
+}
+
+static void model_write(void *ctx, const int c) {
+    cgram_model *m = ctx;
+    m->cgram[m->ac++] = (uint8_t)c;
+}
+
+static cgram_model model;
+static const hd44780_glyph_sink sink = {
+    .set_cgram_address = model_set_cgram_address,
+    .write = model_write,
+    .ctx = &model,
+};
+static hd44780_fb fb;
+static hd44780_glyph_cache cache;
+
+// Application glyph n, its rows all n so the CGRAM shows which one it is
+static hd44780_glyph user_glyph(const int n) {
+    hd44780_glyph g = { .code = HD44780_GLYPH_USER(n), .fallback = '#' };
+    memset(g.rows, n & 0x1F, sizeof(g.rows));
+    return g;
+}
+
+static int slot_of(const char c) {
+    return (uint8_t)c - HD44780_GLYPH_CHAR_BASE;
+}
+
+// A frame was flushed showing nothing of CGRAM
+static void flushed_blank(void) {
+    hd44780_fb_cleared(&fb);
+    hd44780_glyph_sync(&cache);
+}
+
+static void reset(void) {
+    memset(&model, 0, sizeof(model));
+    hd44780_fb_init(&fb, 2, 16, line_start);
+    hd44780_glyph_init(&cache, &fb, &sink);
+    flushed_blank();
+}
+
+static void test_fill(void) {
+    reset();
+    // Free slots go first, in order, one upload each
+    for(int n=0; n<HD44780_GLYPH_SLOTS; n++) {
+        const hd44780_glyph g = user_glyph(n);
+        TEST_EQUAL(slot_of(hd44780_glyph_get(&cache, &g)), n);
+        TEST_EQUAL(model.cgram[n * HD44780_GLYPH_ROWS], n);
+    }
+    TEST_EQUAL(model.uploads, HD44780_GLYPH_SLOTS);
+    // Resident: a hit, no upload
+    const hd44780_glyph g = user_glyph(3);
+    TEST_EQUAL(slot_of(hd44780_glyph_get(&cache, &g)), 3);
+    TEST_EQUAL(model.uploads, HD44780_GLYPH_SLOTS);
+    TEST_EQUAL(cache.stats.hits, 1);
+}
+
+static void test_lru(void) {
+    reset();
+    for(int n=0; n<HD44780_GLYPH_SLOTS; n++) {
+        const hd44780_glyph g = user_glyph(n);
+        hd44780_glyph_get(&cache, &g);
+    }
+    // Use 0, 1 and 2 again: 3 is now the oldest, then 4
+    for(int n=0; n<3; n++) {
+        const hd44780_glyph g = user_glyph(n);
+        hd44780_glyph_get(&cache, &g);
+    }
+    flushed_blank();
+
+    const hd44780_glyph a = user_glyph(20);
+    TEST_EQUAL(slot_of(hd44780_glyph_get(&cache, &a)), 3);
+    TEST_EQUAL(model.last_slot, 3);
+    TEST_EQUAL(model.cgram[3 * HD44780_GLYPH_ROWS], 20);
+    const hd44780_glyph b = user_glyph(21);
+    TEST_EQUAL(slot_of(hd44780_glyph_get(&cache, &b)), 4);
+    TEST_EQUAL(cache.stats.evictions, 2);
+    // The evicted glyph comes back into the next oldest slot
+    flushed_blank();
+    const hd44780_glyph c = user_glyph(3);
+    TEST_EQUAL(slot_of(hd44780_glyph_get(&cache, &c)), 5);
+}
+
+static void test_pinned_by_shadow(void) {
+    reset();
+    for(int n=0; n<HD44780_GLYPH_SLOTS; n++) {
+        const hd44780_glyph g = user_glyph(n);
+        hd44780_glyph_get(&cache, &g);
+    }
+    // The controller shows slot 0 (through 08) and slot 1 (through 01):
+    // both stay although they are the oldest
+    hd44780_fb_cleared(&fb);
+    fb.shadow[0x05] = HD44780_GLYPH_CHAR_BASE + 0;
+    fb.shadow[0x42] = 1;
+    hd44780_glyph_sync(&cache);
+    TEST_EQUAL(cache.pinned, 0x03);
+
+    const hd44780_glyph g = user_glyph(30);
+    TEST_EQUAL(slot_of(hd44780_glyph_get(&cache, &g)), 2);
+    // Unknown cells pin nothing
+    hd44780_fb_invalidate(&fb);
+    hd44780_glyph_sync(&cache);
+    TEST_EQUAL(cache.pinned, 0);
+}
+
+static void test_fallback(void) {
+    reset();
+    // Nine glyphs in one frame: the ninth has no slot to take
+    char out[16];
+    TEST_EQUAL(hd44780_glyph_utf8(&cache, "áéíóúÁÉÍ¿", out, sizeof(out)), 9);
+    for(int i=0; i<HD44780_GLYPH_SLOTS; i++) {
+        TEST_EQUAL(slot_of(out[i]), i);
+    }
+    TEST_EQUAL(out[8], '?');
+    TEST_EQUAL(cache.stats.fallbacks, 1);
+    TEST_EQUAL(cache.stats.uploads, HD44780_GLYPH_SLOTS);
+
+    // Another frame, nothing shown: the slots free up again
+    flushed_blank();
+    TEST_EQUAL(hd44780_glyph_utf8(&cache, "¿", out, sizeof(out)), 1);
+    TEST_CHECK(slot_of(out[0]) >= 0 && slot_of(out[0]) < HD44780_GLYPH_SLOTS);
+
+    // No glyph for it at all
+    TEST_EQUAL(hd44780_glyph_utf8(&cache, "\xE2\x82\xAC", out, sizeof(out)), 1);
+    TEST_EQUAL(out[0], '?');
+}
+
+static void test_rom_differences(void) {
+    reset();
+    char out[16];
+    // The A00 ROM shows a yen sign at 0x5C and an arrow at 0x7E
+    hd44780_glyph_utf8(&cache, "a\\b~c", out, sizeof(out));
+    TEST_EQUAL(out[0], 'a');
+    TEST_EQUAL(slot_of(out[1]), 0);
+    TEST_EQUAL(out[2], 'b');
+    TEST_EQUAL(slot_of(out[3]), 1);
+    TEST_EQUAL(out[4], 'c');
+    TEST_EQUAL(cache.stats.uploads, 2);
+
+    hd44780_glyph_utf8(&cache, "¥→←", out, sizeof(out));
+    TEST_EQUAL(out[0], 0x5C);
+    TEST_EQUAL(out[1], 0x7E);
+    TEST_EQUAL(out[2], 0x7F);
+    TEST_EQUAL(cache.stats.uploads, 2);
+}
+
+int main(void) {
+    test_fill();
+    test_lru();
+    test_pinned_by_shadow();
+    test_fallback();
+    test_rom_differences();
+    return test_done("hd44780_glyph");
+}
@@ -0,0 +1,216 @@
+#include "hd44780_sim.h"
+#include "hal_host.h"
+
+#include <stdio.h>
+#include <string.h>
+
+const hd44780_sim_timing hd44780_sim_default_timing = {
+    .exec_us = 37,
+    .clear_us = 1520,
+    .home_us = 1520,
+};
+
+void hd44780_sim_init(hd44780_sim *sim, const int data[8], const int rw, const int rs, const int e,
+        const hd44780_sim_timing *timing) {
+    memset(sim, 0, sizeof(*sim));
+    for(int i=0; i<8; i++) {
+        sim->pin_data[i] = data[i];
+    }
+    sim->pin_rw = rw;
+    sim->pin_rs = rs;
+    sim->pin_e = e;
+    sim->timing = timing ? *timing : hd44780_sim_default_timing;
+    // Power on state: 8 bit interface, display off, increment
+    sim->increment = 1;
+    memset(sim->ddram, ' ', sizeof(sim->ddram));
+}
+
+static void advance_ac(hd44780_sim *sim) {
+    if(sim->cgram_selected) {
+        sim->ac = (sim->ac + (sim->increment ? 1 : -1)) & (HD44780_SIM_CGRAM_SIZE - 1);
+        return;
+    }
+    if(sim->increment) {
+        if(sim->two_lines && sim->ac == 0x27) { sim->ac = 0x40; }
+        else if(sim->two_lines && sim->ac == 0x67) { sim->ac = 0x00; }
+        else if(!sim->two_lines && sim->ac == 0x4F) { sim->ac = 0x00; }
+        else { sim->ac++; }
+    } else {
+        if(sim->two_lines && sim->ac == 0x40) { sim->ac = 0x27; }
+        else if(sim->two_lines && sim->ac == 0x00) { sim->ac = 0x67; }
+        else if(!sim->two_lines && sim->ac == 0x00) { sim->ac = 0x4F; }
+        else { sim->ac--; }
+    }
+}
+
+static uint32_t execute_instruction(hd44780_sim *sim, const int v) {
+    sim->stats.instructions++;
+    if(v & 0x80) {
+        sim->ac = v & 0x7F;
+        sim->cgram_selected = 0;
+    } else if(v & 0x40) {
+        sim->ac = v & 0x3F;
+        sim->cgram_selected = 1;
+    } else if(v & 0x20) {
+        sim->four_bit = !(v & 0x10);
+        sim->two_lines = (v & 0x08) ? 1 : 0;
+    } else if(v & 0x10) {
+        const int right = (v & 0x04) ? 1 : 0;
+        if(v & 0x08) {
+            sim->display_shift += right ? -1 : 1;
+        } else {
+            const int inc = sim->increment;
+            sim->increment = right;
+            advance_ac(sim);
+            sim->increment = inc;
+        }
+    } else if(v & 0x08) {
+        sim->display_on = (v & 0x04) ? 1 : 0;
+        sim->cursor_on = (v & 0x02) ? 1 : 0;
+        sim->blink_on = (v & 0x01) ? 1 : 0;
+    } else if(v & 0x04) {
+        sim->increment = (v & 0x02) ? 1 : 0;
+        sim->shift_on_write = v & 0x01;
+    } else if(v & 0x02) {
+        sim->ac = 0;
+        sim->cgram_selected = 0;
+        sim->display_shift = 0;
+        return sim->timing.home_us;
+    } else if(v & 0x01) {
+        memset(sim->ddram, ' ', sizeof(sim->ddram));
+        sim->ac = 0;
+        sim->cgram_selected = 0;
+        sim->increment = 1;
+        sim->display_shift = 0;
+        return sim->timing.clear_us;
+    }
+    return sim->timing.exec_us;
+}
+
+static uint32_t execute_write(hd44780_sim *sim, const int v) {
+    sim->stats.data_writes++;
+    if(sim->cgram_selected) {
+        sim->cgram[sim->ac & (HD44780_SIM_CGRAM_SIZE - 1)] = (uint8_t)v;
+    } else {
+        sim->ddram[sim->ac & (HD44780_SIM_DDRAM_SIZE - 1)] = (uint8_t)v;
+        if(sim->shift_on_write) {
+            sim->display_shift += sim->increment ? 1 : -1;
+        }
+    }
+    advance_ac(sim);
+    return sim->timing.exec_us;
+}
+
+static void execute(hd44780_sim *sim, const int rs, const int v, const uint64_t now) {
+    if(now < sim->busy_until) {
+        // The real controller ignores anything sent while busy
+        sim->stats.busy_violations++;
+        return;
+    }
+    const uint32_t t = rs ? execute_write(sim, v) : execute_instruction(sim, v);
+    sim->busy_until = now + t;
+    sim->stats.busy_us += t;
+}
+
+static int read_value(const hd44780_sim *sim, const uint64_t now) {
+    if(!sim->rs) {
+        return (now < sim->busy_until ? 0x80 : 0x00) | (sim->ac & 0x7F);
+    }
+    return sim->cgram_selected ? sim->cgram[sim->ac & (HD44780_SIM_CGRAM_SIZE - 1)]
+                               : sim->ddram[sim->ac & (HD44780_SIM_DDRAM_SIZE - 1)];
+}
+
+void hd44780_sim_pin_write(hd44780_sim *sim, const int pin, const int level, const uint64_t now) {
+    const int l = level ? 1 : 0;
+    if(pin == sim->pin_rs) { sim->rs = l; return; }
+    if(pin == sim->pin_rw) { sim->rw = l; return; }
+    for(int i=0; i<8; i++) {
+        if(pin == sim->pin_data[i]) {
+            sim->bus = (sim->bus & ~(1 << i)) | (l << i);
+            return;
+        }
+    }
+    if(pin != sim->pin_e || l == sim->e) { return; }
+    sim->e = l;
+    if(l) { return; }
+
+    // Falling edge of E commits the cycle
+    sim->stats.e_cycles++;
+    if(sim->rw) {
+        if(!sim->rs) { sim->stats.status_reads++; }
+        if(sim->four_bit && !sim->read_nibble) {
+            sim->read_nibble = 1;
+            return;
+        }
+        sim->read_nibble = 0;
+        if(sim->rs) { advance_ac(sim); }
+        return;
+    }
+    if(!sim->four_bit) {
+        execute(sim, sim->rs, sim->bus, now);
+        return;
+    }
+    const int nibble = (sim->bus >> 4) & 0x0F;
+    if(!sim->nibble_pending) {
+        sim->nibble_high = nibble;
+        sim->nibble_pending = 1;
+        return;
+    }
+    sim->nibble_pending = 0;
+    execute(sim, sim->rs, sim->nibble_high << 4 | nibble, now);
+}
+
+int hd44780_sim_pin_read(const hd44780_sim *sim, const int pin, const uint64_t now) {
+    if(!sim->e || !sim->rw) { return -1; }
+    int v = read_value(sim, now);
+    if(sim->four_bit) {
+        // Nibbles come out on D4..D7, high first
+        v = sim->read_nibble ? (v & 0x0F) << 4 : (v & 0xF0);
+    }
+    for(int i=0; i<8; i++) {
+        if(pin == sim->pin_data[i]) { return (v >> i) & 0x01; }
+    }
+    return -1;
+}
+
+void hd44780_sim_row(const hd44780_sim *sim, const int row, const int cols, char *out) {
+    // Rows 0/1 start each DDRAM line, rows 2/3 continue them `cols` later
+    const int base = (row & 0x01) ? 0x40 : 0x00;
+    for(int c=0; c<cols; c++) {
+        int offset = ((row >> 1) * cols + c + sim->display_shift) % 40;
+        if(offset < 0) { offset += 40; }
+        const uint8_t ch = sim->ddram[base + offset];
+        // CGRAM glyphs and non ASCII ROM characters are shown as '?'
+        out[c] = (ch >= 0x20 && ch < 0x7F) ? (char)ch : '?';
+    }
+    out[cols] = '\0';
+}
+
+void hd44780_sim_dump(const hd44780_sim *sim, const int rows, const int cols) {
+    char line[41];
+    for(int r=0; r<rows; r++) {
+        hd44780_sim_row(sim, r, cols, line);
+        printf("|%s|\n", line);
+    }
+    printf("e_cycles=%u instructions=%u data_writes=%u status_reads=%u busy_violations=%u busy_us=%llu\n",
+        sim->stats.e_cycles, sim->stats.instructions, sim->stats.data_writes,
+        sim->stats.status_reads, sim->stats.busy_violations,
+        (unsigned long long)sim->stats.busy_us);
+}
+
+static void sim_write(void *ctx, const int pin, const int level, const uint64_t now) {
+    hd44780_sim_pin_write((hd44780_sim *)ctx, pin, level, now);
+}
+
+static int sim_read(void *ctx, const int pin, const uint64_t now) {
+    return hd44780_sim_pin_read((const hd44780_sim *)ctx, pin, now);
+}
+
+void hd44780_sim_attach(hd44780_sim *sim) {
+    const hal_host_device dev = {
+        .on_write = sim_write,
+        .on_read = sim_read,
+        .ctx = sim,
+    };
+    hal_host_attach(&dev);
+}
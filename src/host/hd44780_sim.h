@@ -0,0 +1,86 @@
+#ifndef HD44780_SIM_H
+#define HD44780_SIM_H
+/*
+ * Simulated HD44780 controller for the host build.
+ *
+ * Pin activity is decoded the same way the controller does it: RS/RW/data
+ * are latched on the falling edge of E (writes) and the data pins are driven
+ * while E is high (reads). Instructions take a configurable execution time
+ * during which the busy flag is set, anything written while busy is dropped
+ * and counted as a violation, so a driver that waits too little shows up.
+ */
+#include <stdint.h>
+
+#define HD44780_SIM_DDRAM_SIZE        ( 0x80 )
+#define HD44780_SIM_CGRAM_SIZE        ( 0x40 )
+
+typedef struct {
+    uint32_t exec_us;      // Most instructions and data writes (37us typ)
+    uint32_t clear_us;     // Clear display (1.52ms)
+    uint32_t home_us;      // Return home (1.52ms)
+} hd44780_sim_timing;
+
+typedef struct {
+    uint32_t e_cycles;
+    uint32_t instructions;
+    uint32_t data_writes;
+    uint32_t status_reads;
+    uint32_t busy_violations;
+    uint64_t busy_us;      // Time spent executing
+} hd44780_sim_stats;
+
+typedef struct {
+    // Wiring, data[i] is the GPIO of Di, -1 if not connected
+    int pin_data[8];
+    int pin_rw;
+    int pin_rs;
+    int pin_e;
+    hd44780_sim_timing timing;
+
+    // Pin levels as seen by the controller
+    int rs;
+    int rw;
+    int e;
+    int bus;               // Levels of D0..D7
+
+    // Interface state
+    int four_bit;
+    int nibble_pending;    // 4 bit mode, waiting for the low nibble
+    int nibble_high;
+    int read_nibble;       // 4 bit mode, next read returns the low nibble
+    uint64_t busy_until;
+
+    // Controller state
+    int ac;
+    int cgram_selected;
+    int increment;
+    int shift_on_write;
+    int display_on;
+    int cursor_on;
+    int blink_on;
+    int two_lines;
+    int display_shift;
+    uint8_t ddram[HD44780_SIM_DDRAM_SIZE];
+    uint8_t cgram[HD44780_SIM_CGRAM_SIZE];
+
+    hd44780_sim_stats stats;
+} hd44780_sim;
+
+extern const hd44780_sim_timing hd44780_sim_default_timing;
+
+// `data` holds the GPIO of D0..D7, -1 for pins not wired (D0..D3 in 4 bit)
+void hd44780_sim_init(hd44780_sim *sim, const int data[8], const int rw, const int rs, const int e,
+        const hd44780_sim_timing *timing);
+// Attach the controller to the host HAL pins
+void hd44780_sim_attach(hd44780_sim *sim);
+
+// Pin level changes and reads, `now` in microseconds
+void hd44780_sim_pin_write(hd44780_sim *sim, const int pin, const int level, const uint64_t now);
+// Returns the level driven by the controller or -1 if it is not driving `pin`
+int hd44780_sim_pin_read(const hd44780_sim *sim, const int pin, const uint64_t now);
+
+// Copy what row `row` shows on a `cols` wide display into `out` (NUL ended)
+void hd44780_sim_row(const hd44780_sim *sim, const int row, const int cols, char *out);
+// Print the visible rows and counters
+void hd44780_sim_dump(const hd44780_sim *sim, const int rows, const int cols);
+#endif
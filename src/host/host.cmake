@@ -0,0 +1,254 @@
+# Host (Linux) build of the firmware against the FreeRTOS POSIX port.
+# Included from src/CMakeLists.txt when HOST_BUILD is ON, the pico SDK is
+# not used at all: hal.h maps onto host/hal_host.c and the LCD is simulated.
+
+# The kernel looks for FreeRTOSConfig.h through this interface library
+add_library(freertos_config INTERFACE)
+target_include_directories(freertos_config SYSTEM INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/..
+)
+target_compile_definitions(freertos_config INTERFACE
+        HOST_BUILD=1
+        $<$<BOOL:${TICKLESS_IDLE}>:TICKLESS_IDLE=1>
+)
+# Sizes are profiled on target, the host tasks run on pthread stacks
+if (STACK_SIZES)
+    message(WARNING "STACK_SIZES is ignored by the host build, sizes measured on target do not apply to it")
+endif ()
+
+set(FREERTOS_PORT GCC_POSIX CACHE STRING "" FORCE)
+set(FREERTOS_HEAP 4 CACHE STRING "" FORCE)
+add_subdirectory(${FREERTOS_KERNEL_PATH} FreeRTOS-Kernel)
+
+# Everything the firmware sources need on the host
+add_library(host_hal STATIC
+        ${CMAKE_CURRENT_LIST_DIR}/hal_host.c
+        ${CMAKE_CURRENT_LIST_DIR}/board_host.c
+        ${CMAKE_CURRENT_LIST_DIR}/console_port_host.c
+        ${CMAKE_CURRENT_LIST_DIR}/hd44780_sim.c
+        ${CMAKE_CURRENT_LIST_DIR}/hd44780_bus_host.c
+        ${CMAKE_CURRENT_LIST_DIR}/input_host.c
+        ${CMAKE_CURRENT_LIST_DIR}/mfrc522_sim.c
+        ${CMAKE_CURRENT_LIST_DIR}/mfrc522_spi_host.c
+)
+target_include_directories(host_hal PUBLIC
+        ${CMAKE_CURRENT_LIST_DIR}/..
+        ${CMAKE_CURRENT_LIST_DIR}
+)
+target_link_libraries(host_hal PUBLIC freertos_kernel freertos_config pthread)
+
+# Cards allowed in, compiled into a flash table by tools/cred_index_gen.py
+find_package(Python3 REQUIRED COMPONENTS Interpreter)
+add_custom_command(OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/credentials.c
+        COMMAND ${Python3_EXECUTABLE} ${CMAKE_CURRENT_LIST_DIR}/../../tools/cred_index_gen.py
+                -o ${CMAKE_CURRENT_BINARY_DIR}/credentials.c ${CMAKE_CURRENT_LIST_DIR}/../credentials.txt
+        DEPENDS ${CMAKE_CURRENT_LIST_DIR}/../../tools/cred_index_gen.py ${CMAKE_CURRENT_LIST_DIR}/../credentials.txt
+        VERBATIM
+)
+
+# Sources shared by every firmware image, the PIO backend is modeled by
+# hd44780_bus_host.c, the SPI one of the reader by mfrc522_spi_host.c and
+# the GPIO one of the inputs by input_host.c
+set(HOST_FIRMWARE_SOURCES
+        ${CMAKE_CURRENT_BINARY_DIR}/credentials.c
+        ${CMAKE_CURRENT_LIST_DIR}/../clock_widget.c
+        ${CMAKE_CURRENT_LIST_DIR}/../common.c
+        ${CMAKE_CURRENT_LIST_DIR}/../console.c
+        ${CMAKE_CURRENT_LIST_DIR}/../cred_index.c
+        ${CMAKE_CURRENT_LIST_DIR}/../dlog.c
+        ${CMAKE_CURRENT_LIST_DIR}/../hd44780.c
+        ${CMAKE_CURRENT_LIST_DIR}/../hd44780_bus.c
+        ${CMAKE_CURRENT_LIST_DIR}/../hd44780_fb.c
+        ${CMAKE_CURRENT_LIST_DIR}/../hd44780_glyph.c
+        ${CMAKE_CURRENT_LIST_DIR}/../hd44780_multi.c
+        ${CMAKE_CURRENT_LIST_DIR}/../hd44780_scroll.c
+        ${CMAKE_CURRENT_LIST_DIR}/../input.c
+        ${CMAKE_CURRENT_LIST_DIR}/../lcd_fmt.c
+        ${CMAKE_CURRENT_LIST_DIR}/../mfrc522.c
+        ${CMAKE_CURRENT_LIST_DIR}/../periodic.c
+        ${CMAKE_CURRENT_LIST_DIR}/../pool.c
+        ${CMAKE_CURRENT_LIST_DIR}/../render.c
+        ${CMAKE_CURRENT_LIST_DIR}/../spsc.c
+        ${CMAKE_CURRENT_LIST_DIR}/../stack_profile.c
+        ${CMAKE_CURRENT_LIST_DIR}/../tickless.c
+        ${CMAKE_CURRENT_LIST_DIR}/../timekeeper.c
+        ${CMAKE_CURRENT_LIST_DIR}/../trace.c
+)
+
+set(HOST_WARNING_OPTIONS
+        $<$<COMPILE_LANG_AND_ID:C,Clang,GNU>:-Wall>
+        $<$<COMPILE_LANG_AND_ID:C,Clang,GNU>:-Wextra>
+        $<$<COMPILE_LANG_AND_ID:C,Clang,GNU>:-Werror>
+        $<$<COMPILE_LANG_AND_ID:CXX,Clang,GNU>:-Wall>
+        $<$<COMPILE_LANG_AND_ID:CXX,Clang,GNU>:-Wextra>
+        $<$<COMPILE_LANG_AND_ID:CXX,Clang,GNU>:-Werror>
+)
+
+# Bench image `name`_host: SOURCES and bench.c over the firmware sources,
+# DEFINITIONS on top, entry point included
+function(add_host_bench name)
+    cmake_parse_arguments(BENCH "" "" "SOURCES;DEFINITIONS" ${ARGN})
+
+    add_executable(${name}_host
+            ${BENCH_SOURCES}
+            ${CMAKE_CURRENT_LIST_DIR}/../bench.c
+            ${HOST_FIRMWARE_SOURCES}
+    )
+
+    target_compile_definitions(${name}_host PRIVATE
+            ${BENCH_DEFINITIONS}
+    )
+
+    target_compile_options(${name}_host PUBLIC ${HOST_WARNING_OPTIONS})
+
+    target_link_libraries(${name}_host host_hal)
+endfunction()
+
+# Test `name` for ctest, built as `name`_test_host from SOURCES. It runs
+# main_`name`_test in a task over the firmware sources, or with UNIT runs
+# SOURCES alone with nothing but the headers and pthreads. ARGS are passed
+# on the command line
+function(add_host_test name)
+    cmake_parse_arguments(TEST "UNIT" "" "SOURCES;DEFINITIONS;ARGS" ${ARGN})
+
+    if (TEST_UNIT)
+        add_executable(${name}_test_host
+                ${TEST_SOURCES}
+        )
+
+        target_include_directories(${name}_test_host PRIVATE
+                ${CMAKE_CURRENT_LIST_DIR}/..
+                ${CMAKE_CURRENT_LIST_DIR}
+        )
+
+        target_link_libraries(${name}_test_host pthread)
+    else ()
+        add_executable(${name}_test_host
+                ${TEST_SOURCES}
+                ${HOST_FIRMWARE_SOURCES}
+        )
+
+        list(APPEND TEST_DEFINITIONS mainAPP_ENTRY=main_${name}_test)
+
+        target_link_libraries(${name}_test_host host_hal)
+    endif ()
+
+    target_compile_definitions(${name}_test_host PRIVATE
+            ${TEST_DEFINITIONS}
+    )
+
+    target_compile_options(${name}_test_host PUBLIC ${HOST_WARNING_OPTIONS})
+
+    add_test(NAME ${name} COMMAND ${name}_test_host ${TEST_ARGS})
+endfunction()
+
+add_executable(main_blinky_host
+        ${CMAKE_CURRENT_LIST_DIR}/../main.c
+        ${HOST_FIRMWARE_SOURCES}
+)
+
+target_compile_definitions(main_blinky_host PRIVATE
+        mainCREATE_SIMPLE_BLINKY_DEMO_ONLY=1
+)
+
+target_compile_options(main_blinky_host PUBLIC ${HOST_WARNING_OPTIONS})
+
+target_link_libraries(main_blinky_host host_hal)
+
+set(SRC_DIR ${CMAKE_CURRENT_LIST_DIR}/..)
+
+add_host_bench(lcd_bench SOURCES ${SRC_DIR}/lcd_bench.c DEFINITIONS mainAPP_ENTRY=main_lcd_bench)
+
+add_host_bench(rx_latency_bench SOURCES ${SRC_DIR}/main.c DEFINITIONS
+        mainCREATE_SIMPLE_BLINKY_DEMO_ONLY=1
+        mainMEASURE_RX_LATENCY=1
+        HD44780_CONFIG_COUNTER=1
+        HD44780_CONFIG_MAX_FPS=1000
+)
+
+add_host_bench(spsc_bench SOURCES ${SRC_DIR}/spsc_bench.c DEFINITIONS mainAPP_ENTRY=main_spsc_bench)
+
+add_host_bench(driver_bench SOURCES ${SRC_DIR}/driver_bench.cpp ${SRC_DIR}/hd44780_cpp.cpp DEFINITIONS
+        mainAPP_ENTRY=main_driver_bench
+        HD44780_CONFIG_BUS_PIO=0
+        HD44780_CONFIG_BUS_DELAYS=0
+)
+
+add_host_bench(multi_bench SOURCES ${SRC_DIR}/multi_bench.c DEFINITIONS mainAPP_ENTRY=main_multi_bench)
+
+add_host_bench(clock_bench SOURCES ${SRC_DIR}/clock_bench.c DEFINITIONS mainAPP_ENTRY=main_clock_bench)
+
+add_host_bench(fmt_bench SOURCES ${SRC_DIR}/fmt_bench.c DEFINITIONS mainAPP_ENTRY=main_fmt_bench)
+target_link_options(fmt_bench_host PRIVATE -Wl,-Map=$<TARGET_FILE:fmt_bench_host>.map)
+
+# snprintf() is in the shared glibc here, only lcd_fmt.c shows up
+if (Python3_Interpreter_FOUND)
+    add_custom_command(TARGET fmt_bench_host POST_BUILD
+            COMMAND ${Python3_EXECUTABLE} ${CMAKE_CURRENT_LIST_DIR}/../../tools/ram_report.py --code --objects $<TARGET_FILE:fmt_bench_host>.map
+            VERBATIM
+    )
+endif ()
+
+add_host_bench(render_bench SOURCES ${SRC_DIR}/render_bench.c DEFINITIONS mainAPP_ENTRY=main_render_bench)
+
+add_host_bench(rfid_bench SOURCES ${SRC_DIR}/rfid_bench.c DEFINITIONS mainAPP_ENTRY=main_rfid_bench)
+
+# Lookups in generated credential tables of 1k, 10k and 50k UIDs, both layouts
+set(CRED_BENCH_TABLES)
+foreach (count 1000 10000 50000)
+    foreach (layout mph eytzinger)
+        set(table ${CMAKE_CURRENT_BINARY_DIR}/cred_${count}_${layout}.c)
+        add_custom_command(OUTPUT ${table}
+                COMMAND ${Python3_EXECUTABLE} ${CMAKE_CURRENT_LIST_DIR}/../../tools/cred_index_gen.py
+                        --random ${count} --layout ${layout} --name cred_${count}_${layout} -o ${table}
+                DEPENDS ${CMAKE_CURRENT_LIST_DIR}/../../tools/cred_index_gen.py
+                VERBATIM
+        )
+        list(APPEND CRED_BENCH_TABLES ${table})
+    endforeach ()
+endforeach ()
+
+add_host_bench(cred_bench SOURCES ${SRC_DIR}/cred_bench.c ${CRED_BENCH_TABLES} DEFINITIONS mainAPP_ENTRY=main_cred_bench)
+
+add_host_bench(log_bench SOURCES ${SRC_DIR}/log_bench.c DEFINITIONS mainAPP_ENTRY=main_log_bench)
+
+add_host_bench(kernel_bench SOURCES ${SRC_DIR}/kernel_bench.c DEFINITIONS mainAPP_ENTRY=main_kernel_bench)
+
+add_host_bench(stack_profile SOURCES ${SRC_DIR}/main.c DEFINITIONS
+        mainCREATE_SIMPLE_BLINKY_DEMO_ONLY=1
+        mainSTACK_PROFILE=1
+        HD44780_CONFIG_COUNTER=1
+        HD44780_CONFIG_MAX_FPS=1000
+)
+
+add_host_bench(input_bench SOURCES ${SRC_DIR}/input_bench.c DEFINITIONS mainAPP_ENTRY=main_input_bench)
+
+# Lock-free ring of spsc.h between two real threads, no kernel involved
+add_host_test(spsc_stress UNIT SOURCES ${CMAKE_CURRENT_LIST_DIR}/spsc_stress.c ARGS 1000000)
+
+# Blocking layer of spsc.h between two tasks of the POSIX port, with the
+# ring kept full and kept empty
+add_host_test(spsc_wait SOURCES ${CMAKE_CURRENT_LIST_DIR}/spsc_wait_test.c)
+
+# Unit tests of the modules that touch no hardware, see host_test.h
+add_host_test(hd44780_bus UNIT SOURCES ${CMAKE_CURRENT_LIST_DIR}/hd44780_bus_test.c ${SRC_DIR}/hd44780_bus.c)
+
+add_host_test(hd44780_fb UNIT SOURCES ${CMAKE_CURRENT_LIST_DIR}/hd44780_fb_test.c ${SRC_DIR}/hd44780_fb.c)
+
+add_host_test(hd44780_glyph UNIT SOURCES ${CMAKE_CURRENT_LIST_DIR}/hd44780_glyph_test.c
+        ${SRC_DIR}/hd44780_glyph.c ${SRC_DIR}/hd44780_fb.c)
+
+# Busy flag polling of hd44780.c on the GPIO bus against the simulator
+add_host_test(hd44780_bf SOURCES ${CMAKE_CURRENT_LIST_DIR}/hd44780_bf_test.c DEFINITIONS
+        HD44780_CONFIG_BUS_PIO=0
+        HD44780_CONFIG_BUSY_FLAG=1
+)
+
+# Fixed block pools of pool.h, in a task for the critical sections
+add_host_test(pool SOURCES ${CMAKE_CURRENT_LIST_DIR}/pool_test.c)
+
+# Number fields of lcd_fmt.h against snprintf()
+add_host_test(lcd_fmt SOURCES ${CMAKE_CURRENT_LIST_DIR}/lcd_fmt_test.c)
+
+# Wall clock of timekeeper.h on a fake counter
+add_host_test(timekeeper SOURCES ${CMAKE_CURRENT_LIST_DIR}/timekeeper_test.c)
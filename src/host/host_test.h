@@ -0,0 +1,40 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+/*
+ * Checks for the host unit tests (*_test.c), registered with CTest and run
+ * by make host-test. A failed check prints where and carries on, the test
+ * exits with failure at the end:
+ *
+ *   TEST_CHECK(n == 2);
+ *   TEST_EQUAL(frame_data(f), 0x5);
+ *   return test_done("hd44780_bus");
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+static unsigned test_checks = 0;
+static unsigned test_failures = 0;
+
+#define TEST_CHECK( cond ) do { \
+        test_checks++; \
+        if(!(cond)) { \
+            test_failures++; \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while(0)
+
+#define TEST_EQUAL( got, want ) do { \
+        const long long test_got_ = (long long)(got); \
+        const long long test_want_ = (long long)(want); \
+        test_checks++; \
+        if(test_got_ != test_want_) { \
+            test_failures++; \
+            printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #got, test_got_, test_want_); \
+        } \
+    } while(0)
+
+static inline int test_done(const char *name) {
+    printf("%s: checks=%u failures=%u\n", name, test_checks, test_failures);
+    return test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+#endif
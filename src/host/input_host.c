@@ -0,0 +1,129 @@
+/*
+ * Host backend of input.h. The tick of the POSIX port is the interrupt
+ * context (hal_host.h): on every tick the edges that are due are applied
+ * to the pins in order, each one entering input_edge_from_isr() with its
+ * own time if the interrupt of its pin is on, then the debounce alarm is
+ * checked. Both resolve to the tick, so the latencies come out up to one
+ * tick longer than on target.
+ *
+ * Edges come from the file named by INPUT_SCRIPT, one per line, in time
+ * order (tools/input_script.py writes them):
+ *   <time_us> <pin> <level>      # from the start of the run
+ * and from input_port_inject(), at the time of the call.
+ */
+#include "input.h"
+#include "hal_host.h"
+
+/* Kernel includes. */
+#include "task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define INPUT_HOST_MAX_EDGES          ( 4096 )
+#define INPUT_HOST_INJECTED           ( 64 )
+
+typedef struct {
+    uint64_t at_us;
+    uint8_t pin;
+    uint8_t level;
+} input_host_edge;
+
+static input_host_edge input_host_script[INPUT_HOST_MAX_EDGES];
+static uint32_t input_host_script_len = 0;
+static uint32_t input_host_script_next = 0;
+
+static input_host_edge input_host_injected[INPUT_HOST_INJECTED];
+static volatile uint32_t input_host_injected_head = 0;
+static volatile uint32_t input_host_injected_tail = 0;
+
+static uint32_t input_host_mask = 0;
+static uint32_t input_host_enabled = 0;
+static uint64_t input_host_alarm_at = UINT64_MAX;
+
+static void load_script(const char *path) {
+    FILE *f = fopen(path, "r");
+    if(f == NULL) {
+        fprintf(stderr, "INPUT_SCRIPT: cannot open %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    char line[128];
+    uint64_t last = 0;
+    while(fgets(line, sizeof(line), f) != NULL) {
+        unsigned long long at;
+        int pin, level;
+        if(sscanf(line, "%llu %d %d", &at, &pin, &level) != 3) { continue; }
+        if(at < last || pin < 0 || pin >= INPUT_MAX_PINS || input_host_script_len == INPUT_HOST_MAX_EDGES) {
+            fprintf(stderr, "INPUT_SCRIPT: bad or out of order edge: %s", line);
+            exit(EXIT_FAILURE);
+        }
+        input_host_script[input_host_script_len++] = (input_host_edge){
+            .at_us = at, .pin = (uint8_t)pin, .level = (uint8_t)(level ? 1 : 0) };
+        last = at;
+    }
+    fclose(f);
+}
+
+static void apply(const input_host_edge *e, BaseType_t *woken) {
+    if(hal_gpio_get(e->pin) == e->level) { return; }
+    hal_host_set_input(e->pin, e->level);
+    if(input_host_enabled & (1u << e->pin)) {
+        input_edge_from_isr(e->pin, e->at_us, woken);
+    }
+}
+
+// The tick handler switches tasks on its own, `woken` is not needed
+static void input_host_tick(void) {
+    const uint64_t now = hal_time_us();
+    BaseType_t woken = pdFALSE;
+
+    while(input_host_script_next < input_host_script_len
+            && input_host_script[input_host_script_next].at_us <= now) {
+        apply(&input_host_script[input_host_script_next++], &woken);
+    }
+    while(input_host_injected_tail != input_host_injected_head) {
+        apply(&input_host_injected[input_host_injected_tail % INPUT_HOST_INJECTED], &woken);
+        input_host_injected_tail++;
+    }
+    if(input_host_alarm_at <= now) {
+        input_host_alarm_at = UINT64_MAX;
+        input_alarm_from_isr(now, &woken);
+    }
+}
+
+void input_port_init(const uint32_t mask) {
+    input_host_mask = mask;
+    for(int pin=0; pin<INPUT_MAX_PINS; pin++) {
+        if(!(mask & (1u << pin))) { continue; }
+        hal_gpio_init(pin);
+        // Pulled up
+        hal_host_set_input(pin, 1);
+    }
+    input_host_enabled = mask;
+
+    const char *script = getenv("INPUT_SCRIPT");
+    if(script) { load_script(script); }
+    hal_host_set_tick_isr(input_host_tick);
+}
+
+void input_port_irq(const int pin, const bool enabled) {
+    if(enabled) {
+        input_host_enabled |= input_host_mask & (1u << pin);
+    } else {
+        input_host_enabled &= ~(1u << pin);
+    }
+}
+
+void input_port_alarm(const uint64_t at_us) {
+    input_host_alarm_at = at_us;
+}
+
+void input_port_inject(const int pin, const int level) {
+    taskENTER_CRITICAL();
+    if(input_host_injected_head - input_host_injected_tail < INPUT_HOST_INJECTED) {
+        input_host_injected[input_host_injected_head % INPUT_HOST_INJECTED] = (input_host_edge){
+            .at_us = hal_time_us(), .pin = (uint8_t)pin, .level = (uint8_t)(level ? 1 : 0) };
+        input_host_injected_head++;
+    }
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,158 @@
+/*
+ * Number fields of lcd_fmt.h against snprintf() of the same value, width and
+ * padding: zero, negatives, INT32_MIN and UINT32_MAX, '0' padding with the
+ * sign first, and the '*' that replaces a number wider than its field, where
+ * printf would have widened it.
+ *
+ *   ./lcd_fmt_test_host
+ */
+#include "lcd_fmt.h"
+#include "host_test.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#define TEST_ROW_SIZE                 ( 41 )
+
+int main_lcd_fmt_test(void);
+
+static const int32_t ints[] = {
+    0, 1, -1, 7, -7, 42, -42, 99999, -99999, 1000000000, INT32_MAX, INT32_MIN + 1, INT32_MIN,
+};
+static const uint32_t uints[] = {
+    0u, 1u, 9u, 10u, 99999u, 1000000000u, 4000000000u, UINT32_MAX - 1u, UINT32_MAX,
+};
+static const int widths[] = { 0, 1, 2, 3, 4, 5, 10, 11, 12 };
+static const char pads[] = { ' ', '0' };
+
+#define ARRAY_SIZE(a) (sizeof(a)/sizeof(a[0]))
+
+// What lcd_fmt must show for snprintf()'s `text` in `width` cells
+static const char *expected(char *text, const int width) {
+    if(width > 0 && strlen(text) > (size_t)width) {
+        memset(text, '*', (size_t)width);
+        text[width] = '\0';
+    }
+    return text;
+}
+
+static void check(const char *what, const char *got, const char *want) {
+    TEST_CHECK(strcmp(got, want) == 0);
+    if(strcmp(got, want) != 0) {
+        printf("  %s: got \"%s\", expected \"%s\"\n", what, got, want);
+    }
+}
+
+static void test_int(void) {
+    char row[TEST_ROW_SIZE], want[TEST_ROW_SIZE], what[64];
+    lcd_fmt f;
+    for(size_t v=0; v<ARRAY_SIZE(ints); v++) {
+        for(size_t w=0; w<ARRAY_SIZE(widths); w++) {
+            for(size_t p=0; p<ARRAY_SIZE(pads); p++) {
+                row[0] = '\0';
+                lcd_fmt_begin(&f, row, sizeof(row), 0);
+                lcd_fmt_int(&f, ints[v], widths[w], pads[p]);
+                lcd_fmt_end(&f);
+                snprintf(want, sizeof(want), pads[p] == '0' ? "%0*" PRId32 : "%*" PRId32, widths[w], ints[v]);
+                snprintf(what, sizeof(what), "int %" PRId32 " width %d pad '%c'", ints[v], widths[w], pads[p]);
+                check(what, row, expected(want, widths[w]));
+            }
+        }
+    }
+}
+
+static void test_uint(void) {
+    char row[TEST_ROW_SIZE], want[TEST_ROW_SIZE], what[64];
+    lcd_fmt f;
+    for(size_t v=0; v<ARRAY_SIZE(uints); v++) {
+        for(size_t w=0; w<ARRAY_SIZE(widths); w++) {
+            for(size_t p=0; p<ARRAY_SIZE(pads); p++) {
+                row[0] = '\0';
+                lcd_fmt_begin(&f, row, sizeof(row), 0);
+                lcd_fmt_uint(&f, uints[v], widths[w], pads[p]);
+                lcd_fmt_end(&f);
+                snprintf(want, sizeof(want), pads[p] == '0' ? "%0*" PRIu32 : "%*" PRIu32, widths[w], uints[v]);
+                snprintf(what, sizeof(what), "uint %" PRIu32 " width %d pad '%c'", uints[v], widths[w], pads[p]);
+                check(what, row, expected(want, widths[w]));
+            }
+        }
+    }
+}
+
+// Doubles hold every value here exactly enough for "%.*f" to round to it
+static void test_fixed(void) {
+    char row[TEST_ROW_SIZE], want[TEST_ROW_SIZE], what[64];
+    lcd_fmt f;
+    for(size_t v=0; v<ARRAY_SIZE(ints); v++) {
+        for(int decimals=1; decimals<=3; decimals++) {
+            double scale = 1.0;
+            for(int i=0; i<decimals; i++) { scale *= 10.0; }
+            for(size_t w=0; w<ARRAY_SIZE(widths); w++) {
+                for(size_t p=0; p<ARRAY_SIZE(pads); p++) {
+                    row[0] = '\0';
+                    lcd_fmt_begin(&f, row, sizeof(row), 0);
+                    lcd_fmt_fixed(&f, ints[v], decimals, widths[w], pads[p]);
+                    lcd_fmt_end(&f);
+                    snprintf(want, sizeof(want), pads[p] == '0' ? "%0*.*f" : "%*.*f",
+                        widths[w], decimals, (double)ints[v] / scale);
+                    snprintf(what, sizeof(what), "fixed %" PRId32 "/10^%d width %d pad '%c'",
+                        ints[v], decimals, widths[w], pads[p]);
+                    check(what, row, expected(want, widths[w]));
+                }
+            }
+        }
+    }
+}
+
+static void test_hex(void) {
+    char row[TEST_ROW_SIZE], want[TEST_ROW_SIZE], what[64];
+    lcd_fmt f;
+    for(size_t v=0; v<ARRAY_SIZE(uints); v++) {
+        for(int digits=0; digits<=10; digits++) {
+            row[0] = '\0';
+            lcd_fmt_begin(&f, row, sizeof(row), 0);
+            lcd_fmt_hex(&f, uints[v], digits);
+            lcd_fmt_end(&f);
+            // The lowest `digits` of them, printf keeps them all
+            const uint32_t shown = digits > 0 && digits < 8 ? uints[v] & ((1u << (4 * digits)) - 1u) : uints[v];
+            snprintf(want, sizeof(want), "%0*" PRIX32, digits, shown);
+            snprintf(what, sizeof(what), "hex %" PRIu32 " digits %d", uints[v], digits);
+            check(what, row, want);
+        }
+    }
+}
+
+static void test_fields(void) {
+    // Fields after other text, and the row cut at its last cell
+    char row[8] = "ab";
+    lcd_fmt f;
+    lcd_fmt_begin(&f, row, sizeof(row), 3);
+    lcd_fmt_int(&f, -5, 3, '0');
+    lcd_fmt_int(&f, 123, 0, ' ');
+    lcd_fmt_end(&f);
+    check("fields", row, "ab -051");
+}
+
+static void test_task(void *pvParameters) {
+    ( void ) pvParameters;
+
+    test_int();
+    test_uint();
+    test_fixed();
+    test_hex();
+    test_fields();
+
+    fflush(stdout);
+    exit(test_done("lcd_fmt"));
+}
+
+int main_lcd_fmt_test(void) {
+    xTaskCreate(test_task, "TEST", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+    vTaskStartScheduler();
+    for( ;; );
+    return -1;
+}
@@ -0,0 +1,328 @@
+#include "mfrc522_sim.h"
+
+#include <string.h>
+
+#define MFRC522_SIM_VERSION           ( 0x92 )
+// Registers with a reset value other than 0
+#define MFRC522_SIM_COMMAND_RESET     ( 0x20 )
+#define MFRC522_SIM_COM_IEN_RESET     ( 0x80 )
+#define MFRC522_SIM_COM_IRQ_RESET     ( 0x14 )
+#define MFRC522_SIM_CONTROL_RESET     ( 0x10 )
+#define MFRC522_SIM_MODE_RESET        ( 0x3F )
+#define MFRC522_SIM_TX_CONTROL_RESET  ( 0x80 )
+#define MFRC522_SIM_COLL_POS_INVALID  ( 0x20 )
+
+static void reset(mfrc522_sim *sim) {
+    memset(sim->regs, 0, sizeof(sim->regs));
+    sim->regs[MFRC522_REG_COMMAND] = MFRC522_SIM_COMMAND_RESET;
+    sim->regs[MFRC522_REG_COM_IEN] = MFRC522_SIM_COM_IEN_RESET;
+    sim->regs[MFRC522_REG_COM_IRQ] = MFRC522_SIM_COM_IRQ_RESET;
+    sim->regs[MFRC522_REG_CONTROL] = MFRC522_SIM_CONTROL_RESET;
+    sim->regs[MFRC522_REG_MODE] = MFRC522_SIM_MODE_RESET;
+    sim->regs[MFRC522_REG_TX_CONTROL] = MFRC522_SIM_TX_CONTROL_RESET;
+    sim->regs[MFRC522_REG_VERSION] = MFRC522_SIM_VERSION;
+    sim->fifo_len = 0;
+    sim->busy = false;
+    // The field went down with the antenna drivers
+    for(int i=0; i<sim->slot_count; i++) {
+        sim->slots[i].state = MFRC522_SIM_IDLE;
+    }
+}
+
+void mfrc522_sim_init(mfrc522_sim *sim) {
+    memset(sim, 0, sizeof(*sim));
+    reset(sim);
+}
+
+bool mfrc522_sim_add_card(mfrc522_sim *sim, const mfrc522_sim_card *card, const uint64_t in_us, const uint64_t out_us) {
+    if(sim->slot_count == MFRC522_SIM_MAX_CARDS) { return false; }
+    sim->slots[sim->slot_count++] = (mfrc522_sim_slot){ *card, in_us, out_us, MFRC522_SIM_IDLE, 0 };
+    return true;
+}
+
+void mfrc522_sim_clear_cards(mfrc522_sim *sim) {
+    sim->slot_count = 0;
+}
+
+// CRC_A, the sim keeps its own to check the driver's
+static uint16_t crc(const uint8_t *data, const int len, uint16_t preset) {
+    for(int i=0; i<len; i++) {
+        preset ^= data[i];
+        for(int b=0; b<8; b++) {
+            preset = (preset & 1) ? (uint16_t)((preset >> 1) ^ 0x8408) : (uint16_t)(preset >> 1);
+        }
+    }
+    return preset;
+}
+
+static bool crc_ok(mfrc522_sim *sim, const uint8_t *f, const int len) {
+    const uint16_t c = crc(f, len - 2, 0x6363);
+    if(f[len - 2] == (c & 0xFF) && f[len - 1] == (c >> 8)) { return true; }
+    sim->stats.bad_crc++;
+    return false;
+}
+
+// Air time of a frame at 106 kbit/s: start bit, 8 data bits and parity per
+// byte (short frames have no parity), end of frame
+static uint64_t frame_us(const int len, const uint8_t last_bits) {
+    if(len == 0) { return 0; }
+    const uint64_t bits = (uint64_t)(len - 1) * 9 + (last_bits ? last_bits : 9) + 2;
+    return bits * MFRC522_SIM_BIT_NS / 1000;
+}
+
+static uint64_t timer_us(const mfrc522_sim *sim) {
+    const uint64_t prescaler = (uint64_t)(sim->regs[MFRC522_REG_T_MODE] & 0x0F) << 8 | sim->regs[MFRC522_REG_T_PRESCALER];
+    const uint64_t reload = (uint64_t)sim->regs[MFRC522_REG_T_RELOAD_H] << 8 | sim->regs[MFRC522_REG_T_RELOAD_L];
+    // 13.56 MHz / (2 * prescaler + 1) per count
+    return (reload + 1) * (2 * prescaler + 1) * 100 / 1356;
+}
+
+static int levels(const mfrc522_sim_card *card) {
+    return card->uid_size == 4 ? 1 : card->uid_size == 7 ? 2 : 3;
+}
+
+// UID bytes of cascade level `level`, with the cascade tag when more follow
+static void level_part(const mfrc522_sim_card *card, const int level, uint8_t part[4]) {
+    const uint8_t *uid = &card->uid[3 * level];
+    if(level < levels(card) - 1) {
+        part[0] = MFRC522_PICC_CASCADE_TAG;
+        memcpy(&part[1], uid, 3);
+    } else {
+        memcpy(part, uid, 4);
+    }
+}
+
+// One card receiving frame `f`, returns the length of its answer (0: none)
+static int card_answer(mfrc522_sim *sim, mfrc522_sim_slot *s, const uint8_t *f, const int len,
+        const uint8_t last_bits, uint8_t *out) {
+    // Invalid commands send a READY or ACTIVE card back to IDLE, HALT stays
+    const mfrc522_sim_card_state invalid = s->state == MFRC522_SIM_HALT ? MFRC522_SIM_HALT : MFRC522_SIM_IDLE;
+    static const uint8_t sel[3] = { MFRC522_PICC_SEL_CL1, MFRC522_PICC_SEL_CL2, MFRC522_PICC_SEL_CL3 };
+
+    if(len == 1 && last_bits == 7) {
+        const bool reqa = f[0] == MFRC522_PICC_REQA && s->state == MFRC522_SIM_IDLE;
+        const bool wupa = f[0] == MFRC522_PICC_WUPA &&
+            (s->state == MFRC522_SIM_IDLE || s->state == MFRC522_SIM_HALT);
+        if(!reqa && !wupa) {
+            s->state = invalid;
+            return 0;
+        }
+        s->state = MFRC522_SIM_READY;
+        s->level = 0;
+        out[0] = (uint8_t)(s->card.atqa & 0xFF);
+        out[1] = (uint8_t)(s->card.atqa >> 8);
+        return 2;
+    }
+    if(last_bits != 0 || len < 2) {
+        s->state = invalid;
+        return 0;
+    }
+
+    if(s->state == MFRC522_SIM_READY && f[0] == sel[s->level]) {
+        uint8_t part[4];
+        level_part(&s->card, s->level, part);
+        if(len == 2 && f[1] == 0x20) {
+            memcpy(out, part, 4);
+            out[4] = part[0] ^ part[1] ^ part[2] ^ part[3];
+            return 5;
+        }
+        if(len == 9 && f[1] == 0x70 && crc_ok(sim, f, len) && memcmp(&f[2], part, 4) == 0) {
+            if(s->level < levels(&s->card) - 1) {
+                s->level++;
+                out[0] = MFRC522_SAK_UID_INCOMPLETE;
+            } else {
+                s->state = MFRC522_SIM_ACTIVE;
+                out[0] = s->card.sak & (uint8_t)~MFRC522_SAK_UID_INCOMPLETE;
+            }
+            const uint16_t c = crc(out, 1, 0x6363);
+            out[1] = (uint8_t)(c & 0xFF);
+            out[2] = (uint8_t)(c >> 8);
+            return 3;
+        }
+    }
+    if(s->state == MFRC522_SIM_ACTIVE && len == 4 && f[0] == MFRC522_PICC_HLTA && f[1] == 0x00 && crc_ok(sim, f, len)) {
+        s->state = MFRC522_SIM_HALT;
+        return 0;
+    }
+    s->state = invalid;
+    return 0;
+}
+
+static void transceive(mfrc522_sim *sim, const uint64_t now) {
+    const uint8_t last_bits = sim->regs[MFRC522_REG_BIT_FRAMING] & 0x07;
+    const uint64_t tx_us = frame_us(sim->fifo_len, last_bits);
+    const bool field = (sim->regs[MFRC522_REG_TX_CONTROL] & 0x03) == 0x03;
+    uint8_t frame[MFRC522_FIFO_SIZE];
+    const int len = sim->fifo_len;
+    memcpy(frame, sim->fifo, (size_t)len);
+    sim->fifo_len = 0;
+    sim->regs[MFRC522_REG_ERROR] = 0;
+    sim->stats.frames++;
+
+    sim->busy = true;
+    sim->answer_len = 0;
+    sim->answer_last_bits = 0;
+    sim->done_irq = MFRC522_IRQ_TX;
+    sim->done_div_irq = 0;
+    sim->done_error = 0;
+    sim->done_coll = MFRC522_SIM_COLL_POS_INVALID;
+
+    int answers = 0;
+    for(int i=0; field && i<sim->slot_count; i++) {
+        mfrc522_sim_slot *s = &sim->slots[i];
+        if(now < s->in_us || now >= s->out_us) {
+            // Out of the field the card has no power
+            s->state = MFRC522_SIM_IDLE;
+            continue;
+        }
+        uint8_t out[MFRC522_FIFO_SIZE];
+        const int n = card_answer(sim, s, frame, len, last_bits, out);
+        if(n == 0) { continue; }
+        if(answers++ == 0) {
+            memcpy(sim->answer, out, (size_t)n);
+            sim->answer_len = n;
+            continue;
+        }
+        // First bit where this answer differs from the ones before
+        for(int bit=0; bit<n*8 && bit<sim->answer_len*8; bit++) {
+            if(((sim->answer[bit / 8] ^ out[bit / 8]) >> (bit % 8)) & 1) {
+                if(!(sim->done_error & MFRC522_ERR_COLL)) {
+                    sim->done_error |= MFRC522_ERR_COLL;
+                    sim->done_coll = bit + 1 < 32 ? (uint8_t)(bit + 1) : (bit + 1 == 32 ? 0 : MFRC522_SIM_COLL_POS_INVALID);
+                    sim->stats.collisions++;
+                }
+                break;
+            }
+        }
+    }
+
+    if(sim->answer_len > 0) {
+        sim->done_us = now + tx_us + MFRC522_SIM_FDT_US + frame_us(sim->answer_len, 0);
+        sim->done_irq |= MFRC522_IRQ_RX;
+        if(sim->done_error) { sim->done_irq |= MFRC522_IRQ_ERR; }
+        sim->stats.answers++;
+    } else if(sim->regs[MFRC522_REG_T_MODE] & 0x80) {
+        // TAuto: the timer starts at the end of the frame
+        sim->done_us = now + tx_us + timer_us(sim);
+        sim->done_irq |= MFRC522_IRQ_TIMER;
+        sim->stats.timeouts++;
+    } else {
+        // Receiving until the driver stops it
+        sim->done_us = UINT64_MAX;
+    }
+}
+
+static void calc_crc(mfrc522_sim *sim) {
+    static const uint16_t presets[4] = { 0x0000, 0x6363, 0xA671, 0xFFFF };
+    const uint16_t c = crc(sim->fifo, sim->fifo_len, presets[sim->regs[MFRC522_REG_MODE] & 0x03]);
+    sim->regs[MFRC522_REG_CRC_RESULT_H] = (uint8_t)(c >> 8);
+    sim->regs[MFRC522_REG_CRC_RESULT_L] = (uint8_t)(c & 0xFF);
+    sim->regs[MFRC522_REG_DIV_IRQ] |= MFRC522_DIV_IRQ_CRC;
+}
+
+// Apply what completed by `now`
+static void update(mfrc522_sim *sim, const uint64_t now) {
+    if(!sim->busy || now < sim->done_us) { return; }
+    sim->busy = false;
+    memcpy(sim->fifo, sim->answer, (size_t)sim->answer_len);
+    sim->fifo_len = sim->answer_len;
+    sim->regs[MFRC522_REG_CONTROL] = (uint8_t)(MFRC522_SIM_CONTROL_RESET | sim->answer_last_bits);
+    sim->regs[MFRC522_REG_COM_IRQ] |= sim->done_irq;
+    sim->regs[MFRC522_REG_DIV_IRQ] |= sim->done_div_irq;
+    sim->regs[MFRC522_REG_ERROR] |= sim->done_error;
+    sim->regs[MFRC522_REG_COLL] = sim->done_coll;
+}
+
+static bool irq_active(const mfrc522_sim *sim) {
+    return (sim->regs[MFRC522_REG_COM_IRQ] & sim->regs[MFRC522_REG_COM_IEN] & 0x7F) ||
+        (sim->regs[MFRC522_REG_DIV_IRQ] & sim->regs[MFRC522_REG_DIV_IEN] & 0x14);
+}
+
+uint8_t mfrc522_sim_read(mfrc522_sim *sim, const uint8_t reg, const uint64_t now) {
+    update(sim, now);
+    sim->stats.reg_reads++;
+    switch(reg & 0x3F) {
+    case MFRC522_REG_FIFO_DATA: {
+        if(sim->fifo_len == 0) { return 0; }
+        const uint8_t v = sim->fifo[0];
+        memmove(sim->fifo, &sim->fifo[1], (size_t)--sim->fifo_len);
+        return v;
+    }
+    case MFRC522_REG_FIFO_LEVEL:
+        return (uint8_t)sim->fifo_len;
+    case MFRC522_REG_STATUS1:
+        return irq_active(sim) ? 0x10 : 0x00;
+    default:
+        return sim->regs[reg & 0x3F];
+    }
+}
+
+void mfrc522_sim_write(mfrc522_sim *sim, const uint8_t reg, const uint8_t v, const uint64_t now) {
+    update(sim, now);
+    sim->stats.reg_writes++;
+    switch(reg & 0x3F) {
+    case MFRC522_REG_COMMAND:
+        sim->regs[MFRC522_REG_COMMAND] = (sim->regs[MFRC522_REG_COMMAND] & 0xF0) | (v & 0x0F);
+        if((v & 0x0F) == MFRC522_CMD_SOFT_RESET) {
+            reset(sim);
+        } else if((v & 0x0F) == MFRC522_CMD_IDLE) {
+            // Stops whatever was running, nothing more arrives
+            sim->busy = false;
+        } else if((v & 0x0F) == MFRC522_CMD_CALC_CRC) {
+            calc_crc(sim);
+        }
+        break;
+    case MFRC522_REG_COM_IRQ:
+    case MFRC522_REG_DIV_IRQ:
+        // Bit 7 selects whether the marked bits are set or cleared
+        if(v & 0x80) { sim->regs[reg] |= v & 0x7F; }
+        else { sim->regs[reg] &= (uint8_t)~v; }
+        break;
+    case MFRC522_REG_FIFO_DATA:
+        if(sim->fifo_len == MFRC522_FIFO_SIZE) {
+            sim->regs[MFRC522_REG_ERROR] |= MFRC522_ERR_BUFFER_OVFL;
+        } else {
+            sim->fifo[sim->fifo_len++] = v;
+        }
+        break;
+    case MFRC522_REG_FIFO_LEVEL:
+        if(v & MFRC522_FIFO_FLUSH) {
+            sim->fifo_len = 0;
+            sim->regs[MFRC522_REG_ERROR] &= (uint8_t)~MFRC522_ERR_BUFFER_OVFL;
+        }
+        break;
+    case MFRC522_REG_BIT_FRAMING: {
+        const bool start = (v & MFRC522_BIT_FRAMING_START) && !(sim->regs[MFRC522_REG_BIT_FRAMING] & MFRC522_BIT_FRAMING_START);
+        sim->regs[MFRC522_REG_BIT_FRAMING] = v;
+        if(start && (sim->regs[MFRC522_REG_COMMAND] & 0x0F) == MFRC522_CMD_TRANSCEIVE) {
+            transceive(sim, now);
+        }
+        break;
+    }
+    case MFRC522_REG_ERROR:
+    case MFRC522_REG_STATUS1:
+    case MFRC522_REG_CONTROL:
+    case MFRC522_REG_COLL:
+    case MFRC522_REG_VERSION:
+        // Read only
+        break;
+    default:
+        sim->regs[reg & 0x3F] = v;
+        break;
+    }
+}
+
+int mfrc522_sim_irq_level(mfrc522_sim *sim, const uint64_t now) {
+    update(sim, now);
+    const bool inverted = sim->regs[MFRC522_REG_COM_IEN] & 0x80;
+    return irq_active(sim) != inverted;
+}
+
+uint64_t mfrc522_sim_irq_at(mfrc522_sim *sim, const uint64_t now) {
+    update(sim, now);
+    if(irq_active(sim)) { return now; }
+    if(!sim->busy) { return UINT64_MAX; }
+    const bool fires = (sim->done_irq & sim->regs[MFRC522_REG_COM_IEN] & 0x7F) ||
+        (sim->done_div_irq & sim->regs[MFRC522_REG_DIV_IEN] & 0x14);
+    return fires ? sim->done_us : UINT64_MAX;
+}
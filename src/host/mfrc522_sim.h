@@ -0,0 +1,102 @@
+#ifndef MFRC522_SIM_H
+#define MFRC522_SIM_H
+/*
+ * Simulated MFRC522 and ISO/IEC 14443 A cards for the host build.
+ *
+ * The model works at the register level the driver sees over SPI: a 64 byte
+ * FIFO behind FIFODataReg/FIFOLevelReg, the interrupt request registers with
+ * their Set bit, ErrorReg, CollReg, BitFramingReg, the timer and the IRQ pin
+ * (ComIEnReg and its IRqInv bit). Commands: Idle, CalcCRC, Transceive and
+ * SoftReset.
+ *
+ * A Transceive frame reaches every card in the field, each runs the
+ * ISO/IEC 14443-3 state machine (IDLE, READY, ACTIVE, HALT with the
+ * cascade levels of the UID). The answer arrives after the frame time at
+ * 106 kbit/s, the frame delay time and its own frame time; without one the
+ * TimerIRq is set when the timer runs out. Different answers from several
+ * cards set CollErr with the position of the first differing bit.
+ *
+ * Results only show once the virtual clock reached them: every register
+ * access applies what completed by `now`, and mfrc522_sim_irq_at() tells
+ * when the IRQ pin falls next, which the host SPI backend waits for.
+ * Cards are scripted with the time they enter and leave the field.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mfrc522.h"
+
+#define MFRC522_SIM_MAX_CARDS         ( 8 )
+// 128 carrier cycles per bit at 13.56 MHz, in ns
+#define MFRC522_SIM_BIT_NS            ( 9440 )
+// Frame delay time of a card, end of the command to start of the answer
+#define MFRC522_SIM_FDT_US            ( 91 )
+
+typedef enum {
+    MFRC522_SIM_IDLE,
+    MFRC522_SIM_READY,
+    MFRC522_SIM_ACTIVE,
+    MFRC522_SIM_HALT,
+} mfrc522_sim_card_state;
+
+typedef struct {
+    uint8_t uid[MFRC522_UID_MAX];
+    uint8_t uid_size;             // 4, 7 or 10
+    uint16_t atqa;
+    uint8_t sak;                  // Of the last cascade level
+} mfrc522_sim_card;
+
+typedef struct {
+    uint32_t frames;              // Transceive commands started
+    uint32_t answers;
+    uint32_t timeouts;
+    uint32_t collisions;
+    uint32_t bad_crc;             // Frames from the reader with a wrong CRC_A
+    uint32_t reg_reads;
+    uint32_t reg_writes;
+} mfrc522_sim_stats;
+
+typedef struct {
+    mfrc522_sim_card card;
+    uint64_t in_us;               // In the field from
+    uint64_t out_us;              // until
+    mfrc522_sim_card_state state;
+    int level;                    // Cascade level being selected
+} mfrc522_sim_slot;
+
+typedef struct {
+    uint8_t regs[MFRC522_REG_COUNT];
+    uint8_t fifo[MFRC522_FIFO_SIZE];
+    int fifo_len;
+
+    mfrc522_sim_slot slots[MFRC522_SIM_MAX_CARDS];
+    int slot_count;
+
+    // Command running until `done_us`, then its results are applied
+    bool busy;
+    uint64_t done_us;
+    uint8_t answer[MFRC522_FIFO_SIZE];
+    int answer_len;
+    uint8_t answer_last_bits;
+    uint8_t done_irq;             // ComIrqReg bits set on completion
+    uint8_t done_div_irq;
+    uint8_t done_error;
+    uint8_t done_coll;
+
+    mfrc522_sim_stats stats;
+} mfrc522_sim;
+
+// Power on state, no cards
+void mfrc522_sim_init(mfrc522_sim *sim);
+// `card` is in the field from `in_us` until `out_us` (virtual time)
+bool mfrc522_sim_add_card(mfrc522_sim *sim, const mfrc522_sim_card *card, const uint64_t in_us, const uint64_t out_us);
+void mfrc522_sim_clear_cards(mfrc522_sim *sim);
+
+uint8_t mfrc522_sim_read(mfrc522_sim *sim, const uint8_t reg, const uint64_t now);
+void mfrc522_sim_write(mfrc522_sim *sim, const uint8_t reg, const uint8_t v, const uint64_t now);
+
+// Level of the IRQ pin
+int mfrc522_sim_irq_level(mfrc522_sim *sim, const uint64_t now);
+// When the IRQ pin becomes active, `now` if it is, UINT64_MAX if never
+uint64_t mfrc522_sim_irq_at(mfrc522_sim *sim, const uint64_t now);
+#endif
@@ -0,0 +1,69 @@
+/*
+ * SPI backend of mfrc522.h for the host build, every register access goes
+ * straight to the simulated chip of the board (host/mfrc522_sim.c).
+ *
+ * Transfers take their time at 4 MHz like on target: short ones spin the
+ * CPU, DMA sized ones only advance the clock. The IRQ pin needs no
+ * interrupt: the model knows when it falls next and the wait sleeps until
+ * then, or until the timeout if that comes first.
+ */
+#include "mfrc522.h"
+#include "board_host.h"
+#include "hal_host.h"
+
+// 8 bits at 4 MHz
+#define MFRC522_SPI_HOST_BYTE_US      ( 2 )
+#define MFRC522_SPI_HOST_US_PER_TICK  ( 1000000u / configTICK_RATE_HZ )
+
+static void transfer_time(const size_t len) {
+    const uint32_t us = (uint32_t)(len + 1) * MFRC522_SPI_HOST_BYTE_US;
+    if(len < MFRC522_SPI_DMA_MIN) {
+        hal_busy_wait_us(us);
+    } else {
+        hal_host_advance_us(us);
+    }
+}
+
+void mfrc522_spi_init(void) {
+}
+
+void mfrc522_spi_write(const uint8_t reg, const uint8_t *data, const size_t len) {
+    mfrc522_sim *sim = board_host_rfid();
+    transfer_time(len);
+    const uint64_t now = hal_time_us();
+    for(size_t i=0; i<len; i++) {
+        mfrc522_sim_write(sim, reg, data[i], now);
+    }
+}
+
+void mfrc522_spi_read(const uint8_t reg, uint8_t *data, const size_t len) {
+    mfrc522_sim *sim = board_host_rfid();
+    transfer_time(len);
+    const uint64_t now = hal_time_us();
+    for(size_t i=0; i<len; i++) {
+        data[i] = mfrc522_sim_read(sim, reg, now);
+    }
+}
+
+void mfrc522_spi_irq_arm(void) {
+}
+
+bool mfrc522_spi_irq_wait(const TickType_t ticks) {
+    mfrc522_sim *sim = board_host_rfid();
+    const uint64_t now = hal_time_us();
+    const uint64_t at = mfrc522_sim_irq_at(sim, now);
+    const uint64_t limit = now + (uint64_t)ticks * MFRC522_SPI_HOST_US_PER_TICK;
+    const bool fired = at <= limit;
+    const uint64_t until = fired ? at : limit;
+
+    // Whole ticks asleep, the rest as if the edge came in between
+    for(uint64_t t = hal_time_us(); t < until; t = hal_time_us()) {
+        const uint64_t left = until - t;
+        if(left >= MFRC522_SPI_HOST_US_PER_TICK) {
+            vTaskDelay((TickType_t)(left / MFRC522_SPI_HOST_US_PER_TICK));
+        } else {
+            hal_host_advance_us((uint32_t)left);
+        }
+    }
+    return fired;
+}
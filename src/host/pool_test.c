@@ -0,0 +1,92 @@
+/*
+ * Fixed block pools of pool.h: allocation order and counters, exhaustion,
+ * reuse after a free, frees of blocks that are not allocated, and a second
+ * pool_init() that must not register the pool twice.
+ *
+ *   ./pool_test_host
+ */
+#include "pool.h"
+#include "host_test.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define TEST_BLOCKS                   ( 4 )
+
+int main_pool_test(void);
+
+// Odd size, rounded up to pointer alignment
+POOL_DEFINE(test_pool, 5, TEST_BLOCKS);
+
+static void test_task(void *pvParameters) {
+    uint8_t *b[TEST_BLOCKS];
+
+    ( void ) pvParameters;
+    pool_init(&test_pool);
+    TEST_EQUAL(test_pool.block_size, sizeof(void *));
+    const size_t total = pool_total_bytes();
+    TEST_EQUAL(total, TEST_BLOCKS * sizeof(void *));
+
+    // Lowest blocks first, then exhausted
+    for(int i=0; i<TEST_BLOCKS; i++) {
+        b[i] = pool_alloc(&test_pool);
+        TEST_CHECK(b[i] == test_pool.storage + i * test_pool.block_size);
+    }
+    TEST_CHECK(pool_alloc(&test_pool) == NULL);
+    TEST_EQUAL(test_pool.in_use, TEST_BLOCKS);
+    TEST_EQUAL(test_pool.peak, TEST_BLOCKS);
+    TEST_EQUAL(test_pool.allocs, TEST_BLOCKS);
+    TEST_EQUAL(test_pool.failures, 1);
+
+    // The last block freed is the next one handed out
+    pool_free(&test_pool, b[2]);
+    pool_free(&test_pool, b[1]);
+    TEST_EQUAL(test_pool.in_use, TEST_BLOCKS - 2);
+    TEST_CHECK(pool_alloc(&test_pool) == b[1]);
+    TEST_CHECK(pool_alloc(&test_pool) == b[2]);
+    TEST_EQUAL(test_pool.peak, TEST_BLOCKS);
+    pool_free(&test_pool, NULL);
+    TEST_EQUAL(test_pool.bad_frees, 0);
+
+    // Freed twice: the second free is refused, the block goes out once
+    pool_free(&test_pool, b[3]);
+    pool_free(&test_pool, b[3]);
+    TEST_EQUAL(test_pool.bad_frees, 1);
+    TEST_EQUAL(test_pool.in_use, TEST_BLOCKS - 1);
+    TEST_CHECK(pool_alloc(&test_pool) == b[3]);
+    TEST_CHECK(pool_alloc(&test_pool) == NULL);
+
+    // Inside a block
+    pool_free(&test_pool, b[0] + 1);
+    TEST_EQUAL(test_pool.bad_frees, 2);
+    TEST_EQUAL(test_pool.in_use, TEST_BLOCKS);
+
+    // From the ISR variants
+    pool_free_from_isr(&test_pool, b[0]);
+    pool_free_from_isr(&test_pool, b[0]);
+    TEST_EQUAL(test_pool.bad_frees, 3);
+    TEST_CHECK(pool_alloc_from_isr(&test_pool) == b[0]);
+
+    // Again: every block free, registered once
+    pool_init(&test_pool);
+    TEST_EQUAL(pool_total_bytes(), total);
+    TEST_EQUAL(test_pool.in_use, 0);
+    TEST_EQUAL(test_pool.bad_frees, 0);
+    pool_free(&test_pool, b[0]);
+    TEST_EQUAL(test_pool.bad_frees, 1);
+    for(int i=0; i<TEST_BLOCKS; i++) {
+        TEST_CHECK(pool_alloc(&test_pool) == b[i]);
+    }
+    pool_report();
+
+    fflush(stdout);
+    exit(test_done("pool"));
+}
+
+int main_pool_test(void) {
+    xTaskCreate(test_task, "TEST", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+    vTaskStartScheduler();
+    for( ;; );
+    return -1;
+}
@@ -0,0 +1,76 @@
+/*
+ * Stress of the lock-free ring of spsc.h with two real threads.
+ *
+ * The FreeRTOS POSIX port only ever runs one task at a time, so this runs
+ * the producer and the consumer as plain pthreads on different host CPUs,
+ * polling the non blocking API. Every message carries a sequence number and
+ * a payload derived from it; the consumer checks both.
+ *
+ *   ./spsc_stress_host [messages]
+ */
+#include "spsc.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STRESS_DEFAULT_MESSAGES       ( 10000000u )
+#define STRESS_PAYLOAD_WORDS          ( 7 )
+
+typedef struct {
+    uint32_t seq;
+    uint32_t payload[STRESS_PAYLOAD_WORDS];
+} stress_msg;
+
+// Small ring so both full and empty are hit all the time
+SPSC_DEFINE(stress_channel, sizeof(stress_msg), 8);
+
+static uint32_t stress_messages;
+static uint32_t stress_errors;
+
+static uint32_t payload_word(const uint32_t seq, const uint32_t i) {
+    return seq * 2654435761u + i;
+}
+
+static void *producer(void *arg) {
+    (void)arg;
+    for(uint32_t seq=0; seq<stress_messages; seq++) {
+        stress_msg *m;
+        while((m = spsc_reserve(&stress_channel)) == NULL) { sched_yield(); }
+        m->seq = seq;
+        for(uint32_t i=0; i<STRESS_PAYLOAD_WORDS; i++) { m->payload[i] = payload_word(seq, i); }
+        spsc_publish(&stress_channel);
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    (void)arg;
+    for(uint32_t seq=0; seq<stress_messages; seq++) {
+        const stress_msg *m;
+        while((m = spsc_peek(&stress_channel)) == NULL) { sched_yield(); }
+        int bad = m->seq != seq;
+        for(uint32_t i=0; i<STRESS_PAYLOAD_WORDS; i++) { bad |= m->payload[i] != payload_word(seq, i); }
+        if(bad) { stress_errors++; }
+        spsc_consume(&stress_channel);
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    pthread_t p, c;
+
+    stress_messages = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : STRESS_DEFAULT_MESSAGES;
+    pthread_create(&c, NULL, consumer, NULL);
+    pthread_create(&p, NULL, producer, NULL);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+
+    printf("spsc_stress: messages=%lu errors=%lu full=%lu empty=%lu left=%lu\n",
+        (unsigned long)stress_messages, (unsigned long)stress_errors,
+        (unsigned long)stress_channel.full, (unsigned long)stress_channel.empty,
+        (unsigned long)spsc_count(&stress_channel));
+    return (stress_errors || spsc_count(&stress_channel)) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,181 @@
+/*
+ * Blocking layer of spsc.h (spsc.c) under the POSIX port: a producer and a
+ * consumer task move numbered messages through a 4 slot ring, alternating
+ * spsc_send() with spsc_reserve_wait()/spsc_commit() and spsc_receive()
+ * with spsc_peek_wait()/spsc_release() so every pairing meets. Three runs:
+ * - full  : the producer has the higher priority and keeps the ring full,
+ *           it blocks in the reserve and the consumer wakes it
+ * - empty : the consumer has the higher priority and finds the ring empty,
+ *           it blocks in the peek and the producer wakes it
+ * - mixed : same priority, both yield at random so the ring is anywhere
+ * A lost wake up leaves a side blocked and the run times out. Last, each
+ * wait on a full or an empty ring has to give up after its timeout.
+ *
+ *   SPSC_WAIT_MESSAGES=100000 ./spsc_wait_test_host
+ */
+#include "spsc.h"
+#include "host_test.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <string.h>
+
+#define TEST_DEFAULT_MESSAGES         ( 20000u )
+#define TEST_RUN_TIMEOUT_MS           ( 10000 )
+#define TEST_WAIT_TICKS               ( 5 )
+#define TEST_STACK                    ( configMINIMAL_STACK_SIZE * 2 )
+
+typedef struct {
+    uint32_t seq;
+    uint32_t check;
+} test_msg;
+
+typedef struct {
+    const char *name;
+    UBaseType_t producer_priority;
+    UBaseType_t consumer_priority;
+    bool yield;
+} test_run;
+
+int main_spsc_wait_test(void);
+
+SPSC_DEFINE(test_channel, sizeof(test_msg), 4);
+
+static uint32_t test_messages = TEST_DEFAULT_MESSAGES;
+static const test_run *test_current;
+static TaskHandle_t test_main;
+static uint32_t test_sequence_errors;
+static uint32_t test_timeouts;
+
+static uint32_t check_of(const uint32_t seq) {
+    return seq * 2654435761u ^ 0x5a5a5a5au;
+}
+
+// Per task xorshift, decides the API and the yields
+static uint32_t next_random(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void producer_task(void *pvParameters) {
+    uint32_t state = 0x1234567u;
+
+    ( void ) pvParameters;
+    for(uint32_t seq=0; seq<test_messages; seq++) {
+        const test_msg m = { seq, check_of(seq) };
+        if(seq & 1) {
+            test_msg *slot = spsc_reserve_wait(&test_channel, portMAX_DELAY);
+            *slot = m;
+            spsc_commit(&test_channel);
+        } else if(!spsc_send(&test_channel, &m, portMAX_DELAY)) {
+            test_timeouts++;
+        }
+        if(test_current->yield && (next_random(&state) & 3) == 0) { taskYIELD(); }
+    }
+    xTaskNotifyGive(test_main);
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pvParameters) {
+    uint32_t state = 0x89abcdefu;
+
+    ( void ) pvParameters;
+    for(uint32_t seq=0; seq<test_messages; seq++) {
+        test_msg m;
+        // Not in step with the producer, so a slot filled by one API is
+        // read by the other
+        if(next_random(&state) & 1) {
+            const test_msg *slot = spsc_peek_wait(&test_channel, portMAX_DELAY);
+            m = *slot;
+            spsc_release(&test_channel);
+        } else if(!spsc_receive(&test_channel, &m, portMAX_DELAY)) {
+            test_timeouts++;
+            continue;
+        }
+        if(m.seq != seq || m.check != check_of(seq)) { test_sequence_errors++; }
+        if(test_current->yield && (next_random(&state) & 3) == 0) { taskYIELD(); }
+    }
+    xTaskNotifyGive(test_main);
+    vTaskDelete(NULL);
+}
+
+static void run(const test_run *r) {
+    spsc_init(&test_channel);
+    test_current = r;
+    test_sequence_errors = 0;
+    test_timeouts = 0;
+    xTaskCreate(producer_task, "PROD", TEST_STACK, NULL, r->producer_priority, NULL);
+    xTaskCreate(consumer_task, "CONS", TEST_STACK, NULL, r->consumer_priority, NULL);
+
+    uint32_t done = 0;
+    while(done < 2 && ulTaskNotifyTake(pdFALSE, pdMS_TO_TICKS(TEST_RUN_TIMEOUT_MS))) { done++; }
+    printf("%s: sent=%lu received=%lu full=%lu empty=%lu\n", r->name,
+        (unsigned long)test_channel.sent, (unsigned long)test_channel.received,
+        (unsigned long)test_channel.full, (unsigned long)test_channel.empty);
+    if(done < 2) {
+        // A side is stuck, the tasks are left behind
+        printf("%s: timed out after %d ms\n", r->name, TEST_RUN_TIMEOUT_MS);
+        TEST_EQUAL(done, 2);
+        fflush(stdout);
+        exit(test_done("spsc_wait"));
+    }
+    TEST_EQUAL(test_channel.sent, test_messages);
+    TEST_EQUAL(test_channel.received, test_messages);
+    TEST_EQUAL(test_sequence_errors, 0);
+    TEST_EQUAL(test_timeouts, 0);
+    TEST_EQUAL(spsc_count(&test_channel), 0);
+}
+
+// Each wait returns NULL once its ticks have passed, and no earlier
+static void timeouts(void) {
+    test_msg m = { 0, 0 };
+
+    spsc_init(&test_channel);
+    TickType_t start = xTaskGetTickCount();
+    TEST_CHECK(spsc_peek_wait(&test_channel, TEST_WAIT_TICKS) == NULL);
+    TEST_CHECK(xTaskGetTickCount() - start >= TEST_WAIT_TICKS);
+    TEST_CHECK(!spsc_receive(&test_channel, &m, 0));
+    TEST_CHECK(test_channel.consumer_waiting == NULL);
+
+    while(spsc_send(&test_channel, &m, 0)) { m.seq++; }
+    TEST_EQUAL(m.seq, test_channel.mask + 1);
+    start = xTaskGetTickCount();
+    TEST_CHECK(spsc_reserve_wait(&test_channel, TEST_WAIT_TICKS) == NULL);
+    TEST_CHECK(xTaskGetTickCount() - start >= TEST_WAIT_TICKS);
+    TEST_CHECK(test_channel.producer_waiting == NULL);
+}
+
+static void test_task(void *pvParameters) {
+    static const test_run runs[] = {
+        { "full", tskIDLE_PRIORITY + 2, tskIDLE_PRIORITY + 1, false },
+        { "empty", tskIDLE_PRIORITY + 1, tskIDLE_PRIORITY + 2, false },
+        { "mixed", tskIDLE_PRIORITY + 1, tskIDLE_PRIORITY + 1, true },
+    };
+
+    ( void ) pvParameters;
+    test_main = xTaskGetCurrentTaskHandle();
+    for(size_t i=0; i<sizeof(runs) / sizeof(runs[0]); i++) {
+        run(&runs[i]);
+        // Each side has to have waited where the run is meant to make it
+        if(strcmp(runs[i].name, "full") == 0) { TEST_CHECK(test_channel.full > 0); }
+        if(strcmp(runs[i].name, "empty") == 0) { TEST_CHECK(test_channel.empty > 0); }
+    }
+    timeouts();
+
+    fflush(stdout);
+    exit(test_done("spsc_wait"));
+}
+
+int main_spsc_wait_test(void) {
+    const char *messages = getenv("SPSC_WAIT_MESSAGES");
+    if(messages) { test_messages = (uint32_t)strtoul(messages, NULL, 0); }
+    xTaskCreate(test_task, "TEST", TEST_STACK, NULL, tskIDLE_PRIORITY + 3, NULL);
+    vTaskStartScheduler();
+    for( ;; );
+    return -1;
+}
@@ -0,0 +1,164 @@
+/*
+ * Wall clock of timekeeper.h on a fake counter the test moves by hand:
+ * - the default epoch until set, then the time set plus the counter time
+ * - a second set at least TIMEKEEPER_DISCIPLINE_MIN_S later measures the
+ *   drift and corrects the rate, sooner or implausible ones do not
+ * - timekeeper_set_drift_ppb() keeps the current time
+ * - timekeeperTask publishes one second event per new second
+ * - timekeeper_split() and timekeeper_join() round trip
+ *
+ *   ./timekeeper_test_host
+ */
+#include "timekeeper.h"
+#include "host_test.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define TEST_US_PER_S                 ( 1000000ull )
+// 2024-02-29 12:34:56 UTC
+#define TEST_LEAP_DAY_S               ( 1709210096ull )
+// Counter fast by 100 ppm
+#define TEST_DRIFT_PPB                ( 100000 )
+#define TEST_EVENT_TICKS              ( pdMS_TO_TICKS( 1000 ) )
+
+int main_timekeeper_test(void);
+
+static uint64_t fake_us = 0;
+
+static uint64_t fake_counter(void) {
+    return fake_us;
+}
+
+static void wall_time(void) {
+    timekeeper_init(fake_counter);
+    TEST_EQUAL(timekeeper_now_s(), TIMEKEEPER_DEFAULT_EPOCH);
+    fake_us += 1500000;
+    TEST_EQUAL(timekeeper_now_us(), TIMEKEEPER_DEFAULT_EPOCH * TEST_US_PER_S + 1500000);
+
+    const uint64_t set = TEST_LEAP_DAY_S * TEST_US_PER_S;
+    timekeeper_set_us(set);
+    TEST_EQUAL(timekeeper_now_us(), set);
+    fake_us += 250;
+    TEST_EQUAL(timekeeper_now_us(), set + 250);
+
+    timekeeper_stats stats;
+    timekeeper_get_stats(&stats);
+    TEST_EQUAL(stats.sets, 1);
+    TEST_EQUAL(stats.disciplines, 0);
+    TEST_EQUAL(stats.last_error_us, (int64_t)(TIMEKEEPER_DEFAULT_EPOCH * TEST_US_PER_S + 1500000 - set));
+}
+
+static void discipline(void) {
+    timekeeper_stats stats;
+    const uint64_t start = TEST_LEAP_DAY_S * TEST_US_PER_S;
+
+    timekeeper_init(fake_counter);
+    timekeeper_set_us(start);
+
+    // Too soon to say anything about the drift
+    fake_us += (TIMEKEEPER_DISCIPLINE_MIN_S - 1) * TEST_US_PER_S;
+    timekeeper_set_us(start + (TIMEKEEPER_DISCIPLINE_MIN_S - 1) * TEST_US_PER_S - 900);
+    timekeeper_get_stats(&stats);
+    TEST_EQUAL(stats.disciplines, 0);
+    TEST_EQUAL(stats.drift_ppb, 0);
+
+    // 100 s of reference on 100.01 s of counter
+    const uint64_t base = timekeeper_now_us();
+    fake_us += 100 * TEST_US_PER_S + 10000;
+    timekeeper_set_us(base + 100 * TEST_US_PER_S);
+    timekeeper_get_stats(&stats);
+    TEST_EQUAL(stats.disciplines, 1);
+    TEST_EQUAL(stats.drift_ppb, TEST_DRIFT_PPB);
+    TEST_EQUAL(stats.last_error_us, 10000);
+
+    // Corrected from here on, 100 s of counter are 99.99 s
+    const uint64_t wall = timekeeper_now_us();
+    fake_us += 100 * TEST_US_PER_S;
+    TEST_EQUAL(timekeeper_now_us() - wall, 100 * TEST_US_PER_S - 10000);
+
+    // A jump of an hour is a wrong time set right, not drift
+    fake_us += 100 * TEST_US_PER_S;
+    timekeeper_set_us(timekeeper_now_us() + 3600 * TEST_US_PER_S);
+    timekeeper_get_stats(&stats);
+    TEST_EQUAL(stats.disciplines, 1);
+    TEST_EQUAL(stats.drift_ppb, TEST_DRIFT_PPB);
+
+    // A new rate from now on, the time stays
+    const uint64_t before = timekeeper_now_us();
+    timekeeper_set_drift_ppb(0);
+    TEST_EQUAL(timekeeper_now_us(), before);
+    fake_us += 10 * TEST_US_PER_S;
+    TEST_EQUAL(timekeeper_now_us(), before + 10 * TEST_US_PER_S);
+}
+
+// The task wakes early on every set and looks at the second again
+static void seconds(void) {
+    timekeeper_stats stats;
+
+    timekeeper_init(fake_counter);
+    timekeeper_set_us(TEST_LEAP_DAY_S * TEST_US_PER_S);
+    TEST_CHECK(timekeeper_subscribe(NULL));
+    xTaskCreate(timekeeperTask, "TIME", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL);
+    // It takes the current second as the last one published
+    vTaskDelay(2);
+
+    for(int i=0; i<3; i++) {
+        fake_us += TEST_US_PER_S;
+        timekeeper_set_us(timekeeper_now_us());
+        uint32_t events = 0;
+        const TickType_t start = xTaskGetTickCount();
+        while(!(events & TIMEKEEPER_EVENT_SECOND) && xTaskGetTickCount() - start < TEST_EVENT_TICKS) {
+            events |= timekeeper_wait(TEST_EVENT_TICKS);
+        }
+        TEST_CHECK(events & TIMEKEEPER_EVENT_SECOND);
+    }
+    // The same second again: a set event, no second
+    timekeeper_set_us(timekeeper_now_us());
+    TEST_EQUAL(timekeeper_wait(TEST_EVENT_TICKS / 10), TIMEKEEPER_EVENT_SET);
+
+    timekeeper_get_stats(&stats);
+    TEST_EQUAL(stats.seconds, 3);
+}
+
+static void calendar(void) {
+    timekeeper_time t;
+
+    timekeeper_split(TEST_LEAP_DAY_S, &t);
+    TEST_EQUAL(t.year, 2024);
+    TEST_EQUAL(t.month, 2);
+    TEST_EQUAL(t.day, 29);
+    TEST_EQUAL(t.hour, 12);
+    TEST_EQUAL(t.minute, 34);
+    TEST_EQUAL(t.second, 56);
+    TEST_EQUAL(timekeeper_join(&t), TEST_LEAP_DAY_S);
+
+    timekeeper_split(0, &t);
+    TEST_EQUAL(t.year, 1970);
+    TEST_EQUAL(t.month, 1);
+    TEST_EQUAL(t.day, 1);
+    // Four years a day and 1:01:01 apart, leap day and year ends included
+    for(uint64_t s=TIMEKEEPER_DEFAULT_EPOCH; s<TIMEKEEPER_DEFAULT_EPOCH + 4 * 366 * 86400ull; s+=86400 + 3661) {
+        timekeeper_split(s, &t);
+        TEST_EQUAL(timekeeper_join(&t), s);
+    }
+}
+
+static void test_task(void *pvParameters) {
+    ( void ) pvParameters;
+    wall_time();
+    discipline();
+    calendar();
+    seconds();
+
+    fflush(stdout);
+    exit(test_done("timekeeper"));
+}
+
+int main_timekeeper_test(void) {
+    xTaskCreate(test_task, "TEST", configMINIMAL_STACK_SIZE * 2, NULL, tskIDLE_PRIORITY + 1, NULL);
+    vTaskStartScheduler();
+    for( ;; );
+    return -1;
+}
@@ -0,0 +1,260 @@
+#include "input.h"
+#include "hal.h"
+
+/* Kernel includes. */
+#include "task.h"
+#include "timers.h"
+
+/* Library includes. */
+#include <stdio.h>
+
+static input *input_list = NULL;
+static uint16_t input_count = 0;
+// Interrupt lookup, one input per pin
+static input *input_by_pin[INPUT_MAX_PINS];
+
+static input_handler input_on_event = NULL;
+static void *input_on_event_ctx = NULL;
+
+// Filled by the interrupts, drained by the timer task
+static input_event input_queue[INPUT_QUEUE_LENGTH];
+static uint32_t input_head = 0;
+static uint32_t input_used = 0;
+static uint8_t input_pending = 0;
+
+// Quadrature steps by previous A:B and current A:B, forward is 00 01 11 10
+static const int8_t input_quadrature[16] = {
+     0, +1, -1,  0,
+    -1,  0,  0, +1,
+    +1,  0,  0, -1,
+     0, -1, +1,  0,
+};
+#define INPUT_ENCODER_REST            ( 3 )
+
+static uint32_t bucket(const uint32_t us) {
+    const uint32_t b = us ? 32u - (uint32_t)__builtin_clz(us) : 0;
+    return b < INPUT_BUCKETS ? b : INPUT_BUCKETS - 1;
+}
+
+static uint32_t since(const uint64_t now, const uint64_t then) {
+    if(now <= then) { return 0; }
+    const uint64_t d = now - then;
+    return d > UINT32_MAX ? UINT32_MAX : (uint32_t)d;
+}
+
+// Active low, pulled up
+static uint8_t pressed(const int pin) {
+    return hal_gpio_get(pin) ? 0 : 1;
+}
+
+static uint8_t encoder_state(const input *in) {
+    return (uint8_t)((hal_gpio_get(in->pin_a) ? 2u : 0u) | (hal_gpio_get(in->pin_b) ? 1u : 0u));
+}
+
+void input_add(input *in) {
+    configASSERT( in->pin_a < INPUT_MAX_PINS && in->pin_b < INPUT_MAX_PINS );
+    configASSERT( input_by_pin[in->pin_a] == NULL && input_by_pin[in->pin_b] == NULL );
+    in->level = 0;
+    in->settling = 0;
+    in->phase = 0;
+    in->stats = (input_stats){ 0 };
+
+    taskENTER_CRITICAL();
+    in->id = input_count++;
+    input_by_pin[in->pin_a] = in;
+    input_by_pin[in->pin_b] = in;
+    in->next_input = input_list;
+    input_list = in;
+    taskEXIT_CRITICAL();
+}
+
+// Called locked, true when the timer task has to be asked to deliver
+static bool enqueue(input *in, const uint8_t type, const int8_t steps, const uint64_t edge_us,
+        const uint64_t now) {
+    if(type == INPUT_TURN && input_used) {
+        input_event *last = &input_queue[(input_head + input_used - 1) % INPUT_QUEUE_LENGTH];
+        const int32_t sum = last->steps + steps;
+        if(last->source == in && last->type == INPUT_TURN && sum >= INT8_MIN && sum <= INT8_MAX) {
+            last->steps = (int8_t)sum;
+            return false;
+        }
+    }
+    if(input_used == INPUT_QUEUE_LENGTH) {
+        in->stats.dropped++;
+        return false;
+    }
+    input_event *e = &input_queue[(input_head + input_used) % INPUT_QUEUE_LENGTH];
+    e->source = in;
+    e->type = type;
+    e->steps = steps;
+    e->edge_us = edge_us;
+    e->queued_us = now;
+    input_used++;
+    if(input_pending) { return false; }
+    input_pending = 1;
+    return true;
+}
+
+static void deliver(void *unused, uint32_t unused2);
+
+static void pend_from_isr(BaseType_t *woken) {
+    if(xTimerPendFunctionCallFromISR(deliver, NULL, 0, woken) == pdPASS) { return; }
+    // Timer queue full: the next event asks again
+    const UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    input_pending = 0;
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+}
+
+// Timer task, drains everything queued until now
+static void deliver(void *unused, uint32_t unused2) {
+    ( void ) unused;
+    ( void ) unused2;
+    for( ;; ) {
+        input_event e;
+        taskENTER_CRITICAL();
+        if(input_used == 0) {
+            input_pending = 0;
+            taskEXIT_CRITICAL();
+            return;
+        }
+        e = input_queue[input_head];
+        input_head = (input_head + 1) % INPUT_QUEUE_LENGTH;
+        input_used--;
+        taskEXIT_CRITICAL();
+
+        const uint64_t now = hal_time_us();
+        const uint32_t latency = since(now, e.edge_us);
+        const uint32_t defer = since(now, e.queued_us);
+        input *in = e.source;
+        taskENTER_CRITICAL();
+        in->stats.events++;
+        in->stats.latency[bucket(latency)]++;
+        if(latency > in->stats.max_latency_us) { in->stats.max_latency_us = latency; }
+        if(defer > in->stats.max_defer_us) { in->stats.max_defer_us = defer; }
+        taskEXIT_CRITICAL();
+
+        if(input_on_event) { input_on_event(&e, input_on_event_ctx); }
+    }
+}
+
+// Called locked, the earliest button still settling sets the alarm
+static void rearm(void) {
+    uint64_t at = UINT64_MAX;
+    for(const input *in=input_list; in!=NULL; in=in->next_input) {
+        if(in->settling && in->due_us < at) { at = in->due_us; }
+    }
+    input_port_alarm(at);
+}
+
+static void settle(input *in, const uint64_t now) {
+    input_port_irq(in->pin_a, false);
+    in->settling = 1;
+    in->edge_us = now;
+    in->due_us = now + INPUT_DEBOUNCE_US;
+}
+
+void input_edge_from_isr(const int pin, const uint64_t now, BaseType_t *woken) {
+    if(pin < 0 || pin >= INPUT_MAX_PINS || input_by_pin[pin] == NULL) { return; }
+    input *in = input_by_pin[pin];
+    bool pend = false;
+
+    const UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    in->stats.edges++;
+    if(in->kind == INPUT_BUTTON) {
+        if(!in->settling) {
+            settle(in, now);
+            rearm();
+        }
+    } else {
+        const uint8_t state = encoder_state(in);
+        const uint8_t moved = in->level ^ state;
+        if(moved == 3) {
+            in->stats.rejected++;
+        } else if(moved) {
+            if(in->phase == 0) { in->edge_us = now; }
+            in->phase = (int8_t)(in->phase + input_quadrature[(in->level << 2) | state]);
+        }
+        in->level = state;
+        if(state == INPUT_ENCODER_REST && in->phase) {
+            // Rounded to the nearest detent, a lost edge does not lose the turn
+            const int8_t half = INPUT_TRANSITIONS_PER_DETENT / 2;
+            const int8_t steps = (int8_t)((in->phase + (in->phase > 0 ? half : -half))
+                    / INPUT_TRANSITIONS_PER_DETENT);
+            in->phase = 0;
+            if(steps) { pend = enqueue(in, INPUT_TURN, steps, in->edge_us, now); }
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+
+    if(pend) { pend_from_isr(woken); }
+}
+
+void input_alarm_from_isr(const uint64_t now, BaseType_t *woken) {
+    bool pend = false;
+
+    const UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    for(input *in=input_list; in!=NULL; in=in->next_input) {
+        if(!in->settling || in->due_us > now) { continue; }
+        in->settling = 0;
+        const uint8_t level = pressed(in->pin_a);
+        if(level != in->level) {
+            in->level = level;
+            pend |= enqueue(in, level ? INPUT_PRESS : INPUT_RELEASE, 0, in->edge_us, now);
+        } else {
+            in->stats.rejected++;
+        }
+        // An edge between the sample and here would be lost with the
+        // interrupt off, sample once more
+        input_port_irq(in->pin_a, true);
+        if(pressed(in->pin_a) != in->level) { settle(in, now); }
+    }
+    rearm();
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+
+    if(pend) { pend_from_isr(woken); }
+}
+
+void input_start(input_handler handler, void *ctx) {
+    uint32_t mask = 0;
+    for(const input *in=input_list; in!=NULL; in=in->next_input) {
+        mask |= (1u << in->pin_a) | (1u << in->pin_b);
+    }
+    input_on_event = handler;
+    input_on_event_ctx = ctx;
+    input_port_init(mask);
+
+    // Levels at start are not events
+    taskENTER_CRITICAL();
+    for(input *in=input_list; in!=NULL; in=in->next_input) {
+        in->level = in->kind == INPUT_BUTTON ? pressed(in->pin_a) : encoder_state(in);
+    }
+    taskEXIT_CRITICAL();
+}
+
+void input_get_stats(input *in, input_stats *stats) {
+    taskENTER_CRITICAL();
+    *stats = in->stats;
+    taskEXIT_CRITICAL();
+}
+
+void input_reset(input *in) {
+    taskENTER_CRITICAL();
+    in->stats = (input_stats){ 0 };
+    taskEXIT_CRITICAL();
+}
+
+void input_report(void) {
+    for(input *in=input_list; in!=NULL; in=in->next_input) {
+        input_stats s;
+        input_get_stats(in, &s);
+        printf("INPUT %u %s edges=%lu events=%lu rejected=%lu dropped=%lu"
+               " max_latency_us=%lu max_defer_us=%lu latency=",
+            (unsigned)in->id, in->name, (unsigned long)s.edges, (unsigned long)s.events,
+            (unsigned long)s.rejected, (unsigned long)s.dropped,
+            (unsigned long)s.max_latency_us, (unsigned long)s.max_defer_us);
+        for(uint32_t b=0; b<INPUT_BUCKETS; b++) {
+            printf(b ? ",%lu" : "%lu", (unsigned long)s.latency[b]);
+        }
+        printf("\n");
+    }
+}
@@ -0,0 +1,157 @@
+#ifndef INPUT_H
+#define INPUT_H
+/*
+ * Buttons and quadrature encoders on GPIO interrupts.
+ *
+ * No task polls the pins. Every input pin is pulled up and active low (the
+ * switch or the common of the encoder to ground) and interrupts on both
+ * edges; between two events nothing runs.
+ *
+ * Buttons: the first edge disables the interrupt of the pin and arms a
+ * timer alarm INPUT_DEBOUNCE_US later. The bounces that follow cost
+ * nothing, the alarm samples the settled level, reports a press or a
+ * release if it changed and enables the pin again.
+ *
+ * Encoders: every edge of A or B steps the decoder through the Gray code
+ * table, a bounce on one contact steps back and forth and cancels out, both
+ * bits changing at once is rejected. Back at rest (both pins high) a turn
+ * of whole detents is reported, INPUT_TRANSITIONS_PER_DETENT transitions
+ * each.
+ *
+ * Events are queued from the interrupt and handed to the handler of
+ * input_start() through xTimerPendFunctionCallFromISR(): it runs in the
+ * timer task, at configTIMER_TASK_PRIORITY, and must not block. One pend
+ * drains every event queued meanwhile, a turn queued behind an undelivered
+ * turn of the same encoder is folded into it.
+ *
+ *   INPUT_BUTTON_DEFINE(ok, "OK", 14);
+ *   INPUT_ENCODER_DEFINE(knob, "KNOB", 12, 13);
+ *   input_add(&ok);
+ *   input_add(&knob);
+ *   input_start(on_input, NULL);     // IRQs on the calling core
+ *
+ * The latency of an event runs from its first edge, taken by the interrupt,
+ * to the call of the handler, so a press includes the debounce time.
+ * trace_task() and the console "stats" command print one line per input:
+ *   INPUT <id> <name> edges=.. events=.. rejected=.. dropped=..
+ *         max_latency_us=.. max_defer_us=.. latency=<buckets>
+ * rejected counts button samples that found the level unchanged (a glitch)
+ * and invalid encoder transitions, dropped the events lost to a full queue,
+ * max_defer_us the worst time from the interrupt queuing an event to the
+ * handler. The latency buckets are those of periodic.h: 0us, then
+ * [2^(b-1), 2^b) us.
+ *
+ * The backends are input_gpio.c (GPIO bank 0 interrupt and a hardware
+ * alarm) and host/input_host.c, which replays scripted edges from the tick.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef INPUT_DEBOUNCE_US
+#define INPUT_DEBOUNCE_US             ( 5000 )
+#endif
+#define INPUT_TRANSITIONS_PER_DETENT  ( 4 )
+#define INPUT_QUEUE_LENGTH            ( 16 )
+#define INPUT_MAX_PINS                ( 30 )
+#define INPUT_BUCKETS                 ( 20 ) // Up to 2^18 us, about 262ms
+
+typedef enum {
+    INPUT_BUTTON,
+    INPUT_ENCODER,
+} input_kind;
+
+typedef enum {
+    INPUT_PRESS,
+    INPUT_RELEASE,
+    INPUT_TURN,
+} input_type;
+
+struct input;
+
+typedef struct {
+    struct input *source;
+    uint8_t type;                 // input_type
+    int8_t steps;                 // INPUT_TURN: detents, positive clockwise
+    uint64_t edge_us;             // First edge of the event
+    uint64_t queued_us;           // Queued by the interrupt
+} input_event;
+
+typedef struct {
+    uint32_t edges;               // Interrupts taken
+    uint32_t events;              // Delivered to the handler
+    uint32_t rejected;
+    uint32_t dropped;
+    uint32_t max_latency_us;
+    uint32_t max_defer_us;
+    uint32_t latency[INPUT_BUCKETS];
+} input_stats;
+
+typedef struct input {
+    const char *name;
+    uint8_t kind;                 // input_kind
+    uint8_t pin_a;                // The pin of a button
+    uint8_t pin_b;
+    uint16_t id;
+
+    // Interrupt state
+    uint8_t level;                // Button: 1 pressed, encoder: last A:B
+    uint8_t settling;             // Button: pin off until due_us
+    int8_t phase;                 // Encoder: transitions since the last rest
+    uint64_t edge_us;
+    uint64_t due_us;
+
+    struct input *next_input;
+    input_stats stats;
+} input;
+
+typedef void (*input_handler)(const input_event *event, void *ctx);
+
+#define INPUT_BUTTON_DEFINE( var, input_name, pin )                             \
+    input var = {                                                               \
+        .name = ( input_name ),                                                 \
+        .kind = INPUT_BUTTON,                                                   \
+        .pin_a = ( pin ),                                                       \
+        .pin_b = ( pin ),                                                       \
+    }
+
+#define INPUT_ENCODER_DEFINE( var, input_name, a, b )                           \
+    input var = {                                                               \
+        .name = ( input_name ),                                                 \
+        .kind = INPUT_ENCODER,                                                  \
+        .pin_a = ( a ),                                                         \
+        .pin_b = ( b ),                                                         \
+    }
+
+// Registers an input, before input_start()
+void input_add(input *in);
+// Sets up the pins and their interrupts on the calling core, the scheduler
+// need not run yet
+void input_start(input_handler handler, void *ctx);
+
+void input_get_stats(input *in, input_stats *stats);
+void input_reset(input *in);
+void input_report(void);
+
+// From the interrupts of the backend
+void input_edge_from_isr(const int pin, const uint64_t now, BaseType_t *woken);
+void input_alarm_from_isr(const uint64_t now, BaseType_t *woken);
+
+// Backend: pins of `mask` as pulled up inputs with both edges enabled
+void input_port_init(const uint32_t mask);
+void input_port_irq(const int pin, const bool enabled);
+// Calls input_alarm_from_isr() at `at_us`, right away if it has passed;
+// UINT64_MAX cancels
+void input_port_alarm(const uint64_t at_us);
+// Level the pin reads, as if driven from outside (benchmarks, tests)
+void input_port_inject(const int pin, const int level);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,224 @@
+/*
+ * Press to task latency of the input layer (input.h).
+ *
+ * Built as input_bench (RP2040, results over USB stdio) and input_bench_host.
+ * common.c calls main_input_bench() instead of main_blinky().
+ *
+ * A button on inputbenchBUTTON_PIN and an encoder on inputbenchENCODER_A/B
+ * are registered and the bench task drives their pins through
+ * input_port_inject(): on target the pins are pulled low by their own
+ * output drivers, so nothing may be wired to them; on the host the edges
+ * are replayed on the next tick. Every contact change bounces
+ * inputbenchBOUNCES times, inputbenchBOUNCE_US apart.
+ * - press_latency   : first edge of a press to its handler call, debounce
+ *                     included
+ * - release_latency : the same for the release
+ * - press_defer     : press queued by the debounce alarm to its handler,
+ *                     the cost of the deferral to the timer task
+ * - turn_latency    : first edge of a detent to its handler call
+ * - press_edges     : interrupts taken by the presses and releases, one
+ *                     each: the bounces after the first edge cost none
+ * - idle_edges      : interrupts taken in inputbenchIDLE_MS without input,
+ *                     nothing runs between events
+ */
+
+#include "input.h"
+#include "bench.h"
+#include "hal.h"
+#include "hd44780.h"
+#include "mfrc522.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+
+#define inputbenchTASK_PRIORITY                ( tskIDLE_PRIORITY + 1 )
+
+#define inputbenchBUTTON_PIN                   ( 14 )
+#define inputbenchENCODER_A                    ( 22 )
+#define inputbenchENCODER_B                    ( 26 )
+
+/* Driven as outputs: a pin of the LCD or the reader would fight them. */
+#if ( ( ( 1u << inputbenchBUTTON_PIN ) | ( 1u << inputbenchENCODER_A ) | ( 1u << inputbenchENCODER_B ) ) & \
+      ( HD44780_GPIO_MASK | MFRC522_GPIO_MASK ) ) != 0
+#error inputbench pins overlap the LCD or the MFRC522
+#endif
+
+#define inputbenchPRESSES                      ( 100 )
+#define inputbenchTURNS                        ( 100 )
+#define inputbenchBOUNCES                      ( 3 )
+#define inputbenchBOUNCE_US                    ( 150 )
+// Between two transitions of a detent
+#define inputbenchTRANSITION_US                ( 2000 )
+#define inputbenchIDLE_MS                      ( 1000 / portTICK_PERIOD_MS )
+// Longest wait for an event before it counts as lost
+#define inputbenchTIMEOUT_MS                   ( 100 / portTICK_PERIOD_MS )
+#define inputbenchBUCKET_US                    ( 250 )
+#define inputbenchBUCKETS                      ( 32 )
+// Give the host time to open the USB serial port
+#define inputbenchUSB_SETTLE_MS                ( 2000 / portTICK_PERIOD_MS )
+
+int main_input_bench( void );
+
+static void prvInputBenchTask( void *pvParameters );
+
+static INPUT_BUTTON_DEFINE( xButton, "BUTTON", inputbenchBUTTON_PIN );
+static INPUT_ENCODER_DEFINE( xEncoder, "ENCODER", inputbenchENCODER_A, inputbenchENCODER_B );
+
+static TaskHandle_t xBenchTask = NULL;
+static bench_samples xPress;
+static bench_samples xRelease;
+static bench_samples xDefer;
+static bench_samples xTurn;
+static uint32_t ulLost = 0;
+
+/*-----------------------------------------------------------*/
+
+int main_input_bench( void )
+{
+    printf(" Starting main_input_bench.\n");
+
+    xTaskCreate( prvInputBenchTask, "BENCH", configMINIMAL_STACK_SIZE * 2, NULL, inputbenchTASK_PRIORITY, &xBenchTask );
+    vTaskStartScheduler();
+
+    for( ;; );
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+/* Timer task, right after the event left the queue. */
+static void prvOnInput( const input_event *pxEvent, void *pvContext )
+{
+    const uint64_t ullNow = hal_time_us();
+    const uint32_t ulLatency = ( uint32_t ) ( ullNow - pxEvent->edge_us );
+
+    ( void ) pvContext;
+    switch( pxEvent->type )
+    {
+        case INPUT_PRESS:
+            bench_add( &xPress, ulLatency );
+            bench_add( &xDefer, ( uint32_t ) ( ullNow - pxEvent->queued_us ) );
+            break;
+        case INPUT_RELEASE:
+            bench_add( &xRelease, ulLatency );
+            break;
+        default:
+            bench_add( &xTurn, ulLatency );
+            break;
+    }
+    xTaskNotifyGive( xBenchTask );
+}
+/*-----------------------------------------------------------*/
+
+/* A contact change with its bounces, the last toggle leaves `iLevel`. */
+static void prvChange( const int iPin, const int iLevel )
+{
+    for( uint32_t i = 0; i < inputbenchBOUNCES * 2; i++ )
+    {
+        input_port_inject( iPin, ( i & 1 ) ? !iLevel : iLevel );
+        hal_busy_wait_us( inputbenchBOUNCE_US );
+    }
+    input_port_inject( iPin, iLevel );
+}
+/*-----------------------------------------------------------*/
+
+static void prvAwaitEvent( void )
+{
+    if( ulTaskNotifyTake( pdTRUE, inputbenchTIMEOUT_MS ) == 0 )
+    {
+        ulLost++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasurePresses( void )
+{
+input_stats xStats;
+
+    bench_reset( &xPress );
+    bench_reset( &xRelease );
+    bench_reset( &xDefer );
+    input_reset( &xButton );
+    for( uint32_t i = 0; i < inputbenchPRESSES; i++ )
+    {
+        prvChange( inputbenchBUTTON_PIN, 0 );
+        prvAwaitEvent();
+        prvChange( inputbenchBUTTON_PIN, 1 );
+        prvAwaitEvent();
+    }
+    input_get_stats( &xButton, &xStats );
+
+    bench_report_histogram( "input", "press_latency", "us", &xPress, inputbenchBUCKET_US, inputbenchBUCKETS );
+    bench_report( "input", "press_latency", "us", &xPress );
+    bench_report( "input", "release_latency", "us", &xRelease );
+    bench_report( "input", "press_defer", "us", &xDefer );
+    bench_report_value( "input", "press_edges", "count", xStats.edges );
+    bench_report_value( "input", "press_rejected", "count", xStats.rejected );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureTurns( void )
+{
+/* A:B after each transition of a clockwise detent, from rest at 11. */
+static const uint8_t ucDetent[] = { 2, 0, 1, 3 };
+uint8_t ucLevel = 3;
+
+    bench_reset( &xTurn );
+    input_reset( &xEncoder );
+    for( uint32_t i = 0; i < inputbenchTURNS; i++ )
+    {
+        for( size_t t = 0; t < sizeof( ucDetent ); t++ )
+        {
+            const uint8_t ucMoved = ucLevel ^ ucDetent[ t ];
+            prvChange( ( ucMoved & 2 ) ? inputbenchENCODER_A : inputbenchENCODER_B,
+                       ( ucMoved & 2 ) ? ( ucDetent[ t ] >> 1 ) : ( ucDetent[ t ] & 1 ) );
+            ucLevel = ucDetent[ t ];
+            hal_busy_wait_us( inputbenchTRANSITION_US );
+        }
+        prvAwaitEvent();
+        /* Turns queued back to back would be folded into one event. */
+        vTaskDelay( 2 );
+    }
+
+    bench_report_histogram( "input", "turn_latency", "us", &xTurn, inputbenchBUCKET_US, inputbenchBUCKETS );
+    bench_report( "input", "turn_latency", "us", &xTurn );
+}
+/*-----------------------------------------------------------*/
+
+static void prvInputBenchTask( void *pvParameters )
+{
+input_stats xButtonBefore;
+input_stats xEncoderBefore;
+input_stats xButtonAfter;
+input_stats xEncoderAfter;
+
+    ( void ) pvParameters;
+
+#ifndef HOST_BUILD
+    vTaskDelay( inputbenchUSB_SETTLE_MS );
+#endif
+
+    input_add( &xButton );
+    input_add( &xEncoder );
+    input_start( prvOnInput, NULL );
+
+    prvMeasurePresses();
+    prvMeasureTurns();
+
+    input_get_stats( &xButton, &xButtonBefore );
+    input_get_stats( &xEncoder, &xEncoderBefore );
+    vTaskDelay( inputbenchIDLE_MS );
+    input_get_stats( &xButton, &xButtonAfter );
+    input_get_stats( &xEncoder, &xEncoderAfter );
+    bench_report_value( "input", "idle_edges", "count", ( xButtonAfter.edges - xButtonBefore.edges ) +
+                        ( xEncoderAfter.edges - xEncoderBefore.edges ) );
+    bench_report_value( "input", "debounce", "us", INPUT_DEBOUNCE_US );
+    bench_report_value( "input", "lost", "events", ulLost );
+    input_report();
+
+    bench_done();
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,96 @@
+/*
+ * RP2040 backend of input.h: a raw handler on the GPIO bank 0 interrupt
+ * for the input pins and one hardware alarm for the debounce of every
+ * button. Both interrupts are enabled on the core that calls
+ * input_start().
+ */
+#include "input.h"
+
+/* Kernel includes. */
+#include "task.h"
+
+/* Library includes. */
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/timer.h"
+
+#define INPUT_GPIO_IRQ                ( IO_IRQ_BANK0 )
+#define INPUT_GPIO_EDGES              ( GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL )
+// An alarm set in the past never fires, it goes this far ahead instead
+#define INPUT_GPIO_ALARM_LEAD_US      ( 5 )
+
+static uint32_t input_gpio_mask;
+static uint input_gpio_alarm;
+
+static void input_gpio_irq_handler(void) {
+    const uint64_t now = time_us_64();
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    bool taken = false;
+
+    for(uint pin=0; pin<INPUT_MAX_PINS; pin++) {
+        if(!(input_gpio_mask & (1u << pin))) { continue; }
+        const uint32_t events = gpio_get_irq_event_mask(pin) & INPUT_GPIO_EDGES;
+        if(!events) { continue; }
+        if(!taken) {
+            traceIRQ_ENTER(INPUT_GPIO_IRQ);
+            taken = true;
+        }
+        gpio_acknowledge_irq(pin, events);
+        input_edge_from_isr((int)pin, now, &xHigherPriorityTaskWoken);
+    }
+    if(!taken) { return; }
+    traceIRQ_EXIT(INPUT_GPIO_IRQ);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+static void input_gpio_alarm_callback(uint alarm_num) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    traceIRQ_ENTER(TIMER_IRQ_0 + alarm_num);
+    input_alarm_from_isr(time_us_64(), &xHigherPriorityTaskWoken);
+    traceIRQ_EXIT(TIMER_IRQ_0 + alarm_num);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void input_port_init(const uint32_t mask) {
+    input_gpio_mask = mask;
+    input_gpio_alarm = (uint)hardware_alarm_claim_unused(true);
+    hardware_alarm_set_callback(input_gpio_alarm, input_gpio_alarm_callback);
+
+    for(uint pin=0; pin<INPUT_MAX_PINS; pin++) {
+        if(!(mask & (1u << pin))) { continue; }
+        gpio_init(pin);
+        gpio_set_dir(pin, GPIO_IN);
+        gpio_pull_up(pin);
+    }
+    // The pull-ups settle in well under a microsecond, no edge of their own
+    busy_wait_us_32(10);
+    gpio_add_raw_irq_handler_masked(mask, input_gpio_irq_handler);
+    for(uint pin=0; pin<INPUT_MAX_PINS; pin++) {
+        if(mask & (1u << pin)) { gpio_set_irq_enabled(pin, INPUT_GPIO_EDGES, true); }
+    }
+    irq_set_enabled(INPUT_GPIO_IRQ, true);
+}
+
+void input_port_irq(const int pin, const bool enabled) {
+    // Enabling clears the edges latched while the pin was off
+    gpio_set_irq_enabled((uint)pin, INPUT_GPIO_EDGES, enabled);
+}
+
+void input_port_alarm(const uint64_t at_us) {
+    if(at_us == UINT64_MAX) {
+        hardware_alarm_cancel(input_gpio_alarm);
+        return;
+    }
+    uint64_t at = at_us;
+    // True when the time has passed already, nothing is armed then
+    while(hardware_alarm_set_target(input_gpio_alarm, from_us_since_boot(at))) {
+        at = time_us_64() + INPUT_GPIO_ALARM_LEAD_US;
+    }
+}
+
+void input_port_inject(const int pin, const int level) {
+    // Low is driven, high is left to the pull-up: a pressed switch on the
+    // pin never shorts a driven high
+    gpio_put((uint)pin, 0);
+    gpio_set_dir((uint)pin, level ? GPIO_IN : GPIO_OUT);
+}
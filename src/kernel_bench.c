@@ -0,0 +1,549 @@
+/*
+ * Cost of the kernel primitives on this port.
+ *
+ * Built as kernel_bench (RP2040, results over USB stdio) and
+ * kernel_bench_host. common.c calls main_kernel_bench() instead of
+ * main_blinky().
+ *
+ * Batched metrics time kernelbenchBATCH operations and report the average
+ * per operation over kernelbenchROUNDS batches, in nanoseconds (from the
+ * microsecond timer on target, CLOCK_MONOTONIC on the host):
+ * - context_switch      : two tasks of the same priority on one core taking
+ *                         turns with taskYIELD(), per switch
+ * - <primitive>_same    : give/take round trip to a task on the same core,
+ *                         the request and the answer each through its own
+ *                         object, per round trip
+ * - <primitive>_cross   : the same with the other task on the other core
+ *                         (not on single core builds)
+ * - <lock>_uncontended  : take and give again by one task, per pair
+ * The primitives are a queue, a binary semaphore, a counting semaphore, an
+ * event group, a stream buffer, a queue set in front of a queue and direct
+ * to task notifications.
+ *
+ * Single events are reported in microseconds:
+ * - isr_wake_same/cross : interrupt to the notified task running. On target
+ *                         a timer alarm is armed kernelbenchALARM_US ahead
+ *                         and the latency counts from its target time, the
+ *                         alarm interrupt is taken by core 0. On the host the
+ *                         tick interrupt of the POSIX port notifies the task
+ *                         and stamps the time.
+ * - delay_until_idle    : lateness of kernelbenchPERIOD_MS periodic
+ *                         releases of vTaskDelayUntil() against the ideal
+ *                         grid, nothing else running
+ * - delay_until_loaded  : the same with a busy task of lower priority on
+ *                         every core
+ *
+ * The trace hooks of trace.h stay in, the numbers are those of the firmware.
+ */
+
+#include "bench.h"
+#include "hal.h"
+#ifdef HOST_BUILD
+#include "hal_host.h"
+#endif
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
+#include "stream_buffer.h"
+
+/* Library includes. */
+#include <stdio.h>
+#ifdef HOST_BUILD
+#include <time.h>
+#else
+#include "hardware/timer.h"
+#endif
+
+#define kernelbenchTASK_PRIORITY               ( tskIDLE_PRIORITY + 2 )
+#define kernelbenchLOAD_PRIORITY               ( tskIDLE_PRIORITY + 1 )
+
+#define kernelbenchBATCH                       ( 100 )
+#define kernelbenchROUNDS                      ( 50 )
+#define kernelbenchWAKES                       ( 200 )
+#define kernelbenchALARM_US                    ( 200 )
+#define kernelbenchPERIOD_MS                   ( 5 )
+#define kernelbenchRELEASES                    ( 200 )
+#define kernelbenchBUCKET_US                   ( 2 )
+#define kernelbenchBUCKETS                     ( 20 )
+// Configured for the application, no driver runs in the bench
+#define kernelbenchNOTIFY_INDEX                ( 2 )
+// Give the host time to open the USB serial port
+#define kernelbenchUSB_SETTLE_MS               ( 2000 / portTICK_PERIOD_MS )
+
+#define kernelbenchCORE_BENCH                  ( 1 << 0 )
+#define kernelbenchCORE_OTHER                  ( 1 << 1 )
+
+/* Direction of a round trip: the request to the peer, the answer back. */
+#define kernelbenchREQUEST                     ( 0 )
+#define kernelbenchANSWER                      ( 1 )
+
+int main_kernel_bench( void );
+
+typedef struct
+{
+    const char *pcName;
+    void ( *pxGive )( const BaseType_t xDirection );
+    void ( *pxTake )( const BaseType_t xDirection );
+} Primitive_t;
+
+static void prvKernelBenchTask( void *pvParameters );
+static void prvPeerTask( void *pvParameters );
+static void prvYieldTask( void *pvParameters );
+static void prvLoadTask( void *pvParameters );
+
+static QueueHandle_t xQueues[ 2 ];
+static SemaphoreHandle_t xBinary[ 2 ];
+static SemaphoreHandle_t xCounting[ 2 ];
+static EventGroupHandle_t xEvents;
+static StreamBufferHandle_t xStreams[ 2 ];
+static QueueHandle_t xSetQueues[ 2 ];
+static QueueSetHandle_t xSets[ 2 ];
+static SemaphoreHandle_t xMutex;
+static SemaphoreHandle_t xRecursiveMutex;
+
+static StaticQueue_t xQueueBuffers[ 2 ];
+static StaticSemaphore_t xBinaryBuffers[ 2 ];
+static StaticSemaphore_t xCountingBuffers[ 2 ];
+static StaticEventGroup_t xEventsBuffer;
+static StaticStreamBuffer_t xStreamBuffers[ 2 ];
+static StaticQueue_t xSetQueueBuffers[ 2 ];
+static StaticSemaphore_t xMutexBuffer;
+static StaticSemaphore_t xRecursiveMutexBuffer;
+static uint8_t ucQueueStorage[ 2 ][ sizeof( uint32_t ) ];
+static uint8_t ucStreamStorage[ 2 ][ 4 * sizeof( uint32_t ) + 1 ];
+static uint8_t ucSetQueueStorage[ 2 ][ sizeof( uint32_t ) ];
+
+/* The helper tasks are deleted and created again with the same memory, each
+time after the idle task has let go of it. */
+static StaticTask_t xPeerTaskBuffer;
+static StaticTask_t xLoadTaskBuffers[ configNUM_CORES ];
+static StackType_t xPeerTaskStack[ configMINIMAL_STACK_SIZE ];
+static StackType_t xLoadTaskStacks[ configNUM_CORES ][ configMINIMAL_STACK_SIZE ];
+
+/* The task of each side of a round trip: the bench asks, the peer answers. */
+static TaskHandle_t xTasks[ 2 ];
+
+static bench_samples xSamples;
+
+/* Time stamps of the interrupt side of isr_wake. */
+static volatile BaseType_t xArmed = pdFALSE;
+static volatile uint64_t ullFiredUs;
+
+/*-----------------------------------------------------------*/
+
+int main_kernel_bench( void )
+{
+    printf(" Starting main_kernel_bench.\n");
+
+    for( BaseType_t i = 0; i < 2; i++ )
+    {
+        xQueues[ i ] = xQueueCreateStatic( 1, sizeof( uint32_t ), ucQueueStorage[ i ], &xQueueBuffers[ i ] );
+        xBinary[ i ] = xSemaphoreCreateBinaryStatic( &xBinaryBuffers[ i ] );
+        xCounting[ i ] = xSemaphoreCreateCountingStatic( kernelbenchBATCH, 0, &xCountingBuffers[ i ] );
+        xStreams[ i ] = xStreamBufferCreateStatic( sizeof( ucStreamStorage[ i ] ) - 1, 1, ucStreamStorage[ i ], &xStreamBuffers[ i ] );
+        xSetQueues[ i ] = xQueueCreateStatic( 1, sizeof( uint32_t ), ucSetQueueStorage[ i ], &xSetQueueBuffers[ i ] );
+        /* Queue sets have no static variant in every kernel, this one comes
+        from the heap. */
+        xSets[ i ] = xQueueCreateSet( 1 );
+        ( void ) xQueueAddToSet( xSetQueues[ i ], xSets[ i ] );
+    }
+    xEvents = xEventGroupCreateStatic( &xEventsBuffer );
+    xMutex = xSemaphoreCreateMutexStatic( &xMutexBuffer );
+    xRecursiveMutex = xSemaphoreCreateRecursiveMutexStatic( &xRecursiveMutexBuffer );
+
+    xTaskCreate( prvKernelBenchTask, "BENCH", configMINIMAL_STACK_SIZE * 2, NULL, kernelbenchTASK_PRIORITY, &xTasks[ kernelbenchANSWER ] );
+    vTaskStartScheduler();
+
+    for( ;; );
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPin( TaskHandle_t xTask, const UBaseType_t uxCores )
+{
+#if ( configUSE_CORE_AFFINITY == 1 ) && ( configNUM_CORES > 1 )
+    vTaskCoreAffinitySet( xTask, uxCores );
+#else
+    ( void ) xTask;
+    ( void ) uxCores;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+/* Wall clock, the host virtual clock only advances with the busy waits. */
+static uint64_t prvNowNs( void )
+{
+#ifdef HOST_BUILD
+    struct timespec xNow;
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+    return ( uint64_t ) xNow.tv_sec * 1000000000u + ( uint64_t ) xNow.tv_nsec;
+#else
+    return hal_time_us() * 1000u;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+/* One give or take per primitive. The bench gives kernelbenchREQUEST and
+takes kernelbenchANSWER, the peer the other way round. */
+
+static void prvQueueGive( const BaseType_t xDirection )
+{
+const uint32_t ulItem = 0;
+
+    ( void ) xQueueSend( xQueues[ xDirection ], &ulItem, portMAX_DELAY );
+}
+
+static void prvQueueTake( const BaseType_t xDirection )
+{
+uint32_t ulItem;
+
+    ( void ) xQueueReceive( xQueues[ xDirection ], &ulItem, portMAX_DELAY );
+}
+
+static void prvBinaryGive( const BaseType_t xDirection )
+{
+    ( void ) xSemaphoreGive( xBinary[ xDirection ] );
+}
+
+static void prvBinaryTake( const BaseType_t xDirection )
+{
+    ( void ) xSemaphoreTake( xBinary[ xDirection ], portMAX_DELAY );
+}
+
+static void prvCountingGive( const BaseType_t xDirection )
+{
+    ( void ) xSemaphoreGive( xCounting[ xDirection ] );
+}
+
+static void prvCountingTake( const BaseType_t xDirection )
+{
+    ( void ) xSemaphoreTake( xCounting[ xDirection ], portMAX_DELAY );
+}
+
+static void prvEventsGive( const BaseType_t xDirection )
+{
+    ( void ) xEventGroupSetBits( xEvents, ( EventBits_t ) 1 << xDirection );
+}
+
+static void prvEventsTake( const BaseType_t xDirection )
+{
+    ( void ) xEventGroupWaitBits( xEvents, ( EventBits_t ) 1 << xDirection, pdTRUE, pdTRUE, portMAX_DELAY );
+}
+
+static void prvStreamGive( const BaseType_t xDirection )
+{
+const uint32_t ulItem = 0;
+
+    ( void ) xStreamBufferSend( xStreams[ xDirection ], &ulItem, sizeof( ulItem ), portMAX_DELAY );
+}
+
+static void prvStreamTake( const BaseType_t xDirection )
+{
+uint32_t ulItem;
+
+    ( void ) xStreamBufferReceive( xStreams[ xDirection ], &ulItem, sizeof( ulItem ), portMAX_DELAY );
+}
+
+static void prvSetGive( const BaseType_t xDirection )
+{
+const uint32_t ulItem = 0;
+
+    ( void ) xQueueSend( xSetQueues[ xDirection ], &ulItem, portMAX_DELAY );
+}
+
+static void prvSetTake( const BaseType_t xDirection )
+{
+uint32_t ulItem;
+
+    QueueSetMemberHandle_t xMember = xQueueSelectFromSet( xSets[ xDirection ], portMAX_DELAY );
+    ( void ) xQueueReceive( ( QueueHandle_t ) xMember, &ulItem, 0 );
+}
+
+static void prvNotifyGive( const BaseType_t xDirection )
+{
+    /* The request wakes the peer, the answer the bench. */
+    ( void ) xTaskNotifyGiveIndexed( xTasks[ xDirection ], kernelbenchNOTIFY_INDEX );
+}
+
+static void prvNotifyTake( const BaseType_t xDirection )
+{
+    ( void ) xDirection;
+    ( void ) ulTaskNotifyTakeIndexed( kernelbenchNOTIFY_INDEX, pdTRUE, portMAX_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+static const Primitive_t xPrimitives[] =
+{
+    { "queue", prvQueueGive, prvQueueTake },
+    { "binary_semaphore", prvBinaryGive, prvBinaryTake },
+    { "counting_semaphore", prvCountingGive, prvCountingTake },
+    { "event_group", prvEventsGive, prvEventsTake },
+    { "stream_buffer", prvStreamGive, prvStreamTake },
+    { "queue_set", prvSetGive, prvSetTake },
+    { "notification", prvNotifyGive, prvNotifyTake },
+};
+/*-----------------------------------------------------------*/
+
+/* Answers every request, for the whole measurement, then leaves. */
+static void prvPeerTask( void *pvParameters )
+{
+const Primitive_t *pxPrimitive = ( const Primitive_t * ) pvParameters;
+
+    for( uint32_t i = 0; i < kernelbenchROUNDS * kernelbenchBATCH; i++ )
+    {
+        pxPrimitive->pxTake( kernelbenchREQUEST );
+        pxPrimitive->pxGive( kernelbenchANSWER );
+    }
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureRoundTrip( const Primitive_t *pxPrimitive, const UBaseType_t uxPeerCore, const char *pcSuffix )
+{
+char cMetric[ 40 ];
+
+    xTasks[ kernelbenchREQUEST ] = xTaskCreateStatic( prvPeerTask, "PEER", configMINIMAL_STACK_SIZE, ( void * ) pxPrimitive,
+                                                      kernelbenchTASK_PRIORITY, xPeerTaskStack, &xPeerTaskBuffer );
+    prvPin( xTasks[ kernelbenchREQUEST ], uxPeerCore );
+
+    bench_reset( &xSamples );
+    for( uint32_t r = 0; r < kernelbenchROUNDS; r++ )
+    {
+        const uint64_t ullStart = prvNowNs();
+        for( uint32_t i = 0; i < kernelbenchBATCH; i++ )
+        {
+            pxPrimitive->pxGive( kernelbenchREQUEST );
+            pxPrimitive->pxTake( kernelbenchANSWER );
+        }
+        bench_add( &xSamples, ( uint32_t ) ( ( prvNowNs() - ullStart ) / kernelbenchBATCH ) );
+    }
+
+    /* The peer deletes itself after its last answer, let the idle task take
+    it off its list before the next one reuses the memory. */
+    vTaskDelay( 2 );
+
+    snprintf( cMetric, sizeof( cMetric ), "%s_%s", pxPrimitive->pcName, pcSuffix );
+    bench_report( "kernel", cMetric, "ns", &xSamples );
+}
+/*-----------------------------------------------------------*/
+
+static void prvYieldTask( void *pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ;; )
+    {
+        taskYIELD();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureContextSwitch( void )
+{
+TaskHandle_t xYield;
+
+    xYield = xTaskCreateStatic( prvYieldTask, "YIELD", configMINIMAL_STACK_SIZE, NULL, kernelbenchTASK_PRIORITY,
+                                xPeerTaskStack, &xPeerTaskBuffer );
+    prvPin( xYield, kernelbenchCORE_BENCH );
+
+    /* Every yield here switches to the other task and its yield back. */
+    bench_reset( &xSamples );
+    for( uint32_t r = 0; r < kernelbenchROUNDS; r++ )
+    {
+        const uint64_t ullStart = prvNowNs();
+        for( uint32_t i = 0; i < kernelbenchBATCH; i++ )
+        {
+            taskYIELD();
+        }
+        bench_add( &xSamples, ( uint32_t ) ( ( prvNowNs() - ullStart ) / ( 2 * kernelbenchBATCH ) ) );
+    }
+    vTaskDelete( xYield );
+    vTaskDelay( 2 );
+    bench_report( "kernel", "context_switch", "ns", &xSamples );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureUncontended( const char *pcName, SemaphoreHandle_t xLock, const BaseType_t xRecursive )
+{
+char cMetric[ 40 ];
+
+    bench_reset( &xSamples );
+    for( uint32_t r = 0; r < kernelbenchROUNDS; r++ )
+    {
+        const uint64_t ullStart = prvNowNs();
+        for( uint32_t i = 0; i < kernelbenchBATCH; i++ )
+        {
+            if( xRecursive )
+            {
+                ( void ) xSemaphoreTakeRecursive( xLock, portMAX_DELAY );
+                ( void ) xSemaphoreGiveRecursive( xLock );
+            }
+            else
+            {
+                ( void ) xSemaphoreTake( xLock, portMAX_DELAY );
+                ( void ) xSemaphoreGive( xLock );
+            }
+        }
+        bench_add( &xSamples, ( uint32_t ) ( ( prvNowNs() - ullStart ) / kernelbenchBATCH ) );
+    }
+    snprintf( cMetric, sizeof( cMetric ), "%s_uncontended", pcName );
+    bench_report( "kernel", cMetric, "ns", &xSamples );
+}
+/*-----------------------------------------------------------*/
+
+#ifdef HOST_BUILD
+/* Runs in the tick interrupt of the POSIX port (hal_host.h). The tick
+handler switches tasks on its own when the notification asks for it. */
+static void prvTickInterrupt( void )
+{
+    if( xArmed )
+    {
+        xArmed = pdFALSE;
+        ullFiredUs = prvNowNs() / 1000u;
+        vTaskNotifyGiveIndexedFromISR( xTasks[ kernelbenchANSWER ], kernelbenchNOTIFY_INDEX, NULL );
+    }
+}
+#else
+static void prvAlarmInterrupt( uint alarm_num )
+{
+BaseType_t xWoken = pdFALSE;
+
+    ( void ) alarm_num;
+    traceIRQ_ENTER( TIMER_IRQ_0 + alarm_num );
+    xArmed = pdFALSE;
+    vTaskNotifyGiveIndexedFromISR( xTasks[ kernelbenchANSWER ], kernelbenchNOTIFY_INDEX, &xWoken );
+    traceIRQ_EXIT( TIMER_IRQ_0 + alarm_num );
+    portYIELD_FROM_ISR( xWoken );
+}
+#endif
+/*-----------------------------------------------------------*/
+
+static void prvMeasureIsrWake( const UBaseType_t uxCore, const char *pcMetric )
+{
+#ifndef HOST_BUILD
+    static int iAlarm = -1;
+
+    /* Claimed from core 0, whose NVIC then takes the alarm interrupt. */
+    if( iAlarm < 0 )
+    {
+        iAlarm = hardware_alarm_claim_unused( true );
+        hardware_alarm_set_callback( ( uint ) iAlarm, prvAlarmInterrupt );
+    }
+#else
+    hal_host_set_tick_isr( prvTickInterrupt );
+#endif
+
+    prvPin( xTasks[ kernelbenchANSWER ], uxCore );
+    vTaskDelay( 1 );
+
+    bench_reset( &xSamples );
+    for( uint32_t i = 0; i < kernelbenchWAKES; i++ )
+    {
+        ( void ) ulTaskNotifyTakeIndexed( kernelbenchNOTIFY_INDEX, pdTRUE, 0 );
+#ifdef HOST_BUILD
+        xArmed = pdTRUE;
+#else
+        ullFiredUs = hal_time_us() + kernelbenchALARM_US;
+        xArmed = pdTRUE;
+        ( void ) hardware_alarm_set_target( ( uint ) iAlarm, from_us_since_boot( ullFiredUs ) );
+#endif
+        ( void ) ulTaskNotifyTakeIndexed( kernelbenchNOTIFY_INDEX, pdTRUE, portMAX_DELAY );
+        bench_add( &xSamples, ( uint32_t ) ( prvNowNs() / 1000u - ullFiredUs ) );
+    }
+
+#ifdef HOST_BUILD
+    hal_host_set_tick_isr( NULL );
+#endif
+    prvPin( xTasks[ kernelbenchANSWER ], kernelbenchCORE_BENCH );
+    vTaskDelay( 1 );
+
+    bench_report_histogram( "kernel", pcMetric, "us", &xSamples, kernelbenchBUCKET_US, kernelbenchBUCKETS );
+    bench_report( "kernel", pcMetric, "us", &xSamples );
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoadTask( void *pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ;; )
+    {
+        hal_busy_wait_us( 10 );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureDelayUntil( const char *pcMetric )
+{
+TickType_t xNextWakeTime;
+const uint64_t ullPeriodUs = ( uint64_t ) kernelbenchPERIOD_MS * 1000u;
+
+    bench_reset( &xSamples );
+
+    /* Start on a tick boundary, the grid counts from there. */
+    vTaskDelay( 1 );
+    xNextWakeTime = xTaskGetTickCount();
+    const uint64_t ullStartUs = prvNowNs() / 1000u;
+    for( uint32_t i = 1; i <= kernelbenchRELEASES; i++ )
+    {
+        vTaskDelayUntil( &xNextWakeTime, pdMS_TO_TICKS( kernelbenchPERIOD_MS ) );
+        const uint64_t ullLate = prvNowNs() / 1000u - ullStartUs;
+        const uint64_t ullIdeal = ( uint64_t ) i * ullPeriodUs;
+        bench_add( &xSamples, ullLate > ullIdeal ? ( uint32_t ) ( ullLate - ullIdeal ) : 0 );
+    }
+
+    bench_report_histogram( "kernel", pcMetric, "us", &xSamples, kernelbenchBUCKET_US, kernelbenchBUCKETS );
+    bench_report( "kernel", pcMetric, "us", &xSamples );
+}
+/*-----------------------------------------------------------*/
+
+static void prvKernelBenchTask( void *pvParameters )
+{
+TaskHandle_t xLoad[ configNUM_CORES ];
+
+    ( void ) pvParameters;
+
+    prvPin( xTasks[ kernelbenchANSWER ], kernelbenchCORE_BENCH );
+
+#ifndef HOST_BUILD
+    vTaskDelay( kernelbenchUSB_SETTLE_MS );
+#endif
+
+    prvMeasureContextSwitch();
+
+    for( size_t p = 0; p < sizeof( xPrimitives ) / sizeof( xPrimitives[ 0 ] ); p++ )
+    {
+        prvMeasureRoundTrip( &xPrimitives[ p ], kernelbenchCORE_BENCH, "same" );
+#if ( configNUM_CORES > 1 )
+        prvMeasureRoundTrip( &xPrimitives[ p ], kernelbenchCORE_OTHER, "cross" );
+#endif
+    }
+
+    prvMeasureUncontended( "mutex", xMutex, pdFALSE );
+    prvMeasureUncontended( "recursive_mutex", xRecursiveMutex, pdTRUE );
+
+    prvMeasureIsrWake( kernelbenchCORE_BENCH, "isr_wake_same" );
+#if ( configNUM_CORES > 1 )
+    prvMeasureIsrWake( kernelbenchCORE_OTHER, "isr_wake_cross" );
+#endif
+
+    prvMeasureDelayUntil( "delay_until_idle" );
+    for( UBaseType_t c = 0; c < configNUM_CORES; c++ )
+    {
+        xLoad[ c ] = xTaskCreateStatic( prvLoadTask, "LOAD", configMINIMAL_STACK_SIZE, NULL, kernelbenchLOAD_PRIORITY,
+                                        xLoadTaskStacks[ c ], &xLoadTaskBuffers[ c ] );
+        prvPin( xLoad[ c ], ( UBaseType_t ) 1 << c );
+    }
+    prvMeasureDelayUntil( "delay_until_loaded" );
+    for( UBaseType_t c = 0; c < configNUM_CORES; c++ )
+    {
+        vTaskDelete( xLoad[ c ] );
+    }
+
+    bench_done();
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,320 @@
+/*
+ * LCD throughput and latency benchmark.
+ *
+ * Built as lcd_bench (RP2040, results over USB stdio) and lcd_bench_host
+ * (simulated bus). common.c calls main_lcd_bench() instead of main_blinky().
+ *
+ * The suite measures, through the real driver path (hd44780_fb + bus):
+ * - full_frame   : rewrite of every cell, latency and characters per second
+ * - cell_update  : a single changed cell, the common case of a counter
+ * - cpu_busy     : share of the update time the CPU spends busy waiting
+ * - jitter       : deviation of a 200ms vTaskDelayUntil task from its ideal
+ *                  release, without and (target only) with the LCD being
+ *                  refreshed below it
+ * - glyph        : CGRAM cache over a cycle of Spanish UI screens, hit rate
+ *                  and uploads, overall and once every screen was shown
+ * - scroll       : bus bytes per step of a 40 character marquee, in software
+ *                  on one row of the 16x4 layout and with the display shift
+ *                  on both rows of a 16x2 layout (the same controller with
+ *                  rows 3 and 4 left out)
+ */
+
+#include "hd44780.h"
+#include "bench.h"
+#include "hal.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+#ifdef HOST_BUILD
+#include "board_host.h"
+#endif
+
+#define lcdbenchTASK_PRIORITY                  ( tskIDLE_PRIORITY + 1 )
+#define lcdbenchPERIODIC_TASK_PRIORITY         ( tskIDLE_PRIORITY + 2 )
+
+#define lcdbenchITERATIONS                     ( 50 )
+#define lcdbenchPERIOD_MS                      ( 200 / portTICK_PERIOD_MS )
+#define lcdbenchPERIOD_US                      ( 200000 )
+#define lcdbenchJITTER_PERIODS                 ( 25 )
+#define lcdbenchGLYPH_FRAMES                   ( 100 )
+#define lcdbenchSCROLL_STEPS                   ( 60 )
+// Give the host time to open the USB serial port
+#define lcdbenchUSB_SETTLE_MS                  ( 2000 / portTICK_PERIOD_MS )
+
+int main_lcd_bench( void );
+
+static void prvLcdBenchTask( void *pvParameters );
+static void prvPeriodicTask( void *pvParameters );
+
+/* UI screens, 5 glyphs outside the ROM between them. */
+static const char * const pcScreens[][ NROW ] =
+{
+    { "Menú principal", "> Configuración", "  Información", "  Salir" },
+    { "Configuración", "> Brillo: 80%", "  Idioma: Esp.", "  Atrás" },
+    { "Información", "Versión 1.2", "Temp: 21.5°C", "¿Reiniciar?" },
+    { "¡Atención!", "Batería baja", "Conecte el", "cargador ahora" },
+};
+
+/* One DDRAM line each. */
+static const char pcMarquee[][ 41 ] =
+{
+    "Temperatura 21.5C  Humedad 40%  Viento 8",
+    "Presion 1013 hPa  Lluvia 0 mm  UV bajo 2",
+};
+
+static bench_samples xSamples;
+static bench_samples xJitter;
+static volatile int xJitterDone = 0;
+
+/*-----------------------------------------------------------*/
+
+int main_lcd_bench( void )
+{
+    printf(" Starting main_lcd_bench.\n");
+
+    xTaskCreate( prvLcdBenchTask, "BENCH", configMINIMAL_STACK_SIZE * 2, NULL, lcdbenchTASK_PRIORITY, NULL );
+    vTaskStartScheduler();
+
+    for( ;; );
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFillFrame( const char c )
+{
+    hd44780_frame_lock();
+    for( int r = 0; r < NROW; r++ )
+    {
+        for( int i = 0; i < ROWLENCP; i++ )
+        {
+            hd44780_display_data[ r ][ i ] = c;
+        }
+        hd44780_display_data[ r ][ ROWLENCP ] = '\0';
+    }
+    hd44780_frame_unlock();
+}
+/*-----------------------------------------------------------*/
+
+#ifdef HOST_BUILD
+/* Row `r` of the simulated controller differs from the frame, cells past
+the end of the frame row are blank. */
+static int prvRowWrong( const int r )
+{
+    char cRow[ ROWLEN ];
+    const char *pcWant = hd44780_display_data[ r ];
+    int xEnd = 0;
+
+    hd44780_sim_row( board_host_lcd(), r, ROWLENCP, cRow );
+    for( int c = 0; c < ROWLENCP; c++ )
+    {
+        xEnd = xEnd || ( pcWant[ c ] == '\0' );
+        if( cRow[ c ] != ( xEnd ? ' ' : pcWant[ c ] ) )
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+/*-----------------------------------------------------------*/
+#endif
+
+/* Scroll lcdbenchSCROLL_STEPS steps, reporting the bus bytes of each and
+on the host whether the controller shows the frame. */
+static void prvRunScroll( const char *pcMetric, const hd44780_scroll_mode xMode )
+{
+    char cMetric[ 40 ];
+    uint32_t ulRowsWrong = 0;
+
+    /* The first step loads or draws the texts. */
+    const uint32_t ulLoadBytes = hd44780_shadow.stats.total_data_bytes + hd44780_shadow.stats.total_instructions;
+    scroll_step();
+    configASSERT( hd44780_scroll_mode_of( &hd44780_scroller ) == xMode );
+    snprintf( cMetric, sizeof( cMetric ), "%s_load_bus_bytes", pcMetric );
+    bench_report_value( "lcd", cMetric, "bytes",
+        hd44780_shadow.stats.total_data_bytes + hd44780_shadow.stats.total_instructions - ulLoadBytes );
+
+    bench_reset( &xSamples );
+    for( int i = 0; i < lcdbenchSCROLL_STEPS; i++ )
+    {
+        const uint32_t ulBytes = hd44780_shadow.stats.total_data_bytes + hd44780_shadow.stats.total_instructions;
+        const uint32_t ulShifts = hd44780_scroller.stats.shift_instructions;
+        scroll_step();
+        bench_add( &xSamples, hd44780_shadow.stats.total_data_bytes + hd44780_shadow.stats.total_instructions - ulBytes +
+            hd44780_scroller.stats.shift_instructions - ulShifts );
+#ifdef HOST_BUILD
+        for( int r = 0; r < hd44780_shadow.rows; r++ )
+        {
+            ulRowsWrong += prvRowWrong( r );
+        }
+#endif
+    }
+    snprintf( cMetric, sizeof( cMetric ), "%s_step_bus_bytes", pcMetric );
+    bench_report( "lcd", cMetric, "bytes", &xSamples );
+#ifdef HOST_BUILD
+    snprintf( cMetric, sizeof( cMetric ), "%s_rows_wrong", pcMetric );
+    bench_report_value( "lcd", cMetric, "rows", ulRowsWrong );
+#else
+    ( void ) ulRowsWrong;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunJitter( const char *pcMetric, const int xLoaded )
+{
+    char c = 'a';
+
+    bench_reset( &xJitter );
+    xJitterDone = 0;
+    xTaskCreate( prvPeriodicTask, "PER", configMINIMAL_STACK_SIZE, NULL, lcdbenchPERIODIC_TASK_PRIORITY, NULL );
+
+    while( !xJitterDone )
+    {
+        if( xLoaded )
+        {
+            prvFillFrame( c );
+            c = ( c == 'z' ) ? 'a' : c + 1;
+            display_frame();
+        }
+        else
+        {
+            vTaskDelay( lcdbenchPERIOD_MS );
+        }
+    }
+    bench_report( "lcd", pcMetric, "us", &xJitter );
+}
+/*-----------------------------------------------------------*/
+
+static void prvLcdBenchTask( void *pvParameters )
+{
+TickType_t xNextWakeTime;
+uint64_t ullTotalUs = 0, ullBusyUs = 0, ullChars = 0, ullBytes = 0, ullInstructions = 0;
+
+    ( void ) pvParameters;
+
+#ifndef HOST_BUILD
+    vTaskDelay( lcdbenchUSB_SETTLE_MS );
+#endif
+
+    xNextWakeTime = xTaskGetTickCount();
+    hd44780_init( &xNextWakeTime );
+
+    /* Every cell changes on every iteration. */
+    bench_reset( &xSamples );
+    for( int i = 0; i < lcdbenchITERATIONS; i++ )
+    {
+        prvFillFrame( ( char ) ( 'A' + ( i % 26 ) ) );
+        const uint64_t ullStart = hal_time_us();
+        const uint64_t ullBusy = hal_busy_us();
+        display_frame();
+        const uint64_t ullTime = hal_time_us() - ullStart;
+        bench_add( &xSamples, ( uint32_t ) ullTime );
+        ullTotalUs += ullTime;
+        ullBusyUs += hal_busy_us() - ullBusy;
+        ullChars += hd44780_shadow.stats.data_bytes;
+        ullInstructions += hd44780_shadow.stats.instructions;
+    }
+    bench_report( "lcd", "full_frame", "us", &xSamples );
+    bench_report_value( "lcd", "chars_per_s", "chars/s", ullTotalUs ? ( ullChars * 1000000 ) / ullTotalUs : 0 );
+    bench_report_value( "lcd", "full_frame_instructions", "instructions", ullInstructions / lcdbenchITERATIONS );
+    bench_report_value( "lcd", "full_frame_cpu_busy", "%", ullTotalUs ? ( ullBusyUs * 100 ) / ullTotalUs : 0 );
+
+    /* Only the last cell changes. */
+    bench_reset( &xSamples );
+    ullTotalUs = 0;
+    ullBusyUs = 0;
+    for( int i = 0; i < lcdbenchITERATIONS; i++ )
+    {
+        hd44780_frame_lock();
+        hd44780_display_data[ NROW - 1 ][ ROWLENCP - 1 ] = ( char ) ( '0' + ( i % 10 ) );
+        hd44780_frame_unlock();
+        const uint64_t ullStart = hal_time_us();
+        const uint64_t ullBusy = hal_busy_us();
+        display_frame();
+        const uint64_t ullTime = hal_time_us() - ullStart;
+        bench_add( &xSamples, ( uint32_t ) ullTime );
+        ullTotalUs += ullTime;
+        ullBusyUs += hal_busy_us() - ullBusy;
+        ullBytes += hd44780_shadow.stats.data_bytes + hd44780_shadow.stats.instructions;
+    }
+    bench_report( "lcd", "cell_update", "us", &xSamples );
+    bench_report_value( "lcd", "cell_update_bus_bytes", "bytes", ullBytes / lcdbenchITERATIONS );
+    bench_report_value( "lcd", "cell_update_cpu_busy", "%", ullTotalUs ? ( ullBusyUs * 100 ) / ullTotalUs : 0 );
+
+    /* Cycle through the UI screens, the first round fills the cache. */
+    const uint32_t ulScreens = sizeof( pcScreens ) / sizeof( pcScreens[ 0 ] );
+    hd44780_glyph_stats xFirstRound = { 0 };
+    hd44780_glyphs.stats = xFirstRound;
+    for( uint32_t i = 0; i < lcdbenchGLYPH_FRAMES; i++ )
+    {
+        if( i == ulScreens )
+        {
+            xFirstRound = hd44780_glyphs.stats;
+        }
+        for( int r = 0; r < NROW; r++ )
+        {
+            set_line_utf8( r, pcScreens[ i % ulScreens ][ r ] );
+        }
+        display_frame();
+    }
+    const hd44780_glyph_stats *pxGlyphs = &hd44780_glyphs.stats;
+    bench_report_value( "lcd", "glyph_lookups", "lookups", pxGlyphs->lookups );
+    bench_report_value( "lcd", "glyph_hit_rate", "%", pxGlyphs->lookups ? ( ( uint64_t ) pxGlyphs->hits * 100 ) / pxGlyphs->lookups : 0 );
+    bench_report_value( "lcd", "glyph_uploads", "glyphs", pxGlyphs->uploads );
+    bench_report_value( "lcd", "glyph_uploads_steady", "glyphs", pxGlyphs->uploads - xFirstRound.uploads );
+    bench_report_value( "lcd", "glyph_evictions", "glyphs", pxGlyphs->evictions );
+    bench_report_value( "lcd", "glyph_fallbacks", "chars", pxGlyphs->fallbacks );
+
+    /* The shift moves rows 1 and 3 together on 16x4: software. */
+    for( int r = 0; r < NROW; r++ )
+    {
+        set_line( r, "" );
+    }
+    scroll_line( 2, pcMarquee[ 0 ] );
+    prvRunScroll( "scroll_software", HD44780_SCROLL_SOFTWARE );
+
+    /* Two rows, one DDRAM line each: one shift instruction per step. */
+    xNextWakeTime = xTaskGetTickCount();
+    hd44780_set_rows( 2, &xNextWakeTime );
+    scroll_line( 0, pcMarquee[ 0 ] );
+    scroll_line( 1, pcMarquee[ 1 ] );
+    prvRunScroll( "scroll_hardware", HD44780_SCROLL_HARDWARE );
+    hd44780_set_rows( NROW, &xNextWakeTime );
+
+    /* Periodic task cadence with the display idle and under full load. On
+    the host the task can only wake on a tick, which the POSIX port delivers
+    the same with or without the bus model running: the loaded figure only
+    means something on target. */
+    prvRunJitter( "jitter_idle", 0 );
+#ifndef HOST_BUILD
+    prvRunJitter( "jitter_loaded", 1 );
+#endif
+
+    bench_done();
+}
+/*-----------------------------------------------------------*/
+
+static void prvPeriodicTask( void *pvParameters )
+{
+TickType_t xNextWakeTime;
+
+    ( void ) pvParameters;
+
+    xNextWakeTime = xTaskGetTickCount();
+    vTaskDelayUntil( &xNextWakeTime, lcdbenchPERIOD_MS );
+    const uint64_t ullFirst = hal_time_us();
+
+    for( uint32_t i = 1; i <= lcdbenchJITTER_PERIODS; i++ )
+    {
+        vTaskDelayUntil( &xNextWakeTime, lcdbenchPERIOD_MS );
+        const int64_t llLate = ( int64_t ) ( hal_time_us() - ullFirst ) - ( int64_t ) i * lcdbenchPERIOD_US;
+        bench_add( &xJitter, ( uint32_t ) ( llLate < 0 ? -llLate : llLate ) );
+    }
+
+    xJitterDone = 1;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,135 @@
+#include "lcd_fmt.h"
+
+#define LCD_FMT_MAX_DIGITS            ( 10 )
+
+static const uint32_t lcd_fmt_pow10[LCD_FMT_MAX_DIGITS] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+};
+
+static const char lcd_fmt_hex_digits[16] = "0123456789ABCDEF";
+
+static void put(lcd_fmt *f, const char c) {
+    // Past the last cell, only the cursor moves
+    if(f->col < f->size - 1) {
+        // Writing over the NUL moves it one cell on
+        if(f->row[f->col] == '\0') { f->row[f->col + 1] = '\0'; }
+        f->row[f->col] = c;
+    }
+    f->col++;
+}
+
+static void fill(lcd_fmt *f, const char c, int n) {
+    while(n-- > 0) { put(f, c); }
+}
+
+void lcd_fmt_begin(lcd_fmt *f, char *row, const int size, const int col) {
+    f->row = row;
+    f->size = size;
+    int end = 0;
+    while(end < size - 1 && row[end] != '\0') { end++; }
+    row[end] = '\0';
+    f->col = end;
+    fill(f, ' ', col - end);
+    f->col = col;
+}
+
+void lcd_fmt_end(lcd_fmt *f) {
+    f->row[f->col < f->size - 1 ? f->col : f->size - 1] = '\0';
+}
+
+void lcd_fmt_char(lcd_fmt *f, const char c) {
+    put(f, c);
+}
+
+void lcd_fmt_str(lcd_fmt *f, const char *s, const int width) {
+    int n = 0;
+    for( ; s[n] != '\0' && (width == 0 || n < width); n++) {
+        put(f, s[n]);
+    }
+    if(width > n) { fill(f, ' ', width - n); }
+}
+
+// Digits of `u`, at least `min_digits`, with the point before the last
+// `decimals` of them
+static void number(lcd_fmt *f, uint32_t u, const int negative, int decimals, const int width, const char pad) {
+    if(decimals < 0) { decimals = 0; }
+    if(decimals > LCD_FMT_MAX_DIGITS - 1) { decimals = LCD_FMT_MAX_DIGITS - 1; }
+
+    int digits = 1;
+    while(digits < LCD_FMT_MAX_DIGITS && u >= lcd_fmt_pow10[digits]) { digits++; }
+    if(digits < decimals + 1) { digits = decimals + 1; }
+
+    const int len = digits + negative + (decimals > 0);
+    if(width > 0 && len > width) {
+        fill(f, '*', width);
+        return;
+    }
+    const int padding = width > len ? width - len : 0;
+    if(pad == '0') {
+        if(negative) { put(f, '-'); }
+        fill(f, '0', padding);
+    } else {
+        fill(f, pad, padding);
+        if(negative) { put(f, '-'); }
+    }
+
+    for(int i=digits-1; i>=0; i--) {
+        if(decimals > 0 && i == decimals - 1) { put(f, '.'); }
+        // The digit bit by bit, 8, 4, 2 and 1 times the power of ten (the
+        // top digit of a 32 bit value is at most 4)
+        const uint32_t p = lcd_fmt_pow10[i];
+        int d = 0;
+        if(i < LCD_FMT_MAX_DIGITS - 1 && u >= p << 3) { u -= p << 3; d += 8; }
+        if(u >= p << 2) { u -= p << 2; d += 4; }
+        if(u >= p << 1) { u -= p << 1; d += 2; }
+        if(u >= p) { u -= p; d += 1; }
+        put(f, (char)('0' + d));
+    }
+}
+
+// Magnitude of `v`, INT32_MIN included
+static uint32_t magnitude(const int32_t v) {
+    return v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+}
+
+void lcd_fmt_int(lcd_fmt *f, const int32_t v, const int width, const char pad) {
+    number(f, magnitude(v), v < 0, 0, width, pad);
+}
+
+void lcd_fmt_uint(lcd_fmt *f, const uint32_t v, const int width, const char pad) {
+    number(f, v, 0, 0, width, pad);
+}
+
+void lcd_fmt_fixed(lcd_fmt *f, const int32_t v, const int decimals, const int width, const char pad) {
+    number(f, magnitude(v), v < 0, decimals, width, pad);
+}
+
+void lcd_fmt_hex(lcd_fmt *f, const uint32_t v, int digits) {
+    if(digits <= 0) {
+        digits = 1;
+        while(digits < 8 && (v >> (4 * digits)) != 0) { digits++; }
+    }
+    if(digits > 8) {
+        fill(f, '0', digits - 8);
+        digits = 8;
+    }
+    for(int i=digits-1; i>=0; i--) {
+        put(f, lcd_fmt_hex_digits[(v >> (4 * i)) & 0x0F]);
+    }
+}
+
+void lcd_fmt_time(lcd_fmt *f, const timekeeper_time *t) {
+    number(f, t->hour, 0, 0, 2, '0');
+    put(f, ':');
+    number(f, t->minute, 0, 0, 2, '0');
+    put(f, ':');
+    number(f, t->second, 0, 0, 2, '0');
+}
+
+void lcd_fmt_date(lcd_fmt *f, const timekeeper_time *t) {
+    number(f, t->day, 0, 0, 2, '0');
+    put(f, '/');
+    number(f, t->month, 0, 0, 2, '0');
+    put(f, '/');
+    number(f, t->year, 0, 0, 4, '0');
+}
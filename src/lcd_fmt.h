@@ -0,0 +1,66 @@
+#ifndef LCD_FMT_H
+#define LCD_FMT_H
+/*
+ * Text fields formatted straight into a frame row.
+ *
+ * A replacement for snprintf() on the display path: no heap, no
+ * intermediate buffer, a few words of stack and no division (digits come
+ * from subtracting powers of ten, the Cortex-M0+ has no divide instruction
+ * and newlib's printf pulls in 64 bit division). Fields are written at a
+ * cursor that walks along the row:
+ *
+ *   lcd_fmt f;
+ *   lcd_fmt_begin(&f, hd44780_display_data[2], ROWLEN, 0);
+ *   lcd_fmt_str(&f, "T:", 0);
+ *   lcd_fmt_fixed(&f, temp_centi, 2, 6, ' ');     // "T: 21.50"
+ *   lcd_fmt_char(&f, 'C');
+ *   lcd_fmt_end(&f);
+ *
+ * Numbers are right aligned in `width` cells (0 for as many as needed),
+ * padded with `pad`; with '0' padding the sign goes before the zeros like
+ * printf's "%05d". A number that does not fit is shown as `width` '*', a
+ * truncated number would be a wrong one. Text past the end of the row is
+ * dropped, the row always stays NUL terminated.
+ */
+#include <stdint.h>
+
+#include "timekeeper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    char *row;                    // NUL terminated frame row
+    int size;                     // Bytes of the row, with the NUL
+    int col;                      // Cell the next field starts at
+} lcd_fmt;
+
+/*
+ * Start writing `row` (`size` bytes) at column `col`. Cells between the end
+ * of the current text and `col` become spaces, text after the fields is
+ * kept until lcd_fmt_end().
+ */
+void lcd_fmt_begin(lcd_fmt *f, char *row, const int size, const int col);
+// Cut the row after the last field
+void lcd_fmt_end(lcd_fmt *f);
+
+void lcd_fmt_char(lcd_fmt *f, const char c);
+// `s` left aligned: cut to `width` cells and padded with spaces, 0 as is
+void lcd_fmt_str(lcd_fmt *f, const char *s, const int width);
+
+void lcd_fmt_int(lcd_fmt *f, const int32_t v, const int width, const char pad);
+void lcd_fmt_uint(lcd_fmt *f, const uint32_t v, const int width, const char pad);
+// `v` in units of 10^-decimals: (2150, 2) is "21.50", (-5, 1) is "-0.5"
+void lcd_fmt_fixed(lcd_fmt *f, const int32_t v, const int decimals, const int width, const char pad);
+// The lowest `digits` hex digits of `v`, upper case, 0 for as many as needed
+void lcd_fmt_hex(lcd_fmt *f, const uint32_t v, const int digits);
+
+// HH:MM:SS and DD/MM/YYYY
+void lcd_fmt_time(lcd_fmt *f, const timekeeper_time *t);
+void lcd_fmt_date(lcd_fmt *f, const timekeeper_time *t);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,268 @@
+/*
+ * Cost of a DLOG() call (dlog.h) against formatting the same line.
+ *
+ * Built as log_bench (RP2040, results over USB stdio) and log_bench_host.
+ * common.c calls main_log_bench() instead of main_blinky().
+ *
+ * Per case, <case>_dlog is the cost of one DLOG() and <case>_snprintf the
+ * cost of snprintf() of the same format into a buffer, the least printf()
+ * spends before it even takes the stdio mutex. Both are averaged over
+ * logbenchCALLS calls with the scheduler suspended and reported over
+ * logbenchROUNDS rounds, in core clock cycles on target and nanoseconds on
+ * the host. The rings are drained into a sink that counts bytes between the
+ * rounds, so the calls never find them full:
+ * - none         : "tick", no arguments
+ * - two          : a card, "card %u bytes, sak %02x"
+ * - four         : four signed readings, "adc %d %d %d %d"
+ * <case>_frame_bytes and <case>_text_bytes are the bytes a record takes on
+ * the wire and the length of the formatted line.
+ *
+ * flood_dlog is the cost per call of logbenchFLOOD calls with nobody
+ * draining: the ring fills and the calls that do not fit are dropped, at
+ * no extra cost. flood_dropped counts them.
+ */
+
+#include "dlog.h"
+#include "bench.h"
+#include "hal.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+#ifdef HOST_BUILD
+#include <time.h>
+#else
+#include "hardware/clocks.h"
+#endif
+
+#define logbenchTASK_PRIORITY                  ( tskIDLE_PRIORITY + 1 )
+
+// Fits the ring with four arguments: 6 words a record
+#define logbenchCALLS                          ( 64 )
+#define logbenchROUNDS                         ( 50 )
+#define logbenchFLOOD                          ( 2000 )
+#define logbenchTEXT                           ( 48 )
+// Give the host time to open the USB serial port
+#define logbenchUSB_SETTLE_MS                  ( 2000 / portTICK_PERIOD_MS )
+
+int main_log_bench( void );
+
+static void prvLogBenchTask( void *pvParameters );
+
+typedef void ( *LogFunction_t )( uint32_t ulValue );
+typedef int ( *TextFunction_t )( char *pcText, uint32_t ulValue );
+
+typedef struct
+{
+    const char *pcName;
+    LogFunction_t pxLog;
+    TextFunction_t pxText;
+} LogCase_t;
+
+static char cText[ logbenchTEXT ];
+static bench_samples xCost;
+static uint32_t ulSinkBytes = 0;
+static uint32_t ulSinkFrames = 0;
+
+/*-----------------------------------------------------------*/
+
+int main_log_bench( void )
+{
+    printf(" Starting main_log_bench.\n");
+
+    xTaskCreate( prvLogBenchTask, "BENCH", configMINIMAL_STACK_SIZE * 2, NULL, logbenchTASK_PRIORITY, NULL );
+    vTaskStartScheduler();
+
+    for( ;; );
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+static void prvNoneLog( uint32_t ulValue )
+{
+    ( void ) ulValue;
+    DLOG( "tick" );
+}
+
+static int prvNoneText( char *pcText, uint32_t ulValue )
+{
+    ( void ) ulValue;
+    return snprintf( pcText, logbenchTEXT, "tick" );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTwoLog( uint32_t ulValue )
+{
+    DLOG( "card %u bytes, sak %02x", 4 + ( ulValue & 3 ) * 3, ulValue & 0xFF );
+}
+
+static int prvTwoText( char *pcText, uint32_t ulValue )
+{
+    return snprintf( pcText, logbenchTEXT, "card %u bytes, sak %02x",
+                     ( unsigned ) ( 4 + ( ulValue & 3 ) * 3 ), ( unsigned ) ( ulValue & 0xFF ) );
+}
+/*-----------------------------------------------------------*/
+
+/* Readings around zero, like a centred ADC. */
+static int32_t prvReading( const uint32_t ulValue, const uint32_t ulChannel )
+{
+    return ( int32_t ) ( ( ulValue * 2654435761u >> ( 8 * ulChannel ) ) & 0xFFF ) - 2048;
+}
+
+static void prvFourLog( uint32_t ulValue )
+{
+    DLOG( "adc %d %d %d %d", prvReading( ulValue, 0 ), prvReading( ulValue, 1 ),
+          prvReading( ulValue, 2 ), prvReading( ulValue, 3 ) );
+}
+
+static int prvFourText( char *pcText, uint32_t ulValue )
+{
+    return snprintf( pcText, logbenchTEXT, "adc %ld %ld %ld %ld",
+                     ( long ) prvReading( ulValue, 0 ), ( long ) prvReading( ulValue, 1 ),
+                     ( long ) prvReading( ulValue, 2 ), ( long ) prvReading( ulValue, 3 ) );
+}
+/*-----------------------------------------------------------*/
+
+static const LogCase_t xCases[] =
+{
+    { "none", prvNoneLog, prvNoneText },
+    { "two", prvTwoLog, prvTwoText },
+    { "four", prvFourLog, prvFourText },
+};
+/*-----------------------------------------------------------*/
+
+/* Wall clock, the host virtual clock only advances with the busy waits. */
+static uint64_t prvNowNs( void )
+{
+#ifdef HOST_BUILD
+    struct timespec xNow;
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+    return ( uint64_t ) xNow.tv_sec * 1000000000u + ( uint64_t ) xNow.tv_nsec;
+#else
+    return hal_time_us() * 1000u;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+/* Nanoseconds to the unit of the reports. */
+static uint32_t prvCost( const uint64_t ullNs, const uint32_t ulCalls )
+{
+#ifdef HOST_BUILD
+    return ( uint32_t ) ( ullNs / ulCalls );
+#else
+    const uint64_t ullMhz = clock_get_hz( clk_sys ) / 1000000u;
+    return ( uint32_t ) ( ( ullNs * ullMhz ) / ( 1000u * ulCalls ) );
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char *pcCase, const char *pcVariant )
+{
+char cMetric[ 32 ];
+
+    snprintf( cMetric, sizeof( cMetric ), "%s_%s", pcCase, pcVariant );
+#ifdef HOST_BUILD
+    bench_report( "log", cMetric, "ns", &xCost );
+#else
+    bench_report( "log", cMetric, "cycles", &xCost );
+#endif
+}
+/*-----------------------------------------------------------*/
+
+/* Frames are counted, not sent: the bench results share the stream. */
+static void prvSink( const uint8_t *pucFrame, size_t xLen )
+{
+    ( void ) pucFrame;
+    ulSinkBytes += ( uint32_t ) xLen;
+    ulSinkFrames++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureCase( const LogCase_t *pxCase )
+{
+char cMetric[ 32 ];
+uint32_t ulTextBytes = 0;
+
+    bench_reset( &xCost );
+    ulSinkBytes = 0;
+    ulSinkFrames = 0;
+    for( uint32_t r = 0; r < logbenchROUNDS; r++ )
+    {
+        vTaskSuspendAll();
+        const uint64_t ullStart = prvNowNs();
+        for( uint32_t i = 0; i < logbenchCALLS; i++ )
+        {
+            pxCase->pxLog( r * logbenchCALLS + i );
+        }
+        const uint64_t ullNs = prvNowNs() - ullStart;
+        ( void ) xTaskResumeAll();
+        bench_add( &xCost, prvCost( ullNs, logbenchCALLS ) );
+        ( void ) dlog_flush();
+    }
+    prvReport( pxCase->pcName, "dlog" );
+
+    bench_reset( &xCost );
+    for( uint32_t r = 0; r < logbenchROUNDS; r++ )
+    {
+        vTaskSuspendAll();
+        const uint64_t ullStart = prvNowNs();
+        for( uint32_t i = 0; i < logbenchCALLS; i++ )
+        {
+            ulTextBytes += ( uint32_t ) pxCase->pxText( cText, r * logbenchCALLS + i );
+        }
+        const uint64_t ullNs = prvNowNs() - ullStart;
+        ( void ) xTaskResumeAll();
+        bench_add( &xCost, prvCost( ullNs, logbenchCALLS ) );
+    }
+    prvReport( pxCase->pcName, "snprintf" );
+
+    snprintf( cMetric, sizeof( cMetric ), "%s_frame_bytes", pxCase->pcName );
+    bench_report_value( "log", cMetric, "bytes", ulSinkFrames ? ulSinkBytes / ulSinkFrames : 0 );
+    snprintf( cMetric, sizeof( cMetric ), "%s_text_bytes", pxCase->pcName );
+    bench_report_value( "log", cMetric, "bytes", ulTextBytes / ( logbenchROUNDS * logbenchCALLS ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvLogBenchTask( void *pvParameters )
+{
+dlog_stats xBefore;
+dlog_stats xAfter;
+
+    ( void ) pvParameters;
+
+#ifndef HOST_BUILD
+    vTaskDelay( logbenchUSB_SETTLE_MS );
+#endif
+
+    dlog_set_output( prvSink );
+    ( void ) dlog_flush();
+
+    for( size_t c = 0; c < sizeof( xCases ) / sizeof( xCases[ 0 ] ); c++ )
+    {
+        prvMeasureCase( &xCases[ c ] );
+    }
+
+    /* One long burst, the ring is full after 128 records. */
+    dlog_get_stats( &xBefore );
+    bench_reset( &xCost );
+    vTaskSuspendAll();
+    const uint64_t ullStart = prvNowNs();
+    for( uint32_t i = 0; i < logbenchFLOOD; i++ )
+    {
+        prvTwoLog( i );
+    }
+    const uint64_t ullNs = prvNowNs() - ullStart;
+    ( void ) xTaskResumeAll();
+    bench_add( &xCost, prvCost( ullNs, logbenchFLOOD ) );
+    ( void ) dlog_flush();
+    dlog_get_stats( &xAfter );
+    prvReport( "flood", "dlog" );
+    bench_report_value( "log", "flood_dropped", "records", xAfter.dropped - xBefore.dropped );
+
+    dlog_set_output( NULL );
+    bench_done();
+}
+/*-----------------------------------------------------------*/
@@ -44,7 +44,9 @@
  * this file.  prvQueueSendTask() sits in a loop that causes it to repeatedly
  * block for 200 milliseconds, before sending the value 100 to the queue that
  * was created within main().  Once the value is sent, the task loops
- * back around to block for another 200 milliseconds...and so on.
+ * back around to block for another 200 milliseconds...and so on.  The
+ * releases go through src/periodic.c, which holds every send to a 5
+ * millisecond deadline and keeps its start latency and response time.
  *
  * The Queue Receive Task:
  * The queue receive task is implemented by the prvQueueReceiveTask() function
@@ -59,12 +61,76 @@
  * send task writes to the queue every 200 milliseconds, the queue receive
  * task leaves the Blocked state every 200 milliseconds, and therefore toggles
  * the LED every 200 milliseconds.
+ *
+ * The Time Task:
+ * timekeeperTask() (timekeeper.c) wakes at every second of the wall clock
+ * and notifies the LCD task, which only redraws the digits that changed.
+ * The LCD task sleeps until then or until another task changes a line
+ * (render.h), never more than HD44780_CONFIG_MAX_FPS frames per second.
+ *
+ * The RFID Task:
+ * mfrc522Task() (mfrc522.c) asks for a card every MFRC522_POLL_MS and sleeps
+ * on the IRQ pin of the reader while a frame is out. Each new card shows its
+ * UID on line 2 through prvShowCard(), with '+' at the end when it is in the
+ * credential table compiled from credentials.txt (cred_index.h) and '-'
+ * when it is not.
+ *
+ * The Input:
+ * Nothing polls the buttons and the rotary encoder (input.h): their pins
+ * interrupt on each edge, a timer alarm debounces the buttons and the timer
+ * task runs prvOnInput() for each press, release or turn. The knob moves a
+ * counter on line 3, OK shows the press there and BACK zeroes the counter.
+ *
+ * The Log Task:
+ * dlog_task() (dlog.c) sends the records of DLOG() as binary frames every
+ * DLOG_DRAIN_PERIOD_MS, tools/dlog_decode.py turns them back into text.
+ * prvShowCard() logs every card there instead of printing it.
+ *
+ * The Console Task:
+ * consoleTask() (console.c) runs the commands that come in over stdio:
+ * lines, cells and whole frames for the LCD, and the run time counters.
+ * tools/lcd_console.py sends them, or stream frames, from the host.
+ *
+ * Task placement:
+ * Every task is listed in xTaskPlacement[] with the cores it may run on. The
+ * LCD bus and the stdio I/O share mainCORE_IO, the queue pair has
+ * mainCORE_CONTROL to itself so display traffic does not delay its wake up.
+ *
+ * Wake up latency measurement (mainMEASURE_RX_LATENCY, the rx_latency_bench
+ * executable):
+ * The send task runs every mainLATENCY_SEND_PERIOD_MS and sends its timestamp,
+ * the LCD task counts frames on line 3 as load, each frame asking for the
+ * next one at up to 1000 frames per second. The receive task collects
+ * mainLATENCY_SAMPLES send to wake up latencies with every task free to run on
+ * any core, prints the histogram, applies the placement table and does the
+ * same again.
+ *
+ * Stack profile (mainSTACK_PROFILE, the stack_profile executable):
+ * Every task gets STACK_PROFILE_DEPTH words and the load of the latency
+ * measurement, prvStressTask() logs every mainSTRESS_PERIOD_MS and
+ * tools/lcd_console.py streams frames and commands to the console. After
+ * mainSTACK_PROFILE_MS the STACK lines (stack_profile.h) carry the deepest
+ * use of each task, tools/stack_report.py turns them into stack sizes.
  */
 
 /* Extra tasks. */
 #ifndef HD44780_H
 #include "hd44780.h"
 #endif
+#include "trace.h"
+#include "dlog.h"
+#include "console.h"
+#include "timekeeper.h"
+#include "mfrc522.h"
+#include "cred_index.h"
+#include "render.h"
+#include "lcd_fmt.h"
+#include "stack_profile.h"
+#include "periodic.h"
+#include "input.h"
+#if ( mainMEASURE_RX_LATENCY == 1 ) || ( mainSTACK_PROFILE == 1 )
+#include "bench.h"
+#endif
 
 /* Kernel includes. */
 #include "FreeRTOS.h"
@@ -73,24 +139,128 @@
 
 /* Library includes. */
 #include <stdio.h>
-#include "hardware/gpio.h"
+#include "hal.h"
 
 /* Priorities at which the tasks are created. */
 #define mainQUEUE_RECEIVE_TASK_PRIORITY        ( tskIDLE_PRIORITY + 3 )
 #define    mainQUEUE_SEND_TASK_PRIORITY        ( tskIDLE_PRIORITY + 2 )
 #define               LCD_TASK_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+#define             TRACE_TASK_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+#define              TIME_TASK_PRIORITY        ( tskIDLE_PRIORITY + 2 )
+#define              RFID_TASK_PRIORITY        ( tskIDLE_PRIORITY + 2 )
+#define               LOG_TASK_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+#define           CONSOLE_TASK_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+#define            STRESS_TASK_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+
+/* Number identifying the queue in the trace records. */
+#define mainQUEUE_TRACE_NUMBER                 ( 1 )
 
 /* The rate at which data is sent to the queue.  The 200ms value is converted
 to ticks using the portTICK_PERIOD_MS constant. */
+#ifndef mainMEASURE_RX_LATENCY
+#define mainMEASURE_RX_LATENCY                 0
+#endif
+#ifndef mainSTACK_PROFILE
+#define mainSTACK_PROFILE                      0
+#endif
+#if ( mainMEASURE_RX_LATENCY == 1 ) || ( mainSTACK_PROFILE == 1 )
+#define mainQUEUE_SEND_FREQUENCY_MS            ( 10 / portTICK_PERIOD_MS )
+#else
 #define mainQUEUE_SEND_FREQUENCY_MS            ( 200 / portTICK_PERIOD_MS )
+#endif
+/* From the release of a send to the send done, in ms. */
+#define mainQUEUE_SEND_DEADLINE_MS             ( 5 )
+
+/* Samples per histogram and its buckets in the measurement mode. */
+#define mainLATENCY_SAMPLES                    ( 300 )
+#define mainLATENCY_BUCKET_US                  ( 5 )
+#define mainLATENCY_BUCKETS                    ( 20 )
+
+/* Length of the stack profile and the period of its log records. */
+#define mainSTACK_PROFILE_MS                   ( 20000 )
+#define mainSTRESS_PERIOD_MS                   ( 20 )
+
+/* Stack depth of every task, in words. The stack profile gives each of them
+room to spare, a header written by tools/stack_report.py (configured with
+-DSTACK_SIZES=<header>) the sizes it measured. */
+#if ( mainSTACK_PROFILE == 1 )
+#define mainSTACK_HD                        STACK_PROFILE_DEPTH
+#define mainSTACK_TRACE                     STACK_PROFILE_DEPTH
+#define mainSTACK_TIME                      STACK_PROFILE_DEPTH
+#define mainSTACK_RFID                      STACK_PROFILE_DEPTH
+#define mainSTACK_LOG                       STACK_PROFILE_DEPTH
+#define mainSTACK_CON                       STACK_PROFILE_DEPTH
+#define mainSTACK_RX                        STACK_PROFILE_DEPTH
+#define mainSTACK_TX                        STACK_PROFILE_DEPTH
+#else
+#ifdef STACK_SIZES_HEADER
+#include STACK_SIZES_HEADER
+#endif
+#ifndef STACK_SIZE_HD
+#define STACK_SIZE_HD                       configMINIMAL_STACK_SIZE
+#endif
+#ifndef STACK_SIZE_TRACE
+#define STACK_SIZE_TRACE                    configMINIMAL_STACK_SIZE
+#endif
+#ifndef STACK_SIZE_TIME
+#define STACK_SIZE_TIME                     configMINIMAL_STACK_SIZE
+#endif
+#ifndef STACK_SIZE_RFID
+#define STACK_SIZE_RFID                     configMINIMAL_STACK_SIZE
+#endif
+#ifndef STACK_SIZE_LOG
+#define STACK_SIZE_LOG                      configMINIMAL_STACK_SIZE
+#endif
+#ifndef STACK_SIZE_CON
+#define STACK_SIZE_CON                      configMINIMAL_STACK_SIZE
+#endif
+#ifndef STACK_SIZE_RX
+#define STACK_SIZE_RX                       configMINIMAL_STACK_SIZE
+#endif
+#ifndef STACK_SIZE_TX
+#define STACK_SIZE_TX                       configMINIMAL_STACK_SIZE
+#endif
+#define mainSTACK_HD                        STACK_SIZE_HD
+#define mainSTACK_TRACE                     STACK_SIZE_TRACE
+#define mainSTACK_TIME                      STACK_SIZE_TIME
+#define mainSTACK_RFID                      STACK_SIZE_RFID
+#define mainSTACK_LOG                       STACK_SIZE_LOG
+#define mainSTACK_CON                       STACK_SIZE_CON
+#define mainSTACK_RX                        STACK_SIZE_RX
+#define mainSTACK_TX                        STACK_SIZE_TX
+#endif
 
 /* The number of items the queue can hold.  This is 1 as the receive task
 will remove items as they are added, meaning the send task should always find
 the queue empty. */
 #define mainQUEUE_LENGTH                    ( 1 )
 
+/* Line showing the UID of the last card. */
+#define mainCARD_LINE                       ( 1 )
+
+/* Buttons to ground and the rotary encoder, and the line they show on. */
+#define mainINPUT_KNOB_A_PIN                ( 22 )
+#define mainINPUT_KNOB_B_PIN                ( 26 )
+#define mainINPUT_OK_PIN                    ( 14 )
+#define mainINPUT_BACK_PIN                  ( 15 )
+#define mainINPUT_LINE                      ( 2 )
+
+/* None of them may be a pin of the LCD or the reader. */
+#define mainINPUT_GPIO_MASK                 ( ( 1u << mainINPUT_KNOB_A_PIN ) | ( 1u << mainINPUT_KNOB_B_PIN ) | \
+                                              ( 1u << mainINPUT_OK_PIN ) | ( 1u << mainINPUT_BACK_PIN ) )
+#if ( mainINPUT_GPIO_MASK & ( HD44780_GPIO_MASK | MFRC522_GPIO_MASK ) ) != 0
+#error mainINPUT pins overlap the LCD or the MFRC522
+#endif
+
+/* Cards allowed in, generated from credentials.txt by the build. */
+extern const cred_index credentials;
+
 /* The LED toggled by the Rx task. */
-#define mainTASK_LED                        ( PICO_DEFAULT_LED_PIN )
+#define mainTASK_LED                        ( HAL_LED_PIN )
+
+/* Cores of the placement table, as affinity masks. */
+#define mainCORE_IO                         ( 1 << 0 )
+#define mainCORE_CONTROL                    ( 1 << 1 )
 
 /*-----------------------------------------------------------*/
 
@@ -106,33 +276,137 @@ int main_blinky( void );
 static void prvQueueReceiveTask( void *pvParameters );
 static void prvQueueSendTask( void *pvParameters );
 
+/*
+ * Card handler of the RFID task, shows the UID and whether it may enter.
+ */
+static void prvShowCard( const mfrc522_uid *pxUid, void *pvContext );
+
+/*
+ * Input handler, runs in the timer task for every button or knob event.
+ */
+static void prvOnInput( const input_event *pxEvent, void *pvContext );
+
+/*
+ * Pins every task of xTaskPlacement[] to its cores, or lets all of them run
+ * anywhere.
+ */
+static void prvApplyPlacement( const BaseType_t xIsolate );
+
+#if ( mainSTACK_PROFILE == 1 )
+/*
+ * Load of the stack profile, see the comments at the top of this file.
+ */
+static void prvStressTask( void *pvParameters );
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* The queue used by both tasks. */
 static QueueHandle_t xQueue = NULL;
 
+/* Every kernel object created here is statically allocated, the FreeRTOS heap
+is only left for the benchmarks and the pico SDK. */
+static StaticQueue_t xQueueBuffer;
+static uint8_t ucQueueStorage[ mainQUEUE_LENGTH * sizeof( uint32_t ) ];
+
+static StaticTask_t xLcdTaskBuffer;
+static StaticTask_t xTraceTaskBuffer;
+static StaticTask_t xTimeTaskBuffer;
+static StaticTask_t xRfidTaskBuffer;
+static StaticTask_t xLogTaskBuffer;
+static StaticTask_t xConsoleTaskBuffer;
+static StaticTask_t xRxTaskBuffer;
+static StaticTask_t xTxTaskBuffer;
+static StackType_t xLcdTaskStack[ mainSTACK_HD ];
+static StackType_t xTraceTaskStack[ mainSTACK_TRACE ];
+static StackType_t xTimeTaskStack[ mainSTACK_TIME ];
+static StackType_t xRfidTaskStack[ mainSTACK_RFID ];
+static StackType_t xLogTaskStack[ mainSTACK_LOG ];
+static StackType_t xConsoleTaskStack[ mainSTACK_CON ];
+static StackType_t xRxTaskStack[ mainSTACK_RX ];
+static StackType_t xTxTaskStack[ mainSTACK_TX ];
+
+typedef struct
+{
+    TaskFunction_t pxTaskCode;
+    const char *pcName;
+    uint32_t ulStackDepth;
+    UBaseType_t uxPriority;
+    UBaseType_t uxCoreAffinityMask;
+    StackType_t *puxStackBuffer;
+    StaticTask_t *pxTaskBuffer;
+} TaskPlacement_t;
+
+/* Every task of the demo and where it runs. */
+static const TaskPlacement_t xTaskPlacement[] =
+{
+    { hd44780Task,         "HD",    mainSTACK_HD,    LCD_TASK_PRIORITY,               mainCORE_IO,      xLcdTaskStack,     &xLcdTaskBuffer },
+    { trace_task,          "TRACE", mainSTACK_TRACE, TRACE_TASK_PRIORITY,             mainCORE_IO,      xTraceTaskStack,   &xTraceTaskBuffer },
+    { timekeeperTask,      "TIME",  mainSTACK_TIME,  TIME_TASK_PRIORITY,              mainCORE_IO,      xTimeTaskStack,    &xTimeTaskBuffer },
+    { mfrc522Task,         "RFID",  mainSTACK_RFID,  RFID_TASK_PRIORITY,              mainCORE_IO,      xRfidTaskStack,    &xRfidTaskBuffer },
+    { dlog_task,           "LOG",   mainSTACK_LOG,   LOG_TASK_PRIORITY,               mainCORE_IO,      xLogTaskStack,     &xLogTaskBuffer },
+    { consoleTask,         "CON",   mainSTACK_CON,   CONSOLE_TASK_PRIORITY,           mainCORE_IO,      xConsoleTaskStack, &xConsoleTaskBuffer },
+    { prvQueueReceiveTask, "Rx",    mainSTACK_RX,    mainQUEUE_RECEIVE_TASK_PRIORITY, mainCORE_CONTROL, xRxTaskStack,      &xRxTaskBuffer },
+    { prvQueueSendTask,    "TX",    mainSTACK_TX,    mainQUEUE_SEND_TASK_PRIORITY,    mainCORE_CONTROL, xTxTaskStack,      &xTxTaskBuffer },
+};
+#define mainNUM_PLACED_TASKS                ( sizeof( xTaskPlacement ) / sizeof( xTaskPlacement[ 0 ] ) )
+
+static TaskHandle_t xPlacedTasks[ mainNUM_PLACED_TASKS ];
+
+#if ( mainMEASURE_RX_LATENCY == 1 )
+static bench_samples xLatency;
+#endif
+
+/* The inputs of prvOnInput(). */
+static INPUT_ENCODER_DEFINE( xKnob, "KNOB", mainINPUT_KNOB_A_PIN, mainINPUT_KNOB_B_PIN );
+static INPUT_BUTTON_DEFINE( xOkButton, "OK", mainINPUT_OK_PIN );
+static INPUT_BUTTON_DEFINE( xBackButton, "BACK", mainINPUT_BACK_PIN );
+
+/* Deadline and jitter of the sends, see periodic.h. */
+static PERIODIC_DEFINE( xSendJob, "TX", mainQUEUE_SEND_FREQUENCY_MS * portTICK_PERIOD_MS, mainQUEUE_SEND_DEADLINE_MS );
+
 /*-----------------------------------------------------------*/
 
 int main_blinky( void )
 {
     printf(" Starting main_blinky.\n");
 
+    /* Wall clock on the 64 bit timer, the LCD task shows it. */
+    timekeeper_init( NULL );
+    mfrc522_set_handler( prvShowCard, NULL );
+    periodic_init( &xSendJob );
+
+    /* The pin interrupts of the inputs are taken by this core. */
+    input_add( &xKnob );
+    input_add( &xOkButton );
+    input_add( &xBackButton );
+    input_start( prvOnInput, NULL );
+
     /* Create the queue. */
-    xQueue = xQueueCreate( mainQUEUE_LENGTH, sizeof( uint32_t ) );
+    xQueue = xQueueCreateStatic( mainQUEUE_LENGTH, sizeof( uint32_t ), ucQueueStorage, &xQueueBuffer );
 
-    xTaskCreate( hd44780Task, "HD", configMINIMAL_STACK_SIZE, NULL, LCD_TASK_PRIORITY, NULL );
     if( xQueue != NULL )
     {
-        /* Start the two tasks as described in the comments at the top of this
+        vQueueSetQueueNumber( xQueue, mainQUEUE_TRACE_NUMBER );
+
+        /* Start the tasks as described in the comments at the top of this
         file. */
-        xTaskCreate( prvQueueReceiveTask,                 /* The function that implements the task. */
-                    "Rx",                                 /* The text name assigned to the task - for debug only as it is not used by the kernel. */
-                    configMINIMAL_STACK_SIZE,             /* The size of the stack to allocate to the task. */
-                    NULL,                                 /* The parameter passed to the task - not used in this case. */
-                    mainQUEUE_RECEIVE_TASK_PRIORITY,      /* The priority assigned to the task. */
-                    NULL );                               /* The task handle is not required, so NULL is passed. */
+        for( size_t i = 0; i < mainNUM_PLACED_TASKS; i++ )
+        {
+            const TaskPlacement_t *pxPlacement = &xTaskPlacement[ i ];
+            xPlacedTasks[ i ] = xTaskCreateStatic( pxPlacement->pxTaskCode, pxPlacement->pcName,
+                                                   pxPlacement->ulStackDepth, NULL, pxPlacement->uxPriority,
+                                                   pxPlacement->puxStackBuffer, pxPlacement->pxTaskBuffer );
+            stack_profile_register( xPlacedTasks[ i ], pxPlacement->ulStackDepth );
+        }
+
+#if ( mainSTACK_PROFILE == 1 )
+        /* Not in the table and not reported, it only drives the others. */
+        xTaskCreate( prvStressTask, "STRESS", configMINIMAL_STACK_SIZE, NULL, STRESS_TASK_PRIORITY, NULL );
+#endif
 
-        xTaskCreate( prvQueueSendTask, "TX", configMINIMAL_STACK_SIZE, NULL, mainQUEUE_SEND_TASK_PRIORITY, NULL );
+        /* The measurement starts with every task free to run anywhere. */
+        prvApplyPlacement( !mainMEASURE_RX_LATENCY );
 
         /* Start the tasks and timer running. */
         vTaskStartScheduler();
@@ -149,35 +423,164 @@ int main_blinky( void )
 }
 /*-----------------------------------------------------------*/
 
+static void prvApplyPlacement( const BaseType_t xIsolate )
+{
+#if ( configUSE_CORE_AFFINITY == 1 ) && ( configNUM_CORES > 1 )
+    for( size_t i = 0; i < mainNUM_PLACED_TASKS; i++ )
+    {
+        vTaskCoreAffinitySet( xPlacedTasks[ i ], xIsolate ? xTaskPlacement[ i ].uxCoreAffinityMask : tskNO_AFFINITY );
+    }
+#else
+    /* Single core build (host, tickless idle): nothing to place. */
+    ( void ) xIsolate;
+#endif
+}
+/*-----------------------------------------------------------*/
+
 static void prvQueueSendTask( void *pvParameters )
 {
-TickType_t xNextWakeTime;
-const unsigned long ulValueToSend = 100UL;
+uint32_t ulValueToSend = 100UL;
 
     /* Remove compiler warning about unused parameter. */
     ( void ) pvParameters;
 
-    /* Initialise xNextWakeTime - this only needs to be done once. */
-    xNextWakeTime = xTaskGetTickCount();
+    /* The first release - this only needs to be done once. */
+    periodic_start( &xSendJob );
 
     for( ;; )
     {
-        /* Place this task in the blocked state until it is time to run again. */
-        vTaskDelayUntil( &xNextWakeTime, mainQUEUE_SEND_FREQUENCY_MS );
+        /* End the previous send and place this task in the blocked state
+        until it is time to run again. */
+        periodic_wait( &xSendJob );
 
         /* Send to the queue - causing the queue receive task to unblock and
         toggle the LED.  0 is used as the block time so the sending operation
         will not block - it shouldn't need to block as the queue should always
         be empty at this point in the code. */
+#if ( mainMEASURE_RX_LATENCY == 1 )
+        ulValueToSend = ( uint32_t ) hal_time_us();
+#endif
         xQueueSend( xQueue, &ulValueToSend, 0U );
     }
 }
 /*-----------------------------------------------------------*/
 
+#if ( mainMEASURE_RX_LATENCY == 1 )
+static void prvRecordLatency( const uint32_t ulLatencyUs )
+{
+static BaseType_t xIsolated = pdFALSE;
+
+    bench_add( &xLatency, ulLatencyUs );
+    if( xLatency.n < mainLATENCY_SAMPLES )
+    {
+        return;
+    }
+
+    bench_report_histogram( "rx", xIsolated ? "wake_latency_isolated" : "wake_latency_shared", "us",
+                            &xLatency, mainLATENCY_BUCKET_US, mainLATENCY_BUCKETS );
+    bench_report( "rx", xIsolated ? "wake_latency_isolated" : "wake_latency_shared", "us", &xLatency );
+    if( xIsolated )
+    {
+        bench_done();
+    }
+
+    bench_reset( &xLatency );
+    xIsolated = pdTRUE;
+    prvApplyPlacement( pdTRUE );
+}
+/*-----------------------------------------------------------*/
+#endif
+
+#if ( mainSTACK_PROFILE == 1 )
+static void prvStressTask( void *pvParameters )
+{
+const TickType_t xStart = xTaskGetTickCount();
+uint32_t ulRound = 0;
+
+    ( void ) pvParameters;
+
+    /* Records with four arguments keep the log task encoding. The console
+    load comes from outside, tools/lcd_console.py streaming frames. */
+    while( xTaskGetTickCount() - xStart < pdMS_TO_TICKS( mainSTACK_PROFILE_MS ) )
+    {
+        DLOG( "stress %u %d %d %u", ulRound, -( int32_t ) ulRound, ( int32_t ) ulRound * 3, ulRound ^ 0x55u );
+        ulRound++;
+        vTaskDelay( pdMS_TO_TICKS( mainSTRESS_PERIOD_MS ) );
+    }
+
+    stack_profile_report();
+    bench_done();
+}
+/*-----------------------------------------------------------*/
+#endif
+
+static void prvShowCard( const mfrc522_uid *pxUid, void *pvContext )
+{
+lcd_fmt xFmt;
+
+    ( void ) pvContext;
+
+    /* A 10 byte UID does not fit, its last bytes are cut off by the
+    mark. */
+    hd44780_frame_lock();
+    lcd_fmt_begin( &xFmt, hd44780_display_data[ mainCARD_LINE ], ROWLEN, 0 );
+    lcd_fmt_str( &xFmt, pxUid->size > 4 ? "" : "UID ", 0 );
+    for( uint8_t i = 0; i < pxUid->size; i++ )
+    {
+        lcd_fmt_hex( &xFmt, pxUid->bytes[ i ], 2 );
+    }
+    lcd_fmt_end( &xFmt );
+    hd44780_frame_unlock();
+
+    /* Looked up in flash, a few microseconds even for a large table. */
+    const BaseType_t xAllowed = cred_index_contains( &credentials, pxUid->bytes, pxUid->size );
+    hd44780_frame_lock();
+    lcd_fmt_begin( &xFmt, hd44780_display_data[ mainCARD_LINE ], ROWLEN, ROWLENCP - 1 );
+    lcd_fmt_char( &xFmt, xAllowed ? '+' : '-' );
+    lcd_fmt_end( &xFmt );
+    hd44780_frame_unlock();
+    render_mark_dirty( RENDER_SOURCE_APP );
+
+    DLOG( "card %u bytes, sak %02x, read in %u us, allowed %d", pxUid->size, pxUid->sak,
+          pxUid->read_us, xAllowed );
+}
+/*-----------------------------------------------------------*/
+
+static void prvOnInput( const input_event *pxEvent, void *pvContext )
+{
+static int32_t lPosition = 0;
+lcd_fmt xFmt;
+
+    ( void ) pvContext;
+
+    if( pxEvent->type == INPUT_TURN )
+    {
+        lPosition += pxEvent->steps;
+    }
+    else if( ( pxEvent->type == INPUT_PRESS ) && ( pxEvent->source == &xBackButton ) )
+    {
+        lPosition = 0;
+    }
+
+    hd44780_frame_lock();
+    lcd_fmt_begin( &xFmt, hd44780_display_data[ mainINPUT_LINE ], ROWLEN, 0 );
+    lcd_fmt_str( &xFmt, "KNOB ", 0 );
+    lcd_fmt_int( &xFmt, lPosition, 5, ' ' );
+    lcd_fmt_char( &xFmt, ' ' );
+    lcd_fmt_str( &xFmt, ( pxEvent->type == INPUT_PRESS ) ? pxEvent->source->name : "", 4 );
+    lcd_fmt_end( &xFmt );
+    hd44780_frame_unlock();
+    render_mark_dirty( RENDER_SOURCE_APP );
+
+    DLOG( "input %u event %u steps %d after %u us", pxEvent->source->id, pxEvent->type,
+          pxEvent->steps, ( uint32_t ) ( hal_time_us() - pxEvent->edge_us ) );
+}
+/*-----------------------------------------------------------*/
+
 static void prvQueueReceiveTask( void *pvParameters )
 {
-unsigned long ulReceivedValue;
-const unsigned long ulExpectedValue = 100UL;
+uint32_t ulReceivedValue;
+const uint32_t ulExpectedValue = 100UL;
 
     /* Remove compiler warning about unused parameter. */
     ( void ) pvParameters;
@@ -189,11 +592,16 @@ const unsigned long ulExpectedValue = 100UL;
         FreeRTOSConfig.h. */
         xQueueReceive( xQueue, &ulReceivedValue, portMAX_DELAY );
 
+#if ( mainMEASURE_RX_LATENCY == 1 )
+        prvRecordLatency( ( uint32_t ) hal_time_us() - ulReceivedValue );
+        ulReceivedValue = ulExpectedValue;
+#endif
+
         /*  To get here something must have been received from the queue, but
         is it the expected value?  If it is, toggle the LED. */
         if( ulReceivedValue == ulExpectedValue )
         {
-            gpio_xor_mask( 1u << mainTASK_LED );
+            hal_gpio_xor_mask( 1u << mainTASK_LED );
             ulReceivedValue = 0U;
         }
     }
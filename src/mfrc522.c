@@ -0,0 +1,251 @@
+#include "mfrc522.h"
+#include "hal.h"
+
+#include <string.h>
+
+// Register access, the chip wants a little time after a soft reset
+#define MFRC522_RESET_MS              ( 50 )
+// SEL + NVB + 4 UID bytes + BCC + CRC_A
+#define MFRC522_SELECT_LEN            ( 9 )
+
+static mfrc522_handler mfrc522_on_card = NULL;
+static void *mfrc522_on_card_ctx = NULL;
+static mfrc522_stats mfrc522_counters;
+
+static void write_reg(const uint8_t reg, const uint8_t v) {
+    mfrc522_spi_write(reg, &v, 1);
+    mfrc522_counters.spi_bytes += 2;
+}
+
+static uint8_t read_reg(const uint8_t reg) {
+    uint8_t v;
+    mfrc522_spi_read(reg, &v, 1);
+    mfrc522_counters.spi_bytes += 2;
+    return v;
+}
+
+static void set_bits(const uint8_t reg, const uint8_t mask) {
+    write_reg(reg, read_reg(reg) | mask);
+}
+
+uint16_t mfrc522_crc_a(const uint8_t *data, const size_t len) {
+    // Reflected CRC-16/CCITT, preset 0x6363
+    uint16_t crc = 0x6363;
+    for(size_t i=0; i<len; i++) {
+        crc ^= data[i];
+        for(int b=0; b<8; b++) {
+            crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0x8408) : (uint16_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+bool mfrc522_init(void) {
+    mfrc522_spi_init();
+    write_reg(MFRC522_REG_COMMAND, MFRC522_CMD_SOFT_RESET);
+    vTaskDelay(pdMS_TO_TICKS(MFRC522_RESET_MS));
+
+    // Nothing on the bus reads as all zeros or all ones
+    const uint8_t version = read_reg(MFRC522_REG_VERSION);
+    if(version == 0x00 || version == 0xFF) { return false; }
+
+    // TAuto: the timer starts at the end of every frame sent
+    write_reg(MFRC522_REG_T_MODE, 0x80 | (MFRC522_TIMER_PRESCALER >> 8));
+    write_reg(MFRC522_REG_T_PRESCALER, MFRC522_TIMER_PRESCALER & 0xFF);
+    write_reg(MFRC522_REG_T_RELOAD_H, MFRC522_TIMER_RELOAD >> 8);
+    write_reg(MFRC522_REG_T_RELOAD_L, MFRC522_TIMER_RELOAD & 0xFF);
+    // 100% ASK, CRC preset 0x6363
+    write_reg(MFRC522_REG_TX_ASK, 0x40);
+    write_reg(MFRC522_REG_MODE, 0x3D);
+
+    // IRQ pin active low (IRqInv), push-pull, on an answer, the timer or an error
+    write_reg(MFRC522_REG_COM_IEN, MFRC522_IRQ_SET | MFRC522_IRQ_RX | MFRC522_IRQ_TIMER | MFRC522_IRQ_ERR);
+    write_reg(MFRC522_REG_DIV_IEN, 0x80);
+
+    // Antenna drivers TX1 and TX2 on
+    set_bits(MFRC522_REG_TX_CONTROL, 0x03);
+    return true;
+}
+
+mfrc522_status mfrc522_transceive(const uint8_t *tx, const size_t tx_len, const uint8_t tx_last_bits,
+        uint8_t *rx, size_t *rx_len) {
+    write_reg(MFRC522_REG_COMMAND, MFRC522_CMD_IDLE);
+    write_reg(MFRC522_REG_COM_IRQ, 0x7F);
+    write_reg(MFRC522_REG_FIFO_LEVEL, MFRC522_FIFO_FLUSH);
+    mfrc522_spi_write(MFRC522_REG_FIFO_DATA, tx, tx_len);
+    mfrc522_counters.spi_bytes += (uint32_t)tx_len + 1;
+    write_reg(MFRC522_REG_BIT_FRAMING, tx_last_bits & 0x07);
+
+    // Armed before the start, the answer may be in before the task sleeps
+    mfrc522_spi_irq_arm();
+    write_reg(MFRC522_REG_COMMAND, MFRC522_CMD_TRANSCEIVE);
+    write_reg(MFRC522_REG_BIT_FRAMING, MFRC522_BIT_FRAMING_START | (tx_last_bits & 0x07));
+
+    if(mfrc522_spi_irq_wait(pdMS_TO_TICKS(MFRC522_IRQ_TIMEOUT_MS))) {
+        mfrc522_counters.irqs++;
+    } else {
+        mfrc522_counters.irq_timeouts++;
+    }
+    const uint8_t irq = read_reg(MFRC522_REG_COM_IRQ);
+    write_reg(MFRC522_REG_COMMAND, MFRC522_CMD_IDLE);
+
+    if(irq & MFRC522_IRQ_ERR) {
+        const uint8_t error = read_reg(MFRC522_REG_ERROR);
+        if(error & MFRC522_ERR_COLL) { return MFRC522_COLLISION; }
+        if(error & (MFRC522_ERR_PROTOCOL | MFRC522_ERR_PARITY | MFRC522_ERR_BUFFER_OVFL)) { return MFRC522_ERROR; }
+    }
+    if(!(irq & MFRC522_IRQ_RX)) {
+        return (irq & MFRC522_IRQ_TIMER) ? MFRC522_NO_CARD : MFRC522_NO_IRQ;
+    }
+
+    size_t n = read_reg(MFRC522_REG_FIFO_LEVEL) & 0x7F;
+    if(n > *rx_len) { return MFRC522_ERROR; }
+    mfrc522_spi_read(MFRC522_REG_FIFO_DATA, rx, n);
+    mfrc522_counters.spi_bytes += (uint32_t)n + 1;
+    *rx_len = n;
+    return MFRC522_OK;
+}
+
+static bool check_crc(const uint8_t *data, const size_t len) {
+    const uint16_t crc = mfrc522_crc_a(data, len - 2);
+    return data[len - 2] == (crc & 0xFF) && data[len - 1] == (crc >> 8);
+}
+
+// ANTICOLLISION and SELECT of one cascade level, `part` gets the 4 UID bytes
+static mfrc522_status select_level(const uint8_t sel, uint8_t part[4], uint8_t *sak) {
+    uint8_t frame[MFRC522_SELECT_LEN] = { sel, 0x20 };
+    uint8_t rx[5];
+    size_t rx_len = sizeof(rx);
+
+    mfrc522_status status = mfrc522_transceive(frame, 2, 0, rx, &rx_len);
+    if(status != MFRC522_OK) { return status; }
+    if(rx_len != 5 || (rx[0] ^ rx[1] ^ rx[2] ^ rx[3]) != rx[4]) { return MFRC522_ERROR; }
+
+    // NVB 0x70: all 40 bits of UID part and BCC follow
+    frame[1] = 0x70;
+    memcpy(&frame[2], rx, 5);
+    const uint16_t crc = mfrc522_crc_a(frame, 7);
+    frame[7] = (uint8_t)(crc & 0xFF);
+    frame[8] = (uint8_t)(crc >> 8);
+    rx_len = 3;
+    status = mfrc522_transceive(frame, MFRC522_SELECT_LEN, 0, rx, &rx_len);
+    if(status != MFRC522_OK) { return status; }
+    if(rx_len != 3 || !check_crc(rx, 3)) { return MFRC522_ERROR; }
+
+    memcpy(part, &frame[2], 4);
+    *sak = rx[0];
+    return MFRC522_OK;
+}
+
+static mfrc522_status read_uid(mfrc522_uid *uid, const bool wake) {
+    static const uint8_t sel[3] = { MFRC522_PICC_SEL_CL1, MFRC522_PICC_SEL_CL2, MFRC522_PICC_SEL_CL3 };
+    const uint64_t start = hal_time_us();
+    const uint8_t req = wake ? MFRC522_PICC_WUPA : MFRC522_PICC_REQA;
+    uint8_t atqa[2];
+    size_t atqa_len = sizeof(atqa);
+
+    // Short frame, 7 bits
+    mfrc522_status status = mfrc522_transceive(&req, 1, 7, atqa, &atqa_len);
+    if(status != MFRC522_OK) { return status; }
+    if(atqa_len != 2) { return MFRC522_ERROR; }
+
+    uid->size = 0;
+    uid->atqa = (uint16_t)(atqa[0] | atqa[1] << 8);
+    for(int level=0; level<3; level++) {
+        uint8_t part[4];
+        status = select_level(sel[level], part, &uid->sak);
+        if(status != MFRC522_OK) { return status; }
+        if(uid->sak & MFRC522_SAK_UID_INCOMPLETE) {
+            // More levels follow, the first byte is the cascade tag
+            if(part[0] != MFRC522_PICC_CASCADE_TAG || level == 2) { return MFRC522_ERROR; }
+            memcpy(&uid->bytes[uid->size], &part[1], 3);
+            uid->size += 3;
+            continue;
+        }
+        memcpy(&uid->bytes[uid->size], part, 4);
+        uid->size += 4;
+        uid->time_us = hal_time_us();
+        uid->read_us = (uint32_t)(uid->time_us - start);
+        return MFRC522_OK;
+    }
+    return MFRC522_ERROR;
+}
+
+mfrc522_status mfrc522_read_uid(mfrc522_uid *uid, const bool wake) {
+    const mfrc522_status status = read_uid(uid, wake);
+    switch(status) {
+    case MFRC522_OK:
+        mfrc522_counters.reads++;
+        if(uid->read_us > mfrc522_counters.max_read_us) { mfrc522_counters.max_read_us = uid->read_us; }
+        break;
+    case MFRC522_NO_CARD:
+        mfrc522_counters.no_card++;
+        break;
+    case MFRC522_COLLISION:
+        mfrc522_counters.collisions++;
+        break;
+    default:
+        mfrc522_counters.errors++;
+        break;
+    }
+    return status;
+}
+
+void mfrc522_halt(void) {
+    uint8_t frame[4] = { MFRC522_PICC_HLTA, 0x00 };
+    const uint16_t crc = mfrc522_crc_a(frame, 2);
+    frame[2] = (uint8_t)(crc & 0xFF);
+    frame[3] = (uint8_t)(crc >> 8);
+    // A halted card does not answer, the timer ending the wait is success
+    uint8_t rx[1];
+    size_t rx_len = sizeof(rx);
+    ( void ) mfrc522_transceive(frame, sizeof(frame), 0, rx, &rx_len);
+}
+
+void mfrc522_set_handler(mfrc522_handler handler, void *ctx) {
+    taskENTER_CRITICAL();
+    mfrc522_on_card = handler;
+    mfrc522_on_card_ctx = ctx;
+    taskEXIT_CRITICAL();
+}
+
+void mfrc522_get_stats(mfrc522_stats *stats) {
+    taskENTER_CRITICAL();
+    *stats = mfrc522_counters;
+    taskEXIT_CRITICAL();
+}
+
+void mfrc522Task(void *pvParameters) {
+    ( void ) pvParameters;
+
+    // No reader: stay out of the way, the handle remains valid for others
+    if(!mfrc522_init()) {
+        vTaskSuspend(NULL);
+    }
+
+    TickType_t xNextWakeTime = xTaskGetTickCount();
+    mfrc522_uid last = { 0 };
+    bool present = false;
+    for( ;; ) {
+        vTaskDelayUntil(&xNextWakeTime, pdMS_TO_TICKS(MFRC522_POLL_MS));
+        mfrc522_counters.polls++;
+
+        // A card still on the reader was halted, only WUPA wakes it again
+        mfrc522_uid uid;
+        const mfrc522_status status = mfrc522_read_uid(&uid, present);
+        if(status == MFRC522_OK) {
+            const bool same = present && uid.size == last.size && memcmp(uid.bytes, last.bytes, uid.size) == 0;
+            if(!same) {
+                mfrc522_counters.taps++;
+                mfrc522_handler handler = mfrc522_on_card;
+                if(handler) { handler(&uid, mfrc522_on_card_ctx); }
+            }
+            last = uid;
+            present = true;
+            mfrc522_halt();
+        } else if(status == MFRC522_NO_CARD) {
+            present = false;
+        }
+        // Collisions and errors are read again at the next poll
+    }
+}
@@ -0,0 +1,189 @@
+#ifndef MFRC522_H
+#define MFRC522_H
+/*
+ * MFRC522 13.56 MHz reader, ISO/IEC 14443 A cards (MIFARE, NTAG).
+ *
+ * The chip is reached over SPI through the backend below: mfrc522_spi.c on
+ * the RP2040 (FIFO bursts by DMA, the IRQ pin on a GPIO interrupt) and
+ * host/mfrc522_spi_host.c on the host, which talks to the register level
+ * model of host/mfrc522_sim.c.
+ *
+ * Every exchange with a card is a Transceive command: the frame goes into
+ * the FIFO, the chip sends it and its timer starts, and the IRQ pin falls
+ * when the answer is in (RxIRq) or the timer ran out (TimerIRq). The task
+ * sleeps on the IRQ in between, it never polls the chip. Cards do not
+ * announce themselves, so mfrc522Task asks every MFRC522_POLL_MS with a
+ * REQA (one frame and a 5ms timeout when nobody answers) and reads the UID
+ * of whichever card answers:
+ *
+ *   REQA -> ATQA, then per cascade level ANTICOLLISION -> UID part + BCC
+ *   and SELECT -> SAK, until the SAK says the UID is complete, then HLTA.
+ *
+ * A halted card only answers WUPA, which tells a card still lying on the
+ * reader from a new tap. Only one card in the field is supported, two
+ * answering the anticollision are counted as a collision and read again.
+ *
+ *   mfrc522_set_handler(on_card, NULL);   // on_card(&uid, ctx) per tap
+ *   xTaskCreate(mfrc522Task, "RFID", ...);
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// GPIOs of the reader on SPI0: MISO 16, CS 17, SCK 18, MOSI 19, RST 20 and
+// IRQ 21. Other pin maps check against it, mfrc522_spi.c against its pins.
+#define MFRC522_GPIO_MASK             ( 0x3Fu << 16 )
+
+// Registers
+#define MFRC522_REG_COMMAND           ( 0x01 )
+#define MFRC522_REG_COM_IEN           ( 0x02 )
+#define MFRC522_REG_DIV_IEN           ( 0x03 )
+#define MFRC522_REG_COM_IRQ           ( 0x04 )
+#define MFRC522_REG_DIV_IRQ           ( 0x05 )
+#define MFRC522_REG_ERROR             ( 0x06 )
+#define MFRC522_REG_STATUS1           ( 0x07 )
+#define MFRC522_REG_STATUS2           ( 0x08 )
+#define MFRC522_REG_FIFO_DATA         ( 0x09 )
+#define MFRC522_REG_FIFO_LEVEL        ( 0x0A )
+#define MFRC522_REG_CONTROL           ( 0x0C )
+#define MFRC522_REG_BIT_FRAMING       ( 0x0D )
+#define MFRC522_REG_COLL              ( 0x0E )
+#define MFRC522_REG_MODE              ( 0x11 )
+#define MFRC522_REG_TX_MODE           ( 0x12 )
+#define MFRC522_REG_RX_MODE           ( 0x13 )
+#define MFRC522_REG_TX_CONTROL        ( 0x14 )
+#define MFRC522_REG_TX_ASK            ( 0x15 )
+#define MFRC522_REG_CRC_RESULT_H      ( 0x21 )
+#define MFRC522_REG_CRC_RESULT_L      ( 0x22 )
+#define MFRC522_REG_MOD_WIDTH         ( 0x24 )
+#define MFRC522_REG_RF_CFG            ( 0x26 )
+#define MFRC522_REG_T_MODE            ( 0x2A )
+#define MFRC522_REG_T_PRESCALER       ( 0x2B )
+#define MFRC522_REG_T_RELOAD_H        ( 0x2C )
+#define MFRC522_REG_T_RELOAD_L        ( 0x2D )
+#define MFRC522_REG_VERSION           ( 0x37 )
+#define MFRC522_REG_COUNT             ( 0x40 )
+
+// CommandReg
+#define MFRC522_CMD_IDLE              ( 0x00 )
+#define MFRC522_CMD_CALC_CRC          ( 0x03 )
+#define MFRC522_CMD_TRANSCEIVE        ( 0x0C )
+#define MFRC522_CMD_SOFT_RESET        ( 0x0F )
+
+// ComIrqReg / ComIEnReg (bit 7 is Set1 / IRqInv)
+#define MFRC522_IRQ_TIMER             ( 1u << 0 )
+#define MFRC522_IRQ_ERR               ( 1u << 1 )
+#define MFRC522_IRQ_IDLE              ( 1u << 4 )
+#define MFRC522_IRQ_RX                ( 1u << 5 )
+#define MFRC522_IRQ_TX                ( 1u << 6 )
+#define MFRC522_IRQ_SET               ( 1u << 7 )
+// DivIrqReg
+#define MFRC522_DIV_IRQ_CRC           ( 1u << 2 )
+
+// ErrorReg
+#define MFRC522_ERR_PROTOCOL          ( 1u << 0 )
+#define MFRC522_ERR_PARITY            ( 1u << 1 )
+#define MFRC522_ERR_CRC               ( 1u << 2 )
+#define MFRC522_ERR_COLL              ( 1u << 3 )
+#define MFRC522_ERR_BUFFER_OVFL       ( 1u << 4 )
+
+#define MFRC522_FIFO_SIZE             ( 64 )
+#define MFRC522_FIFO_FLUSH            ( 0x80 )
+#define MFRC522_BIT_FRAMING_START     ( 0x80 )
+
+// ISO/IEC 14443 A commands
+#define MFRC522_PICC_REQA             ( 0x26 )
+#define MFRC522_PICC_WUPA             ( 0x52 )
+#define MFRC522_PICC_HLTA             ( 0x50 )
+#define MFRC522_PICC_SEL_CL1          ( 0x93 )
+#define MFRC522_PICC_SEL_CL2          ( 0x95 )
+#define MFRC522_PICC_SEL_CL3          ( 0x97 )
+#define MFRC522_PICC_CASCADE_TAG      ( 0x88 )
+#define MFRC522_SAK_UID_INCOMPLETE    ( 0x04 )
+
+#define MFRC522_UID_MAX               ( 10 )
+
+// Time between two REQA while no card is in the field
+#ifndef MFRC522_POLL_MS
+#define MFRC522_POLL_MS               ( 50 )
+#endif
+// Chip timer started at the end of every frame: 40 kHz, 5ms
+#define MFRC522_TIMER_PRESCALER       ( 0x0A9 )
+#define MFRC522_TIMER_RELOAD          ( 200 )
+// Longest wait for the IRQ pin, past the chip timer
+#define MFRC522_IRQ_TIMEOUT_MS        ( 10 )
+
+typedef enum {
+    MFRC522_OK,
+    MFRC522_NO_CARD,              // Timer ran out, nobody answered
+    MFRC522_COLLISION,
+    MFRC522_ERROR,                // Parity, protocol, CRC, BCC, framing
+    MFRC522_NO_IRQ,               // The IRQ pin never fell
+} mfrc522_status;
+
+typedef struct {
+    uint8_t size;                 // 4, 7 or 10 bytes
+    uint8_t bytes[MFRC522_UID_MAX];
+    uint8_t sak;
+    uint16_t atqa;
+    uint64_t time_us;             // hal_time_us() when the UID was complete
+    uint32_t read_us;             // From the REQA/WUPA that found the card
+} mfrc522_uid;
+
+typedef struct {
+    uint32_t polls;
+    uint32_t reads;               // UIDs read
+    uint32_t taps;                // New cards handed to the handler
+    uint32_t no_card;
+    uint32_t collisions;
+    uint32_t errors;
+    uint32_t irqs;                // Waits ended by the IRQ pin
+    uint32_t irq_timeouts;
+    uint32_t spi_bytes;
+    uint32_t max_read_us;
+} mfrc522_stats;
+
+typedef void (*mfrc522_handler)(const mfrc522_uid *uid, void *ctx);
+
+// Reset the chip, set up timer, IRQ and antenna; false if it does not answer
+bool mfrc522_init(void);
+// Exchange of one frame, `tx_last_bits` valid bits in the last byte (0: 8)
+mfrc522_status mfrc522_transceive(const uint8_t *tx, const size_t tx_len, const uint8_t tx_last_bits,
+        uint8_t *rx, size_t *rx_len);
+// REQA (or WUPA when `wake`) and the whole cascade, leaves the card selected
+mfrc522_status mfrc522_read_uid(mfrc522_uid *uid, const bool wake);
+// Put the selected card to sleep, it then only answers WUPA
+void mfrc522_halt(void);
+// CRC_A of ISO/IEC 14443-3, appended to SELECT and HLTA, low byte first
+uint16_t mfrc522_crc_a(const uint8_t *data, const size_t len);
+
+void mfrc522_set_handler(mfrc522_handler handler, void *ctx);
+void mfrc522_get_stats(mfrc522_stats *stats);
+
+// Polls for cards, calls the handler once per tap
+void mfrc522Task(void *pvParameters);
+
+/*
+ * SPI backend. Register accesses are short blocking transfers, FIFO bursts
+ * of MFRC522_SPI_DMA_MIN bytes or more go by DMA with the task asleep.
+ */
+#define MFRC522_SPI_DMA_MIN           ( 8 )
+void mfrc522_spi_init(void);
+void mfrc522_spi_write(const uint8_t reg, const uint8_t *data, const size_t len);
+void mfrc522_spi_read(const uint8_t reg, uint8_t *data, const size_t len);
+// The next IRQ wakes the calling task, call before starting the command
+void mfrc522_spi_irq_arm(void);
+// Wait for the armed IRQ, false on timeout
+bool mfrc522_spi_irq_wait(const TickType_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
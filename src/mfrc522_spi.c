@@ -0,0 +1,178 @@
+#include "mfrc522.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/spi.h"
+
+#define MFRC522_SPI                   ( spi0 )
+#define MFRC522_SPI_BAUD              ( 4000000 )
+#define MFRC522_SPI_PIN_MISO          ( 16 )
+#define MFRC522_SPI_PIN_CS            ( 17 )
+#define MFRC522_SPI_PIN_SCK           ( 18 )
+#define MFRC522_SPI_PIN_MOSI          ( 19 )
+#define MFRC522_SPI_PIN_RST           ( 20 )
+#define MFRC522_SPI_PIN_IRQ           ( 21 )
+#if MFRC522_GPIO_MASK != ( ( 1u << MFRC522_SPI_PIN_MISO ) | ( 1u << MFRC522_SPI_PIN_CS ) | ( 1u << MFRC522_SPI_PIN_SCK ) | \
+    ( 1u << MFRC522_SPI_PIN_MOSI ) | ( 1u << MFRC522_SPI_PIN_RST ) | ( 1u << MFRC522_SPI_PIN_IRQ ) )
+#error MFRC522_GPIO_MASK DOES NOT MATCH THE SPI PINS
+#endif
+// DMA_IRQ_0 belongs to the LCD bus
+#define MFRC522_SPI_DMA_IRQ           ( DMA_IRQ_1 )
+#define MFRC522_SPI_GPIO_IRQ          ( IO_IRQ_BANK0 )
+
+// Address byte plus a full FIFO
+static uint8_t mfrc522_spi_tx[MFRC522_FIFO_SIZE + 1];
+static uint8_t mfrc522_spi_rx[MFRC522_FIFO_SIZE + 1];
+static int mfrc522_spi_dma_tx;
+static int mfrc522_spi_dma_rx;
+static TaskHandle_t volatile mfrc522_spi_dma_waiter = NULL;
+static TaskHandle_t volatile mfrc522_spi_irq_waiter = NULL;
+
+static void mfrc522_spi_dma_handler(void) {
+    if(!dma_channel_get_irq1_status((uint)mfrc522_spi_dma_rx)) { return; }
+    traceIRQ_ENTER(MFRC522_SPI_DMA_IRQ);
+    dma_channel_acknowledge_irq1((uint)mfrc522_spi_dma_rx);
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    if(mfrc522_spi_dma_waiter != NULL) {
+        vTaskNotifyGiveFromISR(mfrc522_spi_dma_waiter, &xHigherPriorityTaskWoken);
+        mfrc522_spi_dma_waiter = NULL;
+    }
+    traceIRQ_EXIT(MFRC522_SPI_DMA_IRQ);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+static void mfrc522_spi_irq_handler(void) {
+    if(!(gpio_get_irq_event_mask(MFRC522_SPI_PIN_IRQ) & GPIO_IRQ_EDGE_FALL)) { return; }
+    traceIRQ_ENTER(MFRC522_SPI_GPIO_IRQ);
+    gpio_acknowledge_irq(MFRC522_SPI_PIN_IRQ, GPIO_IRQ_EDGE_FALL);
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    if(mfrc522_spi_irq_waiter != NULL) {
+        vTaskNotifyGiveFromISR(mfrc522_spi_irq_waiter, &xHigherPriorityTaskWoken);
+        mfrc522_spi_irq_waiter = NULL;
+    }
+    traceIRQ_EXIT(MFRC522_SPI_GPIO_IRQ);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void mfrc522_spi_init(void) {
+    spi_init(MFRC522_SPI, MFRC522_SPI_BAUD);
+    gpio_set_function(MFRC522_SPI_PIN_MISO, GPIO_FUNC_SPI);
+    gpio_set_function(MFRC522_SPI_PIN_SCK, GPIO_FUNC_SPI);
+    gpio_set_function(MFRC522_SPI_PIN_MOSI, GPIO_FUNC_SPI);
+    gpio_init(MFRC522_SPI_PIN_CS);
+    gpio_set_dir(MFRC522_SPI_PIN_CS, GPIO_OUT);
+    gpio_put(MFRC522_SPI_PIN_CS, 1);
+
+    // Hard reset, the chip powers down while RST is low
+    gpio_init(MFRC522_SPI_PIN_RST);
+    gpio_set_dir(MFRC522_SPI_PIN_RST, GPIO_OUT);
+    gpio_put(MFRC522_SPI_PIN_RST, 0);
+    vTaskDelay(pdMS_TO_TICKS(1));
+    gpio_put(MFRC522_SPI_PIN_RST, 1);
+
+    // Both channels paced by the SPI, RX completes last
+    mfrc522_spi_dma_tx = dma_claim_unused_channel(true);
+    mfrc522_spi_dma_rx = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config((uint)mfrc522_spi_dma_tx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(MFRC522_SPI, true));
+    dma_channel_configure((uint)mfrc522_spi_dma_tx, &c,
+            &spi_get_hw(MFRC522_SPI)->dr, mfrc522_spi_tx, 0, false);
+
+    c = dma_channel_get_default_config((uint)mfrc522_spi_dma_rx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, spi_get_dreq(MFRC522_SPI, false));
+    dma_channel_configure((uint)mfrc522_spi_dma_rx, &c,
+            mfrc522_spi_rx, &spi_get_hw(MFRC522_SPI)->dr, 0, false);
+
+    dma_channel_set_irq1_enabled((uint)mfrc522_spi_dma_rx, true);
+    irq_add_shared_handler(MFRC522_SPI_DMA_IRQ, mfrc522_spi_dma_handler,
+            PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(MFRC522_SPI_DMA_IRQ, true);
+
+    // IRQ pin, the chip drives it push-pull and active low once set up
+    gpio_init(MFRC522_SPI_PIN_IRQ);
+    gpio_set_dir(MFRC522_SPI_PIN_IRQ, GPIO_IN);
+    gpio_pull_up(MFRC522_SPI_PIN_IRQ);
+    gpio_add_raw_irq_handler(MFRC522_SPI_PIN_IRQ, mfrc522_spi_irq_handler);
+    gpio_set_irq_enabled(MFRC522_SPI_PIN_IRQ, GPIO_IRQ_EDGE_FALL, true);
+    irq_set_enabled(MFRC522_SPI_GPIO_IRQ, true);
+}
+
+// Whole transfer of `len` bytes from mfrc522_spi_tx, the task sleeps until
+// the last byte is clocked in
+static void transfer_dma(const size_t len) {
+    // Clear any stale notification before arming the wait
+    ulTaskNotifyTake(pdTRUE, 0);
+    mfrc522_spi_dma_waiter = xTaskGetCurrentTaskHandle();
+    dma_channel_set_read_addr((uint)mfrc522_spi_dma_tx, mfrc522_spi_tx, false);
+    dma_channel_set_write_addr((uint)mfrc522_spi_dma_rx, mfrc522_spi_rx, false);
+    dma_channel_set_trans_count((uint)mfrc522_spi_dma_tx, (uint32_t)len, false);
+    dma_channel_set_trans_count((uint)mfrc522_spi_dma_rx, (uint32_t)len, false);
+    dma_start_channel_mask((1u << mfrc522_spi_dma_tx) | (1u << mfrc522_spi_dma_rx));
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+void mfrc522_spi_write(const uint8_t reg, const uint8_t *data, const size_t len) {
+    // Address byte: bit 7 clear to write, register in bits 6..1
+    const uint8_t address = (uint8_t)((reg << 1) & 0x7E);
+    gpio_put(MFRC522_SPI_PIN_CS, 0);
+    if(len < MFRC522_SPI_DMA_MIN) {
+        spi_write_blocking(MFRC522_SPI, &address, 1);
+        spi_write_blocking(MFRC522_SPI, data, len);
+    } else {
+        mfrc522_spi_tx[0] = address;
+        for(size_t i=0; i<len; i++) {
+            mfrc522_spi_tx[i + 1] = data[i];
+        }
+        transfer_dma(len + 1);
+    }
+    gpio_put(MFRC522_SPI_PIN_CS, 1);
+}
+
+void mfrc522_spi_read(const uint8_t reg, uint8_t *data, const size_t len) {
+    if(len == 0) { return; }
+    // Bit 7 set to read. The address of the next read goes out while the
+    // previous byte comes in, 0 ends the burst
+    const uint8_t address = (uint8_t)(0x80 | ((reg << 1) & 0x7E));
+    gpio_put(MFRC522_SPI_PIN_CS, 0);
+    if(len < MFRC522_SPI_DMA_MIN) {
+        spi_write_blocking(MFRC522_SPI, &address, 1);
+        spi_read_blocking(MFRC522_SPI, address, data, len - 1);
+        spi_read_blocking(MFRC522_SPI, 0x00, &data[len - 1], 1);
+    } else {
+        for(size_t i=0; i<len; i++) {
+            mfrc522_spi_tx[i] = address;
+        }
+        mfrc522_spi_tx[len] = 0x00;
+        transfer_dma(len + 1);
+        for(size_t i=0; i<len; i++) {
+            data[i] = mfrc522_spi_rx[i + 1];
+        }
+    }
+    gpio_put(MFRC522_SPI_PIN_CS, 1);
+}
+
+void mfrc522_spi_irq_arm(void) {
+    ulTaskNotifyTake(pdTRUE, 0);
+    mfrc522_spi_irq_waiter = xTaskGetCurrentTaskHandle();
+}
+
+bool mfrc522_spi_irq_wait(const TickType_t ticks) {
+    const bool fired = ulTaskNotifyTake(pdTRUE, ticks) > 0;
+    // A late edge finds nobody, the next arm clears what it may have given
+    mfrc522_spi_irq_waiter = NULL;
+    return fired;
+}
@@ -0,0 +1,231 @@
+/*
+ * Several displays on one bus, interleaved against one after the other.
+ *
+ * Built as multi_bench (RP2040, results over USB stdio) and multi_bench_host
+ * (three simulated controllers). common.c calls main_multi_bench() instead
+ * of main_blinky().
+ *
+ * Three displays share D4..D7, RW and RS with their own E pin: 16x2 on the
+ * board LCD pin (11), 20x4 on 13 and 40x2 on 14. For 1, 2 and 3 of them
+ * every cell changes on every render:
+ * - serial_chars_per_s_N      : displays written one after the other
+ * - interleaved_chars_per_s_N : transfers interleaved across the displays
+ * - scaling_N                 : interleaved rate over the one display rate,
+ *                               in percent (N * 100 is linear)
+ * - bound_N                   : best scaling the sizes allow, each controller
+ *                               takes one character per execution time, so
+ *                               the largest frame sets the render time
+ * On the host the simulated controllers also have to show the last frames
+ * without a single busy violation.
+ */
+
+#include "hd44780_multi.h"
+#include "bench.h"
+#include "hal.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+#include <string.h>
+#ifdef HOST_BUILD
+#include "board_host.h"
+#endif
+
+#define multibenchTASK_PRIORITY                ( tskIDLE_PRIORITY + 1 )
+
+#define multibenchRENDERS                      ( 20 )
+#define multibenchDISPLAYS                     ( 3 )
+#define multibenchPIN_RW                       ( 9 )
+#define multibenchPIN_RS                       ( 10 )
+// Give the host time to open the USB serial port
+#define multibenchUSB_SETTLE_MS                ( 2000 / portTICK_PERIOD_MS )
+
+int main_multi_bench( void );
+
+typedef struct
+{
+    int xPinE;
+    int xRows;
+    int xCols;
+} DisplayConfig_t;
+
+static const int xDataPins[ 4 ] = { 5, 6, 7, 8 };
+static const DisplayConfig_t xDisplayConfig[ multibenchDISPLAYS ] =
+{
+    { 11, 2, 16 },
+    { 13, 4, 20 },
+    { 14, 2, 40 },
+};
+
+static void prvMultiBenchTask( void *pvParameters );
+
+static hd44780_multi xBus;
+static hd44780_display xDisplays[ multibenchDISPLAYS ];
+#ifdef HOST_BUILD
+/* The board already simulates the display on pin 11. */
+static hd44780_sim xSims[ multibenchDISPLAYS - 1 ];
+#endif
+
+/*-----------------------------------------------------------*/
+
+int main_multi_bench( void )
+{
+    printf(" Starting main_multi_bench.\n");
+
+    xTaskCreate( prvMultiBenchTask, "BENCH", configMINIMAL_STACK_SIZE * 2, NULL, multibenchTASK_PRIORITY, NULL );
+    vTaskStartScheduler();
+
+    for( ;; );
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+#ifdef HOST_BUILD
+static hd44780_sim *prvSim( const int xDisplay )
+{
+    return ( xDisplay == 0 ) ? board_host_lcd() : &xSims[ xDisplay - 1 ];
+}
+#endif
+/*-----------------------------------------------------------*/
+
+static void prvAttachSims( void )
+{
+#ifdef HOST_BUILD
+    const int xData[ 8 ] = { -1, -1, -1, -1, xDataPins[ 0 ], xDataPins[ 1 ], xDataPins[ 2 ], xDataPins[ 3 ] };
+
+    for( int i = 1; i < multibenchDISPLAYS; i++ )
+    {
+        hd44780_sim_init( &xSims[ i - 1 ], xData, multibenchPIN_RW, multibenchPIN_RS, xDisplayConfig[ i ].xPinE, NULL );
+        hd44780_sim_attach( &xSims[ i - 1 ] );
+    }
+#endif
+}
+/*-----------------------------------------------------------*/
+
+/* Every cell of the first xCount displays gets a new character. */
+static uint32_t prvFillFrames( const int xCount, const char c )
+{
+char cLine[ HD44780_MULTI_MAX_COLS + 1 ];
+uint32_t ulCells = 0;
+
+    for( int i = 0; i < xCount; i++ )
+    {
+        hd44780_display *pxDisplay = &xDisplays[ i ];
+        for( int r = 0; r < pxDisplay->rows; r++ )
+        {
+            memset( cLine, c + r, ( size_t ) pxDisplay->cols );
+            cLine[ pxDisplay->cols ] = '\0';
+            hd44780_display_set_line( pxDisplay, r, cLine );
+        }
+        ulCells += ( uint32_t ) ( pxDisplay->rows * pxDisplay->cols );
+    }
+    return ulCells;
+}
+/*-----------------------------------------------------------*/
+
+/* Cells of the first xCount displays over the cells of the largest one. */
+static uint64_t prvBound( const int xCount )
+{
+uint32_t ulCells = 0, ulLargest = 0;
+
+    for( int i = 0; i < xCount; i++ )
+    {
+        const uint32_t ulDisplay = ( uint32_t ) ( xDisplayConfig[ i ].xRows * xDisplayConfig[ i ].xCols );
+        ulCells += ulDisplay;
+        ulLargest = ( ulDisplay > ulLargest ) ? ulDisplay : ulLargest;
+    }
+    return ( ( uint64_t ) ulCells * 100 ) / ulLargest;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvRun( const int xCount, const bool xInterleave, const char *pcMetric, char *pcNext )
+{
+uint64_t ullUs = 0, ullCells = 0;
+
+    xBus.interleave = xInterleave;
+    for( int i = 0; i < multibenchRENDERS; i++ )
+    {
+        ullCells += prvFillFrames( xCount, *pcNext );
+        *pcNext = ( *pcNext >= 'Z' ) ? 'A' : *pcNext + 1;
+        const uint64_t ullStart = hal_time_us();
+        hd44780_multi_render( &xBus );
+        ullUs += hal_time_us() - ullStart;
+    }
+
+    const uint64_t ullRate = ullUs ? ( ullCells * 1000000 ) / ullUs : 0;
+    bench_report_value( "multi", pcMetric, "chars/s", ullRate );
+    return ullRate;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheckSims( void )
+{
+#ifdef HOST_BUILD
+char cRow[ HD44780_MULTI_MAX_COLS + 1 ];
+uint32_t ulViolations = 0, ulRowsWrong = 0;
+
+    for( int i = 0; i < multibenchDISPLAYS; i++ )
+    {
+        const hd44780_display *pxDisplay = &xDisplays[ i ];
+        ulViolations += prvSim( i )->stats.busy_violations;
+        for( int r = 0; r < pxDisplay->rows; r++ )
+        {
+            hd44780_sim_row( prvSim( i ), r, pxDisplay->cols, cRow );
+            ulRowsWrong += strcmp( cRow, pxDisplay->frame[ r ] ) != 0;
+        }
+    }
+    bench_report_value( "multi", "busy_violations", "writes", ulViolations );
+    bench_report_value( "multi", "rows_wrong", "rows", ulRowsWrong );
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvMultiBenchTask( void *pvParameters )
+{
+TickType_t xNextWakeTime;
+uint64_t ullSingle = 0;
+char cNext = 'A';
+char cMetric[ 32 ];
+
+    ( void ) pvParameters;
+
+#ifndef HOST_BUILD
+    vTaskDelay( multibenchUSB_SETTLE_MS );
+#endif
+
+    prvAttachSims();
+    hd44780_multi_init( &xBus, xDataPins, multibenchPIN_RW, multibenchPIN_RS );
+    for( int i = 0; i < multibenchDISPLAYS; i++ )
+    {
+        const bool xAdded = hd44780_multi_add( &xBus, &xDisplays[ i ], xDisplayConfig[ i ].xPinE,
+            xDisplayConfig[ i ].xRows, xDisplayConfig[ i ].xCols );
+        configASSERT( xAdded );
+        ( void ) xAdded;
+    }
+    xNextWakeTime = xTaskGetTickCount();
+    hd44780_multi_reset( &xBus, &xNextWakeTime );
+
+    for( int xCount = 1; xCount <= multibenchDISPLAYS; xCount++ )
+    {
+        snprintf( cMetric, sizeof( cMetric ), "serial_chars_per_s_%d", xCount );
+        prvRun( xCount, false, cMetric, &cNext );
+        snprintf( cMetric, sizeof( cMetric ), "interleaved_chars_per_s_%d", xCount );
+        const uint64_t ullRate = prvRun( xCount, true, cMetric, &cNext );
+        if( xCount == 1 )
+        {
+            ullSingle = ullRate;
+        }
+        snprintf( cMetric, sizeof( cMetric ), "scaling_%d", xCount );
+        bench_report_value( "multi", cMetric, "percent", ullSingle ? ( ullRate * 100 ) / ullSingle : 0 );
+        snprintf( cMetric, sizeof( cMetric ), "bound_%d", xCount );
+        bench_report_value( "multi", cMetric, "percent", prvBound( xCount ) );
+    }
+
+    bench_report_value( "multi", "bus_waits", "waits", xBus.stats.waits );
+    prvCheckSims();
+    bench_done();
+}
+/*-----------------------------------------------------------*/
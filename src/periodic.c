@@ -0,0 +1,132 @@
+#include "periodic.h"
+#include "dlog.h"
+#include "hal.h"
+
+/* Library includes. */
+#include <stdio.h>
+
+static periodic *periodic_list = NULL;
+static uint16_t periodic_count = 0;
+
+static uint32_t bucket(const uint32_t us) {
+    const uint32_t b = us ? 32u - (uint32_t)__builtin_clz(us) : 0;
+    return b < PERIODIC_BUCKETS ? b : PERIODIC_BUCKETS - 1;
+}
+
+static uint32_t since(const uint64_t now, const uint64_t then) {
+    if(now <= then) { return 0; }
+    const uint64_t d = now - then;
+    return d > UINT32_MAX ? UINT32_MAX : (uint32_t)d;
+}
+
+void periodic_init(periodic *p) {
+    // The release grid advances by period_us while the task sleeps whole
+    // ticks, any remainder would pile up as start latency
+    configASSERT( p->period_us >= PERIODIC_TICK_US && p->period_us % PERIODIC_TICK_US == 0 );
+
+    p->running = 0;
+    p->flagged = 0;
+    p->stats = (periodic_stats){ 0 };
+
+    taskENTER_CRITICAL();
+    p->id = periodic_count++;
+    p->next_periodic = periodic_list;
+    periodic_list = p;
+    taskEXIT_CRITICAL();
+}
+
+// Called with the job locked
+static void begin(periodic *p, const uint64_t now) {
+    const uint32_t start = since(now, p->release_us);
+    p->stats.start[bucket(start)]++;
+    if(start > p->stats.max_start_us) { p->stats.max_start_us = start; }
+    if(start >= p->period_us) { p->stats.late_releases++; }
+    p->running = 1;
+    p->flagged = 0;
+}
+
+void periodic_start(periodic *p) {
+    p->wake = xTaskGetTickCount();
+    const uint64_t now = hal_time_us();
+    taskENTER_CRITICAL();
+    p->release_us = now;
+    p->running = 0;
+    taskEXIT_CRITICAL();
+}
+
+void periodic_wait(periodic *p) {
+    const uint64_t done = hal_time_us();
+    uint32_t missed_us = 0;
+
+    taskENTER_CRITICAL();
+    if(p->running) {
+        const uint32_t response = since(done, p->release_us);
+        p->stats.response[bucket(response)]++;
+        if(response > p->stats.max_response_us) { p->stats.max_response_us = response; }
+        if(response > p->deadline_us && !p->flagged) {
+            p->stats.misses++;
+            missed_us = response;
+        }
+        p->stats.jobs++;
+        p->running = 0;
+    }
+    taskEXIT_CRITICAL();
+    if(missed_us) {
+        DLOG("periodic %u missed its deadline, done %u us after release", p->id, missed_us);
+    }
+
+    vTaskDelayUntil(&p->wake, (TickType_t)(p->period_us / PERIODIC_TICK_US));
+
+    const uint64_t now = hal_time_us();
+    taskENTER_CRITICAL();
+    p->release_us += p->period_us;
+    begin(p, now);
+    taskEXIT_CRITICAL();
+}
+
+void periodic_tick(void) {
+    const uint64_t now = hal_time_us();
+    const UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    for(periodic *p=periodic_list; p!=NULL; p=p->next_periodic) {
+        if(p->running && !p->flagged && since(now, p->release_us) > p->deadline_us) {
+            p->flagged = 1;
+            p->stats.misses++;
+            DLOG("periodic %u still running past its deadline, job %u", p->id, p->stats.jobs);
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+}
+
+void periodic_get_stats(periodic *p, periodic_stats *stats) {
+    taskENTER_CRITICAL();
+    *stats = p->stats;
+    taskEXIT_CRITICAL();
+}
+
+void periodic_reset(periodic *p) {
+    taskENTER_CRITICAL();
+    p->stats = (periodic_stats){ 0 };
+    taskEXIT_CRITICAL();
+}
+
+static void print_buckets(const char *label, const uint32_t *counts) {
+    printf(" %s=", label);
+    for(uint32_t b=0; b<PERIODIC_BUCKETS; b++) {
+        printf(b ? ",%lu" : "%lu", (unsigned long)counts[b]);
+    }
+}
+
+void periodic_report(void) {
+    for(periodic *p=periodic_list; p!=NULL; p=p->next_periodic) {
+        periodic_stats s;
+        periodic_get_stats(p, &s);
+        printf("PERIODIC %u %s period_us=%lu deadline_us=%lu jobs=%lu misses=%lu late_releases=%lu"
+               " max_start_us=%lu max_response_us=%lu",
+            (unsigned)p->id, p->name, (unsigned long)p->period_us, (unsigned long)p->deadline_us,
+            (unsigned long)s.jobs, (unsigned long)s.misses, (unsigned long)s.late_releases,
+            (unsigned long)s.max_start_us, (unsigned long)s.max_response_us);
+        print_buckets("start", s.start);
+        print_buckets("response", s.response);
+        printf("\n");
+    }
+}
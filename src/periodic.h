@@ -0,0 +1,99 @@
+#ifndef PERIODIC_H
+#define PERIODIC_H
+/*
+ * Deadline and jitter monitor of periodic jobs.
+ *
+ * A periodic task declares its period and deadline once and waits for its
+ * next release with periodic_wait() instead of vTaskDelayUntil():
+ *
+ *   PERIODIC_DEFINE(send_job, "TX", 200, 5);     // every 200ms, done in 5ms
+ *   periodic_init(&send_job);                     // before the scheduler
+ *   ...in the task:
+ *   periodic_start(&send_job);
+ *   for( ;; ) {
+ *       periodic_wait(&send_job);
+ *       ...the job...
+ *   }
+ *
+ * Releases are on a grid of `period` from periodic_start(). On every
+ * release the job records the start latency (release to running) and on
+ * the next periodic_wait() the response time (release to done), each into
+ * a histogram of power of two buckets of microseconds: bucket 0 is 0us,
+ * bucket b holds [2^(b-1), 2^b) us and the last one everything above.
+ *
+ * The tick hook calls periodic_tick(), which flags a job still running past
+ * its deadline on that tick: the miss is counted and logged with DLOG()
+ * within the deadline plus a tick, without waiting for the job to end. A
+ * job that ends late between two ticks is counted when it ends. A job that
+ * starts after its release has passed by a whole period (the previous one
+ * ran past it) is a late release. The hook costs a few compares per job.
+ *
+ * trace_task() and the console "stats" command print one line per job:
+ *   PERIODIC <id> <name> period_us=.. deadline_us=.. jobs=.. misses=.. late_releases=..
+ *            max_start_us=.. max_response_us=.. start=<buckets> response=<buckets>
+ */
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PERIODIC_BUCKETS              ( 20 ) // Up to 2^18 us, about 262ms
+// Periods are whole ticks, periodic_init() asserts it
+#define PERIODIC_TICK_US              ( 1000000u / configTICK_RATE_HZ )
+
+typedef struct {
+    uint32_t jobs;                // Completed
+    uint32_t misses;              // Past their deadline, running or done
+    uint32_t late_releases;       // Released a period or more late
+    uint32_t max_start_us;
+    uint32_t max_response_us;
+    uint32_t start[PERIODIC_BUCKETS];
+    uint32_t response[PERIODIC_BUCKETS];
+} periodic_stats;
+
+typedef struct periodic {
+    const char *name;
+    uint32_t period_us;
+    uint32_t deadline_us;
+
+    // Owner task only
+    TickType_t wake;
+    // Shared with the tick hook
+    uint64_t release_us;          // Of the current job
+    uint8_t running;
+    uint8_t flagged;              // Miss already counted by the tick hook
+    uint16_t id;                  // Registration order, for DLOG()
+
+    struct periodic *next_periodic;
+    periodic_stats stats;
+} periodic;
+
+#define PERIODIC_DEFINE( var, job_name, period_ms, deadline_ms )                \
+    periodic var = {                                                            \
+        .name = ( job_name ),                                                   \
+        .period_us = ( period_ms ) * 1000u,                                     \
+        .deadline_us = ( deadline_ms ) * 1000u,                                 \
+    }
+
+// Registers the job, before the scheduler starts or from any task. The
+// period must be a whole number of ticks.
+void periodic_init(periodic *p);
+// First release now, called by the task of the job
+void periodic_start(periodic *p);
+// Ends the current job and sleeps until the next release
+void periodic_wait(periodic *p);
+// From the tick hook, flags the jobs running past their deadline
+void periodic_tick(void);
+
+void periodic_get_stats(periodic *p, periodic_stats *stats);
+void periodic_reset(periodic *p);
+void periodic_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
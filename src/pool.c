@@ -0,0 +1,115 @@
+#include "pool.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+#include <string.h>
+
+static pool *pool_list = NULL;
+
+void pool_init(pool *p) {
+    p->free_list = NULL;
+    memset(p->used, 0, (p->count + 7) / 8);
+    // Thread the blocks in order so the first allocations are the lowest
+    for(size_t i=p->count; i>0; i--) {
+        pool_block *b = (pool_block *)(p->storage + (i - 1) * p->block_size);
+        b->next = p->free_list;
+        p->free_list = b;
+    }
+    p->in_use = 0;
+    p->peak = 0;
+    p->allocs = 0;
+    p->failures = 0;
+    p->bad_frees = 0;
+
+    taskENTER_CRITICAL();
+    // Registered once, a second link would close the list into a cycle
+    const pool *q = pool_list;
+    while(q != NULL && q != p) { q = q->next_pool; }
+    if(q == NULL) {
+        p->next_pool = pool_list;
+        pool_list = p;
+    }
+    taskEXIT_CRITICAL();
+}
+
+static void *take(pool *p) {
+    pool_block *b = p->free_list;
+    if(b == NULL) {
+        p->failures++;
+        return NULL;
+    }
+    p->free_list = b->next;
+    const size_t i = ((uint8_t *)b - p->storage) / p->block_size;
+    p->used[i / 8] |= (uint8_t)(1u << (i % 8));
+    p->allocs++;
+    if(++p->in_use > p->peak) { p->peak = p->in_use; }
+    return b;
+}
+
+static void give(pool *p, void *block) {
+    pool_block *b = (pool_block *)block;
+    configASSERT( (uint8_t *)block >= p->storage &&
+                  (uint8_t *)block < p->storage + p->count * p->block_size );
+    const size_t offset = (size_t)((uint8_t *)block - p->storage);
+    const size_t i = offset / p->block_size;
+    const uint8_t bit = (uint8_t)(1u << (i % 8));
+    // Freed twice or inside a block: linking it would hand it out twice
+    if(offset % p->block_size || !(p->used[i / 8] & bit)) {
+        p->bad_frees++;
+        return;
+    }
+    p->used[i / 8] &= (uint8_t)~bit;
+    b->next = p->free_list;
+    p->free_list = b;
+    p->in_use--;
+}
+
+void *pool_alloc(pool *p) {
+    taskENTER_CRITICAL();
+    void *b = take(p);
+    taskEXIT_CRITICAL();
+    return b;
+}
+
+void pool_free(pool *p, void *block) {
+    if(block == NULL) { return; }
+    taskENTER_CRITICAL();
+    give(p, block);
+    taskEXIT_CRITICAL();
+}
+
+void *pool_alloc_from_isr(pool *p) {
+    const UBaseType_t uxSaved = taskENTER_CRITICAL_FROM_ISR();
+    void *b = take(p);
+    taskEXIT_CRITICAL_FROM_ISR(uxSaved);
+    return b;
+}
+
+void pool_free_from_isr(pool *p, void *block) {
+    if(block == NULL) { return; }
+    const UBaseType_t uxSaved = taskENTER_CRITICAL_FROM_ISR();
+    give(p, block);
+    taskEXIT_CRITICAL_FROM_ISR(uxSaved);
+}
+
+size_t pool_total_bytes(void) {
+    size_t total = 0;
+    for(const pool *p=pool_list; p!=NULL; p=p->next_pool) {
+        total += p->block_size * p->count;
+    }
+    return total;
+}
+
+void pool_report(void) {
+    for(const pool *p=pool_list; p!=NULL; p=p->next_pool) {
+        printf("POOL %s block=%lu count=%lu in_use=%lu peak=%lu allocs=%lu failures=%lu bad_frees=%lu\n",
+            p->name, (unsigned long)p->block_size, (unsigned long)p->count,
+            (unsigned long)p->in_use, (unsigned long)p->peak,
+            (unsigned long)p->allocs, (unsigned long)p->failures,
+            (unsigned long)p->bad_frees);
+    }
+}
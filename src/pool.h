@@ -0,0 +1,74 @@
+#ifndef POOL_H
+#define POOL_H
+/*
+ * Fixed size block pools.
+ *
+ * Each pool is a statically allocated array of equally sized blocks threaded
+ * on a free list, so pool_alloc()/pool_free() are O(1) with a bounded,
+ * short critical section and never fragment. Pools register themselves on
+ * pool_init() and pool_report() prints the usage of all of them. Calling
+ * pool_init() again frees every block and keeps the one registration.
+ *
+ * A bit per block marks it allocated: pool_free() of a block that is not
+ * (freed twice, or never handed out) leaves the pool untouched and is
+ * counted in bad_frees.
+ *
+ *   POOL_DEFINE(display_cmd_pool, sizeof(display_cmd), 8);
+ *   pool_init(&display_cmd_pool);
+ *   display_cmd *c = pool_alloc(&display_cmd_pool);
+ *   pool_free(&display_cmd_pool, c);
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct pool_block {
+    struct pool_block *next;
+} pool_block;
+
+typedef struct pool {
+    const char *name;
+    uint8_t *storage;
+    // One bit per block, set while allocated
+    uint8_t *used;
+    size_t block_size;
+    size_t count;
+
+    pool_block *free_list;
+    struct pool *next_pool;
+
+    // Usage counters
+    uint32_t in_use;
+    uint32_t peak;
+    uint32_t allocs;
+    uint32_t failures;
+    uint32_t bad_frees;
+} pool;
+
+// Blocks are rounded up so every block stays pointer aligned
+#define POOL_BLOCK_SIZE( size ) \
+    ( ( ( size ) + sizeof( void * ) - 1 ) / sizeof( void * ) * sizeof( void * ) )
+
+#define POOL_DEFINE( var, size, n )                                              \
+    static uint8_t var##_storage[ POOL_BLOCK_SIZE( size ) * ( n ) ]              \
+        __attribute__( ( aligned( 8 ) ) );                                       \
+    static uint8_t var##_used[ ( ( n ) + 7 ) / 8 ];                              \
+    pool var = {                                                                 \
+        .name = #var,                                                            \
+        .storage = var##_storage,                                                \
+        .used = var##_used,                                                      \
+        .block_size = POOL_BLOCK_SIZE( size ),                                   \
+        .count = ( n ),                                                          \
+    }
+
+void pool_init(pool *p);
+// NULL when the pool is exhausted (counted in failures)
+void *pool_alloc(pool *p);
+// A block not allocated from `p` is counted in bad_frees, see above
+void pool_free(pool *p, void *block);
+void *pool_alloc_from_isr(pool *p);
+void pool_free_from_isr(pool *p, void *block);
+
+// Bytes reserved by every registered pool
+size_t pool_total_bytes(void);
+void pool_report(void);
+#endif
@@ -0,0 +1,144 @@
+#include "render.h"
+#include "hal.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#define RENDER_US_PER_TICK            ( 1000000u / configTICK_RATE_HZ )
+
+static TaskHandle_t render_task;
+static uint32_t render_interval_us;
+static uint32_t render_latency_us;
+
+// Updates since the last frame started, shared with the producers
+static uint32_t render_updates;
+static bool render_pending;
+static uint64_t render_first_us;
+
+// Renderer only
+static bool render_started;
+static uint64_t render_frame_start_us;
+static uint64_t render_frame_first_us;
+static uint32_t render_frame_updates;
+static render_stats render_counters;
+
+void render_init(TaskHandle_t task, const uint32_t interval_us, const uint32_t latency_us) {
+    taskENTER_CRITICAL();
+    render_task = task ? task : xTaskGetCurrentTaskHandle();
+    render_interval_us = interval_us;
+    render_latency_us = latency_us;
+    render_updates = 0;
+    render_pending = false;
+    render_started = false;
+    render_counters = (render_stats){ 0 };
+    taskEXIT_CRITICAL();
+}
+
+// Called with the counters locked
+static TaskHandle_t mark(const uint64_t now) {
+    if(!render_pending) {
+        render_pending = true;
+        render_first_us = now;
+    }
+    render_updates++;
+    return render_task;
+}
+
+void render_mark_dirty(const uint32_t sources) {
+    const uint64_t now = hal_time_us();
+    taskENTER_CRITICAL();
+    const TaskHandle_t task = mark(now);
+    taskEXIT_CRITICAL();
+    // Without a renderer the frame is flushed by whoever changed it
+    if(task) {
+        xTaskNotifyIndexed(task, RENDER_NOTIFY_INDEX, sources, eSetBits);
+    }
+}
+
+void render_mark_dirty_from_isr(const uint32_t sources, BaseType_t *higher_priority_task_woken) {
+    const uint64_t now = hal_time_us();
+    const UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    const TaskHandle_t task = mark(now);
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+    if(task) {
+        xTaskNotifyIndexedFromISR(task, RENDER_NOTIFY_INDEX, sources, eSetBits, higher_priority_task_woken);
+    }
+}
+
+// Notifications within `ticks`, external events count as one update
+static uint32_t take(const TickType_t ticks) {
+    uint32_t bits = 0;
+    if(xTaskNotifyWaitIndexed(RENDER_NOTIFY_INDEX, 0, UINT32_MAX, &bits, ticks) != pdTRUE) { return 0; }
+    if(bits & RENDER_EVENTS_EXTERNAL) {
+        const uint64_t now = hal_time_us();
+        taskENTER_CRITICAL();
+        ( void ) mark(now);
+        taskEXIT_CRITICAL();
+    }
+    return bits;
+}
+
+uint32_t render_wait(void) {
+    uint32_t sources = 0;
+    while(sources == 0) {
+        sources = take(portMAX_DELAY);
+    }
+
+    // Hold the frame until the interval has passed, gathering what comes in
+    if(render_started) {
+        const uint64_t due = render_frame_start_us + render_interval_us;
+        bool capped = false;
+        for(uint64_t now = hal_time_us(); now < due; now = hal_time_us()) {
+            const TickType_t ticks = (TickType_t)((due - now + RENDER_US_PER_TICK - 1) / RENDER_US_PER_TICK);
+            sources |= take(ticks);
+            capped = true;
+        }
+        if(capped) { render_counters.capped++; }
+    }
+
+    const uint64_t now = hal_time_us();
+    taskENTER_CRITICAL();
+    // Nothing pending: the update was taken by the previous frame between
+    // its mark and its notification
+    render_frame_updates = render_updates;
+    render_frame_first_us = render_pending ? render_first_us : now;
+    render_updates = 0;
+    render_pending = false;
+    taskEXIT_CRITICAL();
+
+    render_frame_start_us = now;
+    render_started = true;
+    return sources;
+}
+
+void render_done(void) {
+    const uint64_t now = hal_time_us();
+    const uint32_t latency = (uint32_t)(now - render_frame_first_us);
+
+    taskENTER_CRITICAL();
+    render_stats *s = &render_counters;
+    s->frames++;
+    s->updates += render_frame_updates;
+    s->busy_us += now - render_frame_start_us;
+    s->last_coalesced = render_frame_updates;
+    s->last_latency_us = latency;
+    if(render_frame_updates > s->max_coalesced) { s->max_coalesced = render_frame_updates; }
+    if(latency > s->max_latency_us) { s->max_latency_us = latency; }
+    if(latency > render_latency_us) { s->late++; }
+    taskEXIT_CRITICAL();
+}
+
+void render_get_stats(render_stats *stats) {
+    taskENTER_CRITICAL();
+    *stats = render_counters;
+    taskEXIT_CRITICAL();
+}
+
+void render_report(void) {
+    render_stats s;
+    render_get_stats(&s);
+    printf("RENDER frames=%lu updates=%lu max_coalesced=%lu capped=%lu late=%lu max_latency_us=%lu busy_us=%llu\n",
+        (unsigned long)s.frames, (unsigned long)s.updates, (unsigned long)s.max_coalesced,
+        (unsigned long)s.capped, (unsigned long)s.late, (unsigned long)s.max_latency_us,
+        (unsigned long long)s.busy_us);
+}
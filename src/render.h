@@ -0,0 +1,98 @@
+#ifndef RENDER_H
+#define RENDER_H
+/*
+ * Frames on demand instead of a redraw loop.
+ *
+ * Producers change the frame (set_line(), lcd_fmt on a row, scroll_line())
+ * and call render_mark_dirty(). That notifies the renderer, the one task that
+ * flushes the frame, which sleeps in render_wait() until something changed:
+ *
+ *   render_init(NULL, 1000000 / 30, 50000);    // 30 fps at most, 50ms target
+ *   timekeeper_subscribe(NULL);
+ *   for( ;; ) {
+ *       const uint32_t sources = render_wait();
+ *       ...draw what depends on `sources`...
+ *       display_frame();
+ *       render_done();
+ *   }
+ *
+ * A frame never starts sooner than the frame interval after the previous
+ * one: render_wait() holds it back until then and folds every update that
+ * arrives meanwhile into it, so a producer updating at 200 Hz costs the bus
+ * one flush per frame, not one per update. As soon as the interval allows,
+ * the frame goes out, an update waits at most one interval plus the flush.
+ * Frames later than the latency target after their first update are counted
+ * as late.
+ *
+ * Sources are bits on the timekeeper's notification index, above its events,
+ * so a renderer subscribed to the timekeeper wakes on the second events
+ * (TIMEKEEPER_EVENT_SECOND) like on any other update.
+ */
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "timekeeper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The timekeeper's index on purpose: the renderer waits for its sources and
+// the second events in one render_wait(). Nothing else may be waited for on
+// it in the renderer, a wait that takes the bits would lose the other's.
+#define RENDER_NOTIFY_INDEX           TIMEKEEPER_NOTIFY_INDEX
+// Bits 0..7 are the timekeeper events
+#define RENDER_EVENTS_EXTERNAL        ( 0xFFu )
+// Rows set through set_line(), set_line_utf8() and scroll_line()
+#define RENDER_SOURCE_TEXT            ( 1u << 8 )
+// Fields written in place
+#define RENDER_SOURCE_FIELD           ( 1u << 9 )
+// The period of a scroll_line() marquee, the renderer moves it one cell
+#define RENDER_SOURCE_SCROLL          ( 1u << 10 )
+// Application sources go from here up
+#define RENDER_SOURCE_APP             ( 1u << 11 )
+
+typedef struct {
+    uint32_t frames;
+    // render_mark_dirty() calls and external events
+    uint32_t updates;
+    uint32_t max_coalesced;       // Most updates folded into one frame
+    uint32_t capped;              // Frames held back by the frame interval
+    uint32_t late;                // Later than the target after their first update
+    uint32_t max_latency_us;      // First update to end of flush
+    // Of the last frame, for per frame histograms
+    uint32_t last_coalesced;
+    uint32_t last_latency_us;
+    uint64_t busy_us;             // Between render_wait() and render_done()
+} render_stats;
+
+/*
+ * The calling task (NULL) or `task` becomes the renderer. Frames start at
+ * least `interval_us` apart, `latency_us` is the target from the first
+ * update of a frame to the end of its flush.
+ */
+void render_init(TaskHandle_t task, const uint32_t interval_us, const uint32_t latency_us);
+
+// Ask for a frame with the changes of `sources`, any task
+void render_mark_dirty(const uint32_t sources);
+void render_mark_dirty_from_isr(const uint32_t sources, BaseType_t *higher_priority_task_woken);
+
+/*
+ * Renderer only. Blocks until something changed and the frame interval has
+ * passed, returns the sources (and external events) of every update
+ * coalesced into the frame.
+ */
+uint32_t render_wait(void);
+// Renderer only, the frame has been flushed
+void render_done(void);
+
+void render_get_stats(render_stats *stats);
+// RENDER line next to the task table, see trace.h
+void render_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,245 @@
+/*
+ * Redraw loop against the event driven renderer of render.h.
+ *
+ * Built as render_bench (RP2040, results over USB stdio) and
+ * render_bench_host. common.c calls main_render_bench() instead of
+ * main_blinky().
+ *
+ * A producer changes a field of line 3 renderbenchBURST times every
+ * renderbenchUPDATE_MS (750 updates per second), while the LCD task
+ * renders for renderbenchWINDOW_MS:
+ * - spin           : the old loop, a frame flushed again as soon as the last
+ *                    one is out, whether anything changed or not
+ * - event          : render_wait()/render_done() at the HD44780_CONFIG_MAX_FPS
+ *                    cap, every update since the last frame in one flush
+ * Per mode <mode>_frames and <mode>_idle, the share of the CPU time (all
+ * cores) left to the idle tasks in permille, from the run time stats.
+ * idle_recovered is the difference. For the event mode also the updates,
+ * updates per frame (coalesced), update to end of flush latency, frames
+ * held back by the cap and frames later than HD44780_CONFIG_LATENCY_MS.
+ */
+
+#include "render.h"
+#include "hd44780.h"
+#include "lcd_fmt.h"
+#include "bench.h"
+#include "hal.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+#include <string.h>
+
+#define renderbenchTASK_PRIORITY               ( tskIDLE_PRIORITY + 3 )
+#define renderbenchPRODUCER_PRIORITY           ( tskIDLE_PRIORITY + 2 )
+#define renderbenchLCD_PRIORITY                ( tskIDLE_PRIORITY + 1 )
+
+#define renderbenchWINDOW_MS                   ( 3000 / portTICK_PERIOD_MS )
+#define renderbenchUPDATE_MS                   ( 4 / portTICK_PERIOD_MS )
+#define renderbenchBURST                       ( 3 )
+#define renderbenchMAX_TASKS                   ( 16 )
+#define renderbenchLATENCY_BUCKET_US           ( 2000 )
+#define renderbenchLATENCY_BUCKETS             ( 30 )
+#define renderbenchCOALESCED_BUCKETS           ( 32 )
+// Give the host time to open the USB serial port
+#define renderbenchUSB_SETTLE_MS               ( 2000 / portTICK_PERIOD_MS )
+
+int main_render_bench( void );
+
+static void prvRenderBenchTask( void *pvParameters );
+static void prvProducerTask( void *pvParameters );
+static void prvSpinTask( void *pvParameters );
+static void prvEventTask( void *pvParameters );
+
+static TaskHandle_t xBench;
+static volatile BaseType_t xStopLcd = pdFALSE;
+static volatile BaseType_t xStopProducer = pdFALSE;
+static volatile uint32_t ulFrames = 0;
+
+static bench_samples xCoalesced;
+static bench_samples xLatency;
+static TaskStatus_t xStatus[ renderbenchMAX_TASKS ];
+
+/*-----------------------------------------------------------*/
+
+int main_render_bench( void )
+{
+    printf(" Starting main_render_bench.\n");
+
+    xTaskCreate( prvRenderBenchTask, "BENCH", configMINIMAL_STACK_SIZE * 2, NULL, renderbenchTASK_PRIORITY, NULL );
+    vTaskStartScheduler();
+
+    for( ;; );
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+/* Run time of the idle tasks and of the system, both in run time counter
+units. */
+static void prvIdleTime( uint64_t *pullIdle, uint64_t *pullTotal )
+{
+configRUN_TIME_COUNTER_TYPE ulTotal = 0;
+
+    const UBaseType_t uxTasks = uxTaskGetSystemState( xStatus, renderbenchMAX_TASKS, &ulTotal );
+    *pullIdle = 0;
+    for( UBaseType_t i = 0; i < uxTasks; i++ )
+    {
+        /* One per core on the SMP kernel, "IDLE0" and "IDLE1". */
+        if( strncmp( xStatus[ i ].pcTaskName, "IDLE", 4 ) == 0 )
+        {
+            *pullIdle += xStatus[ i ].ulRunTimeCounter;
+        }
+    }
+    *pullTotal = ulTotal;
+}
+/*-----------------------------------------------------------*/
+
+/* Runs the LCD task pxLcd for renderbenchWINDOW_MS, reports its frames and
+the idle share, returns the idle share in permille. The producer runs
+along. */
+static uint64_t prvRunMode( TaskFunction_t pxLcd, const char *pcMode )
+{
+uint64_t ullIdleStart, ullTotalStart, ullIdleEnd, ullTotalEnd;
+char cMetric[ 24 ];
+
+    xStopLcd = pdFALSE;
+    xStopProducer = pdFALSE;
+    ulFrames = 0;
+    xTaskCreate( pxLcd, "HD", configMINIMAL_STACK_SIZE, NULL, renderbenchLCD_PRIORITY, NULL );
+    xTaskCreate( prvProducerTask, "PROD", configMINIMAL_STACK_SIZE, NULL, renderbenchPRODUCER_PRIORITY, NULL );
+    vTaskDelay( renderbenchUPDATE_MS * 10 );
+
+    prvIdleTime( &ullIdleStart, &ullTotalStart );
+    const uint32_t ulFramesStart = ulFrames;
+    vTaskDelay( renderbenchWINDOW_MS );
+    prvIdleTime( &ullIdleEnd, &ullTotalEnd );
+    const uint32_t ulWindowFrames = ulFrames - ulFramesStart;
+
+    /* The producer goes first, its marks would notify a deleted task. */
+    xStopProducer = pdTRUE;
+    ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+    /* The event task may be asleep until the next update. */
+    xStopLcd = pdTRUE;
+    render_mark_dirty( RENDER_SOURCE_APP );
+    ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+    const uint64_t ullTotal = ( ullTotalEnd - ullTotalStart ) * configNUM_CORES;
+    const uint64_t ullIdle = ullTotal ? ( ullIdleEnd - ullIdleStart ) * 1000 / ullTotal : 0;
+    snprintf( cMetric, sizeof( cMetric ), "%s_frames", pcMode );
+    bench_report_value( "render", cMetric, "frames", ulWindowFrames );
+    snprintf( cMetric, sizeof( cMetric ), "%s_idle", pcMode );
+    bench_report_value( "render", cMetric, "permille", ullIdle );
+    return ullIdle;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRenderBenchTask( void *pvParameters )
+{
+TickType_t xNextWakeTime;
+render_stats xStats;
+
+    ( void ) pvParameters;
+
+#ifndef HOST_BUILD
+    vTaskDelay( renderbenchUSB_SETTLE_MS );
+#endif
+
+    xBench = xTaskGetCurrentTaskHandle();
+    xNextWakeTime = xTaskGetTickCount();
+    hd44780_init( &xNextWakeTime );
+    set_line( 0, "Render" );
+    set_line( 2, "" );
+
+    /* Without a renderer the marks of the producer notify nobody. */
+    const uint64_t ullSpinIdle = prvRunMode( prvSpinTask, "spin" );
+
+    bench_reset( &xCoalesced );
+    bench_reset( &xLatency );
+    const uint64_t ullEventIdle = prvRunMode( prvEventTask, "event" );
+    bench_report_value( "render", "idle_recovered", "permille", ullEventIdle > ullSpinIdle ? ullEventIdle - ullSpinIdle : 0 );
+
+    render_get_stats( &xStats );
+    bench_report_value( "render", "event_updates", "updates", xStats.updates );
+    bench_report_histogram( "render", "event_coalesced", "updates", &xCoalesced, 1, renderbenchCOALESCED_BUCKETS );
+    bench_report( "render", "event_coalesced", "updates", &xCoalesced );
+    bench_report_histogram( "render", "event_latency", "us", &xLatency, renderbenchLATENCY_BUCKET_US, renderbenchLATENCY_BUCKETS );
+    bench_report( "render", "event_latency", "us", &xLatency );
+    bench_report_value( "render", "event_capped", "frames", xStats.capped );
+    bench_report_value( "render", "event_late", "frames", xStats.late );
+    bench_done();
+}
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void *pvParameters )
+{
+TickType_t xNextWakeTime;
+uint32_t ulValue = 0;
+lcd_fmt xFmt;
+
+    ( void ) pvParameters;
+
+    xNextWakeTime = xTaskGetTickCount();
+    while( !xStopProducer )
+    {
+        vTaskDelayUntil( &xNextWakeTime, renderbenchUPDATE_MS );
+        for( uint32_t i = 0; i < renderbenchBURST; i++ )
+        {
+            hd44780_frame_lock();
+            lcd_fmt_begin( &xFmt, hd44780_display_data[ 2 ], ROWLEN, 0 );
+            lcd_fmt_str( &xFmt, "N:", 0 );
+            lcd_fmt_uint( &xFmt, ulValue++, 8, ' ' );
+            lcd_fmt_end( &xFmt );
+            hd44780_frame_unlock();
+            render_mark_dirty( RENDER_SOURCE_FIELD );
+        }
+    }
+    xTaskNotifyGive( xBench );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+/* The loop the LCD task had, no pause between frames. */
+static void prvSpinTask( void *pvParameters )
+{
+    ( void ) pvParameters;
+
+    while( !xStopLcd )
+    {
+        display_frame();
+        ulFrames++;
+    }
+    xTaskNotifyGive( xBench );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvEventTask( void *pvParameters )
+{
+render_stats xStats;
+
+    ( void ) pvParameters;
+
+    hd44780_render_init();
+    for( ;; )
+    {
+        ( void ) render_wait();
+        if( xStopLcd )
+        {
+            break;
+        }
+        display_frame();
+        render_done();
+        ulFrames++;
+
+        render_get_stats( &xStats );
+        bench_add( &xCoalesced, xStats.last_coalesced );
+        bench_add( &xLatency, xStats.last_latency_us );
+    }
+    xTaskNotifyGive( xBench );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,214 @@
+/*
+ * Tap to UID latency of the MFRC522 driver (mfrc522.h).
+ *
+ * Built as rfid_bench (RP2040, results over USB stdio) and rfid_bench_host.
+ * common.c calls main_rfid_bench() instead of main_blinky().
+ *
+ * On the host the simulated reader of the board gets rfidbenchTAPS cards
+ * tapped in turn, 4, 7 and 10 byte UIDs, each in the field for
+ * rfidbenchDWELL_MS every rfidbenchTAP_PERIOD_MS give or take some jitter.
+ * mfrc522Task runs as in the demo and the handler records per tap:
+ * - tap_to_uid     : card in the field to UID complete, poll wait included
+ * - read           : REQA/WUPA to UID complete, the exchanges alone
+ * and at the end the taps the handler never saw (missed), UIDs that were
+ * not the card in the field (wrong_uid), polls, IRQ wake ups and timeouts
+ * and SPI bytes per UID read.
+ *
+ * On target nobody scripts the cards: the bench waits for
+ * rfidbenchTAPS taps by hand and only reports the read time.
+ */
+
+#include "mfrc522.h"
+#include "bench.h"
+#include "hal.h"
+#ifdef HOST_BUILD
+#include "board_host.h"
+#endif
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+#include <string.h>
+
+#define rfidbenchTASK_PRIORITY                 ( tskIDLE_PRIORITY + 1 )
+#define rfidbenchRFID_PRIORITY                 ( tskIDLE_PRIORITY + 2 )
+
+#define rfidbenchTAPS                          ( 24 )
+#define rfidbenchTAP_PERIOD_MS                 ( 400 )
+#define rfidbenchDWELL_MS                      ( 150 )
+#define rfidbenchJITTER_MS                     ( 40 )
+#define rfidbenchLATENCY_BUCKET_US             ( 5000 )
+#define rfidbenchLATENCY_BUCKETS               ( 20 )
+#define rfidbenchREAD_BUCKET_US                ( 500 )
+#define rfidbenchREAD_BUCKETS                  ( 20 )
+// Give the host time to open the USB serial port
+#define rfidbenchUSB_SETTLE_MS                 ( 2000 / portTICK_PERIOD_MS )
+
+int main_rfid_bench( void );
+
+static void prvRfidBenchTask( void *pvParameters );
+static void prvOnCard( const mfrc522_uid *pxUid, void *pvContext );
+
+static TaskHandle_t xBench;
+static volatile uint32_t ulCards = 0;
+
+static bench_samples xTapToUid;
+static bench_samples xRead;
+
+#ifdef HOST_BUILD
+typedef struct
+{
+    mfrc522_sim_card xCard;
+    uint64_t ullIn;
+    uint64_t ullOut;
+    BaseType_t xSeen;
+} Tap_t;
+
+static Tap_t xTaps[ rfidbenchTAPS ];
+static uint32_t ulWrongUid = 0;
+#endif
+
+/*-----------------------------------------------------------*/
+
+int main_rfid_bench( void )
+{
+    printf(" Starting main_rfid_bench.\n");
+
+    xTaskCreate( prvRfidBenchTask, "BENCH", configMINIMAL_STACK_SIZE * 2, NULL, rfidbenchTASK_PRIORITY, NULL );
+    vTaskStartScheduler();
+
+    for( ;; );
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+#ifdef HOST_BUILD
+/* One card per tap, UID sizes in turn, the bytes from a linear congruential
+generator so every run scripts the same taps. */
+static void prvScriptTaps( const uint64_t ullStart )
+{
+uint32_t ulSeed = 12345;
+mfrc522_sim *pxSim = board_host_rfid();
+static const uint8_t ucSizes[ 3 ] = { 4, 7, 10 };
+
+    mfrc522_sim_clear_cards( pxSim );
+    for( uint32_t i = 0; i < rfidbenchTAPS; i++ )
+    {
+        Tap_t *pxTap = &xTaps[ i ];
+        pxTap->xCard.uid_size = ucSizes[ i % 3 ];
+        for( uint8_t j = 0; j < pxTap->xCard.uid_size; j++ )
+        {
+            ulSeed = ulSeed * 1103515245u + 12345u;
+            pxTap->xCard.uid[ j ] = ( uint8_t ) ( ulSeed >> 16 );
+        }
+        /* A first byte of 0x88 would read as a cascade tag. */
+        if( pxTap->xCard.uid[ 0 ] == MFRC522_PICC_CASCADE_TAG )
+        {
+            pxTap->xCard.uid[ 0 ] = 0x04;
+        }
+        pxTap->xCard.atqa = pxTap->xCard.uid_size == 4 ? 0x0004 : pxTap->xCard.uid_size == 7 ? 0x0044 : 0x0084;
+        pxTap->xCard.sak = 0x08;
+
+        ulSeed = ulSeed * 1103515245u + 12345u;
+        const uint32_t ulJitterMs = ( ulSeed >> 16 ) % rfidbenchJITTER_MS;
+        pxTap->ullIn = ullStart + ( ( uint64_t ) ( i + 1 ) * rfidbenchTAP_PERIOD_MS + ulJitterMs ) * 1000;
+        pxTap->ullOut = pxTap->ullIn + rfidbenchDWELL_MS * 1000;
+        pxTap->xSeen = pdFALSE;
+        ( void ) mfrc522_sim_add_card( pxSim, &pxTap->xCard, pxTap->ullIn, pxTap->ullOut );
+    }
+}
+#endif
+/*-----------------------------------------------------------*/
+
+static void prvRfidBenchTask( void *pvParameters )
+{
+mfrc522_stats xStats;
+
+    ( void ) pvParameters;
+
+#ifndef HOST_BUILD
+    vTaskDelay( rfidbenchUSB_SETTLE_MS );
+    printf(" Tap %d cards.\n", rfidbenchTAPS);
+#else
+    /* The reset and set up of the chip take mfrc522_init() about 50ms. */
+    prvScriptTaps( hal_time_us() );
+#endif
+
+    xBench = xTaskGetCurrentTaskHandle();
+    bench_reset( &xTapToUid );
+    bench_reset( &xRead );
+    mfrc522_set_handler( prvOnCard, NULL );
+    xTaskCreate( mfrc522Task, "RFID", configMINIMAL_STACK_SIZE, NULL, rfidbenchRFID_PRIORITY, NULL );
+
+#ifdef HOST_BUILD
+    /* Until the last card has left the field and one poll more. */
+    vTaskDelay( pdMS_TO_TICKS( ( rfidbenchTAPS + 1 ) * rfidbenchTAP_PERIOD_MS + rfidbenchJITTER_MS + rfidbenchDWELL_MS + MFRC522_POLL_MS ) );
+#else
+    while( ulCards < rfidbenchTAPS )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    }
+#endif
+
+    mfrc522_get_stats( &xStats );
+#ifdef HOST_BUILD
+    uint32_t ulMissed = 0;
+    for( uint32_t i = 0; i < rfidbenchTAPS; i++ )
+    {
+        ulMissed += xTaps[ i ].xSeen ? 0 : 1;
+    }
+    bench_report_histogram( "rfid", "tap_to_uid", "us", &xTapToUid, rfidbenchLATENCY_BUCKET_US, rfidbenchLATENCY_BUCKETS );
+    bench_report( "rfid", "tap_to_uid", "us", &xTapToUid );
+#endif
+    bench_report_histogram( "rfid", "read", "us", &xRead, rfidbenchREAD_BUCKET_US, rfidbenchREAD_BUCKETS );
+    bench_report( "rfid", "read", "us", &xRead );
+    bench_report_value( "rfid", "poll_period", "ms", MFRC522_POLL_MS );
+#ifdef HOST_BUILD
+    bench_report_value( "rfid", "missed", "taps", ulMissed );
+    bench_report_value( "rfid", "wrong_uid", "taps", ulWrongUid );
+#endif
+    bench_report_value( "rfid", "taps", "taps", xStats.taps );
+    bench_report_value( "rfid", "polls", "polls", xStats.polls );
+    bench_report_value( "rfid", "collisions", "reads", xStats.collisions );
+    bench_report_value( "rfid", "errors", "reads", xStats.errors );
+    bench_report_value( "rfid", "irqs", "waits", xStats.irqs );
+    bench_report_value( "rfid", "irq_timeouts", "waits", xStats.irq_timeouts );
+    bench_report_value( "rfid", "spi_per_read", "bytes", xStats.reads ? xStats.spi_bytes / xStats.reads : 0 );
+    bench_done();
+}
+/*-----------------------------------------------------------*/
+
+/* Runs in the RFID task. */
+static void prvOnCard( const mfrc522_uid *pxUid, void *pvContext )
+{
+    ( void ) pvContext;
+
+    bench_add( &xRead, pxUid->read_us );
+#ifdef HOST_BUILD
+    Tap_t *pxTap = NULL;
+    for( uint32_t i = 0; i < rfidbenchTAPS; i++ )
+    {
+        if( pxUid->time_us >= xTaps[ i ].ullIn && pxUid->time_us < xTaps[ i ].ullOut )
+        {
+            pxTap = &xTaps[ i ];
+            break;
+        }
+    }
+    if( pxTap == NULL || pxTap->xCard.uid_size != pxUid->size ||
+        memcmp( pxTap->xCard.uid, pxUid->bytes, pxUid->size ) != 0 )
+    {
+        ulWrongUid++;
+    }
+    else if( !pxTap->xSeen )
+    {
+        pxTap->xSeen = pdTRUE;
+        bench_add( &xTapToUid, ( uint32_t ) ( pxUid->time_us - pxTap->ullIn ) );
+    }
+#endif
+    ulCards++;
+    xTaskNotifyGive( xBench );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,108 @@
+#include "spsc.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <string.h>
+
+void spsc_init(spsc *c) {
+    c->head = 0;
+    c->tail = 0;
+    c->consumer_waiting = NULL;
+    c->producer_waiting = NULL;
+    c->sent = 0;
+    c->full = 0;
+    c->received = 0;
+    c->empty = 0;
+}
+
+// The waiter stores its handle and then checks the ring again, the other
+// side updates the ring and then loads the handle: the full barriers make
+// sure at least one of them sees the other, so no wake up is lost
+static void wake(void * volatile *waiting) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    TaskHandle_t t = (TaskHandle_t)*waiting;
+    if(t != NULL) {
+        xTaskNotifyGiveIndexed(t, SPSC_NOTIFY_INDEX);
+    }
+}
+
+static bool wake_from_isr(void * volatile *waiting) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    TaskHandle_t t = (TaskHandle_t)*waiting;
+    if(t != NULL) {
+        vTaskNotifyGiveIndexedFromISR(t, SPSC_NOTIFY_INDEX, &xHigherPriorityTaskWoken);
+    }
+    return xHigherPriorityTaskWoken != pdFALSE;
+}
+
+void spsc_commit(spsc *c) {
+    spsc_publish(c);
+    wake(&c->consumer_waiting);
+}
+
+void spsc_release(spsc *c) {
+    spsc_consume(c);
+    wake(&c->producer_waiting);
+}
+
+bool spsc_commit_from_isr(spsc *c) {
+    spsc_publish(c);
+    return wake_from_isr(&c->consumer_waiting);
+}
+
+bool spsc_release_from_isr(spsc *c) {
+    spsc_consume(c);
+    return wake_from_isr(&c->producer_waiting);
+}
+
+static void *wait_for(spsc *c, void *(*poll)(spsc *), void * volatile *waiting,
+        const TickType_t ticks) {
+    void *slot = poll(c);
+    if(slot != NULL || ticks == 0) { return slot; }
+
+    TimeOut_t xTimeOut;
+    TickType_t xRemaining = ticks;
+    vTaskSetTimeOutState(&xTimeOut);
+    *waiting = xTaskGetCurrentTaskHandle();
+    for( ;; ) {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        slot = poll(c);
+        if(slot != NULL) { break; }
+        // A stale notification only costs one more round
+        ulTaskNotifyTakeIndexed(SPSC_NOTIFY_INDEX, pdTRUE, xRemaining);
+        if(xTaskCheckForTimeOut(&xTimeOut, &xRemaining) != pdFALSE) {
+            slot = poll(c);
+            break;
+        }
+    }
+    *waiting = NULL;
+    return slot;
+}
+
+void *spsc_reserve_wait(spsc *c, uint32_t ticks) {
+    return wait_for(c, spsc_reserve, &c->producer_waiting, (TickType_t)ticks);
+}
+
+void *spsc_peek_wait(spsc *c, uint32_t ticks) {
+    return wait_for(c, spsc_peek, &c->consumer_waiting, (TickType_t)ticks);
+}
+
+bool spsc_send(spsc *c, const void *item, uint32_t ticks) {
+    void *slot = spsc_reserve_wait(c, ticks);
+    if(slot == NULL) { return false; }
+    memcpy(slot, item, c->item_size);
+    spsc_commit(c);
+    return true;
+}
+
+bool spsc_receive(spsc *c, void *item, uint32_t ticks) {
+    const void *slot = spsc_peek_wait(c, ticks);
+    if(slot == NULL) { return false; }
+    memcpy(item, slot, c->item_size);
+    spsc_release(c);
+    return true;
+}
@@ -0,0 +1,131 @@
+#ifndef SPSC_H
+#define SPSC_H
+/*
+ * Lock-free single producer, single consumer channel.
+ *
+ * A power of 2 ring of fixed size slots. The producer only writes head, the
+ * consumer only writes tail, and each publishes with a release store that
+ * the other side reads with an acquire load: no critical section and no
+ * cross core spin lock, unlike a queue. Exactly one task (or ISR) may
+ * produce and one may consume, possibly on different cores.
+ *
+ * The ring itself, inline below, never blocks: reserve a slot, fill it in
+ * place and publish it; peek at the oldest slot, use it in place and consume
+ * it. spsc.c adds the blocking layer on task notifications (index
+ * SPSC_NOTIFY_INDEX): a side that has to wait announces itself, the other
+ * side notifies it after publishing or consuming, so an uncontended transfer
+ * touches no kernel object at all.
+ *
+ *   SPSC_DEFINE(sample_channel, sizeof(sample), 16);
+ *   spsc_init(&sample_channel);
+ *   // producer                          // consumer
+ *   sample *s = spsc_reserve_wait(&c, t); const sample *s = spsc_peek_wait(&c, t);
+ *   s->value = ...;                      use(s->value);
+ *   spsc_commit(&c);                     spsc_release(&c);
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Task notification used by the blocking wrappers, see the index map next
+to configTASK_NOTIFICATION_ARRAY_ENTRIES in FreeRTOSConfig.h */
+#define SPSC_NOTIFY_INDEX             ( 1 )
+
+typedef struct {
+    uint8_t *slots;
+    uint32_t item_size;
+    uint32_t slot_size;
+    uint32_t mask;                // Slot count - 1
+
+    // Free running counters, each written by one side only
+    volatile uint32_t head;       // Published by the producer
+    volatile uint32_t tail;       // Consumed by the consumer
+
+    // Task waiting on the other side, set and cleared by the waiter itself
+    void * volatile consumer_waiting;
+    void * volatile producer_waiting;
+
+    // Producer side counters
+    uint32_t sent;
+    uint32_t full;                // Reserve attempts on a full ring
+    // Consumer side counters
+    uint32_t received;
+    uint32_t empty;               // Peek attempts on an empty ring
+} spsc;
+
+// Slots are rounded up so every slot stays pointer aligned
+#define SPSC_SLOT_SIZE( size ) \
+    ( ( ( size ) + sizeof( void * ) - 1 ) / sizeof( void * ) * sizeof( void * ) )
+
+// n must be a power of 2
+#define SPSC_DEFINE( var, size, n )                                              \
+    _Static_assert( ( ( n ) & ( ( n ) - 1 ) ) == 0, #var " slots not a power of 2" ); \
+    static uint8_t var##_slots[ SPSC_SLOT_SIZE( size ) * ( n ) ]                 \
+        __attribute__( ( aligned( 8 ) ) );                                       \
+    spsc var = {                                                                 \
+        .slots = var##_slots,                                                    \
+        .item_size = ( size ),                                                   \
+        .slot_size = SPSC_SLOT_SIZE( size ),                                     \
+        .mask = ( n ) - 1,                                                       \
+    }
+
+void spsc_init(spsc *c);
+
+/* Non blocking ring, usable from any context */
+
+// Next free slot, NULL when the ring is full
+static inline void *spsc_reserve(spsc *c) {
+    const uint32_t head = c->head;
+    const uint32_t tail = __atomic_load_n(&c->tail, __ATOMIC_ACQUIRE);
+    if(head - tail > c->mask) {
+        c->full++;
+        return NULL;
+    }
+    return c->slots + (head & c->mask) * c->slot_size;
+}
+
+// Makes the reserved slot visible to the consumer, does not wake it
+static inline void spsc_publish(spsc *c) {
+    c->sent++;
+    __atomic_store_n(&c->head, c->head + 1, __ATOMIC_RELEASE);
+}
+
+// Oldest published slot, NULL when the ring is empty
+static inline void *spsc_peek(spsc *c) {
+    const uint32_t tail = c->tail;
+    const uint32_t head = __atomic_load_n(&c->head, __ATOMIC_ACQUIRE);
+    if(head == tail) {
+        c->empty++;
+        return NULL;
+    }
+    return c->slots + (tail & c->mask) * c->slot_size;
+}
+
+// Hands the peeked slot back to the producer, does not wake it
+static inline void spsc_consume(spsc *c) {
+    c->received++;
+    __atomic_store_n(&c->tail, c->tail + 1, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t spsc_count(const spsc *c) {
+    return __atomic_load_n(&c->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&c->tail, __ATOMIC_ACQUIRE);
+}
+
+/* Blocking layer (spsc.c), tasks only unless noted */
+
+// spsc_publish()/spsc_consume() and wake the other side if it waits
+void spsc_commit(spsc *c);
+void spsc_release(spsc *c);
+// ISR producer or consumer, returns whether a context switch is needed
+bool spsc_commit_from_isr(spsc *c);
+bool spsc_release_from_isr(spsc *c);
+
+// Wait up to ticks (a TickType_t) for a free or a published slot, NULL on
+// timeout
+void *spsc_reserve_wait(spsc *c, uint32_t ticks);
+void *spsc_peek_wait(spsc *c, uint32_t ticks);
+
+// Copying wrappers for small items of item_size bytes
+bool spsc_send(spsc *c, const void *item, uint32_t ticks);
+bool spsc_receive(spsc *c, void *item, uint32_t ticks);
+#endif
@@ -0,0 +1,266 @@
+/*
+ * SPSC channel against FreeRTOS queues.
+ *
+ * Built as spsc_bench (RP2040, results over USB stdio) and spsc_bench_host.
+ * common.c calls main_spsc_bench() instead of main_blinky().
+ *
+ * The benchmark task produces on core 0, a consumer task started for every
+ * run receives on core 1 (on a single core build both share it). Both tasks
+ * and the queues are statically allocated, the runs allocate nothing:
+ * - msgs_per_s   : spscbenchMESSAGES back to back 4 byte messages
+ * - latency      : one timestamped message per tick, send to receive
+ * - payload      : spscbenchPAYLOAD byte messages, copied into and out of
+ *                  the queue, filled and read in place with reserve/commit
+ * Every consumer also checks the sequence numbers it receives.
+ */
+
+#include "spsc.h"
+#include "bench.h"
+#include "hal.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Library includes. */
+#include <stdio.h>
+#include <string.h>
+
+#define spscbenchTASK_PRIORITY                 ( tskIDLE_PRIORITY + 2 )
+#define spscbenchCONSUMER_PRIORITY             ( tskIDLE_PRIORITY + 2 )
+
+#define spscbenchMESSAGES                      ( 10000 )
+#define spscbenchLATENCY_SAMPLES               ( 200 )
+#define spscbenchPAYLOAD                       ( 64 )
+#define spscbenchSLOTS                         ( 16 )
+#define spscbenchBENCH_STACK                   ( configMINIMAL_STACK_SIZE * 2 )
+#define spscbenchCONSUMER_STACK                ( configMINIMAL_STACK_SIZE )
+// Give the host time to open the USB serial port
+#define spscbenchUSB_SETTLE_MS                 ( 2000 / portTICK_PERIOD_MS )
+
+#define spscbenchCORE_PRODUCER                 ( 1 << 0 )
+#define spscbenchCORE_CONSUMER                 ( 1 << 1 )
+
+int main_spsc_bench( void );
+
+typedef enum
+{
+    spscbenchQUEUE,
+    spscbenchSPSC
+} Transport_t;
+
+typedef struct
+{
+    Transport_t eTransport;
+    uint32_t ulSize;
+    uint32_t ulCount;
+    BaseType_t xLatency;
+} Run_t;
+
+static void prvSpscBenchTask( void *pvParameters );
+static void prvConsumerTask( void *pvParameters );
+static void prvPin( TaskHandle_t xTask, const UBaseType_t uxCores );
+
+static QueueHandle_t xSmallQueue;
+static QueueHandle_t xPayloadQueue;
+static StaticQueue_t xSmallQueueBuffer;
+static StaticQueue_t xPayloadQueueBuffer;
+static uint8_t ucSmallQueueStorage[ spscbenchSLOTS * sizeof( uint32_t ) ];
+static uint8_t ucPayloadQueueStorage[ spscbenchSLOTS * spscbenchPAYLOAD ];
+
+SPSC_DEFINE( xSmallChannel, sizeof( uint32_t ), spscbenchSLOTS );
+SPSC_DEFINE( xPayloadChannel, spscbenchPAYLOAD, spscbenchSLOTS );
+
+static StaticTask_t xBenchTaskBuffer;
+static StaticTask_t xConsumerTaskBuffer;
+static StackType_t xBenchTaskStack[ spscbenchBENCH_STACK ];
+static StackType_t xConsumerTaskStack[ spscbenchCONSUMER_STACK ];
+
+static TaskHandle_t xBenchTask;
+static TaskHandle_t xConsumer;
+/* Set before the consumer is started for a run. */
+static const Run_t *pxCurrentRun;
+static bench_samples xLatency;
+static uint32_t ulSequenceErrors;
+
+/*-----------------------------------------------------------*/
+
+int main_spsc_bench( void )
+{
+    printf(" Starting main_spsc_bench.\n");
+
+    xSmallQueue = xQueueCreateStatic( spscbenchSLOTS, sizeof( uint32_t ), ucSmallQueueStorage, &xSmallQueueBuffer );
+    xPayloadQueue = xQueueCreateStatic( spscbenchSLOTS, spscbenchPAYLOAD, ucPayloadQueueStorage, &xPayloadQueueBuffer );
+
+    xBenchTask = xTaskCreateStatic( prvSpscBenchTask, "BENCH", spscbenchBENCH_STACK, NULL, spscbenchTASK_PRIORITY,
+                                    xBenchTaskStack, &xBenchTaskBuffer );
+    xConsumer = xTaskCreateStatic( prvConsumerTask, "CONS", spscbenchCONSUMER_STACK, NULL, spscbenchCONSUMER_PRIORITY,
+                                   xConsumerTaskStack, &xConsumerTaskBuffer );
+    prvPin( xConsumer, spscbenchCORE_CONSUMER );
+    vTaskStartScheduler();
+
+    for( ;; );
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPin( TaskHandle_t xTask, const UBaseType_t uxCores )
+{
+#if ( configUSE_CORE_AFFINITY == 1 ) && ( configNUM_CORES > 1 )
+    vTaskCoreAffinitySet( xTask, uxCores );
+#else
+    ( void ) xTask;
+    ( void ) uxCores;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvSend( const Run_t *pxRun, const uint32_t ulValue )
+{
+uint8_t ucItem[ spscbenchPAYLOAD ];
+
+    if( pxRun->eTransport == spscbenchQUEUE )
+    {
+        QueueHandle_t xQueue = ( pxRun->ulSize == sizeof( uint32_t ) ) ? xSmallQueue : xPayloadQueue;
+        memset( ucItem, ( int ) ulValue, pxRun->ulSize );
+        memcpy( ucItem, &ulValue, sizeof( ulValue ) );
+        xQueueSend( xQueue, ucItem, portMAX_DELAY );
+    }
+    else if( pxRun->ulSize == sizeof( uint32_t ) )
+    {
+        spsc_send( &xSmallChannel, &ulValue, portMAX_DELAY );
+    }
+    else
+    {
+        /* Zero copy: the payload is written straight into the slot. */
+        uint8_t *pucSlot = spsc_reserve_wait( &xPayloadChannel, portMAX_DELAY );
+        memset( pucSlot, ( int ) ulValue, pxRun->ulSize );
+        memcpy( pucSlot, &ulValue, sizeof( ulValue ) );
+        spsc_commit( &xPayloadChannel );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvReceive( const Run_t *pxRun )
+{
+uint8_t ucItem[ spscbenchPAYLOAD ];
+uint32_t ulValue;
+
+    if( pxRun->eTransport == spscbenchQUEUE )
+    {
+        QueueHandle_t xQueue = ( pxRun->ulSize == sizeof( uint32_t ) ) ? xSmallQueue : xPayloadQueue;
+        xQueueReceive( xQueue, ucItem, portMAX_DELAY );
+        memcpy( &ulValue, ucItem, sizeof( ulValue ) );
+    }
+    else if( pxRun->ulSize == sizeof( uint32_t ) )
+    {
+        spsc_receive( &xSmallChannel, &ulValue, portMAX_DELAY );
+    }
+    else
+    {
+        const uint8_t *pucSlot = spsc_peek_wait( &xPayloadChannel, portMAX_DELAY );
+        memcpy( &ulValue, pucSlot, sizeof( ulValue ) );
+        spsc_release( &xPayloadChannel );
+    }
+    return ulValue;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvRun( const Run_t *pxRun )
+{
+    spsc_init( &xSmallChannel );
+    spsc_init( &xPayloadChannel );
+    xQueueReset( xSmallQueue );
+    xQueueReset( xPayloadQueue );
+    bench_reset( &xLatency );
+
+    pxCurrentRun = pxRun;
+    xTaskNotifyGive( xConsumer );
+
+    const uint64_t ullStart = hal_time_us();
+    for( uint32_t i = 0; i < pxRun->ulCount; i++ )
+    {
+        if( pxRun->xLatency )
+        {
+            vTaskDelay( 1 );
+            prvSend( pxRun, ( uint32_t ) hal_time_us() );
+        }
+        else
+        {
+            prvSend( pxRun, i );
+        }
+    }
+
+    /* The consumer gives back once it has seen every message. */
+    ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    return hal_time_us() - ullStart;
+}
+/*-----------------------------------------------------------*/
+
+static void prvThroughput( const Transport_t eTransport, const uint32_t ulSize, const char *pcMetric )
+{
+    const Run_t xRun = { eTransport, ulSize, spscbenchMESSAGES, pdFALSE };
+    const uint64_t ullUs = prvRun( &xRun );
+
+    bench_report_value( "spsc", pcMetric, "msg/s", ullUs ? ( ( uint64_t ) spscbenchMESSAGES * 1000000 ) / ullUs : 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvLatency( const Transport_t eTransport, const char *pcMetric )
+{
+    const Run_t xRun = { eTransport, sizeof( uint32_t ), spscbenchLATENCY_SAMPLES, pdTRUE };
+
+    prvRun( &xRun );
+    bench_report( "spsc", pcMetric, "us", &xLatency );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSpscBenchTask( void *pvParameters )
+{
+    ( void ) pvParameters;
+
+#ifndef HOST_BUILD
+    vTaskDelay( spscbenchUSB_SETTLE_MS );
+#endif
+    prvPin( xBenchTask, spscbenchCORE_PRODUCER );
+
+    prvThroughput( spscbenchQUEUE, sizeof( uint32_t ), "queue_msgs_per_s" );
+    prvThroughput( spscbenchSPSC, sizeof( uint32_t ), "spsc_msgs_per_s" );
+    prvLatency( spscbenchQUEUE, "queue_latency" );
+    prvLatency( spscbenchSPSC, "spsc_latency" );
+    prvThroughput( spscbenchQUEUE, spscbenchPAYLOAD, "queue_payload_msgs_per_s" );
+    prvThroughput( spscbenchSPSC, spscbenchPAYLOAD, "spsc_payload_msgs_per_s" );
+
+    bench_report_value( "spsc", "spsc_full_waits", "reserves", xPayloadChannel.full );
+    bench_report_value( "spsc", "sequence_errors", "messages", ulSequenceErrors );
+    bench_done();
+}
+/*-----------------------------------------------------------*/
+
+static void prvConsumerTask( void *pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ;; )
+    {
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        const Run_t *pxRun = pxCurrentRun;
+
+        for( uint32_t i = 0; i < pxRun->ulCount; i++ )
+        {
+            const uint32_t ulValue = prvReceive( pxRun );
+            if( pxRun->xLatency )
+            {
+                bench_add( &xLatency, ( uint32_t ) hal_time_us() - ulValue );
+            }
+            else if( ulValue != i )
+            {
+                ulSequenceErrors++;
+            }
+        }
+
+        xTaskNotifyGive( xBenchTask );
+    }
+}
+/*-----------------------------------------------------------*/
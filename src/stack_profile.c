@@ -0,0 +1,30 @@
+#include "stack_profile.h"
+
+/* Library includes. */
+#include <stdio.h>
+
+typedef struct {
+    TaskHandle_t task;
+    uint32_t depth;
+} stack_profile_entry;
+
+static stack_profile_entry stack_profile_tasks[STACK_PROFILE_MAX_TASKS];
+static uint32_t stack_profile_count = 0;
+
+void stack_profile_register(TaskHandle_t task, const uint32_t depth) {
+    if(task == NULL || stack_profile_count >= STACK_PROFILE_MAX_TASKS) { return; }
+    stack_profile_tasks[stack_profile_count].task = task;
+    stack_profile_tasks[stack_profile_count].depth = depth;
+    stack_profile_count++;
+}
+
+void stack_profile_report(void) {
+    for(uint32_t i=0; i<stack_profile_count; i++) {
+        const stack_profile_entry *e = &stack_profile_tasks[i];
+        // Scans from the end of the stack up to the first used word
+        const uint32_t free_words = (uint32_t)uxTaskGetStackHighWaterMark(e->task);
+        printf("STACK %s depth=%lu free=%lu used=%lu\n",
+            pcTaskGetName(e->task), (unsigned long)e->depth, (unsigned long)free_words,
+            (unsigned long)(e->depth - free_words));
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef STACK_PROFILE_H
+#define STACK_PROFILE_H
+/*
+ * Stack depth of every task against its high water mark.
+ *
+ * Tasks register with the depth they were created with, stack_profile_report()
+ * prints one line per task next to the task table of trace_task():
+ *   STACK <name> depth=<words> free=<words> used=<words>
+ * `free` is uxTaskGetStackHighWaterMark(), the least free stack the task has
+ * had since it started, so one line at the end of a run carries the deepest
+ * use of the whole run.
+ *
+ * The stack_profile executable runs main_blinky with every stack at
+ * STACK_PROFILE_DEPTH and a stress load, tools/stack_report.py turns the
+ * STACK lines into sizes with a margin and writes a header of
+ * STACK_SIZE_<NAME> defines. Configure with -DSTACK_SIZES=<header> to build
+ * the tasks with those sizes.
+ */
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STACK_PROFILE_MAX_TASKS       ( 16 )
+// Depth of every task in the profile, room for any of them
+#define STACK_PROFILE_DEPTH           ( 1024 )
+
+// Tasks past STACK_PROFILE_MAX_TASKS are not reported
+void stack_profile_register(TaskHandle_t task, const uint32_t depth);
+void stack_profile_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,133 @@
+#include "tickless.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#ifndef HOST_BUILD
+#include "hardware/structs/scb.h"
+#include "hardware/structs/systick.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#else
+#include <errno.h>
+#include <time.h>
+#endif
+
+#define tickless_US_PER_TICK          ( 1000000u / configTICK_RATE_HZ )
+// Longest single sleep, well inside the 32 bit range of a timer alarm
+#define tickless_MAX_IDLE_TICKS       ( 10u * configTICK_RATE_HZ )
+
+static tickless_stats tickless_counters;
+
+void tickless_tick( void ) {
+    tickless_counters.ticks++;
+}
+
+void tickless_get_stats( tickless_stats *stats ) {
+    taskENTER_CRITICAL();
+    *stats = tickless_counters;
+    taskEXIT_CRITICAL();
+}
+
+#if ( configUSE_TICKLESS_IDLE == 2 ) && !defined( HOST_BUILD )
+#define tickless_SYSTICK_ENABLE       ( 1u << 0 )
+#define tickless_ICSR_PENDSTSET       ( 1u << 26 )
+
+static uint tickless_alarm;
+
+// Only there to end the WFI, the alarm is cancelled on wake anyway
+static void tickless_alarm_callback( uint alarm_num ) {
+    ( void ) alarm_num;
+}
+
+void tickless_init( void ) {
+    tickless_alarm = (uint)hardware_alarm_claim_unused(true);
+    hardware_alarm_set_callback(tickless_alarm, tickless_alarm_callback);
+}
+
+void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime ) {
+    // The port loads SysTick with one tick period from clk_sys
+    const uint32_t cycles_per_tick = systick_hw->rvr + 1;
+    const uint32_t cycles_per_us = cycles_per_tick / tickless_US_PER_TICK;
+
+    if(xExpectedIdleTime > tickless_MAX_IDLE_TICKS) { xExpectedIdleTime = tickless_MAX_IDLE_TICKS; }
+
+    // PRIMASK stays set across the sleep, a pending interrupt still ends WFI
+    // and runs once interrupts are restored
+    const uint32_t save = save_and_disable_interrupts();
+    if(eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        restore_interrupts(save);
+        return;
+    }
+
+    // Stop the tick and see how far into the current period we are. A tick
+    // that expired meanwhile stays pending and ends the WFI straight away.
+    systick_hw->csr &= ~tickless_SYSTICK_ENABLE;
+    const uint64_t start = time_us_64();
+    const uint32_t into_us = (cycles_per_tick - 1 - systick_hw->cvr) / cycles_per_us;
+
+    // Wake on the boundary of the tick the next task is due on
+    const uint32_t sleep_us = xExpectedIdleTime * tickless_US_PER_TICK - into_us;
+    if(!hardware_alarm_set_target(tickless_alarm, from_us_since_boot(start + sleep_us))) {
+        __dsb();
+        __wfi();
+    }
+    const uint64_t elapsed_us = time_us_64() - start;
+    hardware_alarm_cancel(tickless_alarm);
+
+    // Whole periods since the last counted tick, and what is left of the current
+    const uint64_t total_us = into_us + elapsed_us;
+    TickType_t ticks = (TickType_t)(total_us / tickless_US_PER_TICK);
+    uint32_t remainder_us = (uint32_t)(total_us % tickless_US_PER_TICK);
+    if(ticks >= xExpectedIdleTime) {
+        // Slept the whole way: the last tick goes through the tick interrupt
+        // so the task it releases is unblocked as usual
+        ticks = xExpectedIdleTime - 1;
+        scb_hw->icsr = tickless_ICSR_PENDSTSET;
+    } else {
+        tickless_counters.early_wakeups++;
+    }
+    vTaskStepTick(ticks);
+
+    // Next tick on the original grid, then back to whole periods
+    uint32_t reload = (tickless_US_PER_TICK - remainder_us) * cycles_per_us;
+    if(reload < cycles_per_us) { reload = cycles_per_us; }
+    systick_hw->rvr = reload - 1;
+    systick_hw->cvr = 0;
+    systick_hw->csr |= tickless_SYSTICK_ENABLE;
+    systick_hw->rvr = cycles_per_tick - 1;
+
+    tickless_counters.sleeps++;
+    tickless_counters.asleep_us += elapsed_us;
+    tickless_counters.suppressed_ticks += ticks;
+    restore_interrupts(save);
+}
+#elif ( configUSE_TICKLESS_IDLE == 2 )
+void tickless_init( void ) { }
+
+void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime ) {
+    struct timespec start, until, end;
+
+    if(xExpectedIdleTime > tickless_MAX_IDLE_TICKS) { xExpectedIdleTime = tickless_MAX_IDLE_TICKS; }
+    if(eTaskConfirmSleepModeStatus() == eAbortSleep) { return; }
+
+    // The scheduler is suspended: the tick signals keep arriving but only
+    // pend. Sleep until just before the last tick, which then runs normally.
+    const uint64_t sleep_ns = (uint64_t)(xExpectedIdleTime - 1) * tickless_US_PER_TICK * 1000u;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    until.tv_sec = start.tv_sec + (time_t)((start.tv_nsec + sleep_ns) / 1000000000u);
+    until.tv_nsec = (long)((start.tv_nsec + sleep_ns) % 1000000000u);
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR) { }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    tickless_counters.sleeps++;
+    tickless_counters.asleep_us += (uint64_t)((int64_t)(end.tv_sec - start.tv_sec) * 1000000
+        + (end.tv_nsec - start.tv_nsec) / 1000);
+    // Still delivered, only late: not suppressed
+    tickless_counters.pended_ticks += xExpectedIdleTime - 1;
+}
+#else
+void tickless_init( void ) { }
+#endif
@@ -0,0 +1,56 @@
+#ifndef TICKLESS_H
+#define TICKLESS_H
+/*
+ * Tickless idle.
+ *
+ * Included at the end of FreeRTOSConfig.h, like trace.h.
+ *
+ * With configUSE_TICKLESS_IDLE 2 the idle task calls
+ * vPortSuppressTicksAndSleep() whenever no task is due for at least
+ * configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks. On the RP2040 SysTick is
+ * stopped, a timer alarm is armed on the tick boundary of the next release
+ * and the core sleeps in WFI. On wake the tick count is stepped by the whole
+ * periods that elapsed and SysTick is restarted for what is left of the
+ * current one, so periodic releases stay on the 1 ms grid of the 64 bit timer.
+ *
+ * The POSIX port tick cannot be stopped: the host build sleeps the idle
+ * thread with the scheduler suspended instead. The ticks that arrive meanwhile
+ * still run, they only pend until the wake, so they are counted as pended and
+ * the suppressed count stays 0 there. The host run prints the pended count in
+ * its summary, it is not a saving and has no place in the SLEEP line.
+ *
+ * trace_task() prints the counters every second:
+ *   SLEEP <sleeps> <early wakeups> <us asleep> <suppressed ticks> <ticks>
+ */
+
+/* Build with TICKLESS_IDLE=1 (CMake -DTICKLESS_IDLE=ON) to enable it */
+#ifndef TICKLESS_IDLE
+#define TICKLESS_IDLE                 0
+#endif
+
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+
+typedef struct {
+    uint32_t sleeps;              // Times the idle core went to sleep and woke
+    uint32_t early_wakeups;       // Woken by an interrupt before the alarm
+    uint64_t asleep_us;
+    uint64_t suppressed_ticks;    // Tick interrupts that never happened
+    uint64_t pended_ticks;        // Host: ticks held back while asleep
+    uint64_t ticks;               // Tick interrupts that did
+} tickless_stats;
+
+// Claims the wake up alarm, called before the scheduler starts
+void tickless_init( void );
+// Counts the serviced ticks, called from the tick hook
+void tickless_tick( void );
+void tickless_get_stats( tickless_stats *stats );
+
+#if ( TICKLESS_IDLE == 1 ) && defined( HOST_BUILD )
+// The RP2040 portmacro.h declares it, the POSIX one does not. TickType_t is
+// not known yet here, it is 32 bits wide in this build.
+void vPortSuppressTicksAndSleep( uint32_t xExpectedIdleTime );
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+#endif /* __ASSEMBLER__ */
+#endif
@@ -0,0 +1,183 @@
+#include "timekeeper.h"
+#include "hal.h"
+
+#define TIMEKEEPER_US_PER_S           ( 1000000ull )
+// Folds the elapsed counter time into the base now and then, so the drift
+// correction below never overflows
+#define TIMEKEEPER_REBASE_US          ( 3600ull * TIMEKEEPER_US_PER_S )
+// More than 1000ppm apart is a wrong time being corrected, not drift
+#define TIMEKEEPER_MAX_DRIFT_PPB      ( 1000000 )
+
+static uint64_t (*timekeeper_source)(void) = hal_time_us;
+static uint64_t timekeeper_base_local;
+static uint64_t timekeeper_base_wall;
+static uint64_t timekeeper_last_set_local;
+static uint64_t timekeeper_last_set_wall;
+static bool timekeeper_was_set;
+static timekeeper_stats timekeeper_counters;
+
+static TaskHandle_t timekeeper_task;
+static TaskHandle_t timekeeper_subscribers[TIMEKEEPER_MAX_SUBSCRIBERS];
+static int timekeeper_subscriber_count;
+
+void timekeeper_init(uint64_t (*now_us)(void)) {
+    timekeeper_source = now_us ? now_us : hal_time_us;
+    timekeeper_base_local = timekeeper_source();
+    timekeeper_base_wall = TIMEKEEPER_DEFAULT_EPOCH * TIMEKEEPER_US_PER_S;
+    timekeeper_last_set_local = timekeeper_base_local;
+    timekeeper_was_set = false;
+    timekeeper_counters = (timekeeper_stats){ 0 };
+    timekeeper_subscriber_count = 0;
+}
+
+// Wall time at counter value `local`, called with the base locked
+static uint64_t wall_at(const uint64_t local) {
+    const int64_t elapsed = (int64_t)(local - timekeeper_base_local);
+    const int64_t correction = elapsed * timekeeper_counters.drift_ppb / 1000000000;
+    return timekeeper_base_wall + (uint64_t)(elapsed - correction);
+}
+
+uint64_t timekeeper_now_us(void) {
+    taskENTER_CRITICAL();
+    const uint64_t wall = wall_at(timekeeper_source());
+    taskEXIT_CRITICAL();
+    return wall;
+}
+
+uint64_t timekeeper_now_s(void) {
+    return timekeeper_now_us() / TIMEKEEPER_US_PER_S;
+}
+
+static void publish(const uint32_t events) {
+    for(int i=0; i<timekeeper_subscriber_count; i++) {
+        xTaskNotifyIndexed(timekeeper_subscribers[i], TIMEKEEPER_NOTIFY_INDEX, events, eSetBits);
+    }
+}
+
+void timekeeper_set_us(const uint64_t wall_us) {
+    taskENTER_CRITICAL();
+    const uint64_t local = timekeeper_source();
+    const int64_t error = (int64_t)(wall_at(local) - wall_us);
+    const uint64_t since = local - timekeeper_last_set_local;
+    if(timekeeper_was_set && since >= TIMEKEEPER_DISCIPLINE_MIN_S * TIMEKEEPER_US_PER_S) {
+        // The counter advanced `since` while the reference advanced `real`
+        const int64_t real = (int64_t)(wall_us - timekeeper_last_set_wall);
+        if(real >= 1000) {
+            const int64_t ppb = ((int64_t)since - real) * 1000000 / (real / 1000);
+            if(ppb > -TIMEKEEPER_MAX_DRIFT_PPB && ppb < TIMEKEEPER_MAX_DRIFT_PPB) {
+                timekeeper_counters.drift_ppb = (int32_t)ppb;
+                timekeeper_counters.disciplines++;
+            }
+        }
+    }
+    timekeeper_base_local = local;
+    timekeeper_base_wall = wall_us;
+    timekeeper_last_set_local = local;
+    timekeeper_last_set_wall = wall_us;
+    timekeeper_was_set = true;
+    timekeeper_counters.last_error_us = error;
+    timekeeper_counters.sets++;
+    taskEXIT_CRITICAL();
+
+    publish(TIMEKEEPER_EVENT_SET);
+    // Realign the second events to the new time
+    if(timekeeper_task != NULL) {
+        xTaskNotifyGiveIndexed(timekeeper_task, TIMEKEEPER_NOTIFY_INDEX);
+    }
+}
+
+void timekeeper_set_drift_ppb(const int32_t ppb) {
+    taskENTER_CRITICAL();
+    // Keep the current wall time, only the rate from now on changes
+    const uint64_t local = timekeeper_source();
+    timekeeper_base_wall = wall_at(local);
+    timekeeper_base_local = local;
+    timekeeper_counters.drift_ppb = ppb;
+    taskEXIT_CRITICAL();
+}
+
+void timekeeper_get_stats(timekeeper_stats *stats) {
+    taskENTER_CRITICAL();
+    *stats = timekeeper_counters;
+    taskEXIT_CRITICAL();
+}
+
+bool timekeeper_subscribe(TaskHandle_t task) {
+    bool ok = false;
+    taskENTER_CRITICAL();
+    if(timekeeper_subscriber_count < TIMEKEEPER_MAX_SUBSCRIBERS) {
+        timekeeper_subscribers[timekeeper_subscriber_count++] = task ? task : xTaskGetCurrentTaskHandle();
+        ok = true;
+    }
+    taskEXIT_CRITICAL();
+    return ok;
+}
+
+uint32_t timekeeper_wait(const TickType_t ticks) {
+    uint32_t events = 0;
+    if(xTaskNotifyWaitIndexed(TIMEKEEPER_NOTIFY_INDEX, 0, UINT32_MAX, &events, ticks) != pdTRUE) {
+        return 0;
+    }
+    return events;
+}
+
+// Days since 1970-01-01 to civil date and back, proleptic Gregorian
+// (H. Hinnant, chrono-compatible low-level date algorithms)
+void timekeeper_split(const uint64_t unix_s, timekeeper_time *t) {
+    const uint32_t sod = (uint32_t)(unix_s % 86400);
+    const int64_t z = (int64_t)(unix_s / 86400) + 719468;
+    const int64_t era = z / 146097;
+    const uint32_t doe = (uint32_t)(z - era * 146097);
+    const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const uint32_t mp = (5 * doy + 2) / 153;
+    const uint32_t d = doy - (153 * mp + 2) / 5 + 1;
+    const uint32_t m = mp < 10 ? mp + 3 : mp - 9;
+    t->year = (uint16_t)(yoe + era * 400 + (m <= 2));
+    t->month = (uint8_t)m;
+    t->day = (uint8_t)d;
+    t->hour = (uint8_t)(sod / 3600);
+    t->minute = (uint8_t)(sod / 60 % 60);
+    t->second = (uint8_t)(sod % 60);
+}
+
+uint64_t timekeeper_join(const timekeeper_time *t) {
+    const int64_t y = (int64_t)t->year - (t->month <= 2);
+    const int64_t era = y / 400;
+    const uint32_t yoe = (uint32_t)(y - era * 400);
+    const uint32_t mp = t->month > 2 ? t->month - 3u : t->month + 9u;
+    const uint32_t doy = (153 * mp + 2) / 5 + t->day - 1;
+    const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    const int64_t days = era * 146097 + (int64_t)doe - 719468;
+    return (uint64_t)days * 86400 + t->hour * 3600u + t->minute * 60u + t->second;
+}
+
+void timekeeperTask(void *pvParameters) {
+    ( void ) pvParameters;
+    timekeeper_task = xTaskGetCurrentTaskHandle();
+    uint64_t last = timekeeper_now_s();
+
+    for( ;; ) {
+        // Sleep into the first tick past the next second boundary, a set
+        // wakes the task early
+        const uint64_t to_next = TIMEKEEPER_US_PER_S - timekeeper_now_us() % TIMEKEEPER_US_PER_S;
+        const TickType_t ticks = (TickType_t)(to_next / (portTICK_PERIOD_MS * 1000)) + 1;
+        ulTaskNotifyTakeIndexed(TIMEKEEPER_NOTIFY_INDEX, pdTRUE, ticks);
+
+        taskENTER_CRITICAL();
+        const uint64_t local = timekeeper_source();
+        const uint64_t now = wall_at(local) / TIMEKEEPER_US_PER_S;
+        const bool second = now != last;
+        if(second) {
+            last = now;
+            timekeeper_counters.seconds++;
+        }
+        if(local - timekeeper_base_local > TIMEKEEPER_REBASE_US) {
+            timekeeper_base_wall = wall_at(local);
+            timekeeper_base_local = local;
+        }
+        taskEXIT_CRITICAL();
+
+        if(second) { publish(TIMEKEEPER_EVENT_SECOND); }
+    }
+}
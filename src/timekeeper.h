@@ -0,0 +1,94 @@
+#ifndef TIMEKEEPER_H
+#define TIMEKEEPER_H
+/*
+ * Wall clock time on top of a free running microsecond counter.
+ *
+ * Time is kept as a base (counter value, wall time) pair, the wall time is
+ * the base plus the counter time elapsed since, corrected by the drift of
+ * the counter in parts per billion. The counter is hal_time_us() (the RP2040
+ * 64 bit timer), or any other source given to timekeeper_init(), such as a
+ * fake clock for tests.
+ *
+ * Setting the time twice at least TIMEKEEPER_DISCIPLINE_MIN_S apart (from
+ * NTP, a GPS, a user typing it in) measures how far the counter drifted in
+ * between and folds that into the correction.
+ *
+ * timekeeperTask wakes at every second boundary and notifies the subscribed
+ * tasks on notification index TIMEKEEPER_NOTIFY_INDEX, setting
+ * TIMEKEEPER_EVENT_SECOND. Setting the time notifies TIMEKEEPER_EVENT_SET.
+ *
+ *   timekeeper_subscribe(NULL);
+ *   for( ;; ) {
+ *       const uint32_t events = timekeeper_wait(portMAX_DELAY);
+ *       timekeeper_time t;
+ *       timekeeper_split(timekeeper_now_s(), &t);
+ *       ...
+ *   }
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Task notification of the events, shared with render.h, see the index map
+in FreeRTOSConfig.h */
+#define TIMEKEEPER_NOTIFY_INDEX       ( 2 )
+#define TIMEKEEPER_EVENT_SECOND       ( 1u << 0 )
+#define TIMEKEEPER_EVENT_SET          ( 1u << 1 )
+
+#define TIMEKEEPER_MAX_SUBSCRIBERS    ( 4 )
+// Shorter intervals between two sets say more about jitter than drift
+#define TIMEKEEPER_DISCIPLINE_MIN_S   ( 10 )
+// Wall time until it is set, 2024-01-01 00:00:00 UTC
+#ifndef TIMEKEEPER_DEFAULT_EPOCH
+#define TIMEKEEPER_DEFAULT_EPOCH      ( 1704067200ull )
+#endif
+
+typedef struct {
+    uint16_t year;
+    uint8_t month;                // 1..12
+    uint8_t day;                  // 1..31
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+} timekeeper_time;
+
+typedef struct {
+    uint32_t sets;
+    uint32_t disciplines;
+    uint32_t seconds;             // Second events published
+    int64_t last_error_us;        // Local minus reference at the last set
+    int32_t drift_ppb;            // Counter fast by this much, corrected
+} timekeeper_stats;
+
+// `now_us` is the counter, NULL for hal_time_us()
+void timekeeper_init(uint64_t (*now_us)(void));
+
+// Wall time in microseconds / seconds since 1970-01-01 00:00:00 UTC
+uint64_t timekeeper_now_us(void);
+uint64_t timekeeper_now_s(void);
+// Set the wall time, disciplining the drift when the last set is old enough
+void timekeeper_set_us(const uint64_t wall_us);
+void timekeeper_set_drift_ppb(const int32_t ppb);
+void timekeeper_get_stats(timekeeper_stats *stats);
+
+// The calling task (NULL) or `task` gets the events, false when full
+bool timekeeper_subscribe(TaskHandle_t task);
+// Wait for events of a subscribed task, returns the event bits, 0 on timeout
+uint32_t timekeeper_wait(const TickType_t ticks);
+
+void timekeeper_split(const uint64_t unix_s, timekeeper_time *t);
+uint64_t timekeeper_join(const timekeeper_time *t);
+
+// Publishes the second events
+void timekeeperTask(void *pvParameters);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,135 @@
+#include "trace.h"
+#include "input.h"
+#include "periodic.h"
+#include "pool.h"
+#include "render.h"
+#include "stack_profile.h"
+#include "tickless.h"
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include <stdio.h>
+#include "hal.h"
+#ifndef HOST_BUILD
+#include "hardware/structs/timer.h"
+#endif
+
+#define TRACE_LINE_RECORDS            ( 16 )
+#define TRACE_MAX_TASKS               ( 16 )
+
+static trace_record trace_ring[TRACE_RING_CORES][TRACE_RING_SIZE];
+// Written only by the owning core, read by trace_task()
+static volatile uint32_t trace_head[TRACE_RING_CORES];
+// Reader side
+static uint32_t trace_tail[TRACE_RING_CORES];
+static uint32_t trace_dropped = 0;
+
+uint64_t trace_runtime_us( void ) {
+    return hal_time_us();
+}
+
+void trace_record_event( const uint8_t event, const uint16_t arg ) {
+#ifdef portGET_CORE_ID
+    const uint32_t core = portGET_CORE_ID();
+#else
+    const uint32_t core = 0;
+#endif
+    const uint32_t h = trace_head[core];
+    trace_record *r = &trace_ring[core][h & (TRACE_RING_SIZE - 1)];
+#ifndef HOST_BUILD
+    // The raw low word does not latch the high one, safe from both cores
+    r->timestamp = timer_hw->timerawl;
+#else
+    r->timestamp = (uint32_t)hal_time_us();
+#endif
+    r->event = event;
+    r->core = (uint8_t)core;
+    r->arg = arg;
+    // Publish the record after its contents
+    __atomic_store_n(&trace_head[core], h + 1, __ATOMIC_RELEASE);
+}
+
+static void print_records( const trace_record *records, const uint32_t n ) {
+    const uint8_t *b = (const uint8_t *)records;
+    printf("TRACE ");
+    for(uint32_t i=0; i<n * sizeof(trace_record); i++) {
+        printf("%02x", b[i]);
+    }
+    printf("\n");
+}
+
+static void drain_core( const uint32_t core ) {
+    trace_record chunk[TRACE_LINE_RECORDS];
+    const uint32_t head = __atomic_load_n(&trace_head[core], __ATOMIC_ACQUIRE);
+
+    if(head - trace_tail[core] > TRACE_RING_SIZE) {
+        trace_dropped += head - trace_tail[core] - TRACE_RING_SIZE;
+        trace_tail[core] = head - TRACE_RING_SIZE;
+    }
+    while(trace_tail[core] != head) {
+        uint32_t n = head - trace_tail[core];
+        if(n > TRACE_LINE_RECORDS) { n = TRACE_LINE_RECORDS; }
+        for(uint32_t i=0; i<n; i++) {
+            chunk[i] = trace_ring[core][(trace_tail[core] + i) & (TRACE_RING_SIZE - 1)];
+        }
+        // The writer may have lapped us while copying
+        const uint32_t now = __atomic_load_n(&trace_head[core], __ATOMIC_ACQUIRE);
+        if(now - trace_tail[core] > TRACE_RING_SIZE) {
+            trace_dropped += n;
+        } else {
+            print_records(chunk, n);
+        }
+        trace_tail[core] += n;
+    }
+}
+
+static void print_task_table( void ) {
+    static TaskStatus_t xStatus[TRACE_MAX_TASKS];
+    configRUN_TIME_COUNTER_TYPE ulTotal = 0;
+
+    const UBaseType_t n = uxTaskGetSystemState(xStatus, TRACE_MAX_TASKS, &ulTotal);
+    for(UBaseType_t i=0; i<n; i++) {
+        printf("TASK %lu %llu %lu %s\n",
+            (unsigned long)xStatus[i].xTaskNumber,
+            (unsigned long long)xStatus[i].ulRunTimeCounter,
+            (unsigned long)xStatus[i].usStackHighWaterMark,
+            xStatus[i].pcTaskName);
+    }
+    printf("TOTAL %llu %lu\n", (unsigned long long)ulTotal, (unsigned long)trace_dropped);
+}
+
+static void print_sleep_stats( void ) {
+    tickless_stats s;
+    tickless_get_stats(&s);
+    printf("SLEEP %lu %lu %llu %llu %llu\n",
+        (unsigned long)s.sleeps, (unsigned long)s.early_wakeups,
+        (unsigned long long)s.asleep_us, (unsigned long long)s.suppressed_ticks,
+        (unsigned long long)s.ticks);
+}
+
+void trace_task( void *pvParameters ) {
+    TickType_t xNextWakeTime = xTaskGetTickCount();
+    TickType_t xLastTable = xNextWakeTime;
+
+    ( void ) pvParameters;
+
+    for( ;; ) {
+        vTaskDelayUntil(&xNextWakeTime, pdMS_TO_TICKS(TRACE_DRAIN_PERIOD_MS));
+        for(uint32_t core=0; core<TRACE_RING_CORES; core++) {
+            drain_core(core);
+        }
+        if(xNextWakeTime - xLastTable >= pdMS_TO_TICKS(TRACE_TABLE_PERIOD_MS)) {
+            xLastTable = xNextWakeTime;
+            print_task_table();
+            print_sleep_stats();
+            pool_report();
+            render_report();
+            periodic_report();
+            input_report();
+            stack_profile_report();
+        }
+    }
+}
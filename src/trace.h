@@ -0,0 +1,84 @@
+#ifndef TRACE_H
+#define TRACE_H
+/*
+ * Run time statistics clock and binary trace ring.
+ *
+ * Included at the end of FreeRTOSConfig.h, so everything in here is seen by
+ * the kernel sources: keep it to declarations and macros.
+ *
+ * Every event is an 8 byte record in a per core ring. Records are written by
+ * the core they happen on, from kernel code that already runs with
+ * interrupts masked (context switch, queue operations) or from ISRs through
+ * traceIRQ_ENTER/EXIT, so claiming a slot needs no lock: a timer read, two
+ * stores and an index update. When a ring is full the oldest records are
+ * overwritten and counted as dropped by the reader.
+ *
+ * trace_task() drains the rings as hex lines over stdio (binary would be
+ * mangled by the CRLF translation), see tools/trace_decode.py:
+ *   TRACE <hex records>
+ *   TASK <number> <run time us> <stack high water mark words> <name>
+ *   TOTAL <run time us> <dropped records>
+ *   SLEEP <sleeps> <early wakeups> <us asleep> <suppressed ticks> <ticks>
+ *   POOL <name> block=<bytes> count=.. in_use=.. peak=.. allocs=.. failures=..
+ *   RENDER frames=.. updates=.. max_coalesced=.. capped=.. late=.. max_latency_us=.. busy_us=..
+ *   STACK <name> depth=<words> free=<words> used=<words>
+ *   PERIODIC <id> <name> period_us=.. deadline_us=.. jobs=.. misses=.. late_releases=.. ..
+ *   INPUT <id> <name> edges=.. events=.. rejected=.. dropped=.. max_latency_us=.. ..
+ */
+
+/* Set to 0 to compile every trace hook out */
+#ifndef TRACE_RING_ENABLE
+#define TRACE_RING_ENABLE             1
+#endif
+
+#define TRACE_RING_SIZE               ( 512 ) // Records per core, power of 2
+#define TRACE_RING_CORES              ( 2 )
+
+#define TRACE_EV_SWITCH_IN            ( 1 )
+#define TRACE_EV_SWITCH_OUT           ( 2 )
+#define TRACE_EV_QUEUE_SEND           ( 3 )
+#define TRACE_EV_QUEUE_RECEIVE        ( 4 )
+#define TRACE_EV_ISR_ENTER            ( 5 )
+#define TRACE_EV_ISR_EXIT             ( 6 )
+
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+
+typedef struct {
+    uint32_t timestamp;   // Microseconds, low 32 bits of the 64 bit timer
+    uint8_t event;
+    uint8_t core;
+    uint16_t arg;         // Task number, queue number or IRQ
+} trace_record;
+
+// Free running microsecond clock, also the run time stats counter
+uint64_t trace_runtime_us( void );
+void trace_record_event( const uint8_t event, const uint16_t arg );
+
+// Low priority task draining the rings and printing the task table every
+// TRACE_DRAIN_PERIOD_MS
+#define TRACE_DRAIN_PERIOD_MS         ( 100 )
+#define TRACE_TABLE_PERIOD_MS         ( 1000 )
+void trace_task( void *pvParameters );
+
+/* Run time stats from the RP2040 64 bit microsecond timer */
+#define configRUN_TIME_COUNTER_TYPE             uint64_t
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()        trace_runtime_us()
+
+#if ( TRACE_RING_ENABLE == 1 )
+#define traceTASK_SWITCHED_IN()       trace_record_event( TRACE_EV_SWITCH_IN, ( uint16_t ) pxCurrentTCB->uxTCBNumber )
+#define traceTASK_SWITCHED_OUT()      trace_record_event( TRACE_EV_SWITCH_OUT, ( uint16_t ) pxCurrentTCB->uxTCBNumber )
+#define traceQUEUE_SEND( pxQueue )    trace_record_event( TRACE_EV_QUEUE_SEND, ( uint16_t ) ( pxQueue )->uxQueueNumber )
+#define traceQUEUE_RECEIVE( pxQueue ) trace_record_event( TRACE_EV_QUEUE_RECEIVE, ( uint16_t ) ( pxQueue )->uxQueueNumber )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )    traceQUEUE_SEND( pxQueue )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue ) traceQUEUE_RECEIVE( pxQueue )
+/* Not kernel hooks, called by the application interrupt handlers */
+#define traceIRQ_ENTER( irq )         trace_record_event( TRACE_EV_ISR_ENTER, ( uint16_t ) ( irq ) )
+#define traceIRQ_EXIT( irq )          trace_record_event( TRACE_EV_ISR_EXIT, ( uint16_t ) ( irq ) )
+#else
+#define traceIRQ_ENTER( irq )
+#define traceIRQ_EXIT( irq )
+#endif
+#endif /* __ASSEMBLER__ */
+#endif
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""Compile a list of card UIDs into a flash resident table of src/cred_index.h.
+
+The list has one UID per line in hex, 4, 7 or 10 bytes, separators and
+# comments allowed:
+
+    04:A2:2F:6A:B1:5D:80    # front door, J. Doe
+    DEADBEEF
+
+The output is a C file with `const cred_index <name>`, keys in the order of
+the layout: a minimal perfect hash (--layout mph, the default) or the sorted
+keys in Eytzinger order (--layout eytzinger). Run by the build for
+src/credentials.txt, or by hand:
+
+    python3 tools/cred_index_gen.py -o credentials.c src/credentials.txt
+    python3 tools/cred_index_gen.py --random 10000 --sizes 4,7 --layout eytzinger \\
+            --name cred_10k -o cred_10k.c
+
+The hashes must stay in step with cred_index.c.
+"""
+import argparse
+import random
+import re
+import sys
+
+MASK = 0xFFFFFFFF
+LAMBDA = 4
+SEED2 = 0x5BD1E995
+MAX_PILOT = 0xFFFF
+SEED_ATTEMPTS = 64
+UID_SIZES = (4, 7, 10)
+
+
+def fmix32(h):
+    h ^= h >> 16
+    h = (h * 0x85EBCA6B) & MASK
+    h ^= h >> 13
+    h = (h * 0xC2B2AE35) & MASK
+    h ^= h >> 16
+    return h
+
+
+def key_hash(key, seed):
+    h = seed
+    for w in key:
+        h = fmix32(h ^ w)
+    return h
+
+
+def pilot_mix(pilot, seed):
+    return fmix32((pilot * 0x9E3779B9 + seed) & MASK)
+
+
+def fastrange(x, n):
+    return (x * n) >> 32
+
+
+def parse(lines, source):
+    uids = []
+    for number, line in enumerate(lines, 1):
+        text = re.sub(r"[\s:\-]", "", line.split("#", 1)[0])
+        if not text:
+            continue
+        if not re.fullmatch(r"[0-9a-fA-F]+", text) or len(text) // 2 not in UID_SIZES or len(text) % 2:
+            sys.exit(f"{source}:{number}: not a 4, 7 or 10 byte UID: {line.strip()}")
+        uids.append(bytes.fromhex(text))
+    return uids
+
+
+def random_uids(count, sizes, seed):
+    rng = random.Random(seed)
+    uids = set()
+    while len(uids) < count:
+        size = sizes[len(uids) % len(sizes)]
+        uid = bytearray(rng.getrandbits(8) for _ in range(size))
+        # A first byte of 0x88 would be read as a cascade tag
+        if uid[0] == 0x88:
+            continue
+        uids.add(bytes(uid))
+    return sorted(uids)
+
+
+def pack(uid, uid_size, words):
+    data = uid if uid_size else bytes([len(uid)]) + uid
+    data = data.ljust(words * 4, b"\0")
+    return tuple(int.from_bytes(data[4 * i:4 * i + 4], "big") for i in range(words))
+
+
+def place(bucket, g, seed, n, taken, pilots, b, order, keys):
+    gs = [g[i] for i in bucket]
+    for pilot in range(MAX_PILOT + 1):
+        mix = pilot_mix(pilot, seed)
+        slots = [fastrange(fmix32(x ^ mix), n) for x in gs]
+        if len(set(slots)) == len(slots) and not any(taken[j] for j in slots):
+            pilots[b] = pilot
+            for j, i in zip(slots, bucket):
+                taken[j] = 1
+                order[j] = keys[i]
+            return True
+    return False
+
+
+def build_mph(keys, seed):
+    n = len(keys)
+    buckets = max(1, (n + LAMBDA - 1) // LAMBDA)
+    for attempt in range(SEED_ATTEMPTS):
+        s = (seed + attempt * 0x9E3779B9) & MASK
+        g = [key_hash(k, s ^ SEED2) for k in keys]
+        members = [[] for _ in range(buckets)]
+        for i, k in enumerate(keys):
+            members[fastrange(key_hash(k, s), buckets)].append(i)
+
+        taken = bytearray(n)
+        pilots = [0] * buckets
+        order = [None] * n
+        # Largest buckets first, while most slots are still free
+        for b in sorted(range(buckets), key=lambda b: -len(members[b])):
+            if members[b] and not place(members[b], g, s, n, taken, pilots, b, order, keys):
+                break
+        else:
+            return s, pilots, order
+    sys.exit(f"no perfect hash after {SEED_ATTEMPTS} seeds")
+
+
+def eytzinger(keys):
+    out = [None] * len(keys)
+    it = iter(sorted(keys))
+
+    def fill(i):
+        if i < len(out):
+            fill(2 * i + 1)
+            out[i] = next(it)
+            fill(2 * i + 2)
+
+    fill(0)
+    return out
+
+
+def emit(out, name, layout, uid_size, words, keys, seed, pilots, source):
+    flash = len(keys) * words * 4 + (len(pilots) * 2 if layout == "mph" else 0)
+    out.write(f"/* Generated by tools/cred_index_gen.py from {source}, do not edit.\n")
+    out.write(f"   {len(keys)} credentials, {layout}, {flash} bytes of flash. */\n")
+    out.write('#include "cred_index.h"\n\n')
+    out.write(f"static const uint32_t {name}_keys[] = {{\n")
+    for k in keys or [(0,) * words]:
+        out.write("    " + ", ".join(f"0x{w:08X}" for w in k) + ",\n")
+    out.write("};\n\n")
+    if layout == "mph":
+        out.write(f"static const uint16_t {name}_pilots[] = {{\n")
+        for i in range(0, max(len(pilots), 1), 12):
+            out.write("    " + ", ".join(f"{p}" for p in (pilots or [0])[i:i + 12]) + ",\n")
+        out.write("};\n\n")
+    out.write(f"const cred_index {name} = {{\n")
+    out.write(f"    .layout = {'CRED_INDEX_MPH' if layout == 'mph' else 'CRED_INDEX_EYTZINGER'},\n")
+    out.write(f"    .count = {len(keys)},\n")
+    out.write(f"    .key_words = {words},\n")
+    out.write(f"    .uid_size = {uid_size},\n")
+    if layout == "mph":
+        out.write(f"    .seed = 0x{seed:08X},\n")
+        out.write(f"    .buckets = {len(pilots)},\n")
+    out.write(f"    .keys = {name}_keys,\n")
+    if layout == "mph":
+        out.write(f"    .pilots = {name}_pilots,\n")
+    out.write("};\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("uids", nargs="?", help="UID list, stdin if omitted")
+    parser.add_argument("-o", "--output", help="C file to write, stdout if omitted")
+    parser.add_argument("--name", default="credentials", help="name of the cred_index")
+    parser.add_argument("--layout", choices=("mph", "eytzinger"), default="mph")
+    parser.add_argument("--seed", type=lambda v: int(v, 0), default=0x2545F491)
+    parser.add_argument("--random", type=int, metavar="N", help="N random UIDs instead of a list")
+    parser.add_argument("--sizes", default="4,7", help="UID sizes of --random, in turn")
+    args = parser.parse_args()
+
+    if args.random is not None:
+        sizes = [int(s) for s in args.sizes.split(",")]
+        if any(s not in UID_SIZES for s in sizes):
+            sys.exit("--sizes: 4, 7 or 10")
+        uids = random_uids(args.random, sizes, args.seed)
+        source = f"{args.random} random UIDs"
+    elif args.uids:
+        with open(args.uids) as f:
+            uids = parse(f, args.uids)
+        source = args.uids
+    else:
+        uids = parse(sys.stdin, "<stdin>")
+        source = "stdin"
+
+    unique = sorted(set(uids))
+    if len(unique) != len(uids):
+        print(f"{source}: {len(uids) - len(unique)} duplicate UIDs dropped", file=sys.stderr)
+    sizes = {len(u) for u in unique}
+    uid_size = sizes.pop() if len(sizes) == 1 else 0
+    longest = max((len(u) for u in unique), default=4)
+    words = (longest + (0 if uid_size else 1) + 3) // 4
+    keys = [pack(u, uid_size, words) for u in unique]
+
+    seed, pilots = 0, []
+    if args.layout == "mph" and keys:
+        seed, pilots, keys = build_mph(keys, args.seed)
+    elif args.layout == "eytzinger":
+        keys = eytzinger(keys)
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    emit(out, args.name, args.layout, uid_size, words, keys, seed, pilots, source)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""Expand the binary log of src/dlog.c.
+
+Reads the stdio capture (USB serial or host build stdout), cuts out the
+frames between 0x00 bytes, checks their CRC and prints each record with its
+format string, taken from the dlog_fmt section of the image that sent them:
+
+    python3 tools/dlog_decode.py build/src/main_blinky.elf capture.bin
+    python3 tools/dlog_decode.py --text build/src/main_blinky.elf < /dev/ttyACM0
+    ./build/src/main_blinky_host | python3 tools/dlog_decode.py build/src/main_blinky_host
+
+The image must be the one running, the record only has the offset of its
+string. Text between the frames (printf()) is dropped, or passed through
+with --text.
+"""
+import argparse
+import re
+import struct
+import sys
+
+SECTION = "dlog_fmt"
+HEADER = struct.Struct("<HBBI")
+SPEC = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z|j|t)?([diouxXc%])")
+
+
+def elf_section(path, name):
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF":
+        sys.exit(f"{path}: not an ELF file")
+    wide = elf[4] == 2
+    order = "<" if elf[5] == 1 else ">"
+    if wide:
+        shoff, = struct.unpack_from(order + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(order + "HHH", elf, 0x3A)
+        entry = struct.Struct(order + "IIQQQQIIQQ")
+    else:
+        shoff, = struct.unpack_from(order + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(order + "HHH", elf, 0x2E)
+        entry = struct.Struct(order + "IIIIIIIIII")
+    sections = [entry.unpack_from(elf, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx]
+    for s in sections:
+        start = names[4] + s[0]
+        if elf[start:elf.index(b"\0", start)].decode() == name:
+            return elf[s[4]:s[4] + s[5]]
+    sys.exit(f"{path}: no {name} section, nothing logs with DLOG()")
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def parse_record(chunk):
+    raw = cobs_decode(chunk)
+    if raw is None or len(raw) < HEADER.size + 2:
+        return None
+    body, crc = raw[:-2], int.from_bytes(raw[-2:], "little")
+    if crc16(body) != crc:
+        return None
+    fmt_id, core, n, timestamp = HEADER.unpack_from(body)
+    if len(body) != HEADER.size + 4 * n:
+        return None
+    args = struct.unpack_from(f"<{n}I", body, HEADER.size)
+    return fmt_id, core, timestamp, args
+
+
+def expand(fmt, args):
+    args = list(args)
+
+    def one(m):
+        flags, width, precision, conv = m.groups()
+        if conv == "%":
+            return "%"
+        if not args:
+            return "<?>"
+        v = args.pop(0)
+        if conv in "di":
+            v = v - (1 << 32) if v & 0x80000000 else v
+            conv = "d"
+        elif conv == "u":
+            conv = "d"
+        elif conv == "c":
+            v = chr(v & 0xFF)
+        spec = "%" + flags + width + ("." + precision if precision else "") + conv
+        return spec % v
+
+    return SPEC.sub(one, fmt)
+
+
+def frames(stream):
+    """Chunks between 0x00 bytes, as they arrive."""
+    chunk = bytearray()
+    while True:
+        data = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+        if not data:
+            break
+        parts = data.split(b"\0")
+        for part in parts[:-1]:
+            chunk += part
+            yield bytes(chunk)
+            chunk = bytearray()
+        chunk += parts[-1]
+    if chunk:
+        yield bytes(chunk)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="image that sent the log")
+    parser.add_argument("capture", nargs="?", help="binary capture, stdin if omitted")
+    parser.add_argument("--text", action="store_true", help="pass the text between frames through")
+    args = parser.parse_args()
+
+    strings = elf_section(args.elf, SECTION)
+    stream = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+    # Timestamps are the low 32 bits of the microsecond timer, unwrapped
+    last = {}
+    high = {}
+    bad = 0
+    for chunk in frames(stream):
+        if not chunk:
+            continue
+        record = parse_record(chunk)
+        if record is None:
+            if not all(32 <= b < 127 or b in b"\r\n\t" for b in chunk):
+                bad += 1
+            elif args.text:
+                sys.stdout.write(chunk.decode())
+            continue
+        fmt_id, core, timestamp, values = record
+        if timestamp < last.get(core, 0):
+            high[core] = high.get(core, 0) + (1 << 32)
+        last[core] = timestamp
+        if fmt_id < len(strings):
+            fmt = strings[fmt_id:strings.index(b"\0", fmt_id)].decode("utf-8", "replace")
+            text = expand(fmt, values)
+        else:
+            text = f"<unknown format {fmt_id}> " + " ".join(f"0x{v:08x}" for v in values)
+        print(f"{(high.get(core, 0) + timestamp) / 1e6:12.6f} {core} {text}", flush=True)
+    if bad:
+        print(f"{bad} frames failed the CRC", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Write the GPIO edges of button clicks and encoder turns for the host build.
+
+The host backend of src/input.h replays the file named by INPUT_SCRIPT on
+the tick of the POSIX port, one "<time_us> <pin> <level>" per line. Every
+contact change can bounce: --bounce extra toggles, --bounce-us apart at
+most, before the level settles. Pins are active low, idle high.
+
+    python3 tools/input_script.py click:14@500 click:15@1000+300 turn:22,26@1500:+5 > edges.txt
+    INPUT_SCRIPT=edges.txt HOST_RUN_MS=4000 ./build_host/src/main_blinky_host
+
+Actions:
+    click:<pin>@<ms>[+<hold ms>]             press, release after the hold (100)
+    turn:<a>,<b>@<ms>:<detents>[/<ms each>]  encoder detents, + clockwise (20 ms each)
+
+The events the firmware should report go to stderr.
+"""
+import argparse
+import random
+import re
+import sys
+
+CLICK = re.compile(r"click:(\d+)@(\d+)(?:\+(\d+))?$")
+TURN = re.compile(r"turn:(\d+),(\d+)@(\d+):([+-]?\d+)(?:/(\d+))?$")
+
+# A:B from rest, clockwise; the decoder steps forward through 00 01 11 10
+CLOCKWISE = [(1, 0), (0, 0), (0, 1), (1, 1)]
+
+
+class Script:
+    def __init__(self, bounce, bounce_us, rng):
+        self.bounce = bounce
+        self.bounce_us = bounce_us
+        self.rng = rng
+        self.edges = []
+
+    def change(self, at_us, pin, level):
+        # Bounces start at `at_us`, the last toggle leaves the new level
+        t = at_us
+        for i in range(self.bounce * 2):
+            self.edges.append((t, pin, level if i % 2 == 0 else 1 - level))
+            t += self.rng.randint(1, self.bounce_us)
+        self.edges.append((t, pin, level))
+
+    def click(self, pin, at_ms, hold_ms):
+        self.change(at_ms * 1000, pin, 0)
+        self.change((at_ms + hold_ms) * 1000, pin, 1)
+
+    def turn(self, a, b, at_ms, detents, each_ms):
+        states = CLOCKWISE if detents > 0 else list(reversed(CLOCKWISE[:-1])) + [CLOCKWISE[-1]]
+        step_us = each_ms * 1000 // len(states)
+        t = at_ms * 1000
+        level = {a: 1, b: 1}
+        for _ in range(abs(detents)):
+            for sa, sb in states:
+                for pin, v in ((a, sa), (b, sb)):
+                    if level[pin] != v:
+                        self.change(t, pin, v)
+                        level[pin] = v
+                t += step_us
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("actions", nargs="+",
+                        help="click:<pin>@<ms>[+<hold ms>] or turn:<a>,<b>@<ms>:<detents>[/<ms each>]")
+    parser.add_argument("--bounce", type=int, default=3, help="extra toggles per contact change (3)")
+    parser.add_argument("--bounce-us", type=int, default=300, help="longest gap between two of them (300)")
+    parser.add_argument("--seed", type=int, default=1, help="of the bounce gaps (1)")
+    parser.add_argument("-o", "--output", help="edge file, stdout if omitted")
+    args = parser.parse_args()
+
+    script = Script(args.bounce, args.bounce_us, random.Random(args.seed))
+    expect = []
+    for action in args.actions:
+        m = CLICK.match(action)
+        if m:
+            pin, at_ms, hold_ms = int(m.group(1)), int(m.group(2)), int(m.group(3) or 100)
+            script.click(pin, at_ms, hold_ms)
+            expect.append(f"{at_ms} ms: press and release of pin {pin}")
+            continue
+        m = TURN.match(action)
+        if m:
+            a, b, at_ms, detents = int(m.group(1)), int(m.group(2)), int(m.group(3)), int(m.group(4))
+            script.turn(a, b, at_ms, detents, int(m.group(5) or 20))
+            expect.append(f"{at_ms} ms: turn of {detents:+d} on pins {a},{b}")
+            continue
+        parser.error(f"unknown action {action}")
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    out.write("# " + " ".join(args.actions) + "\n")
+    for at_us, pin, level in sorted(script.edges, key=lambda e: e[0]):
+        out.write(f"{at_us} {pin} {level}\n")
+    for line in expect:
+        print(line, file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
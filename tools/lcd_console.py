@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Drive the LCD through the command console of src/console.h.
+
+Sends the given commands, or streams whole frames at a fixed rate, to the
+USB serial port of the board or to stdout for the host build:
+
+    python3 tools/lcd_console.py --port /dev/ttyACM0 "line 0 Hola" show
+    python3 tools/lcd_console.py --port /dev/ttyACM0 --stream 30 --seconds 10 stats
+    python3 tools/lcd_console.py --stream 30 --seconds 5 stats --quit | ./main_blinky_host
+
+Streamed frames are a counter and a bar moving one cell per frame, every
+cell of the display changes. With --port the answers are read back: lines
+other than OK are printed, and the OK and ERR counts at the end. Reading
+them matters on target, stdio output nobody reads holds the console up.
+"""
+import argparse
+import os
+import sys
+import termios
+import threading
+import time
+import tty
+
+ROWS = 4
+COLS = 16
+
+
+def frame(n):
+    rows = [f"frame {n:>10}".ljust(COLS)[:COLS]]
+    for r in range(1, ROWS):
+        pos = (n + 5 * r) % COLS
+        rows.append("".join("#" if c == pos else "-" for c in range(COLS)))
+    return "frame " + "".join(row.encode("ascii").hex() for row in rows)
+
+
+class Port:
+    def __init__(self, path):
+        self.counts = {"OK": 0, "ERR": 0}
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        termios.tcflush(self.fd, termios.TCIFLUSH)
+        threading.Thread(target=self.read, daemon=True).start()
+
+    def read(self):
+        pending = b""
+        while True:
+            data = os.read(self.fd, 4096)
+            if not data:
+                return
+            pending += data
+            *lines, pending = pending.split(b"\n")
+            for raw in lines:
+                # Frames of the binary log share the stream
+                line = raw.rsplit(b"\0", 1)[-1].decode("ascii", "replace").strip()
+                word = line.split(" ", 1)[0]
+                if word in self.counts:
+                    self.counts[word] += 1
+                if line and line != "OK":
+                    print(line, flush=True)
+
+    def write(self, text):
+        os.write(self.fd, text.encode())
+
+
+class Stdout:
+    counts = None
+
+    def write(self, text):
+        sys.stdout.write(text)
+        sys.stdout.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("commands", nargs="*", help="sent after the stream")
+    parser.add_argument("--port", help="serial device, stdout if omitted")
+    parser.add_argument("--stream", type=float, metavar="FPS", help="send whole frames at this rate")
+    parser.add_argument("--seconds", type=float, default=5.0, help="length of the stream")
+    parser.add_argument("--quit", action="store_true", help="end with quit, the host build exits")
+    args = parser.parse_args()
+
+    out = Port(args.port) if args.port else Stdout()
+    sent = 0
+    start = time.monotonic()
+    if args.stream:
+        period = 1.0 / args.stream
+        while sent < args.stream * args.seconds:
+            out.write(frame(sent) + "\n")
+            sent += 1
+            delay = start + sent * period - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+    for command in args.commands:
+        out.write(command + "\n")
+    if args.quit:
+        out.write("quit\n")
+    if out.counts is not None:
+        # Time for the last answers
+        time.sleep(0.5)
+        elapsed = time.monotonic() - start
+        print(f"{sent} frames in {elapsed:.1f} s, OK {out.counts['OK']}, ERR {out.counts['ERR']}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""Report the static RAM use of a firmware image per subsystem.
+
+Reads the GNU ld map file written next to the ELF (pico_add_extra_outputs)
+and sums every input section placed in SRAM, or with --flash in XIP flash.
+Run as a post build step of main_blinky, or by hand:
+
+    python3 tools/ram_report.py build/src/main_blinky.elf.map
+    python3 tools/ram_report.py --objects build/src/main_blinky.elf.map
+    python3 tools/ram_report.py --flash --objects build/src/driver_bench.elf.map
+    python3 tools/ram_report.py --flash --objects --members build/src/fmt_bench.elf.map
+
+--code counts code and constants by section name at any address, for maps
+of the host build:
+
+    python3 tools/ram_report.py --code --objects build/src/host/fmt_bench_host.map
+"""
+import argparse
+import re
+import sys
+from collections import defaultdict
+
+# RP2040 striped SRAM plus the two 4 KB scratch banks
+RAM_START = 0x20000000
+RAM_END = 0x20042000
+# XIP flash window, initialised data is counted at its RAM address
+FLASH_START = 0x10000000
+FLASH_END = 0x11000000
+
+SECTION = re.compile(r"^ (\.\S+|COMMON)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(.+))?$")
+CONTINUATION = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(.+)$")
+HEAP_OBJECT = re.compile(r"heap_\d\.c")
+ARCHIVE_MEMBER = re.compile(r"\((?:lib_a-)?([^()]+?)(?:\.o)?\)$")
+
+
+def subsystem(section, obj, members=False):
+    if section.startswith(".heap"):
+        return "newlib heap"
+    if section.startswith(".stack"):
+        return "boot stacks"
+    if HEAP_OBJECT.search(obj):
+        return "freertos heap"
+    if "FreeRTOS-Kernel" in obj or "FreeRTOS_Kernel" in obj:
+        return "kernel"
+    if "pico-sdk" in obj or "pico_sdk" in obj or "/pico_" in obj or "/hardware_" in obj:
+        return "sdk"
+    if re.search(r"lib(c|g|gcc|m|nosys|stdc\+\+)(_nano)?\.a", obj):
+        member = ARCHIVE_MEMBER.search(obj)
+        return f"libc {member.group(1)}" if members and member else "libc"
+    name = obj.rsplit("/", 1)[-1]
+    for suffix in (".obj", ".o"):
+        if name.endswith(suffix):
+            name = name[: -len(suffix)]
+    return name
+
+
+def parse(lines):
+    sections = []
+    pending = None
+    for line in lines:
+        line = line.rstrip("\n")
+        if pending is not None:
+            m = CONTINUATION.match(line)
+            if m:
+                sections.append((pending, int(m.group(1), 16), int(m.group(2), 16), m.group(3).strip()))
+            pending = None
+            continue
+        m = SECTION.match(line)
+        if not m:
+            continue
+        if m.group(2) is None:
+            # Long section names put the address on the next line
+            pending = m.group(1)
+        else:
+            sections.append((m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4).strip()))
+    return sections
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("map", help="linker map file")
+    parser.add_argument("--objects", action="store_true", help="also list every object")
+    parser.add_argument("--flash", action="store_true", help="flash instead of RAM")
+    parser.add_argument("--code", action="store_true", help=".text and .rodata at any address")
+    parser.add_argument("--members", action="store_true", help="split libc into its archive members")
+    args = parser.parse_args()
+    start, end = (FLASH_START, FLASH_END) if args.flash else (RAM_START, RAM_END)
+
+    with open(args.map, errors="replace") as f:
+        sections = parse(f)
+
+    totals = defaultdict(int)
+    objects = defaultdict(int)
+    for section, addr, size, obj in sections:
+        if size == 0:
+            continue
+        if args.code:
+            if not section.startswith((".text", ".rodata")):
+                continue
+        elif not start <= addr < end:
+            continue
+        # Code copied to RAM (.time_critical) counts as well, it takes SRAM
+        totals[subsystem(section, obj, args.members)] += size
+        objects[obj] += size
+
+    total = sum(totals.values())
+    print(f"{'subsystem':<24}{'bytes':>10}")
+    for name, size in sorted(totals.items(), key=lambda kv: -kv[1]):
+        print(f"{name:<24}{size:>10}")
+    if args.code:
+        print(f"{'total':<24}{total:>10}")
+    else:
+        print(f"{'total':<24}{total:>10}  of {end - start}")
+
+    if args.objects:
+        print()
+        for obj, size in sorted(objects.items(), key=lambda kv: -kv[1]):
+            print(f"{size:>10}  {obj}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
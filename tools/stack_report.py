@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Recommend task stack sizes from the STACK lines of src/stack_profile.c.
+
+Reads the stdio capture of a stack_profile run (or of any firmware, the
+lines come with every task table), keeps the deepest use of each task and
+prints it with the size recommended: the use plus a margin, rounded up to
+whole 8 byte units. With --header it also writes the STACK_SIZE_<NAME>
+defines that main.c takes when configured with -DSTACK_SIZES=<header>.
+
+    python3 tools/lcd_console.py --port /dev/ttyACM0 --stream 30 --seconds 25 stats
+    python3 tools/stack_report.py capture.txt
+    python3 tools/stack_report.py --margin 25 --header build/stack_sizes.h capture.txt
+
+Capture on target: the host tasks are pthreads, their use says nothing about
+the target stacks, and the host build ignores STACK_SIZES.
+"""
+import argparse
+import re
+import sys
+
+STACK = re.compile(r"STACK (\S+) depth=(\d+) free=(\d+) used=(\d+)")
+
+# Words a task needs before it runs a line of its own: the context the
+# port saves on a switch and an exception frame on top
+FLOOR_WORDS = 64
+
+
+def parse(lines):
+    tasks = {}
+    for line in lines:
+        # Frames of src/dlog.c share the stream, the text follows their last 0x00
+        m = STACK.search(line.rsplit("\0", 1)[-1])
+        if not m:
+            continue
+        name = m.group(1)
+        depth, used = int(m.group(2)), int(m.group(4))
+        tasks[name] = (depth, max(used, tasks.get(name, (depth, 0))[1]))
+    return tasks
+
+
+def recommend(used, margin, extra):
+    words = used + (used * margin + 99) // 100 + extra
+    # Stacks of the Cortex-M0+ stay 8 byte aligned
+    return max(FLOOR_WORDS, (words + 1) // 2 * 2)
+
+
+def macro(name):
+    return "STACK_SIZE_" + re.sub(r"[^A-Za-z0-9]", "_", name).upper()
+
+
+def write_header(path, tasks, sizes, source, margin, extra):
+    with open(path, "w") as out:
+        out.write("/* Generated by tools/stack_report.py from %s, do not edit.\n" % source)
+        out.write("Deepest use measured plus %d %% and %d words, in words. */\n" % (margin, extra))
+        out.write("#ifndef STACK_SIZES_H\n#define STACK_SIZES_H\n\n")
+        for name in sorted(tasks):
+            out.write("#define %-32s( %d ) // used %d\n" % (macro(name), sizes[name], tasks[name][1]))
+        out.write("\n#endif\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="capture file, stdin if omitted")
+    parser.add_argument("--margin", type=int, default=25, help="percent over the deepest use (25)")
+    parser.add_argument("--extra", type=int, default=32, help="words over the margin (32)")
+    parser.add_argument("--current", type=int, default=256,
+                        help="words every task has without the header (configMINIMAL_STACK_SIZE, 256)")
+    parser.add_argument("--header", help="write the STACK_SIZE_<NAME> defines here")
+    args = parser.parse_args()
+
+    src = open(args.capture, errors="replace") if args.capture else sys.stdin
+    tasks = parse(src)
+    if not tasks:
+        print("no STACK lines found")
+        return 1
+
+    sizes = {name: recommend(used, args.margin, args.extra) for name, (_, used) in tasks.items()}
+    print(f"{'task':<12}{'depth':>8}{'used':>8}{'recommended':>13}{'saved':>8}")
+    saved = 0
+    for name, (depth, used) in sorted(tasks.items()):
+        print(f"{name:<12}{depth:>8}{used:>8}{sizes[name]:>13}{args.current - sizes[name]:>8}")
+        saved += args.current - sizes[name]
+    print(f"words saved against {args.current} words a task: {saved} ({saved * 4} bytes)")
+    for name, (depth, used) in sorted(tasks.items()):
+        if depth - used < args.extra:
+            print(f"warning: {name} came within {depth - used} words of its end, profile it deeper")
+
+    if args.header:
+        write_header(args.header, tasks, sizes, args.capture or "stdin", args.margin, args.extra)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Decode the trace output of src/trace.c.
+
+Reads the stdio capture (USB serial or host build stdout) and prints the
+per task CPU share, stack high water marks, tickless idle statistics and
+optionally the timeline or the release cadence of a queue's sender.
+
+    python3 tools/trace_decode.py capture.txt
+    python3 tools/trace_decode.py --timeline < /dev/ttyACM0
+    python3 tools/trace_decode.py --cadence 1 capture.txt
+"""
+import argparse
+import struct
+import sys
+
+RECORD = struct.Struct("<IBBH")
+
+EVENTS = {
+    1: "switch_in",
+    2: "switch_out",
+    3: "queue_send",
+    4: "queue_receive",
+    5: "isr_enter",
+    6: "isr_exit",
+}
+
+
+def parse(lines):
+    records = []
+    snapshots = []
+    sleeps = []
+    tasks = {}
+    dropped = 0
+    total = 0
+    for line in lines:
+        # Frames of src/dlog.c share the stream, the text follows their last 0x00
+        parts = line.rsplit("\0", 1)[-1].strip().split(" ", 1)
+        if len(parts) != 2:
+            continue
+        kind, rest = parts
+        if kind == "TRACE":
+            try:
+                raw = bytes.fromhex(rest)
+            except ValueError:
+                continue
+            for off in range(0, len(raw) - RECORD.size + 1, RECORD.size):
+                records.append(RECORD.unpack_from(raw, off))
+        elif kind == "TASK":
+            number, runtime, hwm, name = rest.split(" ", 3)
+            tasks[int(number)] = (name, int(runtime), int(hwm))
+        elif kind == "TOTAL":
+            total, dropped = (int(v) for v in rest.split())
+            snapshots.append((total, dict(tasks)))
+            tasks = {}
+        elif kind == "SLEEP":
+            # sleeps, early wakeups, us asleep, suppressed ticks, ticks
+            sleeps.append((total, [int(v) for v in rest.split()]))
+    return records, snapshots, sleeps, dropped
+
+
+def print_cpu(snapshots, dropped):
+    if not snapshots:
+        print("no task table found")
+        return
+    total, tasks = snapshots[-1]
+    base_total, base = (0, {}) if len(snapshots) < 2 else snapshots[-2]
+    window = total - base_total
+    print(f"{'task':<16}{'number':>8}{'cpu %':>10}{'stack hwm':>12}")
+    for number, (name, runtime, hwm) in sorted(tasks.items()):
+        delta = runtime - base.get(number, (name, 0, 0))[1]
+        share = 100.0 * delta / window if window else 0.0
+        print(f"{name:<16}{number:>8}{share:>10.2f}{hwm:>12}")
+    print(f"window {window} us, dropped records {dropped}")
+
+
+def print_sleep(sleeps):
+    if len(sleeps) < 2:
+        return
+    (t0, a), (t1, b) = sleeps[-2], sleeps[-1]
+    window = t1 - t0
+    if window <= 0:
+        return
+    d = [y - x for x, y in zip(a, b)]
+    per_s = 1e6 / window
+    print(f"wakeups/s {d[0] * per_s:.1f} (early {d[1] * per_s:.1f}), "
+          f"asleep {100.0 * d[2] / window:.2f} %, "
+          f"ticks/s {d[4] * per_s:.1f}, suppressed ticks/s {d[3] * per_s:.1f}")
+
+
+def print_cadence(records, queue):
+    sends = sorted(r[0] for r in records if r[1] == 3 and r[3] == queue)
+    periods = [b - a for a, b in zip(sends, sends[1:])]
+    if not periods:
+        print(f"no sends on queue {queue}")
+        return
+    print(f"queue {queue} send period us: min {min(periods)} "
+          f"avg {sum(periods) / len(periods):.1f} max {max(periods)} ({len(periods)} periods)")
+
+
+def print_timeline(records, snapshots):
+    names = {}
+    for _, tasks in snapshots:
+        names.update({n: t[0] for n, t in tasks.items()})
+    for ts, event, core, arg in sorted(records, key=lambda r: r[0]):
+        ev = EVENTS.get(event, str(event))
+        what = names.get(arg, str(arg)) if event in (1, 2) else str(arg)
+        print(f"{ts:>12} core{core} {ev:<14} {what}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="capture file, stdin if omitted")
+    parser.add_argument("--timeline", action="store_true", help="print every record")
+    parser.add_argument("--cadence", type=int, metavar="QUEUE",
+                        help="period between sends to the queue with this number")
+    args = parser.parse_args()
+
+    src = open(args.capture, errors="replace") if args.capture else sys.stdin
+    records, snapshots, sleeps, dropped = parse(src)
+    print_cpu(snapshots, dropped)
+    print_sleep(sleeps)
+    if args.cadence is not None:
+        print_cadence(records, args.cadence)
+    if args.timeline:
+        print_timeline(records, snapshots)
+
+
+if __name__ == "__main__":
+    main()